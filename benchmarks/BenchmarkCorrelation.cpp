@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/risk/RollingCorrelation.h"
+
+// one resampling step of the rolling correlation engine (every symbol priced, the interval closed, the
+// snapshot published) against the size of the universe, at a one-hour window of one-second returns
+
+static void BM_CorrelationStep(benchmark::State& state) {
+  const auto symbols = static_cast<std::size_t>(state.range(0));
+  RollingCorrelation correlation(3600, 1000, symbols);
+  for (std::size_t i = 0; i < symbols; ++i) {
+    correlation.add_symbol("sym" + std::to_string(i));
+  }
+  std::mt19937_64 rng(11);
+  std::lognormal_distribution<double> move(0.0, 0.001);
+  std::vector<double> prices(symbols, 100.0);
+  std::int64_t second = 0;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < symbols; ++i) {
+      prices[i] *= move(rng);
+      correlation.on_price(static_cast<std::uint32_t>(i), prices[i], second * 1000 + 1);
+    }
+    ++second;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_CorrelationSnapshot(benchmark::State& state) {
+  RollingCorrelation correlation(60, 1000, 500);
+  for (std::size_t i = 0; i < 500; ++i) {
+    correlation.add_symbol("sym" + std::to_string(i));
+    correlation.on_price(static_cast<std::uint32_t>(i), 100.0, 1);
+  }
+  correlation.advance_to(1000);
+  for (auto _ : state) {
+    std::shared_ptr<const CorrelationSnapshot> snapshot = correlation.snapshot();
+    benchmark::DoNotOptimize(snapshot->correlation_at(3, 7));
+  }
+}
+
+BENCHMARK(BM_CorrelationStep)->Arg(50)->Arg(200)->Arg(500)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CorrelationSnapshot);
+
+BENCHMARK_MAIN();
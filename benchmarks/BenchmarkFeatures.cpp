@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/ml/FeaturePipeline.h"
+
+// cost of one feature row on the trade path (lookup, incremental state, row written into the ring), with a
+// consumer draining the ring in batches as a streaming reader would
+
+static void BM_FeatureRow(benchmark::State& state) {
+  const auto symbols = static_cast<std::size_t>(state.range(0));
+  FeaturePipeline pipeline(1 << 12);
+  std::vector<Coin> coins;
+  coins.reserve(symbols);
+  for (std::size_t i = 0; i < symbols; ++i) {
+    coins.emplace_back("sym" + std::to_string(i) + "usdt");
+  }
+  std::mt19937_64 rng(3);
+  std::lognormal_distribution<double> move(0.0, 0.0005);
+  std::vector<CoinData> trades(1 << 12);
+  std::vector<std::size_t> trade_symbol(trades.size());
+  std::vector<double> prices(symbols, 100.0);
+  for (std::size_t i = 0; i < trades.size(); ++i) {
+    const std::size_t symbol = rng() % symbols;
+    trade_symbol[i] = symbol;
+    prices[symbol] *= move(rng);
+    trades[i] = CoinData{coins[symbol].symbol(), prices[symbol], static_cast<long>(i), 0.1, static_cast<long>(i) * 10};
+    coins[symbol].update_trade(trades[i]);
+  }
+
+  std::size_t i = 0;
+  double checksum = 0.0;
+  for (auto _ : state) {
+    const std::size_t k = i & (trades.size() - 1);
+    pipeline.on_trade(coins[trade_symbol[k]], trades[k]);
+    if ((++i & 255) == 0) {
+      pipeline.consume([&](const FeatureRow* rows, std::size_t count) { checksum += rows[count - 1].price; });
+    }
+  }
+  benchmark::DoNotOptimize(checksum);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["dropped"] = static_cast<double>(pipeline.dropped());
+}
+
+BENCHMARK(BM_FeatureRow)->Arg(1)->Arg(64);
+
+BENCHMARK_MAIN();
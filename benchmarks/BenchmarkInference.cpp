@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "../include/ml/Model.h"
+
+// per-prediction cost of the embedded models: a linear model over every feature, and complete forests of
+// state.range(0) trees of depth state.range(1), one row at a time (the tick path) and in batches across symbols
+
+namespace {
+  std::vector<FeatureRow> random_rows(std::size_t count) {
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> value(0.0, 1.0);
+    std::vector<FeatureRow> rows(count);
+    for (FeatureRow& row : rows) {
+      for (double& v : row.values) {
+        v = value(rng);
+      }
+    }
+    return rows;
+  }
+
+  Model random_forest(int trees, int depth) {
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> value(0.0, 1.0);
+    std::ostringstream text;
+    text << "model forest\nfeatures";
+    for (const char* name : FEATURE_NAMES) {
+      text << ' ' << name;
+    }
+    text << '\n';
+    const int nodes = (1 << (depth + 1)) - 1;
+    for (int t = 0; t < trees; ++t) {
+      text << "tree " << nodes << '\n';
+      for (int n = 0; n < nodes; ++n) {
+        if (n < (1 << depth) - 1) {
+          text << "split " << rng() % FEATURE_COUNT << ' ' << value(rng) << ' ' << 2 * n + 1 << ' ' << 2 * n + 2
+               << '\n';
+        } else {
+          text << "leaf " << value(rng) << '\n';
+        }
+      }
+    }
+    std::istringstream in(text.str());
+    Model model;
+    model.load(in);
+    return model;
+  }
+}
+
+static void BM_LinearPredict(benchmark::State& state) {
+  std::ostringstream text;
+  text << "model linear\nlink logistic\nfeatures";
+  for (const char* name : FEATURE_NAMES) {
+    text << ' ' << name;
+  }
+  text << "\nweights";
+  for (unsigned i = 0; i < FEATURE_COUNT; ++i) {
+    text << ' ' << 0.1 * i;
+  }
+  std::istringstream in(text.str() + "\n");
+  Model model;
+  model.load(in);
+  const std::vector<FeatureRow> rows = random_rows(1024);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.predict(rows[i++ & 1023]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ForestPredict(benchmark::State& state) {
+  const Model model = random_forest(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  const std::vector<FeatureRow> rows = random_rows(1024);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.predict(rows[i++ & 1023]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ForestPredictBatch(benchmark::State& state) {
+  const Model model = random_forest(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  const std::vector<FeatureRow> rows = random_rows(64);
+  std::vector<double> out(rows.size());
+  for (auto _ : state) {
+    model.predict_batch(rows.data(), rows.size(), out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rows.size()));
+}
+
+BENCHMARK(BM_LinearPredict);
+BENCHMARK(BM_ForestPredict)->Args({32, 6})->Args({100, 8});
+BENCHMARK(BM_ForestPredictBatch)->Args({32, 6})->Args({100, 8});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include "../include/metrics/LatencyTracker.h"
+
+// cost per message of the instrumentation alone, in each tracker mode
+static void stamp_message(LatencyTracker& tracker) {
+  if (tracker.begin_message()) {
+    MessageStamps stamps{};
+    stamps.receive_tick = Clock::ticks();
+    stamps.exchange_time_ms = Clock::to_wall_ns(stamps.receive_tick) / 1000000 - 3;
+    stamps.parse_tick = Clock::ticks();
+    stamps.apply_tick = Clock::ticks();
+    stamps.render_tick = Clock::ticks();
+    tracker.record(stamps);
+  }
+}
+
+static void BM_LatencyOff(benchmark::State& state) {
+  LATENCY_TRACKER.set_mode(LatencyMode::off);
+  for (auto _ : state) {
+    stamp_message(LATENCY_TRACKER);
+  }
+}
+
+static void BM_LatencySampled(benchmark::State& state) {
+  LATENCY_TRACKER.set_mode(LatencyMode::sampled, static_cast<std::uint32_t>(state.range(0)));
+  for (auto _ : state) {
+    stamp_message(LATENCY_TRACKER);
+  }
+}
+
+static void BM_LatencyFull(benchmark::State& state) {
+  LATENCY_TRACKER.set_mode(LatencyMode::full);
+  for (auto _ : state) {
+    stamp_message(LATENCY_TRACKER);
+  }
+}
+
+BENCHMARK(BM_LatencyOff);
+BENCHMARK(BM_LatencySampled)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_LatencyFull);
+
+BENCHMARK_MAIN();
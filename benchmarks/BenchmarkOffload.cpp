@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../include/common/MovingAverageBackend.h"
+#include "../include/fpga/FpgaEmulator.h"
+#include "../include/fpga/OffloadMovingAverageBackend.h"
+
+// moving-average updates per second and batch round trip through the offload path, against the pty emulator,
+// for batch sizes state.range(0); state.range(1) is the emulated UART's baud rate, 0 for no wire delay.
+// The native backend is the in-process baseline.
+
+namespace {
+  constexpr std::size_t CHANNELS = 16;
+
+  std::vector<double> random_prices() {
+    std::mt19937_64 rng(9);
+    std::uniform_real_distribution<double> price(60000.0, 70000.0);
+    std::vector<double> prices(1 << 12);
+    for (double& p : prices) {
+      p = price(rng);
+    }
+    return prices;
+  }
+}
+
+static void BM_NativeUpdate(benchmark::State& state) {
+  NativeMovingAverageBackend backend;
+  for (std::size_t i = 0; i < CHANNELS; ++i) {
+    backend.add_channel(512);
+  }
+  const std::vector<double> prices = random_prices();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    backend.update(static_cast<std::uint32_t>(i % CHANNELS), prices[i & (prices.size() - 1)]);
+    ++i;
+  }
+  benchmark::DoNotOptimize(backend.value(0));
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_OffloadUpdate(benchmark::State& state) {
+  FpgaEmulator emulator(static_cast<unsigned>(state.range(1)));
+  OffloadMovingAverageBackend backend(static_cast<std::size_t>(state.range(0)));
+  if (!emulator.start() || !backend.open(emulator.device())) {
+    state.SkipWithError("no emulator");
+    return;
+  }
+  for (std::size_t i = 0; i < CHANNELS; ++i) {
+    backend.add_channel(512);
+  }
+  const std::vector<double> prices = random_prices();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    backend.update(static_cast<std::uint32_t>(i % CHANNELS), prices[i & (prices.size() - 1)]);
+    ++i;
+  }
+  backend.flush();
+  state.SetItemsProcessed(state.iterations());
+  const LatencyHistogram& round_trip = backend.round_trip();
+  state.counters["rtt_p50_us"] = static_cast<double>(round_trip.percentile(50.0)) / 1000.0;
+  state.counters["rtt_p99_us"] = static_cast<double>(round_trip.percentile(99.0)) / 1000.0;
+  state.counters["bytes_per_update"] =
+      static_cast<double>(backend.bytes_sent() + backend.bytes_received()) / static_cast<double>(backend.updates());
+}
+
+BENCHMARK(BM_NativeUpdate);
+BENCHMARK(BM_OffloadUpdate)->ArgsProduct({{1, 16, 128, 1024}, {0, 921600}})->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../include/exchange/OrderBook.h"
+
+// order flow around a fixed mid: mostly passive limits, a third of them cancelled again, some crossing
+
+namespace {
+  struct Op {
+    enum Kind { add, cancel, cross } kind;
+    OrderSide side;
+    std::int64_t price;
+    std::int64_t quantity;
+    std::uint64_t id; // to cancel
+  };
+
+  std::vector<Op> order_flow(std::size_t count) {
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<int> kind(0, 99);
+    std::uniform_int_distribution<std::int64_t> offset(1, 50);
+    std::uniform_int_distribution<std::int64_t> quantity(1, 20);
+    std::vector<Op> ops;
+    std::vector<std::uint64_t> live;
+    ops.reserve(count);
+    const std::int64_t mid = 100000;
+    for (std::uint64_t id = 1; ops.size() < count; ++id) {
+      const int k = kind(rng);
+      const OrderSide side = rng() & 1 ? OrderSide::buy : OrderSide::sell;
+      if (k < 30 && !live.empty()) {
+        const std::size_t pick = rng() % live.size();
+        ops.push_back({Op::cancel, side, 0, 0, live[pick]});
+        live[pick] = live.back();
+        live.pop_back();
+      } else if (k < 40) {
+        ops.push_back({Op::cross, side, side == OrderSide::buy ? mid + 5 : mid - 5, quantity(rng), id});
+      } else {
+        const std::int64_t price = side == OrderSide::buy ? mid - offset(rng) : mid + offset(rng);
+        ops.push_back({Op::add, side, price, quantity(rng), id});
+        live.push_back(id);
+      }
+    }
+    return ops;
+  }
+}
+
+static void BM_OrderBookFlow(benchmark::State& state) {
+  const std::vector<Op> ops = order_flow(1 << 20);
+  std::vector<BookFill> fills;
+  fills.reserve(1024);
+  for (auto _ : state) {
+    OrderBook book(1 << 16);
+    for (const Op& op : ops) {
+      fills.clear();
+      switch (op.kind) {
+        case Op::add: book.add(op.id, op.side, op.price, op.quantity, true, fills); break;
+        case Op::cancel: book.cancel(op.id); break; // may already be filled
+        case Op::cross: book.add(op.id, op.side, op.price, op.quantity, false, fills); break;
+      }
+    }
+    benchmark::DoNotOptimize(book.order_count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ops.size()));
+}
+
+BENCHMARK(BM_OrderBookFlow)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../include/common/MovingAverage.h"
+#include "../include/strategy/Pipeline.h"
+#include "../include/strategy/RuntimePipeline.h"
+
+// cost per trade of the same SMA(512) / EMA(50) / cross configuration, fused at compile time vs virtual
+
+static std::vector<double> random_walk() {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> step(0.0, 0.5);
+  std::vector<double> prices(1 << 16);
+  double price = 100.0;
+  for (double& p : prices) {
+    p = price += step(rng);
+  }
+  return prices;
+}
+
+static void BM_CompiledPipeline(benchmark::State& state) {
+  const std::vector<double> prices = random_walk();
+  Pipeline<SMA<512>, EMA<50>, CrossRule<EMA<50>, SMA<512>>> pipeline;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pipeline.update(prices[i++ & (prices.size() - 1)]));
+  }
+}
+
+static void BM_RuntimePipeline(benchmark::State& state) {
+  const std::vector<double> prices = random_walk();
+  RuntimePipeline pipeline;
+  Indicator& slow = pipeline.add_indicator(std::make_unique<RuntimeSMA>(512));
+  Indicator& fast = pipeline.add_indicator(std::make_unique<RuntimeEMA>(50));
+  pipeline.add_rule(std::make_unique<RuntimeCrossRule>(fast, slow));
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pipeline.update(prices[i++ & (prices.size() - 1)]));
+  }
+}
+
+// what Coin does today: MovingAverage on its native backend plus the below/above check
+static void BM_MovingAverageCheck(benchmark::State& state) {
+  const std::vector<double> prices = random_walk();
+  MovingAverage average(MA_STANDARD_SIZE);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const double price = prices[i++ & (prices.size() - 1)];
+    average.update(price);
+    benchmark::DoNotOptimize(average.is_price_below_MA(price));
+  }
+}
+
+BENCHMARK(BM_CompiledPipeline);
+BENCHMARK(BM_RuntimePipeline);
+BENCHMARK(BM_MovingAverageCheck);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/risk/RiskManager.h"
+
+// pre-trade check latency over a book of symbols with open positions, orders spread randomly across them
+// so a fraction of checks fail; and the cost of the incremental updates feeding the checks
+
+namespace {
+  struct Order {
+    std::uint32_t symbol;
+    OrderSide side;
+    double quantity;
+    double price;
+  };
+
+  RiskManager make_book(std::size_t symbols) {
+    RiskManager risk(symbols);
+    SymbolRiskLimits limits;
+    limits.max_position = 10.0;
+    limits.max_notional = 1000.0;
+    limits.max_order_notional = 300.0;
+    limits.max_price_deviation = 0.05;
+    limits.stop_loss = 0.1;
+    GlobalRiskLimits global;
+    global.max_gross_notional = 500.0 * static_cast<double>(symbols);
+    global.max_daily_loss = 1000.0;
+    risk.set_global_limits(global);
+    for (std::size_t i = 0; i < symbols; ++i) {
+      const std::uint32_t index = risk.add_symbol("sym" + std::to_string(i), limits);
+      risk.on_fill(index, i & 1 ? OrderSide::buy : OrderSide::sell, static_cast<double>(i % 8), 100.0);
+    }
+    return risk;
+  }
+
+  std::vector<Order> orders(std::size_t symbols, std::size_t count) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> quantity(0.1, 4.0);
+    std::uniform_real_distribution<double> price(94.0, 106.0);
+    std::vector<Order> out(count);
+    for (Order& order : out) {
+      order = {static_cast<std::uint32_t>(rng() % symbols), rng() & 1 ? OrderSide::buy : OrderSide::sell,
+               quantity(rng), price(rng)};
+    }
+    return out;
+  }
+}
+
+static void BM_RiskCheck(benchmark::State& state) {
+  const auto symbols = static_cast<std::size_t>(state.range(0));
+  const RiskManager risk = make_book(symbols);
+  const std::vector<Order> flow = orders(symbols, 1 << 16);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Order& order = flow[i++ & (flow.size() - 1)];
+    benchmark::DoNotOptimize(risk.check(order.symbol, order.side, order.quantity, order.price));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_RiskFill(benchmark::State& state) {
+  const auto symbols = static_cast<std::size_t>(state.range(0));
+  RiskManager risk = make_book(symbols);
+  const std::vector<Order> flow = orders(symbols, 1 << 16);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Order& order = flow[i++ & (flow.size() - 1)];
+    risk.on_fill(order.symbol, order.side, order.quantity, order.price);
+  }
+  benchmark::DoNotOptimize(risk.total_pnl());
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_RiskPrice(benchmark::State& state) {
+  const auto symbols = static_cast<std::size_t>(state.range(0));
+  RiskManager risk = make_book(symbols);
+  const std::vector<Order> flow = orders(symbols, 1 << 16);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Order& order = flow[i++ & (flow.size() - 1)];
+    risk.on_price(order.symbol, order.price);
+  }
+  benchmark::DoNotOptimize(risk.gross_notional());
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RiskCheck)->Arg(16)->Arg(1024);
+BENCHMARK(BM_RiskFill)->Arg(16)->Arg(1024);
+BENCHMARK(BM_RiskPrice)->Arg(16)->Arg(1024);
+
+BENCHMARK_MAIN();
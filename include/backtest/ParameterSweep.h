@@ -0,0 +1,62 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Grid of MA mean-reversion parameters: every window is combined with every threshold.
+// Rule per parameter set: while flat, buy once the price is more than threshold below the window's
+// simple moving average; while long, sell once it is more than threshold above. Orders fill on the next
+// trade with slippage and fees, as in Backtester with zero latency. Position is 0 or 1 unit.
+struct SweepConfig {
+  std::string history_dir;
+  std::vector<std::string> symbols; // empty: every symbol with a capture
+  std::int64_t begin_ms = 0;
+  std::int64_t end_ms = std::numeric_limits<std::int64_t>::max();
+
+  std::vector<std::size_t> windows;
+  std::vector<double> thresholds; // fractions, 0.001 = 0.1 %
+
+  double slippage_bps = 0.0;
+  double fee_rate = 0.001;
+  unsigned threads = 0;
+};
+
+struct SweepResult {
+  std::string symbol;
+  std::size_t window;
+  double threshold;
+  double pnl; // open position marked at the last price, fees included
+  double fees;
+  std::uint64_t fills;
+  double max_drawdown;
+};
+
+// Evaluates the whole grid in one pass per symbol. Each symbol's trades are read once into a price
+// array; parameter sets are laid out structure-of-arrays, one slot per set, and every tick updates all
+// slots of a shard in straight-line loops the compiler vectorises. Shards (groups of windows, with all
+// their thresholds) run in parallel on a WorkStealingPool over the same shared price array.
+class ParameterSweep {
+private:
+  SweepConfig config_;
+
+public:
+  explicit ParameterSweep(SweepConfig config);
+
+  // one block of results per symbol, in symbol order, each ranked by P&L, best first. Symbols are not
+  // summed: every one trades a single unit of its own base asset. Empty if any window is zero; a symbol
+  // with fewer trades than the longest window is skipped.
+  [[nodiscard]] std::vector<SweepResult> run() const;
+  // simulates the given windows x thresholds over one price series; used by run() per shard. Empty if a
+  // window is zero or longer than the series.
+  static std::vector<SweepResult> simulate(const std::vector<double>& prices, const std::vector<std::size_t>& windows,
+                                           const std::vector<double>& thresholds, double slippage_bps,
+                                           double fee_rate);
+
+  // symbol,rank,window,threshold,pnl,fees,fills,max_drawdown; rank restarts at 1 for every symbol
+  static bool write_table(const std::vector<SweepResult>& results, const std::string& path);
+};
+
+#endif //PARAMETERSWEEP_H
@@ -0,0 +1,55 @@
+#ifndef MARKETBUS_H
+#define MARKETBUS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "market_bus.h"
+#include "../common/Coin.h"
+#include "../feed/MarketDataFeed.h"
+
+#define MARKET_BUS_DEFAULT_SYMBOLS 256
+#define MARKET_BUS_DEFAULT_EVENTS (1 << 16) // rounded up to a power of two
+
+// Write side of the shared-memory market data bus (layout and reader API in market_bus.h). CoinManager
+// publishes every trade it applies and every quote it receives: the symbol's slot is rewritten under its
+// sequence counter and trades are appended to the broadcast ring, a few stores each and no system calls,
+// so local processes (the Python ML service, monitors) share one feed instead of opening their own.
+// Not thread-safe, add_symbol() included: calls must not overlap. CoinManager makes every one of them under its
+// feed mutex, which it holds through each dispatch and while it adds coins or attaches the bus.
+class MarketBus {
+private:
+  std::string name_;
+  void* base_;
+  std::size_t size_;
+  market_bus_header* header_;
+  market_bus_slot* slots_;
+  market_bus_event* events_;
+  std::unordered_map<std::string, std::uint32_t> index_;
+
+  void touch();
+
+public:
+  MarketBus();
+  ~MarketBus();
+  MarketBus(const MarketBus&) = delete;
+  MarketBus& operator=(const MarketBus&) = delete;
+
+  // creates (or replaces) /dev/shm/<name>; false with a message when that fails
+  bool create(const std::string& name, std::uint32_t max_symbols = MARKET_BUS_DEFAULT_SYMBOLS,
+              std::uint32_t ring_capacity = MARKET_BUS_DEFAULT_EVENTS);
+  // unmaps and removes the region; readers that still have it mapped keep their view
+  void close();
+  [[nodiscard]] bool is_open() const { return base_ != nullptr; }
+  [[nodiscard]] const std::string& name() const { return name_; }
+
+  // slot for the symbol, assigned on first use; UINT32_MAX when the bus is full or the id too long
+  std::uint32_t add_symbol(const std::string& symbol);
+  // after the coin has applied the trade
+  void publish_trade(const Coin& coin, const CoinData& trade);
+  void publish_quote(const Quote& quote);
+
+  [[nodiscard]] std::uint64_t published() const;
+};
+
+#endif //MARKETBUS_H
@@ -0,0 +1,115 @@
+#ifndef MARKET_BUS_H
+#define MARKET_BUS_H
+
+/*
+ * Read side of the shared-memory market data bus, as a plain C API for out-of-process consumers.
+ * The trader (MarketBus, C++) publishes into a POSIX shared-memory object /dev/shm/<name>:
+ *
+ *   market_bus_header    128 bytes
+ *   market_bus_slot      max_symbols x 128 bytes at slots_offset: latest state per symbol, seqlocked
+ *   market_bus_event     ring_capacity x 64 bytes at ring_offset: every trade, broadcast to all readers
+ *
+ * Any number of processes map it read-only; readers never write to it and so never slow the trader or each
+ * other. Slots are copied out consistently with market_bus_read_slot(); events are polled from a cursor the
+ * reader owns with market_bus_poll(). A reader that falls more than ring_capacity events behind loses the
+ * oldest ones and is told how many. All structs have fixed sizes and no padding, so NumPy can view the
+ * regions in place (market_bus_data() + the offsets in the header) for bulk reads that tolerate tearing.
+ *
+ * Python, through ctypes:
+ *   lib = ctypes.CDLL("libmarket_bus.so")
+ *   lib.market_bus_open.restype = ctypes.c_void_p
+ *   bus = lib.market_bus_open(b"crypto_market")
+ *   ... define market_bus_slot / market_bus_event as ctypes.Structure with the fields below ...
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MARKET_BUS_MAGIC 0x5355424bu /* "KBUS" */
+#define MARKET_BUS_VERSION 1u
+#define MARKET_BUS_SYMBOL_LENGTH 24 /* including the terminating NUL */
+#define MARKET_BUS_READ_RETRIES 65536 /* copies market_bus_read_slot() attempts before giving up */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct market_bus_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t max_symbols;
+  uint32_t ring_capacity; /* events, a power of two */
+  uint32_t slot_size;
+  uint32_t event_size;
+  uint64_t slots_offset; /* bytes from the start of the region */
+  uint64_t ring_offset;
+  uint64_t total_size;
+  uint32_t symbol_count; /* slots in use; only grows */
+  uint32_t writer_pid;
+  int64_t updated_ms;    /* wall clock of the last publish, to spot a dead writer */
+  uint64_t head;         /* events published so far; on its own cache line */
+  uint8_t reserved[56];
+} market_bus_header;
+
+typedef struct market_bus_slot {
+  uint64_t sequence;                    /* odd while the writer is updating the slot */
+  char symbol[MARKET_BUS_SYMBOL_LENGTH]; /* normalized id, e.g. "btcusdt" */
+  double price;                         /* last trade */
+  double quantity;
+  int64_t trade_id;
+  int64_t trade_time;                   /* ms since epoch */
+  double moving_average;                /* 0 until the average is ready */
+  double bid;                           /* last quote, 0 before one */
+  double bid_quantity;
+  double ask;
+  double ask_quantity;
+  int64_t quote_time;
+  uint64_t trade_count;
+  double volume;                        /* base quantity traded since the bus was created */
+} market_bus_slot;
+
+typedef struct market_bus_event {
+  uint64_t stamp;   /* sequence number + 1 once written, 0 while being written */
+  uint32_t symbol;  /* slot index */
+  uint32_t reserved;
+  int64_t trade_time;
+  int64_t trade_id;
+  double price;
+  double quantity;
+  double bid;       /* quote in effect at the trade, 0 if none */
+  double ask;
+} market_bus_event;
+
+typedef struct market_bus market_bus; /* a reader's mapping */
+
+/* maps /dev/shm/<name> read-only; NULL if it does not exist or has a different layout version */
+market_bus* market_bus_open(const char* name);
+void market_bus_close(market_bus* bus);
+
+/* the whole region, for zero-copy views */
+const void* market_bus_data(const market_bus* bus);
+uint64_t market_bus_size(const market_bus* bus);
+
+uint32_t market_bus_symbol_count(const market_bus* bus);
+/* slot index of the symbol, -1 if it has none */
+int32_t market_bus_find(const market_bus* bus, const char* symbol);
+/* consistent copy of a slot; 0 on success, -1 for an index not below market_bus_symbol_count(), -2 when no
+   consistent copy was seen in MARKET_BUS_READ_RETRIES attempts. A live writer holds a slot for well under a
+   microsecond, so -2 usually means it died mid-update: retry, or compare the header's updated_ms to the clock. */
+int market_bus_read_slot(const market_bus* bus, uint32_t index, market_bus_slot* out);
+
+/* events published so far; start a cursor here to see only new events */
+uint64_t market_bus_head(const market_bus* bus);
+/* copies up to max events from *cursor on and advances it; *lost (optional) receives the number of events
+   that were overwritten before they could be read. Returns the number copied. */
+size_t market_bus_poll(const market_bus* bus, uint64_t* cursor, market_bus_event* out, size_t max, uint64_t* lost);
+
+#ifdef __cplusplus
+}
+
+static_assert(sizeof(market_bus_header) == 128);
+static_assert(sizeof(market_bus_slot) == 128);
+static_assert(sizeof(market_bus_event) == 64);
+#endif
+
+#endif /* MARKET_BUS_H */
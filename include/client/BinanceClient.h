@@ -5,8 +5,10 @@
 #include <string>
 #include <vector>
 #include "../common/CoinManager.h"
+#include "../feed/MarketDataFeed.h"
 
-class BinanceClient {
+// Binance spot market data: <symbol>@trade for trades and <symbol>@bookTicker for the top of the book
+class BinanceClient : public MarketDataFeed {
 private:
   class Impl;
   std::unique_ptr<Impl> pImpl;  // Pointer to implementation
@@ -14,7 +16,7 @@ private:
 
 public:
   explicit BinanceClient(CoinManager& manager);
-  ~BinanceClient();
+  ~BinanceClient() override;
 
   BinanceClient(BinanceClient&&) = default;
   BinanceClient& operator=(BinanceClient&&) = delete;
@@ -23,11 +25,16 @@ public:
   BinanceClient& operator=(const BinanceClient&) = delete;
 
   void setup_websocket(const std::string& url);
-  void connect();
-  void disconnect();
+  [[nodiscard]] Venue venue() const override { return Venue::binance; }
+  void connect() override;
+  void disconnect() override;
+  [[nodiscard]] bool is_connected() const override;
+  // normalized instrument ids, mapped to their trade and book ticker streams
+  void subscribe(const std::vector<std::string>& instruments) override;
+  void unsubscribe(const std::vector<std::string>& instruments) override;
+  // raw Binance stream names ("btcusdt@ticker")
   void subscribe_to_streams(const std::vector<std::string>& streams);
   void unsubscribe_from_streams(const std::vector<std::string>& streams);
-  [[nodiscard]] bool is_connected() const;
 };
 
 #endif //BINANCECLIENT_H
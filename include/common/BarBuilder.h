@@ -0,0 +1,76 @@
+#ifndef BARBUILDER_H
+#define BARBUILDER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#define BAR_HISTORY_SIZE 256
+
+struct Bar {
+  long open_time; // ms since epoch, aligned to the resolution
+  double open;
+  double high;
+  double low;
+  double close;
+  double volume;
+  long trade_count;
+};
+
+// one resolution's bars, for warm starts
+struct BarSeriesSnapshot {
+  long resolution_ms;
+  bool has_current;
+  Bar current;
+  std::vector<Bar> closed; // oldest first
+};
+
+// Incrementally aggregates trades into OHLCV bars at several resolutions at once.
+// Each resolution keeps its in-progress bar plus a fixed ring of closed bars, so updates never allocate.
+// Intervals without trades close as flat bars at the previous close with zero volume.
+class BarBuilder {
+public:
+  using BarCloseHandler = std::function<void(long resolution_ms, const Bar& bar)>;
+
+private:
+  struct Series {
+    long resolution_ms;
+    Bar current;
+    bool has_current;
+    std::vector<Bar> closed; // ring, capacity fixed at construction
+    std::size_t next;        // ring slot the next closed bar goes to
+    std::size_t closed_count;
+  };
+
+  std::vector<Series> series_;
+  BarCloseHandler on_bar_close_;
+
+  void close_bar(Series& series);
+  void roll_to(Series& series, long open_time);
+
+public:
+  explicit BarBuilder(const std::vector<long>& resolutions_ms = {1000, 60000, 300000, 3600000},
+                      std::size_t history = BAR_HISTORY_SIZE);
+
+  void update(double price, double quantity, long trade_time);
+  void set_bar_close_handler(BarCloseHandler handler);
+
+  [[nodiscard]] std::size_t resolution_count() const;
+  [[nodiscard]] long resolution_ms(std::size_t index) const;
+  // index of the given resolution, or resolution_count() if it is not tracked
+  [[nodiscard]] std::size_t find_resolution(long resolution_ms) const;
+  // bar currently being built; only meaningful once has_current_bar() is true
+  [[nodiscard]] const Bar& current_bar(std::size_t index) const;
+  [[nodiscard]] bool has_current_bar(std::size_t index) const;
+  // closed bars still held in the ring (at most the history size)
+  [[nodiscard]] std::size_t closed_bars(std::size_t index) const;
+  // ago = 0 is the most recently closed bar
+  [[nodiscard]] const Bar& closed_bar(std::size_t index, std::size_t ago) const;
+
+  [[nodiscard]] std::vector<BarSeriesSnapshot> snapshot() const;
+  // series are matched by resolution: tracked resolutions missing from the snapshot start empty, and closed bars
+  // beyond the history size keep the newest. No bar close handler runs
+  void restore(const std::vector<BarSeriesSnapshot>& snapshot);
+};
+
+#endif //BARBUILDER_H
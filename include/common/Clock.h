@@ -0,0 +1,121 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Cheap timestamps for the whole pipeline. ticks() reads the CPU timestamp counter (rdtsc, or cntvct_el0 on
+// ARM) and Clock converts tick values to CLOCK_MONOTONIC and CLOCK_REALTIME nanoseconds with a calibrated
+// fixed-point multiplier. Without an invariant counter it falls back to clock_gettime(CLOCK_MONOTONIC).
+// Calibration happens on first use; call Clock::calibrate() from main before starting threads to pay for
+// it up front. It may also be called later, to pick up NTP adjustments, while other threads convert: each
+// calibration is published whole through an atomic pointer and readers use the new one from their next call.
+// Superseded calibrations are never freed, since a reader may still hold one; recalibrate rarely.
+class Clock {
+private:
+  struct Calibration {
+    bool use_counter;
+    std::uint64_t base_ticks;
+    std::int64_t base_mono_ns;
+    std::int64_t wall_offset_ns; // CLOCK_REALTIME - CLOCK_MONOTONIC
+    std::uint64_t ns_per_tick_q32; // ns per tick in 32.32 fixed point
+  };
+
+  static std::atomic<const Calibration*> published_;
+
+  static const Calibration& calibration() {
+    const Calibration* current = published_.load(std::memory_order_acquire);
+    return current ? *current : first_calibration();
+  }
+  static const Calibration& first_calibration();
+  static Calibration measure(int sample_ms);
+
+  static std::int64_t monotonic_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+
+public:
+  static void calibrate(int sample_ms = 20);
+  [[nodiscard]] static bool uses_cpu_counter();
+
+  static std::uint64_t ticks() {
+    if (calibration().use_counter) {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#elif defined(__aarch64__)
+      std::uint64_t value;
+      asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+      return value;
+#endif
+    }
+    return static_cast<std::uint64_t>(monotonic_ns());
+  }
+
+  static std::int64_t ticks_to_ns(std::int64_t delta_ticks) {
+    return static_cast<std::int64_t>((static_cast<__int128>(delta_ticks) * calibration().ns_per_tick_q32) >> 32);
+  }
+  // CLOCK_MONOTONIC nanoseconds of a ticks() reading
+  static std::int64_t to_ns(std::uint64_t tick) {
+    const Calibration& c = calibration();
+    return c.base_mono_ns + ticks_to_ns(static_cast<std::int64_t>(tick - c.base_ticks));
+  }
+  // CLOCK_REALTIME nanoseconds of a ticks() reading
+  static std::int64_t to_wall_ns(std::uint64_t tick) { return to_ns(tick) + calibration().wall_offset_ns; }
+
+  static std::int64_t now_ns() { return to_ns(ticks()); }
+  static std::int64_t wall_ns() { return to_wall_ns(ticks()); }
+  static std::int64_t wall_ms() { return wall_ns() / 1000000; }
+};
+
+// Broken-down local (or UTC) calendar time with preformatted strings. update() is a no-op within the same
+// second, patches the time fields arithmetically within the same hour, and only calls localtime_r/strftime
+// when an hour (and so possibly a day or DST) boundary is crossed. Not thread-safe: keep one per thread.
+class CalendarCache {
+private:
+  bool utc_;
+  std::int64_t second_;
+  std::int64_t hour_start_;
+  std::tm tm_;
+  char date_[11];       // 2025-07-23
+  char time_[9];        // 14:30:05
+  char day_[11];        // Wed Jul 23
+
+  void recompute(std::int64_t epoch_seconds);
+
+public:
+  explicit CalendarCache(bool utc = false);
+
+  void update(std::int64_t epoch_seconds) {
+    if (epoch_seconds == second_) {
+      return;
+    }
+    std::int64_t offset = epoch_seconds - hour_start_;
+    if (offset < 0 || offset >= 3600) {
+      recompute(epoch_seconds);
+      return;
+    }
+    second_ = epoch_seconds;
+    tm_.tm_min = static_cast<int>(offset / 60);
+    tm_.tm_sec = static_cast<int>(offset % 60);
+    time_[3] = static_cast<char>('0' + tm_.tm_min / 10);
+    time_[4] = static_cast<char>('0' + tm_.tm_min % 10);
+    time_[6] = static_cast<char>('0' + tm_.tm_sec / 10);
+    time_[7] = static_cast<char>('0' + tm_.tm_sec % 10);
+  }
+
+  [[nodiscard]] const std::tm& tm() const { return tm_; }
+  [[nodiscard]] const char* date() const { return date_; }
+  [[nodiscard]] const char* time() const { return time_; }
+  [[nodiscard]] const char* day() const { return day_; }
+  [[nodiscard]] int year() const { return tm_.tm_year + 1900; }
+};
+
+#endif //CLOCK_H
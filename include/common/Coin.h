@@ -6,8 +6,13 @@
 
 #include <ctime>
 #include <string>
+#include <vector>
+#include "BarBuilder.h"
 #include "MovingAverage.h"
 
+class Counter;
+class Gauge;
+
 struct CoinData {
   std::string symbol;
   double price;
@@ -16,6 +21,13 @@ struct CoinData {
   long trade_time;
 };
 
+// everything needed to bring a Coin back to where it was, used for warm starts
+struct CoinSnapshot {
+  CoinData last_trade;
+  std::vector<double> ma_window;
+  std::vector<BarSeriesSnapshot> bars;
+};
+
 class Coin {
 private:
   std::string const symbol_;
@@ -24,16 +36,31 @@ private:
   double last_trade_quantity_;
   long last_trade_time_;
   MovingAverage average_manager_; //storing object is fine as copy is not performed (references stored in coin manager)
+  BarBuilder bars_;
+  Counter* trades_metric_; // coin_trades_total{symbol=...}, null without metrics
+  Gauge* price_metric_;
+
+  void apply_trade(const CoinData& data); // everything but the trade id
 
 public:
-  Coin(const std::string& symbol);
-  void update_trade(CoinData& data);
+  // the moving average runs on average_backend when one is given (MovingAverageBackend.h); without metrics the
+  // coin stays out of the process's METRICS registry, as for a backtest running next to a live feed
+  Coin(const std::string& symbol, MovingAverageBackend* average_backend = nullptr, bool metrics = true);
+  // trade ids are per venue: captured is false for trades from venues other than the capture venue, which leave
+  // last_trade_id() at the capture venue's
+  void update_trade(CoinData& data, bool captured = true);
+  // the same for a captured trade replayed on a warm start: state only, not counted as a live trade
+  void replay_trade(const CoinData& data);
   std::string symbol() const;
   double price() const;
   long last_trade_id() const;
   double last_trade_quantity() const;
   long last_trade_time() const;
   [[nodiscard]] const MovingAverage& moving_average() const;
+  [[nodiscard]] const BarBuilder& bars() const;
+  BarBuilder& bars();
+  [[nodiscard]] CoinSnapshot snapshot() const;
+  void restore(const CoinSnapshot& snapshot);
 };
 
 #endif //COIN_H
@@ -4,28 +4,114 @@
 
 #ifndef COINMANAGER_H
 #define COINMANAGER_H
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include "Coin.h"
 #include "MovingAverage.h"
+#include "../feed/ConsolidatedBook.h"
 
-class BinanceClient;
+class HistoryWriter;
+class StrategyEngine;
+class Counter;
+class Gauge;
+class MarketBus;
+class MovingAverageBackend;
 
 class CoinManager {
 private:
   std::unordered_map<std::string, std::unique_ptr<Coin>> coins_;
-  BinanceClient* binance_client_;
+  std::vector<MarketDataFeed*> feeds_;
+  // Serialises feeds running on their own threads with each other and with adding and removing coins: held for a
+  // whole dispatch (coin update, strategies, bus, capture), never taken from inside one. Also guards feeds_, which
+  // is copied out before (un)subscribing so a feed is never called with it held.
+  mutable std::mutex feed_mutex_;
+  mutable std::mutex book_mutex_; // guards consolidated_ alone, so its readers never wait for a dispatch
+  ConsolidatedBook consolidated_;
+  HistoryWriter* history_writer_;
+  StrategyEngine* strategy_engine_;
+  MarketBus* market_bus_;
+  MovingAverageBackend* average_backend_;
+  Venue capture_venue_;
+
+  // warm start: snapshot state waiting for its coin to be added, and where to backfill the gap from
+  std::unordered_map<std::string, CoinSnapshot> pending_snapshots_;
+  std::string backfill_directory_;
+  long backfill_lookback_ms_;
+  std::string checkpoint_path_;
+  long checkpoint_interval_ms_;
+  long last_checkpoint_time_; // 0 until the first trade starts the interval
+
+  // Checkpoints are copied on the feed thread and written by their own thread, so the feed never waits on the
+  // disk; if a write is still running when the next one is due, only the newest copy is kept.
+  std::thread checkpoint_thread_;
+  std::mutex checkpoint_mutex_;
+  std::condition_variable checkpoint_ready_;
+  std::string checkpoint_target_;
+  std::vector<CoinSnapshot> checkpoint_coins_;
+  bool checkpoint_pending_;
+  bool checkpoint_stop_;
+
+  Counter* unknown_coin_metric_;
+  Counter* checkpoint_metric_;
+  Counter* replayed_trades_metric_;
+  Gauge* tracked_coins_metric_;
+
+  void warm_start(Coin& coin);
+  void attach_strategies(Coin& coin);
+  [[nodiscard]] std::vector<CoinSnapshot> coin_snapshots() const;
+  void queue_checkpoint();
+  void run_checkpoints();
 
 public:
   CoinManager();
-  void set_binance_client(BinanceClient* client);
+  ~CoinManager();
+  CoinManager(const CoinManager&) = delete;
+  CoinManager& operator=(const CoinManager&) = delete;
+  // feeds are subscribed to every coin added while they are connected; several feeds drive the same coins
+  void add_feed(MarketDataFeed* feed);
+  void set_history_writer(HistoryWriter* writer);
+  // trades and bar closes are forwarded to the engine's subscribers after each coin has applied them; any thread
+  void set_strategy_engine(StrategyEngine* engine);
+  // applied trades and quotes of tracked coins are also published to the shared-memory bus, ahead of the strategies
+  void set_market_bus(MarketBus* bus);
+  // moving averages of coins added from now on run on the backend instead of in process
+  void set_moving_average_backend(MovingAverageBackend* backend);
+  // any thread, also while feeds run: coins change between two dispatches, feeds are (un)subscribed after
   void add_coins(const std::vector<std::string>& symbols);
   void remove_coins(const std::vector<std::string>& symbols);
-  void update_coin_data(CoinData &data);
+  // Trade ids are numbered per venue, so only the capture venue's trades are written to the history writer and
+  // kept as the coins' last_trade_id(), which the warm start resumes the capture from; the other venues' trades
+  // update coins and strategies alone. Binance unless set; any thread.
+  void set_capture_venue(Venue venue);
+  // caller holds off the feeds; on_trade() is the locked entry point. captured: from the capture venue
+  void update_coin_data(CoinData &data, bool captured = true);
+  // Entry points for feeds, from their own threads: feed_mutex_ serialises them so coins and strategies see one
+  // ordered stream (uncontended with a single feed). The consolidated book is updated first, under its own lock
+  // only; trades then go on to update_coin_data().
+  void on_trade(Venue venue, CoinData& data);
+  void on_quote(Venue venue, const Quote& quote);
+  // best bid / offer across venues with a fresh quote, and the last trade on any venue; any thread
+  bool best_quote(const std::string& symbol, ConsolidatedQuote& out) const;
+  // whether the venue has sent anything within the staleness window; any thread
+  [[nodiscard]] bool venue_fresh(Venue venue) const;
   std::vector<std::string> all_coin_symbols() const;
   std::vector<Coin*> all_coins() const;
   bool has_coin(const std::string& symbol) const;
+
+  // Loads a snapshot written by save_snapshot(); each coin is restored when it is (or already was) added,
+  // then trades captured after the snapshot are replayed from history_directory if one is given.
+  // Coins missing from the snapshot replay the last lookback_ms of capture instead.
+  bool restore_snapshot(const std::string& path, const std::string& history_directory = "",
+                        long lookback_ms = 3600000);
+  bool save_snapshot(const std::string& path) const;
+  // checkpoints from update_coin_data() whenever interval_ms of trade time has passed since the last one (or the
+  // first trade), written in the background; unlike save_snapshot() they do not flush the history writer
+  void enable_checkpoints(const std::string& path, long interval_ms);
 };
 
 #endif //COINMANAGER_H
@@ -5,22 +5,43 @@
 #ifndef MOVINGAVERAGE_H
 #define MOVINGAVERAGE_H
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <memory>
+#include <vector>
 
 #define MA_STANDARD_SIZE 512
 
+class MovingAverageBackend;
+class NativeMovingAverageBackend;
+
+// The average is computed by a backend (MovingAverageBackend.h): a native one of its own unless another is given,
+// e.g. the FPGA offload. Only an external backend needs the window shadowed here, as it cannot hand it back for
+// snapshots; once it fails, or has no room, the average moves to a native backend of its own, restored from the
+// shadow, so it carries on in process instead of freezing. A failure seen on another channel is picked up at this
+// average's next update. Windows are at least one price.
 class MovingAverage{
   private:
     std::size_t window_size_;
-    std::deque<double> window_;
-    double sum_;
+    std::unique_ptr<NativeMovingAverageBackend> native_; // null while an external backend computes the average
+    MovingAverageBackend* backend_;                       // native_ or the external backend
+    std::uint32_t channel_;
+    std::deque<double> shadow_;                           // the window, kept while on an external backend
+
+    void use_native(); // moves the average to native_, starting from the shadow window
   public:
-    explicit MovingAverage(std::size_t window_size);
+    explicit MovingAverage(std::size_t window_size, MovingAverageBackend* backend = nullptr);
+    ~MovingAverage();
+    MovingAverage(MovingAverage&&) noexcept;
+    MovingAverage& operator=(MovingAverage&&) noexcept;
     void update(double new_price);
     double get_value() const;
     bool is_ready() const;
     bool is_price_below_MA(double current_price) const;
     bool is_price_above_MA(double current_price) const;
+    std::size_t window_size() const;
+    std::vector<double> window() const;
+    void restore(const std::vector<double>& prices); // keeps the newest window_size prices
 };
 
 #endif //MOVINGAVERAGE_H
@@ -0,0 +1,61 @@
+#ifndef MOVINGAVERAGEBACKEND_H
+#define MOVINGAVERAGEBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Where MovingAverage's sliding-window arithmetic runs. Each moving average is a channel with a fixed window;
+// prices are streamed in with update() and the average read back with value(). A backend may queue updates (the
+// FPGA offload sends them in batches), so value() and count() reflect the updates up to the last flush(), which
+// a backend also does by itself whenever its batch fills. Channels are never reused, so a backend with limited
+// room (add_channel() returning UINT32_MAX) bounds the coins added over a run. Not thread-safe, add_channel()
+// included: CoinManager creates channels and streams prices under its feed mutex.
+class MovingAverageBackend {
+public:
+  virtual ~MovingAverageBackend() = default;
+
+  // a new, empty channel averaging the last window prices; UINT32_MAX when the backend cannot take it
+  virtual std::uint32_t add_channel(std::size_t window) = 0;
+  // empties the channel's window
+  virtual void reset(std::uint32_t channel) = 0;
+  virtual void update(std::uint32_t channel, double price) = 0;
+  // makes every update so far visible; false once the backend has failed
+  virtual bool flush() = 0;
+  // mean of the prices in the window, 0 while it is empty
+  [[nodiscard]] virtual double value(std::uint32_t channel) const = 0;
+  // prices in the window, at most its size
+  [[nodiscard]] virtual std::size_t count(std::uint32_t channel) const = 0;
+  [[nodiscard]] virtual const char* name() const = 0;
+  // a failed backend drops updates and its values go stale, so callers stop relying on it
+  [[nodiscard]] virtual bool failed() const { return false; }
+};
+
+// The in-process implementation and MovingAverage's default: every channel's window is a ring in one contiguous
+// array, updated with a running sum, so an update is a few loads and stores and results are visible immediately.
+class NativeMovingAverageBackend final : public MovingAverageBackend {
+private:
+  struct Channel {
+    std::size_t offset; // of the ring in prices_
+    std::size_t window;
+    std::size_t next;
+    std::size_t count;
+    double sum;
+  };
+
+  std::vector<Channel> channels_;
+  std::vector<double> prices_;
+
+public:
+  std::uint32_t add_channel(std::size_t window) override;
+  void reset(std::uint32_t channel) override;
+  void update(std::uint32_t channel, double price) override;
+  bool flush() override { return true; }
+  [[nodiscard]] double value(std::uint32_t channel) const override;
+  [[nodiscard]] std::size_t count(std::uint32_t channel) const override { return channels_[channel].count; }
+  [[nodiscard]] const char* name() const override { return "native"; }
+  // prices in the channel's window, oldest first
+  [[nodiscard]] std::vector<double> window(std::uint32_t channel) const;
+};
+
+#endif //MOVINGAVERAGEBACKEND_H
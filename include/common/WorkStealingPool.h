@@ -0,0 +1,55 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker runs its own tasks newest first
+// (they are likely still in cache) and, when it runs dry, steals the oldest task of another worker, so
+// a few long jobs next to many short ones still keep every core busy. Tasks submitted from inside a task
+// go to the submitting worker's deque.
+class WorkStealingPool {
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_worker_;
+  std::atomic<std::uint64_t> steals_;
+
+  std::mutex state_mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable idle_cv_;
+  long queued_;         // submitted, not yet taken by a worker
+  std::size_t pending_; // submitted, not yet finished
+  bool stop_;
+
+  bool take(std::size_t index, std::function<void()>& task);
+  void run(std::size_t index);
+
+public:
+  // threads = 0 uses one per hardware thread
+  explicit WorkStealingPool(unsigned threads = 0);
+  ~WorkStealingPool();
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  void submit(std::function<void()> task);
+  // blocks until every submitted task, including ones submitted by tasks, has finished
+  void wait_idle();
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] std::uint64_t steals() const;
+};
+
+#endif //WORKSTEALINGPOOL_H
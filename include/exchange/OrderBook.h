@@ -0,0 +1,80 @@
+#ifndef ORDERBOOK_H
+#define ORDERBOOK_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "OrderTypes.h"
+
+// One match. Prices are in ticks and quantities in lots; 0 for an id means the external trade feed.
+struct BookFill {
+  std::uint64_t maker_id;
+  std::uint64_t taker_id;
+  OrderSide taker_side;
+  std::int64_t price;
+  std::int64_t quantity;
+};
+
+// Price-time-priority limit order book for one symbol, in integer ticks and lots so matching is exact.
+// Each side is a vector of price levels sorted with the best price at the back, so the top of the book is
+// one load and new levels near the top are cheap to insert. Orders live in a pooled array linked into a
+// FIFO per level; an id -> slot map serves cancels. Not thread-safe: one book per matching thread.
+class OrderBook {
+private:
+  struct Order {
+    std::uint64_t id;
+    std::int64_t price;
+    std::int64_t remaining;
+    std::uint32_t prev;
+    std::uint32_t next;
+    OrderSide side;
+  };
+
+  struct Level {
+    std::int64_t price;
+    std::int64_t quantity;
+    std::uint32_t head;
+    std::uint32_t tail;
+  };
+
+  std::vector<Order> orders_;
+  std::vector<std::uint32_t> free_;
+  std::vector<Level> bids_; // ascending, best (highest) at the back
+  std::vector<Level> asks_; // descending, best (lowest) at the back
+  std::unordered_map<std::uint64_t, std::uint32_t> index_;
+
+  std::uint32_t allocate(std::uint64_t id, OrderSide side, std::int64_t price, std::int64_t quantity);
+  void release(std::uint32_t slot);
+  void rest(std::uint32_t slot);
+  // fills takers against levels while cross(level price) holds; returns the quantity left over
+  template<typename Cross>
+  std::int64_t match(std::vector<Level>& levels, Cross cross, std::uint64_t taker_id, OrderSide taker_side,
+                     std::int64_t quantity, std::vector<BookFill>& fills);
+
+public:
+  static constexpr std::int64_t MARKET_BUY_PRICE = INT64_MAX;
+  static constexpr std::int64_t MARKET_SELL_PRICE = 0;
+
+  explicit OrderBook(std::size_t expected_orders = 4096);
+
+  // Matches an incoming order and, if rest is set, leaves the remainder on the book under id.
+  // Market orders use MARKET_BUY_PRICE / MARKET_SELL_PRICE. Returns the quantity not filled.
+  std::int64_t add(std::uint64_t id, OrderSide side, std::int64_t price, std::int64_t quantity, bool rest,
+                   std::vector<BookFill>& fills);
+  bool cancel(std::uint64_t id);
+
+  // A trade printed on the real market at price: resting bids at or above it and asks at or below it fill
+  // at their own price, each side up to quantity, in priority order. Optimistic about queue position.
+  void on_trade(std::int64_t price, std::int64_t quantity, std::vector<BookFill>& fills);
+
+  // 0 when the side is empty
+  [[nodiscard]] std::int64_t best_bid() const { return bids_.empty() ? 0 : bids_.back().price; }
+  [[nodiscard]] std::int64_t best_ask() const { return asks_.empty() ? 0 : asks_.back().price; }
+  [[nodiscard]] std::int64_t quantity_at(OrderSide side, std::int64_t price) const;
+  // unfilled quantity of a resting order, 0 once it is filled, cancelled or unknown
+  [[nodiscard]] std::int64_t remaining(std::uint64_t id) const;
+  [[nodiscard]] std::size_t order_count() const { return index_.size(); }
+  [[nodiscard]] std::size_t level_count(OrderSide side) const;
+};
+
+#endif //ORDERBOOK_H
@@ -0,0 +1,189 @@
+#ifndef ORDERGATEWAY_H
+#define ORDERGATEWAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OrderTypes.h"
+#include "../metrics/LatencyHistogram.h"
+#include "../net/HmacSha256.h"
+#include "../net/RateLimiter.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+#define GATEWAY_READ_CHUNK 16384
+#define GATEWAY_MAX_QUEUED 1024 // orders waiting for the sender thread
+#define GATEWAY_MAX_DECIMALS 8   // Binance quotes prices and quantities to at most 8 decimals
+
+struct GatewayConfig {
+  std::string host = "api.binance.com";
+  std::uint16_t port = 443;
+  bool tls = true; // off for local stand-ins such as PaperExchange
+  std::string api_key;
+  std::string secret_key;
+  std::size_t connections = 2; // opened by start() and kept warm
+  long recv_window_ms = 5000;
+  long keepalive_ms = 30000; // idle connections get a ping after this long; 0: no keepalive thread
+  int timeout_ms = 5000;     // per send / receive
+  bool binance_limits = true; // 6000 weight / minute, 100 orders / 10 s, 200000 orders / day
+};
+
+struct GatewayResponse {
+  int status = 0; // HTTP status, 0 when the request was not sent or nothing came back
+  std::string body;
+  std::string error; // local failure, e.g. "rate limited", "connect failed"
+};
+
+using OrderCallback = std::function<void(const GatewayResponse&)>;
+
+// what submit_order() did with an order
+enum class SubmitResult {
+  queued,
+  queue_full, // GATEWAY_MAX_QUEUED orders already waiting for the sender thread
+  stopped,    // the gateway was not started, or has been stopped
+};
+
+// Signed REST client for Binance order entry, built so that an order costs one write on a warm socket.
+//  - start() opens a pool of keep-alive connections (TLS handshake included) and a thread pings idle ones
+//    so neither side times them out; a request never pays for a handshake unless the pool ran dry.
+//  - prepare_order() renders everything constant about an order (request line, headers, symbol, side,
+//    type) once, and absorbs the constant parameters into the HMAC inner state. place_order() then only
+//    formats quantity, price and timestamp, signs those bytes and writes head + body in one call.
+//  - every endpoint has a request weight (and order count), checked against a RateLimiter that is kept in
+//    sync with the X-MBX-USED-WEIGHT / X-MBX-ORDER-COUNT headers; a 429 / 418 blocks sending until
+//    Retry-After has passed.
+//  - tick_to_order_sent() measures from the trade that triggered an order (Clock ticks, e.g.
+//    StrategyEngine::dispatch_tick()) to the order's last byte handed to the kernel.
+// Requests are synchronous: the calling thread waits for the response. Safe to call from several threads;
+// each borrows its own connection. A thread that must not wait on the exchange, such as the market-data thread,
+// hands orders to submit_order() instead; start() runs a sender thread that places them in turn.
+// With TLS, OpenSSL writes with write(), so the process has to ignore SIGPIPE or a reset connection kills it.
+class OrderGateway {
+private:
+  struct Connection {
+    int fd;
+    SSL* ssl;
+    std::int64_t last_used_ms;
+  };
+
+  struct OrderTemplate {
+    explicit OrderTemplate(HmacSha256 template_signer) : signer(std::move(template_signer)) {}
+
+    std::mutex mutex;
+    std::string head; // request line and fixed headers, up to the Content-Length value
+    std::string body_prefix; // constant parameters; already absorbed by signer
+    HmacSha256 signer;
+    bool has_price;
+    int price_decimals;
+    int quantity_decimals;
+    std::string wire; // scratch: the rendered request
+  };
+
+  struct QueuedOrder {
+    std::size_t template_id;
+    double price;
+    double quantity;
+    std::uint64_t trigger_tick;
+    OrderCallback on_response;
+  };
+
+  struct Endpoint {
+    std::uint32_t weight;
+    std::uint32_t orders;
+  };
+
+  GatewayConfig config_;
+  SSL_CTX* ssl_context_;
+  HmacSha256 signer_;
+  RateLimiter limiter_;
+  std::map<std::string, Endpoint> endpoints_; // "METHOD /path"
+  std::vector<std::unique_ptr<OrderTemplate>> templates_;
+
+  std::mutex pool_mutex_;
+  std::vector<Connection> idle_;
+  std::atomic<std::uint64_t> connects_;
+  std::atomic<std::int64_t> blocked_until_ms_;
+  std::atomic<std::int64_t> time_offset_ms_;
+
+  std::mutex stats_mutex_;
+  LatencyHistogram tick_to_sent_;
+  LatencyHistogram round_trip_;
+
+  std::atomic<bool> running_;
+  std::mutex keepalive_mutex_;
+  std::condition_variable keepalive_wake_;
+  std::thread keepalive_thread_;
+
+  std::mutex send_mutex_;
+  std::condition_variable send_wake_;
+  std::deque<QueuedOrder> send_queue_;
+  bool sending_;
+  std::thread sender_thread_;
+
+  bool open(Connection& connection);
+  void close(Connection& connection);
+  bool acquire(Connection& connection);
+  void release(Connection& connection);
+  bool write_all(Connection& connection, const char* data, std::size_t size);
+  bool read_response(Connection& connection, GatewayResponse& response, bool& keep_alive);
+  // sends a rendered request on a pooled connection and waits for its response
+  GatewayResponse exchange(const std::string& endpoint, const char* wire, std::size_t size,
+                           std::uint64_t trigger_tick);
+  void keepalive_loop();
+  void send_loop();
+  [[nodiscard]] std::int64_t timestamp_ms() const;
+
+public:
+  explicit OrderGateway(GatewayConfig config);
+  ~OrderGateway();
+  OrderGateway(const OrderGateway&) = delete;
+  OrderGateway& operator=(const OrderGateway&) = delete;
+
+  // fills the pool and starts the sender and keepalive threads; false if no connection could be opened
+  bool start();
+  // orders still queued are not sent; their callbacks get the error "gateway stopped"
+  void stop();
+
+  // template for POST /api/v3/order with these fixed fields; decimals format price and quantity
+  // (e.g. 2 and 5 for BTCUSDT). Returns the id for place_order(). Not thread-safe with place_order().
+  std::size_t prepare_order(const std::string& symbol, OrderSide side, OrderType type, TimeInForce time_in_force,
+                            int price_decimals, int quantity_decimals);
+  // decimals a tickSize or stepSize is written with, e.g. 5 for 0.00001: what prepare_order() needs so every
+  // multiple of the step is formatted exactly. At most GATEWAY_MAX_DECIMALS.
+  static int step_decimals(double step);
+  // price is ignored for market templates; trigger_tick 0 skips the latency sample
+  GatewayResponse place_order(std::size_t template_id, double price, double quantity,
+                              std::uint64_t trigger_tick = 0);
+  // place_order() on the sender thread, which then calls on_response (if set) with the result; returns at once.
+  // No callback unless the order was queued.
+  SubmitResult submit_order(std::size_t template_id, double price, double quantity, std::uint64_t trigger_tick = 0,
+                    OrderCallback on_response = nullptr);
+  GatewayResponse cancel_order(const std::string& symbol, std::uint64_t order_id);
+  // any endpoint; params are an already encoded query string. Signed requests get timestamp, recvWindow
+  // and signature appended.
+  GatewayResponse request(const std::string& method, const std::string& path, const std::string& params = "",
+                          bool sign = false);
+  // measures the offset to the exchange clock from GET /api/v3/time, used for every timestamp after
+  bool sync_time();
+
+  // weight (and order count) charged for an endpoint, defaults follow the Binance spot documentation
+  void set_endpoint_weight(const std::string& method, const std::string& path, std::uint32_t weight,
+                           std::uint32_t orders = 0);
+  RateLimiter& limiter() { return limiter_; }
+
+  [[nodiscard]] const LatencyHistogram& tick_to_order_sent() const { return tick_to_sent_; }
+  [[nodiscard]] const LatencyHistogram& round_trip() const { return round_trip_; }
+  // connections opened so far, including the initial pool
+  [[nodiscard]] std::uint64_t connects() const { return connects_.load(); }
+};
+
+#endif //ORDERGATEWAY_H
@@ -0,0 +1,11 @@
+#ifndef ORDERTYPES_H
+#define ORDERTYPES_H
+
+// Order vocabulary shared by the matching engine, the paper exchange and the order gateway.
+enum class OrderSide { buy, sell };
+enum class OrderType { limit, market };
+enum class TimeInForce { gtc, ioc };
+// pending_new: still travelling to the book (latency); open is Binance's NEW
+enum class OrderStatus { pending_new, open, partially_filled, filled, canceled, expired };
+
+#endif //ORDERTYPES_H
@@ -0,0 +1,136 @@
+#ifndef PAPEREXCHANGE_H
+#define PAPEREXCHANGE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "OrderBook.h"
+#include "../common/Coin.h"
+
+class HttpServer;
+
+struct PaperOrderRequest {
+  std::string symbol;
+  OrderSide side = OrderSide::buy;
+  OrderType type = OrderType::limit;
+  TimeInForce time_in_force = TimeInForce::gtc;
+  double price = 0.0; // ignored for market orders
+  double quantity = 0.0;
+  std::string client_order_id; // optional
+};
+
+struct PaperOrder {
+  std::uint64_t id;
+  PaperOrderRequest request;
+  OrderStatus status;
+  double executed;       // base quantity filled so far
+  double quote_executed; // sum of price * quantity of those fills
+  std::int64_t created_ms;
+  std::int64_t updated_ms;
+};
+
+struct PaperFill {
+  std::uint64_t order_id;
+  std::string symbol;
+  OrderSide side;
+  double price;
+  double quantity;
+  double fee; // in quote currency
+  std::int64_t time_ms;
+  bool maker;
+};
+
+struct ExchangeConfig {
+  long latency_ms = 0;    // from submit/cancel until the order or cancel reaches the book
+  double fee_rate = 0.001; // same for maker and taker
+  // market orders, and limit orders crossing the last trade, fill against unlimited liquidity at the last
+  // trade price once the paper book itself is exhausted. Off: they only match other paper orders.
+  bool fill_at_last_trade = true;
+  std::size_t expected_orders = 4096; // per symbol, to size the book up front
+  // filled, cancelled and expired orders kept for lookups; past that the oldest are forgotten
+  std::size_t order_history = 10000;
+};
+
+// Local stand-in for the Binance spot API. Orders match with price-time priority in one OrderBook per
+// symbol, against each other and against the real trades fed in through on_trade() (live via a
+// StrategyEngine EVENT_TRADE subscription, or replayed). Time is whatever the caller passes in: trade times
+// when replaying, so latency is simulated rather than slept. serve() exposes the Binance REST order
+// endpoints on an HttpServer. Thread-safe: every public method takes one mutex.
+class PaperExchange {
+private:
+  struct Market {
+    double tick_size;
+    double lot_size;
+    OrderBook book;
+    double last_price = 0.0; // 0 until the first trade
+  };
+
+  struct Action {
+    std::int64_t due_ms;
+    std::uint64_t order_id;
+    bool cancel;
+  };
+
+  ExchangeConfig config_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Market> markets_;
+  std::unordered_map<std::uint64_t, PaperOrder> orders_;
+  std::unordered_map<std::string, std::uint64_t> client_ids_;
+  std::deque<Action> queue_; // constant latency keeps it sorted by due_ms
+  std::deque<std::uint64_t> finished_; // orders that reached a final status, oldest first
+  std::vector<BookFill> matches_;
+  std::vector<PaperFill>* request_fills_; // fills of the REST call being served, if any
+  std::function<void(const PaperFill&)> fill_handler_;
+  std::uint64_t next_id_;
+  std::int64_t now_ms_;
+
+  void advance_locked(std::int64_t now_ms);
+  void execute(const Action& action);
+  void activate(PaperOrder& order, Market& market);
+  // applies book matches: updates both paper orders involved in each
+  void settle(Market& market);
+  void fill(PaperOrder& order, double price, double quantity, bool maker);
+  void finish(PaperOrder& order, OrderStatus status);
+  // forgets the oldest finished orders beyond the history size; only between requests, never while matching
+  void prune_locked();
+  std::uint64_t submit_locked(const PaperOrderRequest& request, std::int64_t now_ms);
+  bool cancel_locked(std::uint64_t order_id, std::int64_t now_ms);
+  std::uint64_t find_locked(const std::string& symbol, const std::string& order_id,
+                            const std::string& client_order_id) const;
+
+public:
+  explicit PaperExchange(ExchangeConfig config = {});
+
+  // symbols are lower case as elsewhere ("btcusdt"); prices and quantities are rounded to tick and lot, which
+  // must be the venue's (PRICE_FILTER tickSize, LOT_SIZE stepSize). False for a tick or lot that is not positive
+  bool add_symbol(const std::string& symbol, double tick_size, double lot_size);
+
+  // returns the order id, 0 when rejected (unknown symbol, quantity below one lot, limit price below one tick,
+  // or either not a finite number of ticks / lots)
+  std::uint64_t submit(const PaperOrderRequest& request, std::int64_t now_ms);
+  // false when the order is unknown or already done; a cancel racing a fill loses, as on the real venue
+  bool cancel(std::uint64_t order_id, std::int64_t now_ms);
+  // delivers orders and cancels whose latency has elapsed by now_ms
+  void advance(std::int64_t now_ms);
+  // a real trade: delivers due orders, then fills resting paper orders it trades through
+  void on_trade(const std::string& symbol, std::int64_t trade_time_ms, double price, double quantity);
+  // StrategyEngine EVENT_TRADE handler, feeding live or backtested trades
+  void on_trade(const Coin& coin, const CoinData& trade);
+
+  bool order(std::uint64_t order_id, PaperOrder& out) const;
+  [[nodiscard]] std::vector<PaperOrder> open_orders(const std::string& symbol = "") const;
+  // called for both sides of every fill, under the exchange lock; set before orders arrive
+  void set_fill_handler(std::function<void(const PaperFill&)> handler);
+
+  // POST/GET/DELETE /api/v3/order, GET /api/v3/openOrders, /api/v3/ping and /api/v3/time with Binance
+  // parameter names and response fields; register before server.start()
+  void serve(HttpServer& server);
+
+  static const char* status_name(OrderStatus status);
+};
+
+#endif //PAPEREXCHANGE_H
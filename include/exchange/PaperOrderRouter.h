@@ -0,0 +1,95 @@
+#ifndef PAPERORDERROUTER_H
+#define PAPERORDERROUTER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "OrderGateway.h"
+#include "../risk/RiskManager.h"
+#include "../strategy/StrategyEngine.h"
+
+class PositionBook;
+
+// A symbol's Binance PRICE_FILTER tickSize and LOT_SIZE stepSize, which the order templates are formatted with,
+// and the quantity every signal trades.
+struct PaperSymbolFilters {
+  double tick_size;
+  double lot_size;
+  double order_quantity; // a whole number of lots
+};
+
+// Sends strategy signals to the paper exchange as market orders through an OrderGateway, after the pre-trade risk
+// check. Orders are sent from the gateway's sender thread so the market-data thread never waits on the exchange.
+// The executions reported in the order responses are queued there and applied on the market-data thread at the
+// next signal or trade (on_trade(), subscribed ahead of the risk manager and the position book), so that thread
+// stays the only writer of both; until then an order counts against the risk check as in flight.
+class PaperOrderRouter {
+private:
+  struct Route {
+    std::string symbol;
+    PaperSymbolFilters filters;
+    std::uint32_t risk_index;
+    std::uint32_t position_index;
+    std::size_t templates[2]; // by OrderSide
+    double in_flight[2];      // by OrderSide: sent, answer not applied yet
+  };
+  struct Answer {
+    std::uint32_t route;
+    OrderSide side;
+    double quantity; // as sent
+    double executed; // 0 when the order was rejected or never sent
+    double price;
+    double fee;
+  };
+
+  StrategyEngine& engine_;
+  RiskManager& risk_;
+  PositionBook& positions_;
+  std::vector<Route> routes_;
+  std::unordered_map<std::string, std::uint32_t> route_index_;
+  std::unique_ptr<OrderGateway> gateway_;
+  std::mutex answers_mutex_;
+  std::vector<Answer> answers_;  // answered on the sender thread, not yet applied
+  std::vector<Answer> applying_; // swapped with answers_, reused to keep the drain allocation-free
+  std::function<void(const std::string&, const std::string&)> notice_handler_;
+
+  void notice(const std::string& source, const std::string& message) const;
+  // sender thread: turns the order response into an answer for the market-data thread
+  void on_response(std::uint32_t route, OrderSide side, double quantity, const GatewayResponse& response);
+  void apply_answers();
+
+public:
+  PaperOrderRouter(StrategyEngine& engine, RiskManager& risk, PositionBook& positions);
+  ~PaperOrderRouter();
+  PaperOrderRouter(const PaperOrderRouter&) = delete;
+  PaperOrderRouter& operator=(const PaperOrderRouter&) = delete;
+
+  // Before start(): routes the symbol's signals and adds it to the risk manager, with these limits, and to the
+  // position book. False for filters the exchange cannot trade (a tick or lot that is not positive, or an order
+  // quantity that is not a whole number of lots), a symbol already routed, or a full risk manager or position book.
+  bool add_symbol(const std::string& symbol, const PaperSymbolFilters& filters, const SymbolRiskLimits& limits);
+  // prepares every symbol's buy and sell templates and starts the gateway; false if it could not connect
+  bool start(const GatewayConfig& config);
+  // orders still queued are not sent; their answers are applied as rejected
+  void stop();
+  // the gateway once started, also after stop() for its latency histograms; null before
+  [[nodiscard]] const OrderGateway* gateway() const { return gateway_.get(); }
+
+  // StrategyEngine signal handler: a market order of the symbol's order quantity, unless the symbol is not routed,
+  // the router is not started or the risk check blocks it
+  void on_signal(const Signal& signal);
+  // StrategyEngine EVENT_TRADE handler: applies the answers received since the last signal or trade
+  void on_trade(const Coin& coin, const CoinData& trade);
+
+  // quantity sent for the symbol and side whose answers are not applied yet; market-data thread
+  [[nodiscard]] double in_flight(const std::string& symbol, OrderSide side) const;
+  // blocked, dropped and rejected orders as (source, message), for the log; called from the market-data thread
+  // and the gateway's sender thread. Set before start().
+  void set_notice_handler(std::function<void(const std::string& source, const std::string& message)> handler);
+};
+
+#endif //PAPERORDERROUTER_H
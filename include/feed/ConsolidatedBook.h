@@ -0,0 +1,68 @@
+#ifndef CONSOLIDATEDBOOK_H
+#define CONSOLIDATEDBOOK_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "MarketDataFeed.h"
+
+// one venue's latest view of an instrument; 0 prices until that side has been seen
+struct VenueQuote {
+  double bid = 0.0;
+  double bid_quantity = 0.0;
+  double ask = 0.0;
+  double ask_quantity = 0.0;
+  double last = 0.0;
+  std::int64_t quote_ms = 0; // local receive times, 0 until seen
+  std::int64_t trade_ms = 0;
+};
+
+struct ConsolidatedQuote {
+  double bid = 0.0; // 0 when no fresh venue has a bid
+  double bid_quantity = 0.0;
+  Venue bid_venue = Venue::binance;
+  double ask = 0.0; // 0 when no fresh venue has an offer
+  double ask_quantity = 0.0;
+  Venue ask_venue = Venue::binance;
+  double last = 0.0; // most recent trade on any venue
+  Venue last_venue = Venue::binance;
+  std::int64_t last_ms = 0;
+};
+
+// Best bid / offer and last trade per instrument merged across venues. Each instrument keeps a fixed
+// array of per-venue quotes and which venue holds the best bid and the best ask. An update from a venue
+// that improves on the best, or is not the best, touches only its own entry; only when the best venue
+// backs off is that side re-picked from the FEED_MAX_VENUES entries. Venues whose last quote for the
+// instrument is older than stale_after_ms are left out when reading, so a dead connection cannot pin a
+// price. Not thread-safe: CoinManager serialises feeds into it.
+class ConsolidatedBook {
+private:
+  struct Entry {
+    VenueQuote venues[FEED_MAX_VENUES];
+    int best_bid = -1; // venue index, -1 until a bid is seen
+    int best_ask = -1;
+    int last_venue = -1;
+  };
+
+  std::unordered_map<std::string, Entry> entries_;
+  std::int64_t venue_seen_ms_[FEED_MAX_VENUES] = {};
+  long stale_after_ms_;
+
+  static int pick_bid(const Entry& entry, std::int64_t fresh_after_ms);
+  static int pick_ask(const Entry& entry, std::int64_t fresh_after_ms);
+
+public:
+  explicit ConsolidatedBook(long stale_after_ms = 5000);
+
+  void on_quote(Venue venue, const Quote& quote, std::int64_t now_ms);
+  void on_trade(Venue venue, const std::string& instrument, double price, std::int64_t now_ms);
+
+  // false when no venue has reported the instrument
+  bool best(const std::string& instrument, std::int64_t now_ms, ConsolidatedQuote& out) const;
+  bool venue_quote(const std::string& instrument, Venue venue, VenueQuote& out) const;
+  // local time of the venue's latest message on any instrument, 0 if none
+  [[nodiscard]] std::int64_t last_seen_ms(Venue venue) const;
+  [[nodiscard]] bool is_fresh(Venue venue, std::int64_t now_ms) const;
+};
+
+#endif //CONSOLIDATEDBOOK_H
@@ -0,0 +1,26 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <cstdint>
+#include <string>
+
+#define FEED_MAX_VENUES 4
+
+// venues a MarketDataFeed can speak for; stand-in feeds impersonate one of them
+enum class Venue : std::uint8_t { binance, coinbase, kraken, simulated };
+
+// Instruments are identified by one normalized id everywhere past the feeds: lower-case base then quote
+// with no separator ("btcusdt"), the form CoinManager, history files and strategies already use. Feeds
+// translate to and from their venue's spelling ("BTCUSDT", "BTC-USDT", "XBT/USDT") at the edge.
+namespace instruments {
+  const char* venue_name(Venue venue);
+
+  // splits a normalized id at a known quote currency suffix ("btcusdt" -> "btc", "usdt"); false if none fits
+  bool split(const std::string& id, std::string& base, std::string& quote);
+  // the venue's symbol for a normalized id, empty if it cannot be split
+  std::string to_venue(Venue venue, const std::string& id);
+  // the normalized id for a venue symbol, resolving venue aliases such as Kraken's XBT
+  std::string from_venue(Venue venue, const std::string& symbol);
+}
+
+#endif //INSTRUMENT_H
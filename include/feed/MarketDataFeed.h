@@ -0,0 +1,35 @@
+#ifndef MARKETDATAFEED_H
+#define MARKETDATAFEED_H
+
+#include <string>
+#include <vector>
+#include "Instrument.h"
+
+// top of a venue's book for one instrument
+struct Quote {
+  std::string instrument; // normalized id
+  double bid;
+  double bid_quantity;
+  double ask;
+  double ask_quantity;
+  long time; // venue time in ms, 0 when the venue does not send one
+};
+
+// One venue's market data connection. Subscriptions use normalized instrument ids and the feed maps them
+// to its venue's streams; what arrives is normalized too and handed to the CoinManager the feed was built
+// with (CoinManager::on_trade / on_quote), from the feed's own thread. Several feeds can drive one
+// CoinManager: it merges them into one market state and a consolidated best bid / offer.
+// Subscribing is not a hot path, so this is a plain virtual interface.
+class MarketDataFeed {
+public:
+  virtual ~MarketDataFeed() = default;
+
+  [[nodiscard]] virtual Venue venue() const = 0;
+  virtual void connect() = 0;
+  virtual void disconnect() = 0;
+  [[nodiscard]] virtual bool is_connected() const = 0;
+  virtual void subscribe(const std::vector<std::string>& instruments) = 0;
+  virtual void unsubscribe(const std::vector<std::string>& instruments) = 0;
+};
+
+#endif //MARKETDATAFEED_H
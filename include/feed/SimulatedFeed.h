@@ -0,0 +1,56 @@
+#ifndef SIMULATEDFEED_H
+#define SIMULATEDFEED_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "MarketDataFeed.h"
+
+class CoinManager;
+
+// Local stand-in for a venue's feed, for tests and for running without network access. push_trade() and
+// push_quote() deliver exactly what a real feed would after normalizing, from the calling thread, and only
+// while connected and subscribed to the instrument. start_random_walk() runs a thread that does the same
+// on a timer around the given prices.
+class SimulatedFeed : public MarketDataFeed {
+private:
+  CoinManager& coin_manager_;
+  Venue venue_;
+  std::atomic<bool> connected_;
+  mutable std::mutex mutex_;
+  std::set<std::string> subscribed_;
+  long next_trade_id_;
+
+  std::atomic<bool> walking_;
+  std::thread walker_;
+
+  [[nodiscard]] bool accepts(const std::string& instrument) const;
+
+public:
+  SimulatedFeed(CoinManager& manager, Venue venue);
+  ~SimulatedFeed() override;
+  SimulatedFeed(const SimulatedFeed&) = delete;
+  SimulatedFeed& operator=(const SimulatedFeed&) = delete;
+
+  [[nodiscard]] Venue venue() const override { return venue_; }
+  void connect() override { connected_ = true; }
+  void disconnect() override { connected_ = false; }
+  [[nodiscard]] bool is_connected() const override { return connected_; }
+  void subscribe(const std::vector<std::string>& instruments) override;
+  void unsubscribe(const std::vector<std::string>& instruments) override;
+  [[nodiscard]] bool is_subscribed(const std::string& instrument) const;
+
+  // false when dropped (not connected or not subscribed)
+  bool push_trade(const std::string& instrument, double price, double quantity, long time_ms);
+  bool push_quote(const Quote& quote);
+
+  // every interval_ms, moves each instrument's price by a random step of about spread_bps and publishes a
+  // quote one spread wide around it plus a trade at it
+  void start_random_walk(const std::map<std::string, double>& start_prices, long interval_ms,
+                         double spread_bps = 2.0, unsigned seed = 1);
+  void stop_random_walk();
+};
+
+#endif //SIMULATEDFEED_H
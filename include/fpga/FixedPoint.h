@@ -0,0 +1,205 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <algorithm>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+
+// Signed two's complement fixed point with the semantics of an FPGA datapath, for golden models that have to agree
+// with the hardware bit for bit. Fixed<I, F> has I integer bits (sign included) and F fraction bits, I + F <= 64,
+// held sign-extended in an int64. How a value is brought into a format is part of the format's type:
+//
+//   Rounding::truncate   drops the low bits: toward -inf, what an arithmetic shift does
+//   Rounding::half_up    adds half an LSB, then truncates: ties toward +inf
+//   Rounding::half_away  ties away from zero, like std::llround
+//   Rounding::half_even  ties to the even neighbour (convergent rounding)
+//   Overflow::wrap       keeps the low I + F bits, as a register of that width does
+//   Overflow::saturate   clamps to the format's range
+//
+// The operations in namespace fixed compute their result exactly in 128 bits and round and fit it once, into the
+// format given as the first template argument, so the formats alone define every result. Qm.n in comments means
+// Fixed<m, n>: the sign counts among the m integer bits.
+enum class Rounding { truncate, half_up, half_away, half_even };
+enum class Overflow { wrap, saturate };
+
+namespace fixed {
+  using Wide = __int128;
+
+  // value with its low shift bits rounded off; a negative shift scales up exactly
+  template<Rounding R>
+  constexpr Wide shift_right(Wide value, int shift) {
+    if (shift <= 0) {
+      return value * (Wide(1) << -shift);
+    }
+    const Wide floor = value >> shift;
+    const Wide remainder = value - floor * (Wide(1) << shift);
+    const Wide half = Wide(1) << (shift - 1);
+    if constexpr (R == Rounding::truncate) {
+      return floor;
+    } else if constexpr (R == Rounding::half_up) {
+      return floor + (remainder >= half);
+    } else if constexpr (R == Rounding::half_away) {
+      return floor + (remainder > half || (remainder == half && value >= 0));
+    } else {
+      return floor + (remainder > half || (remainder == half && (floor & 1) != 0));
+    }
+  }
+
+  // numerator / denominator for denominator > 0, rounded the same way
+  template<Rounding R, typename T>
+  constexpr T divide_rounded(T numerator, T denominator) {
+    T floor = numerator / denominator;
+    T remainder = numerator % denominator;
+    if (remainder < 0) {
+      --floor;
+      remainder += denominator;
+    }
+    if constexpr (R == Rounding::truncate) {
+      return floor;
+    } else {
+      // remainder against what is left to the next multiple, rather than 2 * remainder, which could overflow
+      const T rest = denominator - remainder;
+      if constexpr (R == Rounding::half_up) {
+        return floor + (remainder >= rest);
+      } else if constexpr (R == Rounding::half_away) {
+        return floor + (remainder > rest || (remainder == rest && numerator >= 0));
+      } else {
+        return floor + (remainder > rest || (remainder == rest && (floor & 1) != 0));
+      }
+    }
+  }
+
+  template<int Width, Overflow O>
+  constexpr std::int64_t fit(Wide value) {
+    if constexpr (O == Overflow::saturate) {
+      constexpr Wide max = (Wide(1) << (Width - 1)) - 1;
+      return static_cast<std::int64_t>(std::clamp(value, -max - 1, max));
+    } else {
+      const auto bits = static_cast<std::uint64_t>(value);
+      if constexpr (Width == 64) {
+        return static_cast<std::int64_t>(bits);
+      } else {
+        return static_cast<std::int64_t>(bits << (64 - Width)) >> (64 - Width);
+      }
+    }
+  }
+
+  // raw value with from fraction bits rescaled to to >= from fraction bits
+  constexpr Wide align(std::int64_t raw, int from, int to) {
+    return Wide(raw) * (Wide(1) << (to - from));
+  }
+}
+
+template<int IntegerBits, int FractionBits, Rounding R = Rounding::truncate, Overflow O = Overflow::wrap>
+class Fixed {
+  static_assert(IntegerBits >= 1 && FractionBits >= 0 && IntegerBits + FractionBits <= 64);
+
+private:
+  std::int64_t raw_ = 0;
+
+public:
+  static constexpr int integer_bits = IntegerBits;
+  static constexpr int fraction_bits = FractionBits;
+  static constexpr int width = IntegerBits + FractionBits;
+  static constexpr Rounding rounding = R;
+  static constexpr Overflow overflow = O;
+  static constexpr std::int64_t max_raw = static_cast<std::int64_t>((fixed::Wide(1) << (width - 1)) - 1);
+  static constexpr std::int64_t min_raw = -max_raw - 1;
+
+  constexpr Fixed() = default;
+
+  // an exact value with the given number of fraction bits, rounded and fitted into this format
+  static constexpr Fixed from_scaled(fixed::Wide value, int fraction) {
+    Fixed result;
+    result.raw_ = fixed::fit<width, O>(fixed::shift_right<R>(value, fraction - FractionBits));
+    return result;
+  }
+  static constexpr Fixed from_raw(std::int64_t raw) {
+    return from_scaled(raw, FractionBits);
+  }
+  // the register contents as width bits, e.g. read from a vector file: always wraps
+  static constexpr Fixed from_bits(std::uint64_t bits) {
+    Fixed result;
+    result.raw_ = fixed::fit<width, Overflow::wrap>(bits);
+    return result;
+  }
+  static Fixed from_double(double value) {
+    const double scaled = std::ldexp(value, FractionBits);
+    if (std::isnan(scaled)) {
+      return Fixed();
+    }
+    // beyond 2^100 every format overflows the same way
+    const double clamped = std::clamp(scaled, -0x1p100, 0x1p100);
+    const double floor = std::floor(clamped);
+    const double remainder = clamped - floor; // exact
+    const auto integer = static_cast<fixed::Wide>(floor);
+    bool up = false;
+    if constexpr (R == Rounding::half_up) {
+      up = remainder >= 0.5;
+    } else if constexpr (R == Rounding::half_away) {
+      up = remainder > 0.5 || (remainder == 0.5 && floor >= 0);
+    } else if constexpr (R == Rounding::half_even) {
+      up = remainder > 0.5 || (remainder == 0.5 && (integer & 1) != 0);
+    }
+    Fixed result;
+    result.raw_ = fixed::fit<width, O>(integer + up);
+    return result;
+  }
+
+  [[nodiscard]] constexpr std::int64_t raw() const { return raw_; }
+  // the low width bits, as the hardware register holds them
+  [[nodiscard]] constexpr std::uint64_t bits() const {
+    const auto bits = static_cast<std::uint64_t>(raw_);
+    return width == 64 ? bits : bits & ((std::uint64_t(1) << (width % 64)) - 1);
+  }
+  [[nodiscard]] double to_double() const { return std::ldexp(static_cast<double>(raw_), -FractionBits); }
+
+  constexpr auto operator<=>(const Fixed&) const = default;
+};
+
+namespace fixed {
+  template<typename Result, typename A>
+  constexpr Result convert(A a) {
+    return Result::from_scaled(a.raw(), A::fraction_bits);
+  }
+
+  template<typename Result, typename A, typename B>
+  constexpr Result add(A a, B b) {
+    constexpr int fraction = std::max(A::fraction_bits, B::fraction_bits);
+    return Result::from_scaled(align(a.raw(), A::fraction_bits, fraction) + align(b.raw(), B::fraction_bits, fraction),
+                               fraction);
+  }
+
+  template<typename Result, typename A, typename B>
+  constexpr Result subtract(A a, B b) {
+    constexpr int fraction = std::max(A::fraction_bits, B::fraction_bits);
+    return Result::from_scaled(align(a.raw(), A::fraction_bits, fraction) - align(b.raw(), B::fraction_bits, fraction),
+                               fraction);
+  }
+
+  template<typename Result, typename A, typename B>
+  constexpr Result multiply(A a, B b) {
+    return Result::from_scaled(Wide(a.raw()) * b.raw(), A::fraction_bits + B::fraction_bits);
+  }
+
+  // a / divisor for divisor > 0, e.g. a window sum over its count, with one rounding into Result
+  template<typename Result, typename A>
+  constexpr Result divide(A a, std::int64_t divisor) {
+    constexpr int up = std::max(Result::fraction_bits - A::fraction_bits, 0);
+    constexpr int down = std::max(A::fraction_bits - Result::fraction_bits, 0);
+    const Wide numerator = Wide(a.raw()) * (Wide(1) << up);
+    const Wide denominator = Wide(divisor) * (Wide(1) << down);
+    Wide quotient;
+    if (numerator >= INT64_MIN && numerator <= INT64_MAX && denominator <= INT64_MAX) {
+      // the common case, and several times faster than a 128-bit divide
+      quotient = divide_rounded<Result::rounding>(static_cast<std::int64_t>(numerator),
+                                                  static_cast<std::int64_t>(denominator));
+    } else {
+      quotient = divide_rounded<Result::rounding>(numerator, denominator);
+    }
+    return Result::from_scaled(quotient, Result::fraction_bits);
+  }
+}
+
+#endif //FIXEDPOINT_H
@@ -0,0 +1,54 @@
+#ifndef FPGAEMULATOR_H
+#define FPGAEMULATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OffloadProtocol.h"
+
+// Software stand-in for the FPGA moving-average unit, on the far side of a pseudo-terminal: the offload backend
+// opens device() exactly as it would open the UART, so the host side is exercised byte for byte without hardware.
+// It answers OffloadProtocol frames from its own thread with the arithmetic the unit will do: fixed-point prices
+// in a ring per channel and a running window sum. With a baud rate it also holds each reply back for the time
+// the request and reply would take on a UART at that rate (10 bits per byte), so latency and throughput
+// measurements reflect the link; 0 answers as fast as the pty allows.
+class FpgaEmulator {
+private:
+  struct Channel {
+    std::vector<std::int64_t> window;
+    std::size_t next = 0;
+    std::size_t count = 0;
+    std::int64_t sum = 0;
+  };
+
+  unsigned baud_;
+  int master_fd_;
+  int slave_fd_; // held open so the pty survives the host closing and reopening it
+  std::string device_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::atomic<std::uint64_t> frames_;
+  std::vector<Channel> channels_;
+  offload::FrameDecoder decoder_;
+
+  void run();
+  // appends the reply to the frame to out
+  void handle(const OffloadFrame& frame, std::vector<std::uint8_t>& out);
+
+public:
+  explicit FpgaEmulator(unsigned baud = 0);
+  ~FpgaEmulator();
+  FpgaEmulator(const FpgaEmulator&) = delete;
+  FpgaEmulator& operator=(const FpgaEmulator&) = delete;
+
+  // creates the pty and starts answering; false with a message on failure
+  bool start();
+  void stop();
+  // path of the pty to open as the serial device, e.g. /dev/pts/3
+  [[nodiscard]] const std::string& device() const { return device_; }
+  [[nodiscard]] std::uint64_t frames() const { return frames_.load(std::memory_order_relaxed); }
+};
+
+#endif //FPGAEMULATOR_H
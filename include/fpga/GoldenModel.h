@@ -0,0 +1,123 @@
+#ifndef GOLDENMODEL_H
+#define GOLDENMODEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FixedPoint.h"
+#include "OffloadProtocol.h"
+
+// Bit-exact reference models of the FPGA's moving-average datapath, for checking the hardware (or FpgaEmulator)
+// against: every width, rounding and overflow is fixed by the Fixed formats the model is instantiated with, so
+// a model built with the unit's formats produces the unit's outputs bit for bit. They mirror the floating-point
+// code they replace, MovingAverage and the MA cross in StrategyEngine.
+
+#define GOLDEN_READY 0x1       // the window is full
+#define GOLDEN_CROSS_ABOVE 0x2 // the price moved above the average
+#define GOLDEN_CROSS_BELOW 0x4 // the price moved below the average
+
+// The sliding-window unit. The window is a ring of prices that starts out zeroed, like the unit's block RAM, and
+// each update replaces the oldest with sum' = sum + price - oldest, computed exactly and then rounded and fitted
+// into Sum once. With a wrapping Sum this is the true window sum whenever it fits, and wraps as the register does
+// when it does not; a saturating Sum sticks once it has clipped, as the hardware would. value() divides the sum
+// by the count with a single rounding into Average.
+template<typename Price, typename Sum, typename Average>
+class GoldenMovingAverage {
+private:
+  std::vector<std::int64_t> window_; // raw prices
+  std::size_t next_;
+  std::size_t count_;
+  Sum sum_;
+
+public:
+  explicit GoldenMovingAverage(std::size_t window_size)
+    : window_(window_size ? window_size : 1, 0), next_(0), count_(0) {}
+
+  void update(Price price) {
+    constexpr int fraction = Price::fraction_bits > Sum::fraction_bits ? Price::fraction_bits : Sum::fraction_bits;
+    std::int64_t& oldest = window_[next_];
+    sum_ = Sum::from_scaled(fixed::align(sum_.raw(), Sum::fraction_bits, fraction)
+                              + fixed::align(price.raw(), Price::fraction_bits, fraction)
+                              - fixed::align(oldest, Price::fraction_bits, fraction),
+                            fraction);
+    oldest = price.raw();
+    next_ = next_ + 1 == window_.size() ? 0 : next_ + 1;
+    count_ += count_ < window_.size();
+  }
+
+  void reset() {
+    std::fill(window_.begin(), window_.end(), 0);
+    next_ = 0;
+    count_ = 0;
+    sum_ = Sum();
+  }
+
+  // mean of the prices in the window, 0 while it is empty
+  [[nodiscard]] Average value() const { return count_ ? fixed::divide<Average>(sum_, count_) : Average(); }
+  [[nodiscard]] Sum sum() const { return sum_; }
+  [[nodiscard]] std::size_t count() const { return count_; }
+  [[nodiscard]] std::size_t window_size() const { return window_.size(); }
+  [[nodiscard]] bool is_ready() const { return count_ == window_.size(); }
+};
+
+struct GoldenOutput {
+  std::uint32_t count;
+  std::int64_t sum;     // raw, in the model's Sum format
+  std::int64_t average; // raw, in the model's Average format
+  std::uint8_t flags;   // GOLDEN_*
+};
+
+// The crossover unit on top of the sliding window, with StrategyEngine's semantics: each price goes into the window
+// first and is then compared, exactly, with the new average. Nothing is compared until the window is full; the
+// first side seen after that is a baseline rather than a cross, and a price equal to the average keeps the side.
+template<typename Price, typename Sum, typename Average>
+class GoldenCrossover {
+private:
+  GoldenMovingAverage<Price, Sum, Average> average_;
+  int side_; // -1 below, 1 above, 0 before the baseline
+
+public:
+  explicit GoldenCrossover(std::size_t window_size) : average_(window_size), side_(0) {}
+
+  GoldenOutput update(Price price) {
+    average_.update(price);
+    const Average average = average_.value();
+    GoldenOutput out{static_cast<std::uint32_t>(average_.count()), average_.sum().raw(), average.raw(), 0};
+    if (!average_.is_ready()) {
+      return out;
+    }
+    out.flags = GOLDEN_READY;
+    constexpr int fraction =
+      Price::fraction_bits > Average::fraction_bits ? Price::fraction_bits : Average::fraction_bits;
+    const fixed::Wide p = fixed::align(price.raw(), Price::fraction_bits, fraction);
+    const fixed::Wide a = fixed::align(average.raw(), Average::fraction_bits, fraction);
+    const int side = p > a ? 1 : p < a ? -1 : side_;
+    if (side != side_) {
+      if (side_ != 0) {
+        out.flags |= side > 0 ? GOLDEN_CROSS_ABOVE : GOLDEN_CROSS_BELOW;
+      }
+      side_ = side;
+    }
+    return out;
+  }
+
+  void reset() {
+    average_.reset();
+    side_ = 0;
+  }
+
+  [[nodiscard]] const GoldenMovingAverage<Price, Sum, Average>& moving_average() const { return average_; }
+};
+
+// The unit as built: prices in the Q32.32 of OffloadProtocol.h, rounded on the host as offload::to_fixed does; a
+// 64-bit window sum that wraps, as the emulator's does, once window x price passes 2^31; averages rounded to
+// nearest even.
+using MaUnitPrice =
+  Fixed<64 - OFFLOAD_PRICE_FRACTION_BITS, OFFLOAD_PRICE_FRACTION_BITS, Rounding::half_away, Overflow::saturate>;
+using MaUnitSum = Fixed<64 - OFFLOAD_PRICE_FRACTION_BITS, OFFLOAD_PRICE_FRACTION_BITS>;
+using MaUnitAverage =
+  Fixed<64 - OFFLOAD_PRICE_FRACTION_BITS, OFFLOAD_PRICE_FRACTION_BITS, Rounding::half_even, Overflow::saturate>;
+using MaUnitModel = GoldenCrossover<MaUnitPrice, MaUnitSum, MaUnitAverage>;
+
+#endif //GOLDENMODEL_H
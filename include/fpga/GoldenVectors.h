@@ -0,0 +1,48 @@
+#ifndef GOLDENVECTORS_H
+#define GOLDENVECTORS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "GoldenModel.h"
+
+// Test vectors for the moving-average unit, in VectorFile.h's hex format, and the tools around them built on
+// MaUnitModel. A stimulus file holds one price per line (MaUnitPrice, 64 bits); an output file holds per price
+//
+//   count (16 bits) | window sum (MaUnitSum) | average (MaUnitAverage) | GOLDEN_* flags (4 bits)
+//
+// The sliding-window unit on its own produces only the first two fields, which is what run_unit() records, so
+// outputs may stop after any field and are compared on the fields they have.
+#define GOLDEN_COUNT_BITS 16
+#define GOLDEN_FLAG_BITS 4
+#define GOLDEN_OUTPUT_FIELDS 4
+
+struct GoldenCheck {
+  std::uint64_t vectors = 0;
+  std::uint64_t mismatches = 0;
+  std::uint64_t first_mismatch = 0; // line in the output file, 0 if there was none
+  std::size_t fields = 0;           // compared per vector
+  double seconds = 0.0;
+
+  [[nodiscard]] double vectors_per_s() const { return seconds > 0 ? static_cast<double>(vectors) / seconds : 0.0; }
+};
+
+namespace golden {
+  // every trade of symbol in the capture under history_dir with begin_ms <= trade_time < end_ms, as stimulus in
+  // <prefix>_stimulus.hex and the model's outputs for a window of window prices in <prefix>_expected.hex. Like
+  // check_vectors() and run_unit(), false for a window the unit cannot take (above OFFLOAD_MAX_WINDOW)
+  bool generate_vectors(const std::string& history_dir, const std::string& symbol, std::int64_t begin_ms,
+                        std::int64_t end_ms, std::size_t window, const std::string& prefix, std::uint64_t& vectors);
+  // Replays the stimulus through the model and compares output line by line, field by field, on as many fields as
+  // its first line has. Mismatches go to report, the first max_reported of them in full. False when the files
+  // cannot be read or disagree in length; mismatches alone are counted in result.
+  bool check_vectors(const std::string& stimulus, const std::string& output, std::size_t window, GoldenCheck& result,
+                     std::ostream& report, std::size_t max_reported = 10);
+  // Drives a unit, or FpgaEmulator, on device with the stimulus on one channel configured for window, as
+  // OFFLOAD_MAX_BATCH updates a frame, and records each update's count and window sum in output.
+  bool run_unit(const std::string& device, unsigned baud, const std::string& stimulus, std::size_t window,
+                const std::string& output, std::uint64_t& vectors);
+}
+
+#endif //GOLDENVECTORS_H
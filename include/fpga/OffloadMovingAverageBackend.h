@@ -0,0 +1,81 @@
+#ifndef OFFLOADMOVINGAVERAGEBACKEND_H
+#define OFFLOADMOVINGAVERAGEBACKEND_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "OffloadProtocol.h"
+#include "SerialPort.h"
+#include "../common/MovingAverageBackend.h"
+#include "../metrics/LatencyHistogram.h"
+
+#define OFFLOAD_DEFAULT_BAUD 921600
+#define OFFLOAD_DEFAULT_TIMEOUT_MS 1000
+
+// Runs moving averages on the FPGA unit behind a serial link (OffloadProtocol.h). Updates are encoded straight
+// into an OFFLOAD_UPDATES frame; when batch_size of them are queued, or on flush(), the frame goes out and the
+// call waits for the unit's OFFLOAD_RESULTS, so value() lags by fewer than batch_size updates across all
+// channels (batch size 1 is synchronous). Each batch's round trip is recorded to measure the link.
+// If the unit stops answering or answers out of turn the backend fails: values stay as they were, updates are
+// dropped, and flush() returns false. A price the channel's window sum cannot hold (offload::max_price) fails it
+// the same way, before it is sent.
+class OffloadMovingAverageBackend : public MovingAverageBackend {
+private:
+  struct Channel {
+    std::size_t window;
+    std::size_t count;
+    std::int64_t sum; // fixed point, as returned by the unit
+    double max_price; // offload::max_price(window)
+  };
+
+  SerialPort port_;
+  std::vector<Channel> channels_;
+  std::size_t batch_size_;
+  int timeout_ms_;
+  std::vector<std::uint8_t> batch_; // OFFLOAD_UPDATES payload being built
+  std::size_t pending_;
+  std::uint16_t sequence_;
+  std::vector<std::uint8_t> frame_;
+  offload::FrameDecoder decoder_;
+  OffloadFrame reply_;
+  bool failed_;
+
+  LatencyHistogram round_trip_;
+  std::uint64_t batches_;
+  std::uint64_t updates_;
+  std::uint64_t bytes_sent_;
+  std::uint64_t bytes_received_;
+
+  // sends a frame and waits for the reply into reply_
+  bool exchange(std::uint8_t type, const std::uint8_t* payload, std::size_t size, std::uint8_t reply_type);
+  bool fail(const std::string& reason);
+
+public:
+  explicit OffloadMovingAverageBackend(std::size_t batch_size = 1, int timeout_ms = OFFLOAD_DEFAULT_TIMEOUT_MS);
+  ~OffloadMovingAverageBackend() override;
+
+  // the unit's serial device; false with a message when it cannot be opened
+  bool open(const std::string& device, unsigned baud = OFFLOAD_DEFAULT_BAUD);
+  void close();
+  // flushes what is queued, then batches batch_size updates (1 to OFFLOAD_MAX_BATCH)
+  void set_batch_size(std::size_t batch_size);
+  [[nodiscard]] std::size_t batch_size() const { return batch_size_; }
+
+  std::uint32_t add_channel(std::size_t window) override;
+  void reset(std::uint32_t channel) override;
+  void update(std::uint32_t channel, double price) override;
+  bool flush() override;
+  [[nodiscard]] double value(std::uint32_t channel) const override;
+  [[nodiscard]] std::size_t count(std::uint32_t channel) const override { return channels_[channel].count; }
+  [[nodiscard]] const char* name() const override { return "fpga offload"; }
+
+  [[nodiscard]] bool failed() const override { return failed_; }
+  // batch sent to results applied
+  [[nodiscard]] const LatencyHistogram& round_trip() const { return round_trip_; }
+  [[nodiscard]] std::uint64_t batches() const { return batches_; }
+  [[nodiscard]] std::uint64_t updates() const { return updates_; }
+  [[nodiscard]] std::uint64_t bytes_sent() const { return bytes_sent_; }
+  [[nodiscard]] std::uint64_t bytes_received() const { return bytes_received_; }
+};
+
+#endif //OFFLOADMOVINGAVERAGEBACKEND_H
@@ -0,0 +1,120 @@
+#ifndef OFFLOADPROTOCOL_H
+#define OFFLOADPROTOCOL_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Framing between the host and the moving-average unit on the serial link. Every frame is
+//
+//   0xA5 | type u8 | length u16 | payload (length bytes) | CRC-16/CCITT-FALSE u16 over type, length and payload
+//
+// all little-endian. The receiver hunts for the start byte and drops frames whose CRC fails, so it recovers from
+// line noise or a reset mid-frame. Prices travel as Q32.32, signed fixed point in 64 bits with
+// OFFLOAD_PRICE_FRACTION_BITS fraction bits and 32 integer bits counting the sign (FixedPoint.h's convention).
+// The unit returns each channel's window sum rather than the mean, so it needs no divider; the host divides.
+// That sum is Q32.32 as well, so it only stays in range while window x |price| < 2^31: prices below
+// offload::max_price(window), 524288 at OFFLOAD_MAX_WINDOW. Past that the unit's sum wraps, so the host refuses
+// such prices rather than send them.
+#define OFFLOAD_START_OF_FRAME 0xA5
+#define OFFLOAD_FRAME_OVERHEAD 6
+#define OFFLOAD_MAX_PAYLOAD 16384
+#define OFFLOAD_PRICE_FRACTION_BITS 32 // 2.3e-10 resolution
+#define OFFLOAD_MAX_CHANNELS 256
+#define OFFLOAD_MAX_WINDOW 4096 // prices held per channel on the unit
+#define OFFLOAD_UPDATE_SIZE 10  // channel u16, price i64
+#define OFFLOAD_RESULT_SIZE 12  // channel u16, count u16, window sum i64
+#define OFFLOAD_BATCH_HEADER 4  // sequence u16, count u16
+#define OFFLOAD_MAX_BATCH ((OFFLOAD_MAX_PAYLOAD - OFFLOAD_BATCH_HEADER) / OFFLOAD_RESULT_SIZE)
+
+enum OffloadFrameType : std::uint8_t {
+  OFFLOAD_CONFIGURE = 0x01, // channel u16, window u16: the channel restarts empty with that window
+  OFFLOAD_UPDATES = 0x02,   // batch header, count x update, applied in order
+  OFFLOAD_ACK = 0x81,       // channel u16, for OFFLOAD_CONFIGURE
+  OFFLOAD_RESULTS = 0x82,   // batch header echoing the updates', count x result: each channel after its update
+  OFFLOAD_ERROR = 0xFF,     // code u8
+};
+
+enum OffloadError : std::uint8_t {
+  OFFLOAD_ERROR_MALFORMED = 1,
+  OFFLOAD_ERROR_CHANNEL = 2, // out of range or not configured
+  OFFLOAD_ERROR_WINDOW = 3,
+};
+
+struct OffloadFrame {
+  std::uint8_t type;
+  std::vector<std::uint8_t> payload;
+};
+
+namespace offload {
+  bool is_frame_type(std::uint8_t type);
+  std::uint16_t crc16(const std::uint8_t* data, std::size_t size);
+  // appends a complete frame to out
+  void append_frame(std::vector<std::uint8_t>& out, std::uint8_t type, const std::uint8_t* payload,
+                    std::size_t size);
+
+  inline void put_u16(std::uint8_t* out, std::uint16_t value) {
+    out[0] = static_cast<std::uint8_t>(value);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+  }
+  inline void put_i64(std::uint8_t* out, std::int64_t value) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+      out[i] = static_cast<std::uint8_t>(bits >> (8 * i));
+    }
+  }
+  inline std::uint16_t get_u16(const std::uint8_t* in) {
+    return static_cast<std::uint16_t>(in[0] | in[1] << 8);
+  }
+  inline std::int64_t get_i64(const std::uint8_t* in) {
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+      bits |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return static_cast<std::int64_t>(bits);
+  }
+
+  // rounded half away from zero and saturated to 64 bits, NaN as 0: MaUnitPrice::from_double() (GoldenModel.h)
+  inline std::int64_t to_fixed(double price) {
+    const double scaled = std::ldexp(price, OFFLOAD_PRICE_FRACTION_BITS);
+    if (std::isnan(scaled)) {
+      return 0;
+    }
+    // llround is unspecified out of range; 2^63 is the first double above it, -2^63 itself still fits
+    if (scaled >= 0x1p63) {
+      return INT64_MAX;
+    }
+    if (scaled < -0x1p63) {
+      return INT64_MIN;
+    }
+    return std::llround(scaled);
+  }
+  inline double from_fixed(std::int64_t value) {
+    return std::ldexp(static_cast<double>(value), -OFFLOAD_PRICE_FRACTION_BITS);
+  }
+  // prices strictly below this in magnitude keep a channel's window sum in 64 bits
+  inline double max_price(std::size_t window) {
+    return std::ldexp(1.0, 63 - OFFLOAD_PRICE_FRACTION_BITS) / static_cast<double>(window);
+  }
+
+  // Incremental frame parser for a byte stream.
+  class FrameDecoder {
+  private:
+    std::vector<std::uint8_t> buffer_;
+    std::size_t start_;
+    std::uint64_t dropped_bytes_;
+    std::uint64_t crc_errors_;
+
+  public:
+    FrameDecoder();
+    void feed(const std::uint8_t* data, std::size_t size);
+    // the next complete, intact frame; false until one has arrived
+    bool next(OffloadFrame& frame);
+    void clear();
+    [[nodiscard]] std::uint64_t dropped_bytes() const { return dropped_bytes_; }
+    [[nodiscard]] std::uint64_t crc_errors() const { return crc_errors_; }
+  };
+}
+
+#endif //OFFLOADPROTOCOL_H
@@ -0,0 +1,33 @@
+#ifndef SERIALPORT_H
+#define SERIALPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A serial device (a UART such as /dev/ttyUSB0, or a pty) in raw 8N1 mode: no echo, no line editing, no flow
+// control, no byte translation. Reads wait with poll(), so they can time out.
+class SerialPort {
+private:
+  int fd_;
+
+public:
+  SerialPort();
+  ~SerialPort();
+  SerialPort(const SerialPort&) = delete;
+  SerialPort& operator=(const SerialPort&) = delete;
+
+  // false with a message when the device cannot be opened or the baud rate is not a standard one
+  bool open(const std::string& device, unsigned baud);
+  void close();
+  [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+
+  bool write_all(const std::uint8_t* data, std::size_t size);
+  // bytes read into buffer, 0 when nothing arrived within timeout_ms, -1 on error
+  long read_some(std::uint8_t* buffer, std::size_t size, int timeout_ms);
+
+  // puts a terminal file descriptor into raw 8N1 mode; speed 0 leaves the speed alone
+  static bool make_raw(int fd, unsigned baud);
+};
+
+#endif //SERIALPORT_H
@@ -0,0 +1,68 @@
+#ifndef VECTORFILE_H
+#define VECTORFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Test vectors as text, one vector per line, each field in two's complement hex with one digit per 4 bits of its
+// width, separated by spaces: what a testbench reads with $readmemh or $fscanf("%h %h") and writes with
+// $fwrite("%h %h"). Readers skip blank lines and // comments. Both sides buffer a megabyte at a time and
+// format and parse by hand, so files of millions of vectors stream at memory speed.
+class VectorWriter {
+private:
+  std::vector<int> widths_; // bits per field
+  std::FILE* file_;
+  std::vector<char> buffer_;
+  std::size_t used_;
+  bool failed_;
+
+  void drain();
+
+public:
+  explicit VectorWriter(std::vector<int> widths);
+  ~VectorWriter();
+  VectorWriter(const VectorWriter&) = delete;
+  VectorWriter& operator=(const VectorWriter&) = delete;
+
+  // false with a message when the file cannot be created
+  bool open(const std::string& path);
+  // one line holding the low widths[i] bits of fields[i]
+  void write(const std::int64_t* fields);
+  // false when anything failed to reach the file
+  bool close();
+};
+
+class VectorReader {
+private:
+  std::vector<int> widths_;
+  std::FILE* file_;
+  std::vector<char> buffer_;
+  std::size_t begin_;
+  std::size_t end_;
+  bool eof_;
+  std::uint64_t line_;
+  std::string error_;
+
+  bool refill();
+
+public:
+  explicit VectorReader(std::vector<int> widths);
+  ~VectorReader();
+  VectorReader(const VectorReader&) = delete;
+  VectorReader& operator=(const VectorReader&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+  // parses the next vector into fields, each sign-extended from its width, and returns how many fields the line
+  // has (at most widths.size(), later ones may be missing); 0 at the end of the file or, see error(), on a line
+  // that does not parse
+  std::size_t next(std::int64_t* fields);
+  // line number of the vector last returned
+  [[nodiscard]] std::uint64_t line() const { return line_; }
+  [[nodiscard]] const std::string& error() const { return error_; }
+};
+
+#endif //VECTORFILE_H
@@ -0,0 +1,47 @@
+#ifndef HISTORYEXPORTER_H
+#define HISTORYEXPORTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ExportFormat { csv, npy };
+
+struct ExportStats {
+  std::size_t files = 0;
+  std::uint64_t records = 0;
+  std::uint64_t bytes_in = 0;
+  std::uint64_t bytes_out = 0;
+  double seconds = 0.0;
+
+  [[nodiscard]] double input_mb_per_s() const;
+  [[nodiscard]] double output_mb_per_s() const;
+};
+
+// Converts tick captures written by HistoryWriter into CSV or NumPy .npy columns.
+// csv: <output>/<day>/<symbol>.csv
+// npy: <output>/<day>/<symbol>/{trade_time,trade_id,price,quantity}.npy, loadable with np.load(..., mmap_mode="r")
+// Every day/symbol file is an independent job handed out to a pool of worker threads.
+class HistoryExporter {
+private:
+  std::string history_dir_;
+  std::string output_dir_;
+  unsigned workers_;
+
+  struct Job {
+    std::string day;
+    std::string symbol;
+  };
+  [[nodiscard]] std::vector<Job> collect_jobs() const;
+
+public:
+  HistoryExporter(const std::string& history_dir, const std::string& output_dir, unsigned workers = 0);
+
+  ExportStats export_all(ExportFormat format) const;
+
+  // single-file conversions, returning bytes written (0 on failure)
+  static std::uint64_t export_csv(const std::string& ticks_path, const std::string& csv_path);
+  static std::uint64_t export_npy(const std::string& ticks_path, const std::string& npy_directory);
+};
+
+#endif //HISTORYEXPORTER_H
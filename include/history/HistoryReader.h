@@ -0,0 +1,58 @@
+#ifndef HISTORYREADER_H
+#define HISTORYREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TickRecord.h"
+
+// Range queries over files written by HistoryWriter. seek_*() binary searches the sparse block index
+// of the first day file in range, then read() streams matching records into a caller-owned buffer,
+// moving on to the following day files until the end of the range.
+//
+//   HistoryReader reader("../history/", "btcusdt");
+//   reader.seek_time(from_ms, to_ms);
+//   while (std::size_t n = reader.read(buffer, capacity)) { ... }
+class HistoryReader {
+private:
+  enum class Key { time, trade_id };
+
+  std::string directory_;
+  std::string symbol_;
+  Key key_;
+  std::int64_t begin_;
+  std::int64_t end_;
+  std::vector<std::string> days_; // day files still to visit, in order
+  std::size_t next_day_;
+  std::FILE* file_;
+  bool skipping_; // still looking for the first in-range record of the current file
+  bool done_;
+
+  bool open_next_day();
+  void close_file();
+  [[nodiscard]] std::int64_t key_of(const TickRecord& record) const;
+  [[nodiscard]] std::int64_t key_of(const TickIndexEntry& entry) const;
+
+public:
+  HistoryReader(const std::string& directory, const std::string& symbol);
+  ~HistoryReader();
+
+  HistoryReader(const HistoryReader&) = delete;
+  HistoryReader& operator=(const HistoryReader&) = delete;
+
+  // trades with begin_ms <= trade_time < end_ms
+  bool seek_time(std::int64_t begin_ms, std::int64_t end_ms);
+  // trades with begin_id <= trade_id < end_id
+  bool seek_trade_id(std::int64_t begin_id, std::int64_t end_id);
+  // fills up to capacity records, returns 0 once the range is exhausted
+  std::size_t read(TickRecord* buffer, std::size_t capacity);
+  [[nodiscard]] bool done() const;
+
+  // day strings ("yyyy-mm-dd") that hold a capture for this symbol, oldest first
+  [[nodiscard]] std::vector<std::string> available_days() const;
+  static std::vector<TickIndexEntry> load_index(const std::string& index_path);
+};
+
+#endif //HISTORYREADER_H
@@ -0,0 +1,46 @@
+#ifndef HISTORYWRITER_H
+#define HISTORYWRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TickRecord.h"
+
+struct CoinData;
+
+// Appends trades to per-symbol day files and maintains the sparse block index as it goes.
+// Single writer: call append() from the thread that feeds CoinManager.
+class HistoryWriter {
+private:
+  struct SymbolFile {
+    std::string day;
+    std::int64_t day_number = -1;
+    std::FILE* ticks = nullptr;
+    std::FILE* index = nullptr;
+    std::uint64_t record_count = 0;
+    std::vector<char> buffer;
+  };
+
+  std::string directory_;
+  std::unordered_map<std::string, std::unique_ptr<SymbolFile>> files_;
+
+  bool open_day(const std::string& symbol, SymbolFile& file, const std::string& day);
+  void close_file(SymbolFile& file);
+
+public:
+  explicit HistoryWriter(const std::string& directory = "../history/");
+  ~HistoryWriter();
+
+  HistoryWriter(const HistoryWriter&) = delete;
+  HistoryWriter& operator=(const HistoryWriter&) = delete;
+
+  bool append(const CoinData& data);
+  bool append(const std::string& symbol, const TickRecord& record);
+  void flush();
+  [[nodiscard]] const std::string& directory() const;
+};
+
+#endif //HISTORYWRITER_H
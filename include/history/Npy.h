@@ -0,0 +1,31 @@
+#ifndef NPY_H
+#define NPY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace npy {
+  // NPY v1.0 header for a 1-D little-endian array of count elements. descr is the dtype as NumPy prints it, a
+  // quoted type ('<f8') or a structured list ([('time_ms', '<i8'), ...]). The header is padded with spaces so
+  // the data starts 64-byte aligned, and to at least min_size bytes: a header written for the largest count
+  // before the data can then be rewritten in place once the real count is known.
+  inline std::string header(const std::string& descr, std::size_t count, std::size_t min_size = 0) {
+    std::string dict = "{'descr': " + descr + ", 'fortran_order': False, 'shape': (" + std::to_string(count) + ",), }";
+    const std::size_t total = 10 + dict.size() + 1;
+    std::size_t padded = (total + 63) / 64 * 64;
+    if (padded < min_size) {
+      padded = min_size;
+    }
+    dict.append(padded - total, ' ');
+    dict.push_back('\n');
+
+    std::string out("\x93NUMPY\x01\x00", 8);
+    const auto length = static_cast<std::uint16_t>(dict.size());
+    out.push_back(static_cast<char>(length & 0xff));
+    out.push_back(static_cast<char>(length >> 8));
+    return out + dict;
+  }
+}
+
+#endif //NPY_H
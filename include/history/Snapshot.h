@@ -0,0 +1,25 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../common/Coin.h"
+
+// Compact binary checkpoint of Coin and indicator state:
+//   header  {magic "SNAP", version, coin count, created (ms since epoch)}
+//   per coin {symbol length, symbol bytes, price, trade id, quantity, trade time, window count, window prices,
+//             series count, per series {resolution, has current, current bar, closed count, closed bars oldest first}}
+// with a bar as {open time, open, high, low, close, volume, trade count}. Only SNAPSHOT_VERSION files load.
+// Files are written next to the target, synced, and renamed into place (the directory synced after), so a crash
+// leaves either the previous snapshot or the new one, never a torn one.
+
+#define SNAPSHOT_MAGIC 0x50414e53u // "SNAP"
+#define SNAPSHOT_VERSION 2u
+
+namespace snapshot {
+  bool save(const std::string& path, const std::vector<CoinSnapshot>& coins, std::int64_t created_ms);
+  bool load(const std::string& path, std::vector<CoinSnapshot>& coins);
+}
+
+#endif //SNAPSHOT_H
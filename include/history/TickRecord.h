@@ -0,0 +1,52 @@
+#ifndef TICKRECORD_H
+#define TICKRECORD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk layout of captured trades. Files live under <dir>/<yyyy-mm-dd>/<symbol>.ticks and hold a
+// TickFileHeader followed by densely packed TickRecords, so a day file can be memory-mapped directly.
+// The matching <symbol>.idx file holds a TickFileHeader followed by one TickIndexEntry per block.
+
+#define TICK_FILE_MAGIC 0x4b434954u  // "TICK"
+#define TICK_INDEX_MAGIC 0x58444954u // "TIDX"
+#define TICK_FILE_VERSION 1u
+#define TICK_INDEX_BLOCK_RECORDS 1024
+
+struct TickFileHeader {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint32_t block_records;
+};
+
+struct TickRecord {
+  std::int64_t trade_time; // ms since epoch (Binance "T")
+  std::int64_t trade_id;
+  double price;
+  double quantity;
+};
+
+struct TickIndexEntry {
+  std::int64_t first_trade_time;
+  std::int64_t first_trade_id;
+  std::uint64_t offset; // byte offset of the block's first record in the .ticks file
+};
+
+static_assert(sizeof(TickFileHeader) == 16);
+static_assert(sizeof(TickRecord) == 32);
+static_assert(sizeof(TickIndexEntry) == 24);
+
+namespace tick_files {
+  constexpr std::int64_t MS_PER_DAY = 86400000;
+
+  // "yyyy-mm-dd" (UTC) for the day containing the given epoch milliseconds
+  std::string day_string(std::int64_t epoch_ms);
+  std::string ticks_path(const std::string& directory, const std::string& day, const std::string& symbol);
+  std::string index_path(const std::string& directory, const std::string& day, const std::string& symbol);
+  // every symbol with a .ticks file on any day under directory, sorted
+  std::vector<std::string> captured_symbols(const std::string& directory);
+}
+
+#endif //TICKRECORD_H
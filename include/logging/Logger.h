@@ -6,10 +6,14 @@
 
 enum TYPE{info, warning, error};
 
+class Counter;
+
 class Logger {
 private:
   std::string directory;
-  Logger(const std::string& dir = "../logs/"): directory(dir) {}
+  Counter* lines_[error + 1];   // log_lines_total per level, looked up once
+  Counter* write_failures_;
+  Logger(const std::string& dir = "../logs/");
 
 public:
   Logger(const Logger& obj) = delete;
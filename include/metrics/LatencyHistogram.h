@@ -0,0 +1,71 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// HDR-style log-linear histogram of nanosecond values: exact below 256 ns, then 128 sub-buckets per
+// power of two (< 0.8% relative error) up to ~2^41 ns. Recording is a handful of instructions.
+// Single writer: record() must only be called from the owning thread, while any thread may read.
+#define LATENCY_LINEAR_BITS 8
+#define LATENCY_MAX_EXPONENT 41
+
+class LatencyHistogram {
+public:
+  static constexpr std::size_t LINEAR_COUNT = std::size_t{1} << LATENCY_LINEAR_BITS;
+  static constexpr std::size_t SUB_BUCKETS = LINEAR_COUNT / 2;
+  static constexpr std::size_t BUCKET_COUNT =
+      LINEAR_COUNT + (LATENCY_MAX_EXPONENT - LATENCY_LINEAR_BITS) * SUB_BUCKETS;
+  static constexpr std::uint64_t MAX_VALUE = (std::uint64_t{1} << LATENCY_MAX_EXPONENT) - 1;
+
+private:
+  std::atomic<std::uint64_t> counts_[BUCKET_COUNT];
+  std::atomic<std::uint64_t> total_;
+  std::atomic<std::uint64_t> max_;
+
+  // single writer, so a relaxed load + store is enough and avoids a locked read-modify-write
+  static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+  }
+
+public:
+  LatencyHistogram();
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  static std::size_t bucket_index(std::uint64_t value) {
+    if (value < LINEAR_COUNT) {
+      return static_cast<std::size_t>(value);
+    }
+    if (value > MAX_VALUE) {
+      value = MAX_VALUE;
+    }
+    unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+    unsigned shift = msb - (LATENCY_LINEAR_BITS - 1);
+    auto mantissa = static_cast<std::size_t>(value >> shift); // in [SUB_BUCKETS, LINEAR_COUNT)
+    return LINEAR_COUNT + (shift - 1) * SUB_BUCKETS + (mantissa - SUB_BUCKETS);
+  }
+  // largest value that lands in the bucket
+  static std::uint64_t bucket_upper(std::size_t index);
+
+  void record(std::int64_t value_ns) {
+    auto value = static_cast<std::uint64_t>(value_ns < 0 ? 0 : value_ns);
+    bump(counts_[bucket_index(value)]);
+    bump(total_);
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  // adds another histogram's counts into this one (this one must not be concurrently recorded into)
+  void add(const LatencyHistogram& other);
+  void reset();
+
+  [[nodiscard]] std::uint64_t count() const;
+  [[nodiscard]] std::uint64_t max() const;
+  // value at or below which the given percentage (0-100) of samples fall
+  [[nodiscard]] std::uint64_t percentile(double percent) const;
+};
+
+#endif //LATENCYHISTOGRAM_H
@@ -0,0 +1,110 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../common/Clock.h"
+#include "LatencyHistogram.h"
+
+#define LATENCY_TRACKER LatencyTracker::getInstance()
+
+// Points each market data message is stamped at on its way through the pipeline.
+// exchange_time_ms is Binance's event time; the *_tick stamps are raw Clock::ticks() readings,
+// only converted to nanoseconds when the message is recorded.
+struct MessageStamps {
+  long exchange_time_ms;
+  std::uint64_t receive_tick;
+  std::uint64_t parse_tick;
+  std::uint64_t apply_tick;
+  std::uint64_t render_tick;
+};
+
+enum LatencyStage {
+  EXCHANGE_TO_RECEIVE,
+  RECEIVE_TO_PARSE,
+  PARSE_TO_APPLY,
+  APPLY_TO_RENDER,
+  RECEIVE_TO_RENDER,
+  LATENCY_STAGE_COUNT
+};
+
+enum class LatencyMode {
+  off,
+  sampled, // always-on: stamps one message in sample_every, a counter bump for the rest
+  full     // stamps every message
+};
+
+// Collects stage-to-stage deltas into per-thread histograms. Each recording thread lazily gets its own
+// set, so the hot path never contends; report() merges all of them on the reading side.
+class LatencyTracker {
+private:
+  struct ThreadHistograms {
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+  };
+
+  std::atomic<LatencyMode> mode_;
+  std::atomic<std::uint32_t> sample_mask_;
+  mutable std::mutex registry_mutex_;
+  std::vector<std::unique_ptr<ThreadHistograms>> registry_;
+
+  std::thread reporter_;
+  std::mutex reporter_mutex_;
+  std::condition_variable reporter_cv_;
+  bool reporter_stop_;
+
+  LatencyTracker();
+  ThreadHistograms& local();
+
+public:
+  LatencyTracker(const LatencyTracker&) = delete;
+  LatencyTracker& operator=(const LatencyTracker&) = delete;
+  ~LatencyTracker();
+
+  static LatencyTracker& getInstance() {
+    static LatencyTracker instance;
+    return instance;
+  }
+
+  // sample_every is rounded up to a power of two
+  void set_mode(LatencyMode mode, std::uint32_t sample_every = 64);
+  [[nodiscard]] LatencyMode mode() const;
+
+  // true when the message about to be processed should be stamped
+  bool begin_message() {
+    LatencyMode mode = mode_.load(std::memory_order_relaxed);
+    if (mode == LatencyMode::full) {
+      return true;
+    }
+    if (mode == LatencyMode::off) {
+      return false;
+    }
+    thread_local std::uint32_t counter = 0;
+    return (counter++ & sample_mask_.load(std::memory_order_relaxed)) == 0;
+  }
+
+  void record(const MessageStamps& stamps);
+
+  // merged view over every thread, for reporting and tests
+  void merged(LatencyStage stage, LatencyHistogram& into) const;
+  // one line per stage: count, p50, p99, p99.9 and max in microseconds
+  [[nodiscard]] std::string report() const;
+  // p50/p99/p99.9 per stage as Prometheus gauges, for MetricsRegistry::add_collector
+  void write_prometheus(std::string& out) const;
+  void reset();
+
+  // periodically hands report() to sink from a background thread
+  void start_reporting(std::chrono::milliseconds interval, std::function<void(const std::string&)> sink);
+  void stop_reporting();
+
+  static const char* stage_name(LatencyStage stage);
+};
+
+#endif //LATENCYTRACKER_H
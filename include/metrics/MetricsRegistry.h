@@ -0,0 +1,82 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define METRICS MetricsRegistry::getInstance()
+
+// Monotonic count. Updates are a relaxed atomic add, so any thread may bump it and scrapes never block it.
+class Counter {
+private:
+  std::atomic<std::uint64_t> value_{0};
+
+public:
+  void inc(std::uint64_t by = 1) { value_.fetch_add(by, std::memory_order_relaxed); }
+  [[nodiscard]] std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// Point-in-time value that can go up and down.
+class Gauge {
+private:
+  std::atomic<double> value_{0.0};
+
+public:
+  void set(double value) { value_.store(value, std::memory_order_relaxed); }
+  void add(double by) {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + by, std::memory_order_relaxed)) {}
+  }
+  [[nodiscard]] double value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// Named counters and gauges rendered in the Prometheus text exposition format.
+// Components look their metrics up once (counter()/gauge() take a lock) and keep the reference; the
+// reference stays valid for the life of the process, so the hot path only ever touches the atomic.
+// labels is the preformatted inside of the braces, e.g. symbol="btcusdt".
+class MetricsRegistry {
+private:
+  enum class Type { counter, gauge };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>> counters; // by labels
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+  std::vector<std::function<void(std::string&)>> collectors_;
+
+  MetricsRegistry() = default;
+  Family& family(const std::string& name, const std::string& help, Type type);
+
+public:
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  static MetricsRegistry& getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+  }
+
+  Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+  Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+  // for values kept elsewhere (e.g. latency percentiles); the callback appends exposition text at scrape time,
+  // without the registry lock held
+  void add_collector(std::function<void(std::string&)> collector);
+
+  [[nodiscard]] std::string render() const;
+
+  static std::string label(const std::string& key, const std::string& value);
+};
+
+#endif //METRICSREGISTRY_H
@@ -0,0 +1,100 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define PERF_PROFILER PerfProfiler::getInstance()
+
+// Hardware counter profiling of pipeline stages through perf_event_open (Linux only).
+// Hot-path code marks stages with PERF_SCOPE(stage); the macro only expands to a ScopedPerfCounters when the
+// build is configured with -DENABLE_PERF_COUNTERS=ON, so regular builds carry no trace of it.
+// Scopes nest (update contains indicator) and the numbers of an outer stage include its inner ones.
+// report() may be called from any thread while the stages run; the trader serves it at /perf on the metrics port
+// and prints it once more at exit.
+
+enum PerfStage { PERF_PARSE, PERF_UPDATE, PERF_INDICATOR, PERF_STAGE_COUNT };
+
+enum PerfCounter { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES,
+                   PERF_COUNTER_COUNT };
+
+struct PerfTotals {
+  std::uint64_t calls = 0;
+  std::uint64_t counters[PERF_COUNTER_COUNT] = {};
+};
+
+class PerfProfiler {
+public:
+  // one counter group per thread; totals have a single writer, the reporting thread only reads
+  struct ThreadCounters {
+    int leader_fd;
+    int fds[PERF_COUNTER_COUNT];
+    int slots[PERF_COUNTER_COUNT]; // position of each counter in the group read, -1 if it could not be opened
+    int opened;
+    std::atomic<std::uint64_t> calls[PERF_STAGE_COUNT];
+    std::atomic<std::uint64_t> totals[PERF_STAGE_COUNT][PERF_COUNTER_COUNT];
+    ThreadCounters();
+    ~ThreadCounters();
+  };
+
+private:
+  mutable std::mutex registry_mutex_;
+  std::vector<std::unique_ptr<ThreadCounters>> registry_;
+
+  PerfProfiler() = default;
+
+public:
+  PerfProfiler(const PerfProfiler&) = delete;
+  PerfProfiler& operator=(const PerfProfiler&) = delete;
+
+  static PerfProfiler& getInstance() {
+    static PerfProfiler instance;
+    return instance;
+  }
+
+  struct Reading {
+    std::uint64_t values[PERF_COUNTER_COUNT];
+    bool valid;
+  };
+
+  // counter group of the calling thread, opened on first use
+  ThreadCounters& local();
+  static Reading read(const ThreadCounters& counters);
+  static void accumulate(ThreadCounters& counters, PerfStage stage, const Reading& start, const Reading& end);
+
+  // true if the calling thread could open its counters
+  bool available();
+  [[nodiscard]] PerfTotals totals(PerfStage stage) const;
+  // per stage: calls, and per call cycles, instructions, IPC, L1D/LLC misses and branch misses
+  [[nodiscard]] std::string report() const;
+
+  static const char* stage_name(PerfStage stage);
+};
+
+class ScopedPerfCounters {
+private:
+  PerfStage stage_;
+  PerfProfiler::ThreadCounters& counters_;
+  PerfProfiler::Reading start_;
+
+public:
+  explicit ScopedPerfCounters(PerfStage stage) :
+    stage_(stage), counters_(PERF_PROFILER.local()), start_(PerfProfiler::read(counters_)) {}
+  ~ScopedPerfCounters() { PerfProfiler::accumulate(counters_, stage_, start_, PerfProfiler::read(counters_)); }
+  ScopedPerfCounters(const ScopedPerfCounters&) = delete;
+  ScopedPerfCounters& operator=(const ScopedPerfCounters&) = delete;
+};
+
+#ifdef PERF_COUNTERS_ENABLED
+#define PERF_SCOPE_CONCAT_(a, b) a##b
+#define PERF_SCOPE_NAME_(line) PERF_SCOPE_CONCAT_(perf_scope_, line)
+#define PERF_SCOPE(stage) ScopedPerfCounters PERF_SCOPE_NAME_(__LINE__)(stage)
+#else
+#define PERF_SCOPE(stage) ((void) 0)
+#endif
+
+#endif //PERFCOUNTERS_H
@@ -0,0 +1,122 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../common/Clock.h"
+
+#define TRACER Tracer::getInstance()
+
+#define TRACE_BUFFER_EVENTS (1 << 15) // per thread, must be a power of two
+#define TRACE_FLUSH_INTERVAL_MS 50
+
+// One finished span (or an instant event when end_tick == 0). name must point to a string literal:
+// only the pointer is stored and it is read later by the serializer thread.
+struct TraceEvent {
+  const char* name;
+  std::uint64_t begin_tick;
+  std::uint64_t end_tick;
+};
+
+// Optional span tracing of the pipeline into Chrome trace-event JSON, which chrome://tracing and
+// ui.perfetto.dev both open. Every recording thread owns a single-producer ring buffer, so recording is a
+// couple of stores; a background thread drains the rings every TRACE_FLUSH_INTERVAL_MS and streams the
+// events to disk. When tracing is off a span costs one relaxed load. A full ring drops events and counts
+// them rather than blocking the hot path.
+class Tracer {
+private:
+  struct ThreadBuffer {
+    std::uint32_t tid;
+    std::string name;
+    bool announced = false; // serializer side: thread_name metadata written
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> tail{0};
+    std::atomic<std::uint64_t> dropped{0};
+    // allocated at the thread's first recorded event, so threads that are only named cost no ring;
+    // set under registry_mutex_, which the serializer holds while reading it
+    std::unique_ptr<TraceEvent[]> events;
+  };
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex registry_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> registry_;
+
+  std::mutex output_mutex_;
+  std::FILE* output_;
+  bool first_event_;
+  std::atomic<std::uint64_t> written_;
+
+  std::thread serializer_;
+  std::mutex serializer_mutex_;
+  std::condition_variable serializer_cv_;
+  bool serializer_stop_;
+
+  Tracer();
+  ThreadBuffer& local();
+  void push(const TraceEvent& event);
+  void drain();
+  void write_event(const char* json);
+
+public:
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+  ~Tracer();
+
+  static Tracer& getInstance() {
+    static Tracer instance;
+    return instance;
+  }
+
+  // opens path and starts recording; false if the file cannot be created
+  bool start(const std::string& path);
+  // stops recording, writes out everything still buffered and closes the file
+  void stop();
+  [[nodiscard]] bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // label shown for the calling thread in the viewer
+  void name_thread(const std::string& name);
+
+  void span(const char* name, std::uint64_t begin_tick, std::uint64_t end_tick) {
+    push({name, begin_tick, end_tick});
+  }
+  void instant(const char* name) {
+    if (enabled()) {
+      push({name, Clock::ticks(), 0});
+    }
+  }
+
+  // events written to the current (or last) trace file and events lost to full rings
+  [[nodiscard]] std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+  [[nodiscard]] std::uint64_t dropped() const;
+  // threads that have recorded an event and hold a ring of TRACE_BUFFER_EVENTS
+  [[nodiscard]] std::size_t rings() const;
+};
+
+class ScopedTrace {
+private:
+  const char* name_;
+  std::uint64_t begin_tick_;
+
+public:
+  explicit ScopedTrace(const char* name) : name_(name), begin_tick_(TRACER.enabled() ? Clock::ticks() : 0) {}
+  ~ScopedTrace() {
+    if (begin_tick_ && TRACER.enabled()) {
+      TRACER.span(name_, begin_tick_, Clock::ticks());
+    }
+  }
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+};
+
+#define TRACE_SCOPE_CONCAT_(a, b) a##b
+#define TRACE_SCOPE_NAME_(line) TRACE_SCOPE_CONCAT_(trace_scope_, line)
+#define TRACE_SCOPE(name) ScopedTrace TRACE_SCOPE_NAME_(__LINE__)(name)
+
+#endif //TRACER_H
@@ -0,0 +1,176 @@
+#ifndef FEATUREPIPELINE_H
+#define FEATUREPIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/Coin.h"
+#include "../feed/MarketDataFeed.h"
+
+// Bumped whenever FeatureRow's layout or a feature's meaning changes; stored in every row.
+#define FEATURE_SCHEMA_VERSION 1
+#define FEATURE_RING_CAPACITY (1 << 16) // rows; rounded up to a power of two
+
+#define FEATURE_EMA_FAST_PERIOD 50
+#define FEATURE_EMA_SLOW_PERIOD 200
+#define FEATURE_VOLATILITY_FAST_PERIOD 32 // trades in the EWMA of squared returns
+#define FEATURE_VOLATILITY_SLOW_PERIOD 512
+
+// columns of FeatureRow::values; FEATURE_NAMES gives the field names in exported files
+enum Feature : unsigned {
+  FEATURE_LOG_RETURN,        // ln(price / previous price), tick to tick (bar to bar for bar rows)
+  FEATURE_RETURN_1S,         // ln(price / close of the last closed 1 s bar)
+  FEATURE_RETURN_1M,         // ln(price / close of the last closed 1 min bar)
+  FEATURE_MA_DISTANCE,       // price / Coin moving average - 1
+  FEATURE_EMA_FAST_DISTANCE, // price / EMA(FEATURE_EMA_FAST_PERIOD) - 1
+  FEATURE_EMA_SLOW_DISTANCE, // price / EMA(FEATURE_EMA_SLOW_PERIOD) - 1
+  FEATURE_VOLATILITY_FAST,   // EWMA standard deviation of tick log returns
+  FEATURE_VOLATILITY_SLOW,
+  FEATURE_SPREAD_BPS,        // (ask - bid) / mid of the last quote, 0 without one
+  FEATURE_BOOK_IMBALANCE,    // (bid size - ask size) / (bid size + ask size) of the last quote
+  FEATURE_TRADE_QUANTITY,    // of the trade (bar volume for bar rows)
+  FEATURE_VOLUME_1M,         // traded so far in the current 1 min bar
+  FEATURE_TRADE_INTERVAL_MS, // since the previous trade (the resolution for bar rows)
+  FEATURE_COUNT
+};
+
+extern const char* const FEATURE_NAMES[FEATURE_COUNT];
+
+// row flags
+#define FEATURE_FLAG_WARM 1u  // moving average full and a 1 min bar closed: every feature is meaningful
+#define FEATURE_FLAG_QUOTE 2u // spread and imbalance come from a quote
+#define FEATURE_FLAG_BAR 4u   // emitted at a bar close rather than on a trade
+
+// One fixed-schema row, laid out exactly as the NumPy structured dtype returned by numpy_descr(), so rows
+// go to disk, shared memory or Python as raw bytes with no conversion.
+struct alignas(64) FeatureRow {
+  std::int64_t time_ms;         // trade time, or bar close time for bar rows
+  std::uint32_t symbol;         // FeaturePipeline symbol index
+  std::uint16_t schema_version; // FEATURE_SCHEMA_VERSION
+  std::uint16_t flags;          // FEATURE_FLAG_*
+  double price;                 // trade price or bar close, kept for labelling
+  double values[FEATURE_COUNT]; // indexed by Feature
+};
+
+// no padding anywhere, so the dtype is just the fields in order
+static_assert(offsetof(FeatureRow, values) == 24 && sizeof(FeatureRow) == 24 + sizeof(double) * FEATURE_COUNT);
+static_assert(sizeof(FeatureRow) == 128);
+
+// Builds a FeatureRow per trade (and optionally per bar close) for every symbol it is subscribed to, from
+// the Coin's price, moving average and bars plus a little incremental state of its own (EMAs, EWMA
+// volatility, the last quote), all O(1) per update with no strings or maps touched after the symbol lookup.
+// Rows are computed straight into a preallocated, cache-line aligned ring, which is also the streaming
+// interface: a consumer thread reads rows in place through consume() and releases them when it returns,
+// so nothing is copied between producer and consumer. The producer never waits; when the consumer falls
+// a full ring behind, new rows are dropped and counted. The export streams the ring into a .npy file whose
+// structured dtype names every column, loadable with np.load(path) (or mmap_mode="r"), with the symbol of
+// each index in <name>_symbols.txt beside it, one per line in index order.
+// One producer (the StrategyEngine thread) and one consumer; the symbol table can be read from any thread.
+class FeaturePipeline {
+private:
+  struct alignas(64) SymbolState {
+    double last_price = 0.0;
+    long last_time = 0;
+    double ema_fast = 0.0;
+    double ema_slow = 0.0;
+    double variance_fast = 0.0;
+    double variance_slow = 0.0;
+    double bid = 0.0;
+    double ask = 0.0;
+    double bid_quantity = 0.0;
+    double ask_quantity = 0.0;
+    double last_bar_close = 0.0;
+  };
+
+  std::unique_ptr<FeatureRow[]> ring_;
+  std::size_t capacity_;
+  long bar_resolution_ms_;
+  alignas(64) std::atomic<std::uint64_t> head_; // next row the producer writes
+  alignas(64) std::atomic<std::uint64_t> tail_; // next row the consumer reads
+  std::atomic<std::uint64_t> dropped_;
+
+  // the producer looks symbols up without it, being the only thread that inserts
+  mutable std::mutex symbols_mutex_;
+  std::unordered_map<std::string, std::uint32_t> index_;
+  std::vector<std::string> symbols_;
+  std::vector<SymbolState> state_; // producer only
+
+  std::FILE* export_file_;
+  std::string export_path_;
+  std::size_t export_header_size_;
+  std::uint64_t exported_;
+  bool export_failed_;
+
+  // slot for the next row, or nullptr when the ring is full
+  FeatureRow* claim();
+  void fill(FeatureRow& row, const SymbolState& state, const Coin& coin, double price) const;
+
+public:
+  // bar_resolution_ms: bar closes of this resolution emit rows when subscribed to EVENT_BAR_CLOSE
+  explicit FeaturePipeline(std::size_t capacity = FEATURE_RING_CAPACITY, long bar_resolution_ms = 60000);
+  ~FeaturePipeline();
+  FeaturePipeline(const FeaturePipeline&) = delete;
+  FeaturePipeline& operator=(const FeaturePipeline&) = delete;
+
+  // producer thread
+  std::uint32_t add_symbol(const std::string& symbol);
+  // any thread
+  [[nodiscard]] std::uint32_t index_of(const std::string& symbol) const;
+  [[nodiscard]] std::string symbol(std::uint32_t index) const;
+  [[nodiscard]] std::size_t size() const;
+
+  // StrategyEngine handlers (EVENT_TRADE, EVENT_BAR_CLOSE, EVENT_QUOTE); symbols are added on first sight
+  void on_trade(const Coin& coin, const CoinData& trade);
+  void on_bar_close(const Coin& coin, long resolution_ms, const Bar& bar);
+  // top of the book for the spread and imbalance features; emits no row
+  void on_quote(const Coin& coin, const Quote& quote);
+
+  // consumer thread: hands the rows available now to consumer(const FeatureRow* rows, std::size_t count),
+  // in at most two contiguous runs (the ring wraps), then releases them; returns the rows consumed
+  template<typename Consumer>
+  std::size_t consume(Consumer&& consumer, std::size_t max_rows = SIZE_MAX) {
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    const std::size_t count = std::min<std::uint64_t>(head - tail, max_rows);
+    const std::size_t start = tail & (capacity_ - 1);
+    const std::size_t first = std::min(count, capacity_ - start);
+    if (first) {
+      consumer(static_cast<const FeatureRow*>(&ring_[start]), first);
+    }
+    if (count > first) {
+      consumer(static_cast<const FeatureRow*>(&ring_[0]), count - first);
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+  // Consumer thread: streams rows into a .npy file for as long as the pipeline runs, so an export is not
+  // limited to what the ring holds. begin_export() writes a header sized for any row count, export_pending()
+  // appends the rows available now and has to be called often enough that the ring does not fill, and
+  // finish_export() appends the rest, puts the final count in the header and writes the symbol table.
+  // finish_export() returns the rows written, 0 on failure.
+  bool begin_export(const std::string& path);
+  std::size_t export_pending();
+  std::size_t finish_export();
+  // consumer thread: all three at once, for the rows available now
+  std::size_t export_npy(const std::string& path);
+
+  [[nodiscard]] std::size_t pending() const;
+  [[nodiscard]] std::uint64_t produced() const { return head_.load(std::memory_order_relaxed); }
+  [[nodiscard]] std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  // NumPy dtype of FeatureRow, e.g. [('time_ms', '<i8'), ..., ('log_return', '<f8'), ...]
+  static std::string numpy_descr();
+  // a complete .npy file of the given rows; false when the file cannot be written
+  static bool write_npy(const std::string& path, const FeatureRow* rows, std::size_t count);
+  // <name>_symbols.txt for <name>.npy
+  static std::string symbols_path(const std::string& npy_path);
+};
+
+#endif //FEATUREPIPELINE_H
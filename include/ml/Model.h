@@ -0,0 +1,94 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "FeaturePipeline.h"
+
+#define MODEL_MAX_TREE_DEPTH 32
+#define MODEL_BATCH_LANES 8 // trees walked together for one row, or rows through one tree by predict_batch()
+
+enum class ModelKind : std::uint8_t { linear, forest, boosted };
+// applied to the raw score: logistic turns a linear model into logistic regression, a boosted one into a classifier
+enum class ModelLink : std::uint8_t { identity, logistic };
+
+// A regression or classification model exported from Python, evaluated in-process on FeatureRows so the tick path
+// does not wait on a round trip to a model service. Models are small text files, one directive per line, '#'
+// starts a comment:
+//
+//   model linear|forest|boosted
+//   link identity|logistic        optional, identity by default
+//   features <name> ...           FEATURE_NAMES columns the model reads, in the order the model refers to them
+//   intercept <value>             linear bias, or the base score added to a forest's mean / the sum of boosted trees
+//   weights <value> ...           linear: one per feature
+//   tree <nodes>                  forest / boosted: followed by one line per node, the root first:
+//     split <feature> <threshold> <left> <right>    feature is a position in the features line, children are node
+//     leaf <value>                                  numbers within the tree; a row goes right when value > threshold
+//
+// The split convention is scikit-learn's (left on <=); XGBoost splits left on <, so its exporter should write
+// nextafter(threshold, -inf). A NaN feature goes left.
+//
+// Linear weights are kept dense over FeatureRow::values, so a prediction is one fixed-length dot product that the
+// compiler vectorises. Trees are flattened into one node array, breadth-first with the two children of a split next
+// to each other: a step is `node = left + (value > threshold)`, with no branch on the comparison. Leaves point at
+// themselves with an infinite threshold, so trees are walked for a fixed depth without testing for leaves. That lets
+// predict() walk MODEL_BATCH_LANES trees side by side and predict_batch() as many rows through each tree, so the
+// chains of dependent loads overlap instead of running one after another.
+// Immutable once loaded: any number of threads may predict concurrently.
+class Model {
+private:
+  struct TreeNode {
+    double threshold;
+    std::uint32_t column; // FeatureRow::values index
+    std::uint32_t left;   // right child at left + 1; a leaf's own index
+  };
+
+  struct ParsedNode {
+    bool leaf;
+    std::uint32_t feature;
+    double threshold;
+    std::uint32_t left;
+    std::uint32_t right;
+    double value;
+  };
+
+  ModelKind kind_;
+  ModelLink link_;
+  std::vector<std::uint32_t> columns_; // per model feature
+  double intercept_;
+  alignas(64) double weights_[FEATURE_COUNT];
+  std::vector<TreeNode> nodes_;
+  std::vector<double> leaf_values_; // by node, 0 for splits
+  std::vector<std::uint32_t> roots_;
+  std::vector<std::uint32_t> depths_;
+  double tree_scale_; // 1 / trees for a forest's mean
+
+  bool add_tree(const std::vector<ParsedNode>& tree);
+  [[nodiscard]] double linear_score(const double* values) const;
+  [[nodiscard]] double tree_score(const double* values) const;
+  [[nodiscard]] double apply_link(double score) const;
+
+public:
+  Model();
+
+  // false with a message on the first malformed line; the model is left empty then
+  bool load(const std::string& path);
+  bool load(std::istream& in);
+
+  // values: a FeatureRow::values array
+  [[nodiscard]] double predict(const double* values) const;
+  [[nodiscard]] double predict(const FeatureRow& row) const { return predict(row.values); }
+  // one prediction per row into out, the same values as predict()
+  void predict_batch(const FeatureRow* rows, std::size_t count, double* out) const;
+
+  [[nodiscard]] ModelKind kind() const { return kind_; }
+  [[nodiscard]] ModelLink link() const { return link_; }
+  [[nodiscard]] std::size_t feature_count() const { return columns_.size(); }
+  [[nodiscard]] std::size_t tree_count() const { return roots_.size(); }
+  [[nodiscard]] std::size_t node_count() const { return nodes_.size(); }
+};
+
+#endif //MODEL_H
@@ -0,0 +1,54 @@
+#ifndef MODELSCORER_H
+#define MODELSCORER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "FeaturePipeline.h"
+#include "Model.h"
+#include "../metrics/LatencyHistogram.h"
+
+#define MODEL_SCORER_DEFAULT_MAX_SYMBOLS 1024
+
+// Runs a Model over a FeaturePipeline's rows on the tick path. Subscribed to the StrategyEngine after the pipeline
+// (EVENT_TRADE, and EVENT_BAR_CLOSE if the pipeline emits bar rows), it is the pipeline's consumer: each event
+// drains the rows waiting in the ring and scores them with one predict_batch() call, so rows from several symbols
+// that arrived together are batched. The latest prediction per symbol is kept, and the time per prediction is
+// recorded. Engine thread only, apart from prediction(), scored() and latency(), which any thread may read.
+class ModelScorer {
+private:
+  FeaturePipeline& pipeline_;
+  const Model& model_;
+  std::vector<double> batch_;
+  // by pipeline symbol index, allocated up front so the engine thread never moves them under a reader
+  std::size_t max_symbols_;
+  std::unique_ptr<std::atomic<double>[]> predictions_;
+  LatencyHistogram latency_;
+  std::atomic<std::uint64_t> scored_; // single writer
+  std::function<void(const FeatureRow&, double)> prediction_handler_;
+
+  void score_rows(const FeatureRow* rows, std::size_t count);
+
+public:
+  // rows of symbol indices from max_symbols on are scored, but their latest prediction is not kept
+  ModelScorer(FeaturePipeline& pipeline, const Model& model,
+              std::size_t max_symbols = MODEL_SCORER_DEFAULT_MAX_SYMBOLS);
+
+  // called with every row and its prediction, in order
+  void set_prediction_handler(std::function<void(const FeatureRow&, double)> handler);
+
+  void on_trade(const Coin&, const CoinData&) { score(); }
+  void on_bar_close(const Coin&, long, const Bar&) { score(); }
+  // scores every row waiting in the pipeline; returns how many
+  std::size_t score();
+
+  // latest prediction for the pipeline's symbol index, NaN before its first row
+  [[nodiscard]] double prediction(std::uint32_t symbol) const;
+  [[nodiscard]] std::uint64_t scored() const { return scored_.load(std::memory_order_relaxed); }
+  // nanoseconds per prediction, a batch's time shared evenly between its rows
+  [[nodiscard]] const LatencyHistogram& latency() const { return latency_; }
+};
+
+#endif //MODELSCORER_H
@@ -0,0 +1,40 @@
+#ifndef HMACSHA256_H
+#define HMACSHA256_H
+
+#include <cstddef>
+#include <string>
+
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+#define HMAC_SHA256_HEX_SIZE 64
+
+// HMAC-SHA256 with the key schedule computed once. The constructor hashes key ^ ipad and key ^ opad into
+// two SHA-256 states; sign() copies those states instead of re-deriving them, so a signature costs the
+// message blocks plus two finalisations. with_prefix() goes one step further for request templates: it
+// returns a signer whose inner state has already absorbed the constant start of every message.
+// Not thread-safe: sign() reuses scratch contexts, keep one instance per thread (or per template).
+class HmacSha256 {
+private:
+  EVP_MD_CTX* inner_;
+  EVP_MD_CTX* outer_;
+  EVP_MD_CTX* scratch_;
+
+  HmacSha256();
+
+public:
+  explicit HmacSha256(const std::string& key);
+  ~HmacSha256();
+  HmacSha256(const HmacSha256&) = delete;
+  HmacSha256& operator=(const HmacSha256&) = delete;
+  HmacSha256(HmacSha256&& other) noexcept;
+  HmacSha256& operator=(HmacSha256&& other) noexcept;
+
+  // a signer for messages that all start with prefix; sign() is then given only the rest
+  [[nodiscard]] HmacSha256 with_prefix(const char* prefix, std::size_t size) const;
+
+  // writes the 32-byte MAC of (prefix +) data as 64 lower-case hex characters, no terminator
+  void sign(const char* data, std::size_t size, char* hex_out);
+  std::string sign(const std::string& data);
+};
+
+#endif //HMACSHA256_H
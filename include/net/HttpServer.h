@@ -0,0 +1,78 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define HTTP_MAX_REQUEST_SIZE (1024 * 1024)
+#define HTTP_POLL_INTERVAL_MS 100
+
+struct HttpRequest {
+  std::string method;
+  std::string path;  // without the query string
+  std::string query; // after '?', not decoded
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+
+  // case-insensitive header lookup, "" when absent
+  [[nodiscard]] std::string header(const std::string& name) const;
+  // decoded value of a query parameter, or of a field in an application/x-www-form-urlencoded body;
+  // "" when absent
+  [[nodiscard]] std::string param(const std::string& name) const;
+};
+
+struct HttpResponse {
+  int status = 200;
+  std::string content_type = "text/plain; charset=utf-8";
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+// Minimal HTTP/1.1 server for local tooling: the metrics endpoint and test stand-ins.
+// One background thread multiplexes every connection with poll(), so handlers run one at a time on that
+// thread and never on the caller's. Connections are kept alive unless the client asks otherwise.
+// Not meant to face the internet: binds to loopback by default and has no TLS.
+class HttpServer {
+private:
+  struct Connection {
+    int fd;
+    std::string input;
+  };
+
+  std::string address_;
+  std::uint16_t port_;
+  int listen_fd_;
+  std::map<std::pair<std::string, std::string>, HttpHandler> routes_; // (method, path)
+  std::atomic<bool> running_;
+  std::thread thread_;
+
+  void run();
+  // consumes complete requests from connection.input; false when the connection should be closed
+  bool serve(Connection& connection);
+  HttpResponse dispatch(const HttpRequest& request) const;
+
+public:
+  // port 0 picks a free ephemeral port, see port() after start()
+  explicit HttpServer(std::uint16_t port = 0, const std::string& address = "127.0.0.1");
+  ~HttpServer();
+  HttpServer(const HttpServer&) = delete;
+  HttpServer& operator=(const HttpServer&) = delete;
+
+  // routes must be registered before start()
+  void route(const std::string& method, const std::string& path, HttpHandler handler);
+  bool start();
+  void stop();
+  [[nodiscard]] std::uint16_t port() const { return port_; }
+
+  static const char* status_text(int status);
+};
+
+#endif //HTTPSERVER_H
@@ -0,0 +1,45 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Client-side mirror of Binance's rate limits: fixed windows aligned to the epoch (a 1-minute window resets
+// on the minute, as the exchange counts), each capping either request weight or order count. A request is
+// admitted only if every window has room for it, so we stop ourselves instead of collecting 429s and
+// IP bans. sync() adopts the exchange's own counters from the X-MBX-USED-WEIGHT-* / X-MBX-ORDER-COUNT-*
+// response headers, which also covers weight spent by other processes on the same key or IP.
+enum class RateLimitKind { request_weight, orders };
+
+class RateLimiter {
+private:
+  struct Window {
+    RateLimitKind kind;
+    std::int64_t interval_ms;
+    std::uint32_t limit;
+    std::int64_t start_ms;
+    std::uint32_t used;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Window> windows_;
+
+  static void roll(Window& window, std::int64_t now_ms);
+
+public:
+  void add_limit(RateLimitKind kind, std::int64_t interval_ms, std::uint32_t limit);
+
+  // takes weight from every request-weight window and orders from every order window, or nothing at all
+  bool try_acquire(std::uint32_t weight, std::uint32_t orders, std::int64_t now_ms);
+  // the exchange reports used units for the window of this kind and interval
+  void sync(RateLimitKind kind, std::int64_t interval_ms, std::uint32_t used, std::int64_t now_ms);
+  // smallest headroom left across windows of this kind
+  [[nodiscard]] std::uint32_t remaining(RateLimitKind kind, std::int64_t now_ms) const;
+
+  // interval of a header suffix such as "1M", "10S" or "1D"; 0 if unrecognised
+  static std::int64_t parse_interval(const std::string& suffix);
+};
+
+#endif //RATELIMITER_H
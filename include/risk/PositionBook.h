@@ -0,0 +1,108 @@
+#ifndef POSITIONBOOK_H
+#define POSITIONBOOK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/Coin.h"
+#include "../exchange/OrderTypes.h"
+
+#define POSITION_BOOK_DEFAULT_MAX_SYMBOLS 1024
+
+struct PositionSnapshot {
+  double position = 0.0;    // signed base quantity
+  double entry_price = 0.0; // average cost of the open position, 0 when flat
+  double last_price = 0.0;  // mark
+  double realized = 0.0;    // closed P&L net of fees
+  double unrealized = 0.0;  // (last_price - entry_price) * position
+  double fees = 0.0;
+  std::uint64_t fills = 0;
+};
+
+struct PortfolioSnapshot {
+  double realized = 0.0;
+  double unrealized = 0.0;
+  double fees = 0.0;
+  double gross_notional = 0.0; // sum of |position| * mark
+  double net_notional = 0.0;   // sum of position * mark
+  std::uint64_t fills = 0;
+  std::uint64_t open_positions = 0;
+
+  [[nodiscard]] double pnl() const { return realized + unrealized; }
+};
+
+// Positions and mark-to-market P&L for every symbol, kept up to date in O(1) per fill and per price update:
+// a fill or a new mark recomputes its own symbol only, and the portfolio totals move by that symbol's
+// change instead of being summed again. Realized P&L uses average cost: adding to a position re-averages
+// the entry, reducing realizes against it, and crossing through flat re-opens at the fill price.
+// One writer (the trading thread) updates; any number of readers (display, risk monitor, metrics scrape)
+// take snapshots without locks. Each symbol and the totals are published under their own sequence
+// counter: the writer bumps it to odd, stores, bumps it to even, and a reader retries if the count moved
+// while it copied. Readers never block the writer, and the writer never waits.
+class PositionBook {
+private:
+  // sequence-counted published copy; fields are relaxed atomics so concurrent reads are well-defined
+  struct alignas(64) Published {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<double> position{0.0};
+    std::atomic<double> entry_price{0.0};
+    std::atomic<double> last_price{0.0};
+    std::atomic<double> realized{0.0};
+    std::atomic<double> unrealized{0.0};
+    std::atomic<double> fees{0.0};
+    std::atomic<std::uint64_t> fills{0};
+  };
+
+  struct alignas(64) Totals {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<double> realized{0.0};
+    std::atomic<double> unrealized{0.0};
+    std::atomic<double> fees{0.0};
+    std::atomic<double> gross_notional{0.0};
+    std::atomic<double> net_notional{0.0};
+    std::atomic<std::uint64_t> fills{0};
+    std::atomic<std::uint64_t> open_positions{0};
+  };
+
+  std::vector<PositionSnapshot> state_; // writer's working copy, one per symbol
+  std::unique_ptr<Published[]> published_;
+  std::size_t capacity_;
+  std::atomic<std::size_t> count_;
+  std::unordered_map<std::string, std::uint32_t> index_;
+  std::vector<std::string> symbols_;
+  PortfolioSnapshot totals_; // writer's working copy
+  Totals published_totals_;
+
+  // moves the totals from a symbol's old state to its new one and publishes both
+  void commit(std::uint32_t index, const PositionSnapshot& before);
+
+public:
+  explicit PositionBook(std::size_t max_symbols = POSITION_BOOK_DEFAULT_MAX_SYMBOLS);
+  PositionBook(const PositionBook&) = delete;
+  PositionBook& operator=(const PositionBook&) = delete;
+
+  // writer thread; returns the index for the index-based calls, UINT32_MAX when the book is full
+  std::uint32_t add_symbol(const std::string& symbol);
+  // writer thread, or any thread once symbols are no longer being added
+  [[nodiscard]] std::uint32_t index_of(const std::string& symbol) const;
+  // any thread, for indices below size()
+  [[nodiscard]] const std::string& symbol(std::uint32_t index) const { return symbols_[index]; }
+  [[nodiscard]] std::size_t size() const { return count_.load(std::memory_order_acquire); }
+
+  // writer thread: an execution of ours (fee in quote currency), or a new mark price
+  void on_fill(std::uint32_t index, OrderSide side, double quantity, double price, double fee = 0.0);
+  void on_price(std::uint32_t index, double price);
+  // StrategyEngine EVENT_TRADE handler, marks the symbol to the trade price
+  void on_trade(const Coin& coin, const CoinData& trade);
+
+  // any thread; false for an index not below size()
+  bool position(std::uint32_t index, PositionSnapshot& out) const;
+  [[nodiscard]] PortfolioSnapshot portfolio() const;
+  // portfolio and per-symbol gauges in Prometheus text format, for a MetricsRegistry collector
+  void write_prometheus(std::string& out) const;
+};
+
+#endif //POSITIONBOOK_H
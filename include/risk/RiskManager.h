@@ -0,0 +1,140 @@
+#ifndef RISKMANAGER_H
+#define RISKMANAGER_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/Coin.h"
+#include "../exchange/OrderTypes.h"
+
+#define RISK_DEFAULT_MAX_SYMBOLS 1024
+
+// reasons an order is refused, combinable as a mask; 0 means the order may go out
+enum RiskViolation : unsigned {
+  RISK_OK = 0u,
+  RISK_UNKNOWN_SYMBOL = 1u,
+  RISK_POSITION_LIMIT = 2u,       // |position| after the order above the symbol's max_position
+  RISK_NOTIONAL_LIMIT = 4u,       // |position| * price after the order above the symbol's max_notional
+  RISK_ORDER_NOTIONAL = 8u,       // the order alone is larger than max_order_notional
+  RISK_PRICE_BAND = 16u,          // limit price too far from the last trade
+  RISK_STOP_LOSS = 32u,           // the open position is down more than stop_loss of its entry value
+  RISK_GROSS_LIMIT = 64u,         // sum of |position| * price over all symbols above max_gross_notional
+  RISK_DAILY_LOSS = 128u,         // P&L since reset_day() below -max_daily_loss
+  RISK_HALTED = 256u              // halt() called
+};
+
+struct SymbolRiskLimits {
+  double max_position = std::numeric_limits<double>::infinity();
+  double max_notional = std::numeric_limits<double>::infinity();
+  double max_order_notional = std::numeric_limits<double>::infinity();
+  double max_price_deviation = std::numeric_limits<double>::infinity(); // fraction of the last price
+  double stop_loss = std::numeric_limits<double>::infinity();           // fraction of entry value
+};
+
+struct GlobalRiskLimits {
+  double max_gross_notional = std::numeric_limits<double>::infinity();
+  double max_daily_loss = std::numeric_limits<double>::infinity(); // positive amount in quote currency
+};
+
+// Pre-trade risk checks for the order hot path. Every symbol gets a fixed, cache-line aligned slot in a
+// preallocated array holding its limits next to its position, entry price, cash flow and last price.
+// Fills and price updates adjust that slot and the global running totals (gross notional, P&L) by their
+// difference, so nothing is ever summed over symbols. check() reads one slot plus the totals and evaluates
+// every rule as arithmetic on flags: the same instructions run whether the order passes or not, no loops.
+// Orders that only reduce a position pass every limit except RISK_UNKNOWN_SYMBOL / RISK_PRICE_BAND, so a
+// breached book can always be flattened.
+// Single-threaded: feed fills, prices and checks from the trading thread.
+class RiskManager {
+private:
+  struct alignas(64) Slot {
+    SymbolRiskLimits limits;
+    double position = 0.0;
+    double entry_price = 0.0; // average price of the open position
+    double cash = 0.0;        // sum of signed fill values and fees; P&L = cash + position * last price
+    double last_price = 0.0;
+    double notional = 0.0;    // |position| * last price, as included in gross_notional_
+    double pnl = 0.0;         // as included in total_pnl_
+    double stopped = 0.0;     // 1.0 while the stop-loss is breached
+  };
+
+  std::vector<Slot> slots_; // capacity fixed at construction, never reallocates
+  std::unordered_map<std::string, std::uint32_t> index_;
+  GlobalRiskLimits global_;
+  double gross_notional_ = 0.0;
+  double total_pnl_ = 0.0;
+  double day_start_pnl_ = 0.0;
+  bool halted_ = false;
+
+  static constexpr double SIDE_SIGN[2] = {1.0, -1.0}; // by OrderSide
+
+  void revalue(Slot& slot);
+
+public:
+  explicit RiskManager(std::size_t max_symbols = RISK_DEFAULT_MAX_SYMBOLS);
+
+  // returns the symbol's slot index for the index-based calls, UINT32_MAX when the table is full
+  std::uint32_t add_symbol(const std::string& symbol, const SymbolRiskLimits& limits);
+  [[nodiscard]] std::uint32_t index_of(const std::string& symbol) const;
+  void set_limits(std::uint32_t index, const SymbolRiskLimits& limits);
+  void set_global_limits(const GlobalRiskLimits& limits) { global_ = limits; }
+
+  [[nodiscard]] unsigned check(std::uint32_t index, OrderSide side, double quantity, double price) const {
+    if (index >= slots_.size()) {
+      return RISK_UNKNOWN_SYMBOL;
+    }
+    const Slot& slot = slots_[index];
+    const SymbolRiskLimits& limits = slot.limits;
+    // indexed rather than ?: on the side, which compiles to a branch that mispredicts on mixed order flow
+    const double signed_quantity = quantity * SIDE_SIGN[static_cast<int>(side)];
+    const double before = std::fabs(slot.position);
+    const double after = std::fabs(slot.position + signed_quantity);
+    const unsigned increasing = after > before;
+    const double reference = slot.last_price > 0.0 ? slot.last_price : price;
+    const double gross_after = gross_notional_ + (after - before) * reference;
+
+    unsigned limited = 0;
+    limited |= static_cast<unsigned>(after > limits.max_position) * RISK_POSITION_LIMIT;
+    limited |= static_cast<unsigned>(after * reference > limits.max_notional) * RISK_NOTIONAL_LIMIT;
+    limited |= static_cast<unsigned>(quantity * price > limits.max_order_notional) * RISK_ORDER_NOTIONAL;
+    limited |= static_cast<unsigned>(slot.stopped != 0.0) * RISK_STOP_LOSS;
+    limited |= static_cast<unsigned>(gross_after > global_.max_gross_notional) * RISK_GROSS_LIMIT;
+    limited |= static_cast<unsigned>(total_pnl_ - day_start_pnl_ < -global_.max_daily_loss) * RISK_DAILY_LOSS;
+    limited |= static_cast<unsigned>(halted_) * RISK_HALTED;
+
+    const unsigned band = static_cast<unsigned>(slot.last_price > 0.0 &&
+                                                std::fabs(price - slot.last_price) >
+                                                  limits.max_price_deviation * slot.last_price) *
+                          RISK_PRICE_BAND;
+    return (limited & (0u - increasing)) | band;
+  }
+  [[nodiscard]] unsigned check(const std::string& symbol, OrderSide side, double quantity, double price) const {
+    return check(index_of(symbol), side, quantity, price);
+  }
+
+  // an execution of ours; fee in quote currency
+  void on_fill(std::uint32_t index, OrderSide side, double quantity, double price, double fee = 0.0);
+  void on_price(std::uint32_t index, double price);
+  // StrategyEngine EVENT_TRADE handler, marks the symbol to the trade price
+  void on_trade(const Coin& coin, const CoinData& trade);
+
+  // starts a new trading day for the daily loss limit
+  void reset_day() { day_start_pnl_ = total_pnl_; }
+  // blocks every risk-increasing order until resume()
+  void halt() { halted_ = true; }
+  void resume() { halted_ = false; }
+
+  [[nodiscard]] double position(std::uint32_t index) const { return slots_[index].position; }
+  [[nodiscard]] double entry_price(std::uint32_t index) const { return slots_[index].entry_price; }
+  [[nodiscard]] double pnl(std::uint32_t index) const { return slots_[index].pnl; }
+  [[nodiscard]] double gross_notional() const { return gross_notional_; }
+  [[nodiscard]] double total_pnl() const { return total_pnl_; }
+  [[nodiscard]] double daily_pnl() const { return total_pnl_ - day_start_pnl_; }
+
+  // "position_limit|stop_loss" for logging a check() result
+  static std::string describe(unsigned violations);
+};
+
+#endif //RISKMANAGER_H
@@ -0,0 +1,92 @@
+#ifndef ROLLINGCORRELATION_H
+#define ROLLINGCORRELATION_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/Coin.h"
+
+#define CORRELATION_DEFAULT_MAX_SYMBOLS 512
+
+// Immutable result of one resampling step. Matrices are n x n, row-major, full (both triangles).
+struct CorrelationSnapshot {
+  std::vector<std::string> symbols;
+  std::uint64_t step = 0;   // resampling steps taken so far
+  std::int64_t time_ms = 0; // end of the last interval
+  std::size_t samples = 0;  // returns in the window, at most the window length
+  std::vector<double> mean;       // per-interval log return
+  std::vector<double> volatility; // sample standard deviation of the returns
+  std::vector<double> covariance;
+  std::vector<double> correlation; // 0 where either side has no variance
+
+  [[nodiscard]] std::size_t size() const { return symbols.size(); }
+  [[nodiscard]] double covariance_at(std::size_t i, std::size_t j) const { return covariance[i * size() + j]; }
+  [[nodiscard]] double correlation_at(std::size_t i, std::size_t j) const { return correlation[i * size() + j]; }
+};
+
+// Rolling covariance and correlation of log returns across symbols, on a common resampled clock: the last
+// price seen in each interval_ms interval closes that interval for every symbol at once, and the window
+// holds the last `window` intervals. Instead of recomputing the matrix from the whole window (O(N^2 * W)),
+// each step keeps running sums and cross-products: the new return vector's outer product is added and the
+// one leaving the window subtracted, so a step costs O(N) per symbol in straight row loops the compiler
+// vectorises. The sums are rebuilt from the window once per `window` steps, so rounding cannot accumulate.
+// A symbol with no price yet, or added after the start, contributes zero returns for the steps it missed.
+// One writer (the StrategyEngine thread) steps the clock; after each step the matrices are published as a
+// new snapshot, built off to the side and swapped in, so readers hold a consistent copy for as long as
+// they like without ever stalling the writer for more than a pointer swap.
+class RollingCorrelation {
+private:
+  std::size_t window_;
+  std::int64_t interval_ms_;
+  std::size_t capacity_;
+
+  std::unordered_map<std::string, std::uint32_t> index_;
+  std::vector<std::string> symbols_;
+  std::vector<double> price_;      // last price seen, per symbol
+  std::vector<double> last_close_; // price at the previous step
+  std::int64_t next_close_ms_;     // end of the open interval, 0 before the first price
+  std::uint64_t steps_;
+
+  // returns of the last window_ steps, capacity_ per row, oldest overwritten first
+  std::vector<double> returns_;
+  std::vector<double> sum_;     // per symbol, over the window
+  std::vector<double> cross_;   // upper triangle of sum(r_i * r_j), capacity_ per row
+  std::vector<double> leaving_; // copy of the row being overwritten
+  std::vector<double> inverse_volatility_;
+
+  mutable std::mutex snapshot_mutex_; // guards the pointer only
+  std::shared_ptr<const CorrelationSnapshot> snapshot_;
+  std::shared_ptr<CorrelationSnapshot> spare_; // previous snapshot, reused once readers let go
+
+  void close_interval(std::int64_t close_ms);
+  void rebuild();
+  void publish(std::int64_t close_ms);
+
+public:
+  // window in intervals, e.g. 300 one-second returns
+  explicit RollingCorrelation(std::size_t window, std::int64_t interval_ms = 1000,
+                              std::size_t max_symbols = CORRELATION_DEFAULT_MAX_SYMBOLS);
+  RollingCorrelation(const RollingCorrelation&) = delete;
+  RollingCorrelation& operator=(const RollingCorrelation&) = delete;
+
+  // writer thread; returns the index for on_price, UINT32_MAX when full
+  std::uint32_t add_symbol(const std::string& symbol);
+  [[nodiscard]] std::uint32_t index_of(const std::string& symbol) const;
+  [[nodiscard]] std::size_t size() const { return symbols_.size(); }
+
+  // writer thread: closes every interval that ended at or before time_ms, then records the price
+  void on_price(std::uint32_t index, double price, std::int64_t time_ms);
+  // StrategyEngine EVENT_TRADE handler; trades of symbols not added are ignored
+  void on_trade(const Coin& coin, const CoinData& trade);
+  // writer thread: closes intervals up to time_ms without a new price, for a clock driven by a timer
+  void advance_to(std::int64_t time_ms);
+
+  [[nodiscard]] std::uint64_t steps() const { return steps_; }
+  // any thread; empty (size 0) until the first step
+  [[nodiscard]] std::shared_ptr<const CorrelationSnapshot> snapshot() const;
+};
+
+#endif //ROLLINGCORRELATION_H
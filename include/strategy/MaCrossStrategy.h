@@ -0,0 +1,20 @@
+#ifndef MACROSSSTRATEGY_H
+#define MACROSSSTRATEGY_H
+
+#include "StrategyEngine.h"
+
+// The roadmap's first strategy: buy when the price drops below its moving average, sell when it rises
+// back above. Tracks a single position, so subscribe one instance per symbol; signals alternate buy / sell.
+class MaCrossStrategy {
+private:
+  StrategyEngine& engine_;
+  bool long_;
+
+public:
+  explicit MaCrossStrategy(StrategyEngine& engine);
+
+  void on_ma_cross(const Coin& coin, const MaCross& cross);
+  [[nodiscard]] bool is_long() const;
+};
+
+#endif //MACROSSSTRATEGY_H
@@ -0,0 +1,172 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include "StrategyEngine.h"
+
+// Per-trade indicator / signal pipelines declared as types, e.g.
+//   Pipeline<SMA<512>, EMA<50>, CrossRule<EMA<50>, SMA<512>>>
+// Window sizes are template parameters and every stage is a concrete member of one object, so the
+// compiler sees the whole chain and emits a single fused update() per configuration with no indirect
+// calls. RuntimePipeline (RuntimePipeline.h) is the virtual, configure-at-runtime equivalent.
+
+enum PipelineSignal { SIGNAL_SELL = -1, SIGNAL_NONE = 0, SIGNAL_BUY = 1 };
+
+// Simple moving average over the last N prices in a fixed ring.
+template<std::size_t N>
+class SMA {
+  static_assert(N > 0, "SMA window must not be empty");
+
+private:
+  std::array<double, N> window_{};
+  std::size_t next_ = 0;
+  std::size_t count_ = 0;
+  double sum_ = 0.0;
+
+public:
+  static constexpr std::size_t window_size = N;
+
+  void update(double price) {
+    sum_ += price - window_[next_]; // slots start at 0.0, so this is exact while filling up
+    window_[next_] = price;
+    next_ = next_ + 1 == N ? 0 : next_ + 1;
+    count_ += count_ < N;
+  }
+  [[nodiscard]] double value() const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+  [[nodiscard]] bool ready() const { return count_ == N; }
+};
+
+// Exponential moving average with the usual alpha = 2 / (N + 1), seeded with the first price.
+// Reports ready after N prices, once the seed's weight has decayed.
+template<std::size_t N>
+class EMA {
+  static_assert(N > 0, "EMA period must not be empty");
+
+private:
+  static constexpr double alpha_ = 2.0 / (static_cast<double>(N) + 1.0);
+  double value_ = 0.0;
+  std::size_t count_ = 0;
+
+public:
+  static constexpr std::size_t window_size = N;
+
+  void update(double price) {
+    value_ = count_ ? value_ + alpha_ * (price - value_) : price;
+    count_ += count_ < N;
+  }
+  [[nodiscard]] double value() const { return value_; }
+  [[nodiscard]] bool ready() const { return count_ == N; }
+};
+
+// Trend rule: buy when Fast crosses above Slow, sell when it crosses below.
+// Fast and Slow name indicators that must also appear in the same pipeline.
+template<typename Fast, typename Slow>
+class CrossRule {
+private:
+  int side_ = 0;
+
+public:
+  template<typename P>
+  int evaluate(double, const P& pipeline) {
+    const auto& fast = pipeline.template get<Fast>();
+    const auto& slow = pipeline.template get<Slow>();
+    if (!fast.ready() || !slow.ready()) {
+      return SIGNAL_NONE;
+    }
+    const int side = fast.value() > slow.value() ? 1 : fast.value() < slow.value() ? -1 : side_;
+    const int signal = side_ != 0 && side != side_ ? side : SIGNAL_NONE;
+    side_ = side;
+    return signal;
+  }
+};
+
+// Mean-reversion rule from the roadmap: buy when the price drops below Average, sell when it rises above.
+template<typename Average>
+class PriceCrossRule {
+private:
+  int side_ = 0;
+
+public:
+  template<typename P>
+  int evaluate(double price, const P& pipeline) {
+    const auto& average = pipeline.template get<Average>();
+    if (!average.ready()) {
+      return SIGNAL_NONE;
+    }
+    const int side = price > average.value() ? 1 : price < average.value() ? -1 : side_;
+    const int signal = side_ != 0 && side != side_ ? -side : SIGNAL_NONE;
+    side_ = side;
+    return signal;
+  }
+};
+
+template<typename Stage>
+concept PipelineIndicator = requires(Stage& stage, double price) {
+  stage.update(price);
+  { stage.value() } -> std::convertible_to<double>;
+};
+
+template<typename... Stages>
+class Pipeline {
+private:
+  std::tuple<Stages...> stages_;
+
+  template<typename Stage>
+  static void feed(Stage& stage, double price) {
+    if constexpr (PipelineIndicator<Stage>) {
+      stage.update(price);
+    }
+  }
+
+  template<typename Stage>
+  int evaluate(Stage& stage, double price) {
+    if constexpr (PipelineIndicator<Stage>) {
+      return SIGNAL_NONE;
+    } else {
+      return stage.evaluate(price, *this);
+    }
+  }
+
+public:
+  // feeds one price through every indicator, then every rule; returns the first rule's signal that fired
+  int update(double price) {
+    std::apply([price](auto&... stage) { (feed(stage, price), ...); }, stages_);
+    int signal = SIGNAL_NONE;
+    // every rule runs so each keeps its own state current, even after an earlier one fired
+    std::apply([&](auto&... stage) {
+      ((void) [&](int fired) { signal = signal ? signal : fired; }(evaluate(stage, price)), ...);
+    }, stages_);
+    return signal;
+  }
+
+  template<typename Stage>
+  [[nodiscard]] const Stage& get() const {
+    return std::get<Stage>(stages_);
+  }
+};
+
+// Adapts a pipeline to StrategyEngine: runs it on every trade of the subscribed symbol and emits its signals.
+template<typename P>
+class PipelineStrategy {
+private:
+  StrategyEngine& engine_;
+  const char* name_;
+  P pipeline_;
+
+public:
+  PipelineStrategy(StrategyEngine& engine, const char* name) : engine_(engine), name_(name) {}
+
+  void on_trade(const Coin&, const CoinData& trade) {
+    const int signal = pipeline_.update(trade.price);
+    if (signal != SIGNAL_NONE) {
+      engine_.emit({name_, trade.symbol, signal > 0 ? SignalSide::buy : SignalSide::sell, trade.price,
+                    trade.trade_time});
+    }
+  }
+  [[nodiscard]] const P& pipeline() const { return pipeline_; }
+};
+
+#endif //PIPELINE_H
@@ -0,0 +1,88 @@
+#ifndef RUNTIMEPIPELINE_H
+#define RUNTIMEPIPELINE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Virtual counterpart of Pipeline<...> (Pipeline.h) for configurations only known at runtime, e.g. read
+// from a config file or swept by the optimiser. Same semantics stage for stage; every update pays one
+// virtual call per stage and the window lives on the heap. benchmarks/BenchmarkPipeline.cpp measures the gap.
+
+class Indicator {
+public:
+  virtual ~Indicator() = default;
+  virtual void update(double price) = 0;
+  [[nodiscard]] virtual double value() const = 0;
+  [[nodiscard]] virtual bool ready() const = 0;
+};
+
+class RuntimeSMA : public Indicator {
+private:
+  std::vector<double> window_;
+  std::size_t next_;
+  std::size_t count_;
+  double sum_;
+
+public:
+  explicit RuntimeSMA(std::size_t window_size);
+  void update(double price) override;
+  [[nodiscard]] double value() const override;
+  [[nodiscard]] bool ready() const override;
+};
+
+class RuntimeEMA : public Indicator {
+private:
+  std::size_t period_;
+  double alpha_;
+  double value_;
+  std::size_t count_;
+
+public:
+  explicit RuntimeEMA(std::size_t period);
+  void update(double price) override;
+  [[nodiscard]] double value() const override;
+  [[nodiscard]] bool ready() const override;
+};
+
+class SignalRule {
+public:
+  virtual ~SignalRule() = default;
+  // PipelineSignal value
+  virtual int evaluate(double price) = 0;
+};
+
+class RuntimeCrossRule : public SignalRule {
+private:
+  const Indicator& fast_;
+  const Indicator& slow_;
+  int side_;
+
+public:
+  RuntimeCrossRule(const Indicator& fast, const Indicator& slow);
+  int evaluate(double price) override;
+};
+
+class RuntimePriceCrossRule : public SignalRule {
+private:
+  const Indicator& average_;
+  int side_;
+
+public:
+  explicit RuntimePriceCrossRule(const Indicator& average);
+  int evaluate(double price) override;
+};
+
+class RuntimePipeline {
+private:
+  std::vector<std::unique_ptr<Indicator>> indicators_;
+  std::vector<std::unique_ptr<SignalRule>> rules_;
+
+public:
+  // returns the indicator so rules can be built on it
+  Indicator& add_indicator(std::unique_ptr<Indicator> indicator);
+  void add_rule(std::unique_ptr<SignalRule> rule);
+  int update(double price);
+};
+
+#endif //RUNTIMEPIPELINE_H
@@ -0,0 +1,137 @@
+#ifndef STRATEGYENGINE_H
+#define STRATEGYENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/BarBuilder.h"
+#include "../common/Coin.h"
+#include "../feed/MarketDataFeed.h"
+#include "../metrics/LatencyHistogram.h"
+
+class Counter;
+
+// event types a strategy can subscribe to, combinable as a mask
+enum StrategyEvent : unsigned { EVENT_TRADE = 1u, EVENT_MA_CROSS = 2u, EVENT_BAR_CLOSE = 4u, EVENT_QUOTE = 8u };
+
+enum class CrossDirection { above, below }; // price moved to this side of the moving average
+
+struct MaCross {
+  CrossDirection direction;
+  double price;
+  double average;
+  long trade_time;
+};
+
+enum class SignalSide { buy, sell };
+
+struct Signal {
+  const char* strategy; // string literal naming the emitting strategy
+  std::string symbol;
+  SignalSide side;
+  double price;
+  long trade_time;
+};
+
+using SignalHandler = std::function<void(const Signal&)>;
+
+// Routes market events from CoinManager to the strategies subscribed to that symbol and event type.
+// Subscribers are kept in contiguous per-symbol arrays of {object, function pointer} pairs generated from
+// the strategy's type at subscribe() time, so a dispatch is a loop of direct calls: no virtual interface,
+// no std::function, and symbols nobody subscribed to cost one hash lookup.
+// A strategy type implements any of:
+//   void on_trade(const Coin& coin, const CoinData& trade);
+//   void on_ma_cross(const Coin& coin, const MaCross& cross);
+//   void on_bar_close(const Coin& coin, long resolution_ms, const Bar& bar);
+//   void on_quote(const Coin& coin, const Quote& quote);
+// and may call emit() from inside them. Everything runs under CoinManager's feed lock, on the thread calling
+// CoinManager::update_coin_data / on_quote; subscribe before data starts flowing or from that same thread.
+class StrategyEngine {
+private:
+  template<typename... Args>
+  struct Subscriber {
+    void* strategy;
+    void (*call)(void* strategy, const Coin& coin, Args... args);
+  };
+
+  struct SymbolSubscribers {
+    std::vector<Subscriber<const CoinData&>> trade;
+    std::vector<Subscriber<const MaCross&>> ma_cross;
+    std::vector<Subscriber<long, const Bar&>> bar_close;
+    std::vector<Subscriber<const Quote&>> quote;
+    int ma_side = 0; // +1 above, -1 below, 0 until the average is ready
+  };
+
+  std::unordered_map<std::string, SymbolSubscribers> symbols_;
+  SignalHandler on_signal_;
+  std::uint64_t dispatch_tick_;
+  LatencyHistogram tick_to_signal_;
+  Counter* signals_metric_;
+
+public:
+  StrategyEngine();
+
+  template<typename S>
+  void subscribe(const std::string& symbol, unsigned events, S& strategy) {
+    SymbolSubscribers& subscribers = symbols_[symbol];
+    unsigned handled = 0;
+    if constexpr (requires(S& s, const Coin& c, const CoinData& d) { s.on_trade(c, d); }) {
+      if (events & EVENT_TRADE) {
+        subscribers.trade.push_back({&strategy, [](void* s, const Coin& c, const CoinData& d) {
+                                       static_cast<S*>(s)->on_trade(c, d);
+                                     }});
+        handled |= EVENT_TRADE;
+      }
+    }
+    if constexpr (requires(S& s, const Coin& c, const MaCross& x) { s.on_ma_cross(c, x); }) {
+      if (events & EVENT_MA_CROSS) {
+        subscribers.ma_cross.push_back({&strategy, [](void* s, const Coin& c, const MaCross& x) {
+                                          static_cast<S*>(s)->on_ma_cross(c, x);
+                                        }});
+        handled |= EVENT_MA_CROSS;
+      }
+    }
+    if constexpr (requires(S& s, const Coin& c, const Bar& b) { s.on_bar_close(c, 0L, b); }) {
+      if (events & EVENT_BAR_CLOSE) {
+        subscribers.bar_close.push_back({&strategy, [](void* s, const Coin& c, long r, const Bar& b) {
+                                           static_cast<S*>(s)->on_bar_close(c, r, b);
+                                         }});
+        handled |= EVENT_BAR_CLOSE;
+      }
+    }
+    if constexpr (requires(S& s, const Coin& c, const Quote& q) { s.on_quote(c, q); }) {
+      if (events & EVENT_QUOTE) {
+        subscribers.quote.push_back({&strategy, [](void* s, const Coin& c, const Quote& q) {
+                                       static_cast<S*>(s)->on_quote(c, q);
+                                     }});
+        handled |= EVENT_QUOTE;
+      }
+    }
+    if (handled != events) {
+      std::cerr << "Strategy subscribed to events it has no handler for on " << symbol << std::endl;
+    }
+  }
+  // drops every subscription of this strategy object
+  void unsubscribe(const void* strategy);
+
+  // called by CoinManager after the coin has applied the trade / closed a bar, and for each top-of-book quote
+  void on_trade(const Coin& coin, const CoinData& trade);
+  void on_bar_close(const Coin& coin, long resolution_ms, const Bar& bar);
+  void on_quote(const Coin& coin, const Quote& quote);
+
+  [[nodiscard]] bool wants_bar_close(const std::string& symbol) const;
+
+  void set_signal_handler(SignalHandler handler);
+  // for strategies: forwards the signal and records the time since the triggering trade was dispatched
+  void emit(const Signal& signal);
+
+  // nanoseconds from CoinManager handing over the trade to emit(), one sample per signal
+  [[nodiscard]] const LatencyHistogram& tick_to_signal() const;
+  // Clock ticks at which the event being dispatched was handed over, for latency measured further down
+  [[nodiscard]] std::uint64_t dispatch_tick() const { return dispatch_tick_; }
+};
+
+#endif //STRATEGYENGINE_H
@@ -0,0 +1,82 @@
+#ifndef TRIANGULARARBITRAGE_H
+#define TRIANGULARARBITRAGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StrategyEngine.h"
+#include "../feed/MarketDataFeed.h"
+#include "../metrics/LatencyHistogram.h"
+
+struct ArbitrageOpportunity {
+  std::string path;        // currencies in trading order, e.g. "usdt>btc>eth>usdt"
+  std::string symbols[3];  // pair traded on each leg
+  bool sells_base[3];      // leg sells the pair's base at the bid (else buys it at the ask)
+  double gross_return;     // product of the leg rates - 1
+  double net_return;       // after fee_rate on every leg
+  std::string trigger;     // pair whose update revealed it
+  long trade_time;         // of the triggering trade, 0 for quotes
+  std::int64_t latency_ns; // from the trigger's dispatch to detection
+};
+
+using OpportunityHandler = std::function<void(const ArbitrageOpportunity&)>;
+
+// Scans currency triangles (e.g. usdt -> btc -> eth -> usdt over btcusdt, ethbtc, ethusdt) for round trips
+// that return more than they cost in fees. The currency graph and every 3-cycle through it, in both
+// directions, are built once from the symbol list; each pair keeps the list of cycles it is a leg of, so an
+// update re-evaluates only those cycles rather than the whole graph. Trades price both sides of a pair at
+// the trade; quotes give real bid / ask. An opportunity is reported when a cycle's net return rises above
+// min_net_return and again only after it has fallen back below, not on every tick in between.
+// Runs on the StrategyEngine thread: subscribe it to EVENT_TRADE for every symbol it was built with.
+class TriangularArbitrage {
+private:
+  struct Pair {
+    std::string symbol;
+    std::uint32_t base;
+    std::uint32_t quote;
+    double bid = 0.0;
+    double ask = 0.0;
+    std::vector<std::uint32_t> cycles;
+  };
+
+  struct Cycle {
+    std::uint32_t pairs[3];
+    bool sells_base[3];
+    std::uint32_t start; // currency
+    bool open;           // above the threshold at the last evaluation
+  };
+
+  StrategyEngine& engine_;
+  double fee_factor_; // (1 - fee_rate)^3
+  double min_net_return_;
+  std::vector<std::string> currencies_;
+  std::vector<Pair> pairs_;
+  std::unordered_map<std::string, std::uint32_t> pair_index_;
+  std::vector<Cycle> cycles_;
+  OpportunityHandler on_opportunity_;
+  LatencyHistogram trigger_to_opportunity_;
+  std::atomic<std::uint64_t> evaluations_; // written by the dispatching thread only
+
+  void build_cycles();
+  void evaluate(std::uint32_t pair, std::uint64_t trigger_tick, long trade_time);
+
+public:
+  // symbols are normalized ids; ones whose quote currency is not recognised are left out
+  TriangularArbitrage(StrategyEngine& engine, const std::vector<std::string>& symbols, double fee_rate = 0.001,
+                      double min_net_return = 0.0);
+
+  void on_trade(const Coin& coin, const CoinData& trade);
+  // top of the book, e.g. from a feed or the consolidated book; measured from the call
+  void on_quote(const Quote& quote);
+  void set_opportunity_handler(OpportunityHandler handler);
+
+  [[nodiscard]] std::size_t cycle_count() const { return cycles_.size(); }
+  // cycles evaluated so far, to see how much of the graph each update touches
+  [[nodiscard]] std::uint64_t evaluations() const { return evaluations_.load(std::memory_order_relaxed); }
+  [[nodiscard]] const LatencyHistogram& trigger_to_opportunity() const { return trigger_to_opportunity_; }
+};
+
+#endif //TRIANGULARARBITRAGE_H
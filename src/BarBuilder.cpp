@@ -0,0 +1,134 @@
+#include "../include/common/BarBuilder.h"
+#include <algorithm>
+
+BarBuilder::BarBuilder(const std::vector<long>& resolutions_ms, std::size_t history) {
+  series_.reserve(resolutions_ms.size());
+  for (long resolution : resolutions_ms) {
+    if (resolution <= 0) {
+      continue;
+    }
+    series_.push_back(Series{resolution, Bar{}, false, std::vector<Bar>(std::max<std::size_t>(history, 1)), 0, 0});
+  }
+}
+
+void BarBuilder::update(double price, double quantity, long trade_time) {
+  for (Series& series : series_) {
+    long open_time = trade_time - trade_time % series.resolution_ms;
+
+    if (!series.has_current) {
+      series.current = Bar{open_time, price, price, price, price, 0.0, 0};
+      series.has_current = true;
+    } else if (open_time > series.current.open_time) {
+      roll_to(series, open_time);
+      series.current = Bar{open_time, price, price, price, price, 0.0, 0};
+    }
+    // late trades from an already closed interval are folded into the current bar
+
+    Bar& bar = series.current;
+    bar.high = std::max(bar.high, price);
+    bar.low = std::min(bar.low, price);
+    bar.close = price;
+    bar.volume += quantity;
+    ++bar.trade_count;
+  }
+}
+
+void BarBuilder::roll_to(Series& series, long open_time) {
+  close_bar(series);
+
+  // emit flat bars for the skipped intervals; anything older than the ring would be overwritten anyway
+  long gap = (open_time - series.current.open_time) / series.resolution_ms - 1;
+  long fill = std::min<long>(gap, static_cast<long>(series.closed.size()));
+  double last_close = series.current.close;
+  for (long i = fill; i > 0; --i) {
+    series.current = Bar{open_time - i * series.resolution_ms, last_close, last_close, last_close, last_close, 0.0, 0};
+    close_bar(series);
+  }
+}
+
+void BarBuilder::close_bar(Series& series) {
+  series.closed[series.next] = series.current;
+  series.next = (series.next + 1) % series.closed.size();
+  ++series.closed_count;
+  if (on_bar_close_) {
+    on_bar_close_(series.resolution_ms, series.current);
+  }
+}
+
+void BarBuilder::set_bar_close_handler(BarCloseHandler handler) {
+  on_bar_close_ = std::move(handler);
+}
+
+std::size_t BarBuilder::resolution_count() const {
+  return series_.size();
+}
+
+long BarBuilder::resolution_ms(std::size_t index) const {
+  return series_[index].resolution_ms;
+}
+
+std::size_t BarBuilder::find_resolution(long resolution_ms) const {
+  for (std::size_t i = 0; i < series_.size(); ++i) {
+    if (series_[i].resolution_ms == resolution_ms) {
+      return i;
+    }
+  }
+  return series_.size();
+}
+
+const Bar& BarBuilder::current_bar(std::size_t index) const {
+  return series_[index].current;
+}
+
+bool BarBuilder::has_current_bar(std::size_t index) const {
+  return series_[index].has_current;
+}
+
+std::size_t BarBuilder::closed_bars(std::size_t index) const {
+  return std::min(series_[index].closed_count, series_[index].closed.size());
+}
+
+const Bar& BarBuilder::closed_bar(std::size_t index, std::size_t ago) const {
+  const Series& series = series_[index];
+  std::size_t capacity = series.closed.size();
+  return series.closed[(series.next + capacity - 1 - ago % capacity) % capacity];
+}
+
+std::vector<BarSeriesSnapshot> BarBuilder::snapshot() const {
+  std::vector<BarSeriesSnapshot> snapshot;
+  snapshot.reserve(series_.size());
+  for (std::size_t index = 0; index < series_.size(); ++index) {
+    const Series& series = series_[index];
+    BarSeriesSnapshot& out =
+      snapshot.emplace_back(BarSeriesSnapshot{series.resolution_ms, series.has_current, series.current, {}});
+    const std::size_t count = closed_bars(index);
+    out.closed.reserve(count);
+    for (std::size_t ago = count; ago > 0; --ago) {
+      out.closed.push_back(closed_bar(index, ago - 1));
+    }
+  }
+  return snapshot;
+}
+
+void BarBuilder::restore(const std::vector<BarSeriesSnapshot>& snapshot) {
+  for (Series& series : series_) {
+    series.current = Bar{};
+    series.has_current = false;
+    series.next = 0;
+    series.closed_count = 0;
+    for (const BarSeriesSnapshot& saved : snapshot) {
+      if (saved.resolution_ms != series.resolution_ms) {
+        continue;
+      }
+      series.current = saved.current;
+      series.has_current = saved.has_current;
+      const std::size_t keep = std::min(saved.closed.size(), series.closed.size());
+      for (std::size_t i = saved.closed.size() - keep; i < saved.closed.size(); ++i) {
+        series.closed[series.next] = saved.closed[i];
+        series.next = (series.next + 1) % series.closed.size();
+        ++series.closed_count;
+      }
+      break;
+    }
+  }
+}
@@ -0,0 +1,113 @@
+#include "../include/common/Clock.h"
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+  bool has_invariant_counter() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+      return false;
+    }
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0; // invariant TSC
+#elif defined(__aarch64__)
+    return true; // the generic timer runs at a fixed frequency
+#else
+    return false;
+#endif
+  }
+
+  std::int64_t read_ns(clockid_t id) {
+    timespec ts{};
+    clock_gettime(id, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+}
+
+std::atomic<const Clock::Calibration*> Clock::published_{nullptr};
+
+const Clock::Calibration& Clock::first_calibration() {
+  // threads racing here may each measure; the first to publish wins and the others use its calibration
+  auto* measured = new Calibration(measure(20));
+  const Calibration* expected = nullptr;
+  if (published_.compare_exchange_strong(expected, measured, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return *measured;
+  }
+  delete measured;
+  return *expected;
+}
+
+void Clock::calibrate(int sample_ms) {
+  // the previous calibration is left allocated: other threads may be converting with it right now
+  published_.store(new Calibration(measure(sample_ms)), std::memory_order_release);
+}
+
+Clock::Calibration Clock::measure(int sample_ms) {
+  Calibration c{false, 0, 0, 0, std::uint64_t{1} << 32};
+  c.base_mono_ns = read_ns(CLOCK_MONOTONIC);
+  c.base_ticks = static_cast<std::uint64_t>(c.base_mono_ns);
+  c.wall_offset_ns = read_ns(CLOCK_REALTIME) - c.base_mono_ns;
+  if (!has_invariant_counter()) {
+    return c;
+  }
+
+  // bracket each clock_gettime with two counter reads and take the midpoint
+  auto sample = [](std::uint64_t& tick, std::int64_t& mono) {
+    std::uint64_t before = 0, after = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    before = __rdtsc();
+    mono = read_ns(CLOCK_MONOTONIC);
+    after = __rdtsc();
+#elif defined(__aarch64__)
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(before));
+    mono = read_ns(CLOCK_MONOTONIC);
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(after));
+#endif
+    tick = before + (after - before) / 2;
+  };
+
+  std::uint64_t tick0 = 0, tick1 = 0;
+  std::int64_t mono0 = 0, mono1 = 0;
+  sample(tick0, mono0);
+  const std::int64_t deadline = mono0 + static_cast<std::int64_t>(sample_ms) * 1000000LL;
+  do {
+    sample(tick1, mono1);
+  } while (mono1 < deadline);
+
+  if (tick1 <= tick0) {
+    std::fprintf(stderr, "Clock: CPU counter did not advance, using clock_gettime\n");
+    return c;
+  }
+
+  c.ns_per_tick_q32 = static_cast<std::uint64_t>((static_cast<unsigned __int128>(mono1 - mono0) << 32) /
+                                                 (tick1 - tick0));
+  c.base_ticks = tick1;
+  c.base_mono_ns = mono1;
+  c.wall_offset_ns = read_ns(CLOCK_REALTIME) - read_ns(CLOCK_MONOTONIC);
+  c.use_counter = true;
+  return c;
+}
+
+bool Clock::uses_cpu_counter() {
+  return calibration().use_counter;
+}
+
+CalendarCache::CalendarCache(bool utc) : utc_(utc), second_(-1), hour_start_(-1), tm_{}, date_{}, time_{}, day_{} {}
+
+void CalendarCache::recompute(std::int64_t epoch_seconds) {
+  std::time_t t = static_cast<std::time_t>(epoch_seconds);
+  if (utc_) {
+    gmtime_r(&t, &tm_);
+  } else {
+    localtime_r(&t, &tm_);
+  }
+  second_ = epoch_seconds;
+  hour_start_ = epoch_seconds - tm_.tm_min * 60 - tm_.tm_sec;
+  std::strftime(date_, sizeof(date_), "%Y-%m-%d", &tm_);
+  std::strftime(time_, sizeof(time_), "%H:%M:%S", &tm_);
+  std::strftime(day_, sizeof(day_), "%a %b %d", &tm_);
+}
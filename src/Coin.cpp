@@ -5,23 +5,45 @@
 #include "../include/common/Coin.h"
 
 #include <memory>
+#include "../include/metrics/MetricsRegistry.h"
 
 
-Coin::Coin(const std::string &symbol) :
+Coin::Coin(const std::string &symbol, MovingAverageBackend* average_backend, bool metrics) :
   symbol_(symbol),
   price_(0),
   last_trade_id_(0),
   last_trade_quantity_(0),
   last_trade_time_(0),
-  average_manager_(MovingAverage(MA_STANDARD_SIZE))
+  average_manager_(MovingAverage(MA_STANDARD_SIZE, average_backend)),
+  bars_(),
+  trades_metric_(metrics ? &METRICS.counter("coin_trades_total", "Trades applied per symbol",
+                                            MetricsRegistry::label("symbol", symbol)) : nullptr),
+  price_metric_(metrics ? &METRICS.gauge("coin_last_price", "Last traded price per symbol",
+                                         MetricsRegistry::label("symbol", symbol)) : nullptr)
 {};
 
-void Coin::update_trade(CoinData& data) {
-  price_ = data.price;
+void Coin::update_trade(CoinData& data, bool captured) {
+  if (captured) {
+    last_trade_id_ = data.trade_id;
+  }
+  apply_trade(data);
+  if (trades_metric_) {
+    trades_metric_->inc();
+    price_metric_->set(data.price);
+  }
+}
+
+void Coin::replay_trade(const CoinData& data) {
   last_trade_id_ = data.trade_id;
+  apply_trade(data);
+}
+
+void Coin::apply_trade(const CoinData& data) {
+  price_ = data.price;
   last_trade_quantity_ = data.trade_quantity;
   last_trade_time_ = data.trade_time;
   average_manager_.update(data.price);
+  bars_.update(data.price, data.trade_quantity, data.trade_time);
 }
 
 std::string Coin::symbol() const {
@@ -44,3 +66,25 @@ long Coin::last_trade_time() const {
 const MovingAverage& Coin::moving_average() const {
   return average_manager_;
 }
+
+const BarBuilder& Coin::bars() const {
+  return bars_;
+}
+
+BarBuilder& Coin::bars() {
+  return bars_;
+}
+
+CoinSnapshot Coin::snapshot() const {
+  return CoinSnapshot{{symbol_, price_, last_trade_id_, last_trade_quantity_, last_trade_time_},
+                      average_manager_.window(), bars_.snapshot()};
+}
+
+void Coin::restore(const CoinSnapshot& snapshot) {
+  price_ = snapshot.last_trade.price;
+  last_trade_id_ = snapshot.last_trade.trade_id;
+  last_trade_quantity_ = snapshot.last_trade.trade_quantity;
+  last_trade_time_ = snapshot.last_trade.trade_time;
+  average_manager_.restore(snapshot.ma_window);
+  bars_.restore(snapshot.bars);
+}
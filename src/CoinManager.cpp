@@ -3,15 +3,97 @@
 //
 
 #include "../include/common/CoinManager.h"
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <vector>
-#include "../include/client/BinanceClient.h"
+#include "../include/bus/MarketBus.h"
+#include "../include/common/Clock.h"
 #include "../include/common/MovingAverage.h"
+#include "../include/history/HistoryReader.h"
+#include "../include/history/HistoryWriter.h"
+#include "../include/history/Snapshot.h"
+#include "../include/metrics/MetricsRegistry.h"
+#include "../include/metrics/PerfCounters.h"
+#include "../include/metrics/Tracer.h"
+#include "../include/strategy/StrategyEngine.h"
 
-CoinManager::CoinManager() : binance_client_(nullptr) {}
+#define WARM_START_READ_BATCH 4096
 
-void CoinManager::set_binance_client(BinanceClient *client) {
-  binance_client_ = client;
+CoinManager::CoinManager() :
+  history_writer_(nullptr),
+  strategy_engine_(nullptr),
+  market_bus_(nullptr),
+  average_backend_(nullptr),
+  capture_venue_(Venue::binance),
+  backfill_lookback_ms_(0),
+  checkpoint_interval_ms_(0),
+  last_checkpoint_time_(0),
+  checkpoint_pending_(false),
+  checkpoint_stop_(false),
+  unknown_coin_metric_(&METRICS.counter("coin_unknown_symbol_total", "Trades received for symbols not tracked")),
+  checkpoint_metric_(&METRICS.counter("coin_checkpoints_total", "Periodic snapshots written")),
+  replayed_trades_metric_(&METRICS.counter("coin_replayed_trades_total",
+                                           "Captured trades replayed on warm start, not in coin_trades_total")),
+  tracked_coins_metric_(&METRICS.gauge("coin_tracked", "Symbols currently tracked")) {}
+
+CoinManager::~CoinManager() {
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+    checkpoint_stop_ = true;
+  }
+  checkpoint_ready_.notify_one();
+  if (checkpoint_thread_.joinable()) {
+    checkpoint_thread_.join();
+  }
+}
+
+void CoinManager::add_feed(MarketDataFeed* feed) {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  feeds_.push_back(feed);
+}
+
+void CoinManager::set_history_writer(HistoryWriter *writer) {
+  history_writer_ = writer;
+}
+
+void CoinManager::set_strategy_engine(StrategyEngine *engine) {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  strategy_engine_ = engine;
+  for (auto& pair : coins_) {
+    attach_strategies(*pair.second);
+  }
+}
+
+void CoinManager::set_market_bus(MarketBus *bus) {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  market_bus_ = bus;
+  if (!market_bus_) {
+    return;
+  }
+  for (const auto& pair : coins_) {
+    market_bus_->add_symbol(pair.first);
+  }
+}
+
+void CoinManager::set_moving_average_backend(MovingAverageBackend *backend) {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  average_backend_ = backend;
+}
+
+void CoinManager::set_capture_venue(Venue venue) {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  capture_venue_ = venue;
+}
+
+void CoinManager::attach_strategies(Coin &coin) {
+  if (!strategy_engine_) {
+    coin.bars().set_bar_close_handler(nullptr);
+    return;
+  }
+  coin.bars().set_bar_close_handler([this, &coin](long resolution_ms, const Bar& bar) {
+    strategy_engine_->on_bar_close(coin, resolution_ms, bar);
+  });
 }
 
 void CoinManager::add_coins(const std::vector<std::string> &symbols) {
@@ -21,70 +103,139 @@ void CoinManager::add_coins(const std::vector<std::string> &symbols) {
   }
 
   std::vector<std::string> new_symbols;
-
-  for (const std::string& symbol : symbols) {
-    if (symbol.empty()) {
-      std::cout << "Warning: Skipping empty symbol" << std::endl;
-      continue;
-    }
-    if (!has_coin(symbol)) {
-      coins_[symbol] = std::make_unique<Coin>(symbol);
-      new_symbols.push_back(symbol);
+  std::vector<MarketDataFeed*> feeds;
+  {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    for (const std::string& symbol : symbols) {
+      if (symbol.empty()) {
+        std::cout << "Warning: Skipping empty symbol" << std::endl;
+        continue;
+      }
+      if (!coins_.count(symbol)) {
+        coins_[symbol] = std::make_unique<Coin>(symbol, average_backend_);
+        warm_start(*coins_[symbol]);
+        // after the warm start, so replayed history does not reach strategies as live events
+        attach_strategies(*coins_[symbol]);
+        if (market_bus_) {
+          market_bus_->add_symbol(symbol);
+        }
+        new_symbols.push_back(symbol);
+      }
     }
+    tracked_coins_metric_->set(static_cast<double>(coins_.size()));
+    feeds = feeds_;
   }
 
   if (new_symbols.empty()) {
-    std::cout << "empty!!!" << std::endl;
+    return;
   }
-
-
-  if (!new_symbols.empty() && binance_client_ && binance_client_->is_connected()) {
-    std::cout << "preparing to subscribe";
-    std::vector<std::string> stream_names;
-    for (const std::string& symbol : new_symbols) {
-      stream_names.push_back(symbol + "@trade");
-      std::cout << stream_names.back() << std::endl;
+  if (feeds.empty()) {
+    std::cout << "Warning: No market data feed available for subscription" << std::endl;
+  }
+  for (MarketDataFeed* feed : feeds) {
+    if (feed->is_connected()) {
+      feed->subscribe(new_symbols);
+    } else {
+      std::cout << "Warning: " << instruments::venue_name(feed->venue()) << " feed not connected, cannot subscribe"
+                << std::endl;
     }
-    binance_client_->subscribe_to_streams(stream_names);
-  } else if (!new_symbols.empty() && !binance_client_) {
-    std::cout << "Warning: No BinanceClient available for subscription" << std::endl;
-  } else if (!new_symbols.empty() && !binance_client_->is_connected()) {
-    std::cout << "Warning: BinanceClient not connected, cannot subscribe" << std::endl;
   }
 }
 
 void CoinManager::remove_coins(const std::vector<std::string> &symbols) {
   std::vector<std::string> symbols_to_remove;
-
-  for (const auto& symbol : symbols) {
-    if (coins_.find(symbol) != coins_.end()) {
-      symbols_to_remove.push_back(symbol);
-      coins_.erase(symbol);
-      std::cout << "Removed coin: " << symbol << std::endl;
+  std::vector<MarketDataFeed*> feeds;
+  {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    for (const auto& symbol : symbols) {
+      if (coins_.find(symbol) != coins_.end()) {
+        symbols_to_remove.push_back(symbol);
+        coins_.erase(symbol);
+        std::cout << "Removed coin: " << symbol << std::endl;
+      }
     }
+    tracked_coins_metric_->set(static_cast<double>(coins_.size()));
+    feeds = feeds_;
   }
 
-  // Unsubscribe from Binance streams
-  if (!symbols_to_remove.empty() && binance_client_ && binance_client_->is_connected()) {
-    std::vector<std::string> stream_names;
-    for (const std::string& symbol : symbols_to_remove) {
-      stream_names.push_back(symbol + "@trade");
-      std::cout << stream_names.back() << std::endl;
+  if (symbols_to_remove.empty()) {
+    return;
+  }
+  for (MarketDataFeed* feed : feeds) {
+    if (feed->is_connected()) {
+      feed->unsubscribe(symbols_to_remove);
     }
-    binance_client_->unsubscribe_from_streams(stream_names);
   }
 }
 
-void CoinManager::update_coin_data(CoinData &data) {
+void CoinManager::update_coin_data(CoinData &data, bool captured) {
+  PERF_SCOPE(PERF_UPDATE);
   auto it = coins_.find(data.symbol);
   if (it != coins_.end()) {
-    it->second->update_trade(data);
+    it->second->update_trade(data, captured);
+    // bus readers first, so they do not wait behind strategies and the orders they send
+    if (market_bus_) {
+      market_bus_->publish_trade(*it->second, data);
+    }
+    if (strategy_engine_) {
+      strategy_engine_->on_trade(*it->second, data);
+    }
+    if (history_writer_ && captured) {
+      history_writer_->append(data);
+    }
+    if (!checkpoint_path_.empty()) {
+      if (last_checkpoint_time_ == 0) {
+        last_checkpoint_time_ = data.trade_time;
+      } else if (data.trade_time - last_checkpoint_time_ >= checkpoint_interval_ms_) {
+        queue_checkpoint();
+        last_checkpoint_time_ = data.trade_time;
+      }
+    }
     return;
   }
+  unknown_coin_metric_->inc();
   std::cout << "Received data for unknown coin: " << data.symbol << std::endl;
 }
 
+void CoinManager::on_trade(Venue venue, CoinData& data) {
+  {
+    std::lock_guard<std::mutex> lock(book_mutex_);
+    consolidated_.on_trade(venue, data.symbol, data.price, Clock::wall_ms());
+  }
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  update_coin_data(data, venue == capture_venue_);
+}
+
+void CoinManager::on_quote(Venue venue, const Quote& quote) {
+  {
+    std::lock_guard<std::mutex> lock(book_mutex_);
+    consolidated_.on_quote(venue, quote, Clock::wall_ms());
+  }
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  auto it = coins_.find(quote.instrument);
+  if (it == coins_.end()) {
+    return;
+  }
+  if (market_bus_) {
+    market_bus_->publish_quote(quote);
+  }
+  if (strategy_engine_) {
+    strategy_engine_->on_quote(*it->second, quote);
+  }
+}
+
+bool CoinManager::best_quote(const std::string& symbol, ConsolidatedQuote& out) const {
+  std::lock_guard<std::mutex> lock(book_mutex_);
+  return consolidated_.best(symbol, Clock::wall_ms(), out);
+}
+
+bool CoinManager::venue_fresh(Venue venue) const {
+  std::lock_guard<std::mutex> lock(book_mutex_);
+  return consolidated_.is_fresh(venue, Clock::wall_ms());
+}
+
 std::vector<std::string> CoinManager::all_coin_symbols() const{
+  std::lock_guard<std::mutex> lock(feed_mutex_);
   std::vector<std::string> symbols;
   symbols.reserve(coins_.size());
 
@@ -96,6 +247,7 @@ std::vector<std::string> CoinManager::all_coin_symbols() const{
 
 
 std::vector<Coin*> CoinManager::all_coins() const {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
   std::vector<Coin*> coins;
   coins.reserve(coins_.size());
 
@@ -107,10 +259,137 @@ std::vector<Coin*> CoinManager::all_coins() const {
 
 
 bool CoinManager::has_coin(const std::string &symbol) const {
+  std::lock_guard<std::mutex> lock(feed_mutex_);
   if (coins_.find(symbol) == coins_.end()) {
     return false;
   }
   return true;
 }
 
+bool CoinManager::restore_snapshot(const std::string &path, const std::string &history_directory, long lookback_ms) {
+  std::vector<CoinSnapshot> snapshots;
+  bool loaded = snapshot::load(path, snapshots);
+  std::lock_guard<std::mutex> lock(feed_mutex_);
+  for (CoinSnapshot& coin : snapshots) {
+    std::string symbol = coin.last_trade.symbol;
+    pending_snapshots_[symbol] = std::move(coin);
+  }
+  backfill_directory_ = history_directory;
+  backfill_lookback_ms_ = lookback_ms;
+
+  for (const auto& pair : coins_) {
+    if (pending_snapshots_.count(pair.first)) {
+      warm_start(*pair.second);
+    }
+  }
+  return loaded;
+}
+
+bool CoinManager::save_snapshot(const std::string &path) const {
+  TRACE_SCOPE("checkpoint");
+  std::vector<CoinSnapshot> coins;
+  {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    // the backfill after a restart relies on the capture being on disk up to this snapshot
+    if (history_writer_) {
+      history_writer_->flush();
+    }
+    coins = coin_snapshots();
+  }
+  return snapshot::save(path, coins, Clock::wall_ms());
+}
 
+std::vector<CoinSnapshot> CoinManager::coin_snapshots() const {
+  std::vector<CoinSnapshot> snapshots;
+  snapshots.reserve(coins_.size());
+  for (const auto& pair : coins_) {
+    snapshots.push_back(pair.second->snapshot());
+  }
+  return snapshots;
+}
+
+void CoinManager::enable_checkpoints(const std::string &path, long interval_ms) {
+  {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    checkpoint_path_ = path;
+    checkpoint_interval_ms_ = interval_ms;
+    last_checkpoint_time_ = 0;
+  }
+  if (!checkpoint_thread_.joinable()) {
+    checkpoint_thread_ = std::thread([this]() { run_checkpoints(); });
+  }
+}
+
+void CoinManager::queue_checkpoint() {
+  std::vector<CoinSnapshot> coins = coin_snapshots();
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+    checkpoint_target_ = checkpoint_path_;
+    checkpoint_coins_ = std::move(coins);
+    checkpoint_pending_ = true;
+  }
+  checkpoint_ready_.notify_one();
+}
+
+void CoinManager::run_checkpoints() {
+  std::unique_lock<std::mutex> lock(checkpoint_mutex_);
+  while (true) {
+    checkpoint_ready_.wait(lock, [this]() { return checkpoint_pending_ || checkpoint_stop_; });
+    // a checkpoint queued before shutdown is still written
+    if (!checkpoint_pending_) {
+      return;
+    }
+    const std::string path = checkpoint_target_;
+    const std::vector<CoinSnapshot> coins = std::move(checkpoint_coins_);
+    checkpoint_pending_ = false;
+    lock.unlock();
+    {
+      TRACE_SCOPE("checkpoint");
+      if (snapshot::save(path, coins, Clock::wall_ms())) {
+        checkpoint_metric_->inc();
+      }
+    }
+    lock.lock();
+  }
+}
+
+void CoinManager::warm_start(Coin &coin) {
+  const std::string symbol = coin.symbol();
+  auto it = pending_snapshots_.find(symbol);
+  bool restored = it != pending_snapshots_.end();
+  if (restored) {
+    coin.restore(it->second);
+    pending_snapshots_.erase(it);
+  }
+  if (backfill_directory_.empty()) {
+    return;
+  }
+
+  HistoryReader reader(backfill_directory_, symbol);
+  constexpr std::int64_t open_end = std::numeric_limits<std::int64_t>::max();
+  if (restored) {
+    reader.seek_trade_id(coin.last_trade_id() + 1, open_end);
+  } else {
+    reader.seek_time(Clock::wall_ms() - backfill_lookback_ms_, open_end);
+  }
+
+  std::vector<TickRecord> buffer(WARM_START_READ_BATCH);
+  std::size_t replayed = 0;
+  CoinData data;
+  data.symbol = symbol;
+  while (std::size_t count = reader.read(buffer.data(), buffer.size())) {
+    for (std::size_t i = 0; i < count; ++i) {
+      data.price = buffer[i].price;
+      data.trade_id = buffer[i].trade_id;
+      data.trade_quantity = buffer[i].quantity;
+      data.trade_time = buffer[i].trade_time;
+      coin.replay_trade(data);
+    }
+    replayed += count;
+  }
+  replayed_trades_metric_->inc(replayed);
+  if (restored || replayed > 0) {
+    std::cout << "Warm start " << symbol << ": " << (restored ? "snapshot + " : "") << replayed
+              << " captured trades" << std::endl;
+  }
+}
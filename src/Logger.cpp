@@ -2,23 +2,35 @@
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <ctime>
 #include <filesystem>
+#include "../include/common/Clock.h"
+#include "../include/metrics/MetricsRegistry.h"
+#include "../include/metrics/Tracer.h"
+
+Logger::Logger(const std::string& dir)
+  : directory(dir),
+    write_failures_(&METRICS.counter("log_write_failures_total",
+                                     "Log lines lost because the file could not be opened")) {
+  for (TYPE type : {info, warning, error}) {
+    lines_[type] = &METRICS.counter("log_lines_total", "Lines written by Logger",
+                                    MetricsRegistry::label("level", enum_to_string(type)));
+  }
+}
 
 
 void Logger::log(TYPE type, std::string data, std::string message) {
-  time_t timestamp; // seconds since 1970
-  time(&timestamp); //set current time
-  struct tm* timeinfo = localtime(&timestamp);
-
-  char fileDate[20];
-  strftime(fileDate, sizeof(fileDate), "%Y-%m-%d", timeinfo);
-  std::string dateDir = directory + fileDate + "/";
+  TRACE_SCOPE("log flush");
+  thread_local CalendarCache calendar; // only re-formats the date when the hour changes
+  calendar.update(Clock::wall_ns() / 1000000000);
+  std::string dateDir = directory + calendar.date() + "/";
 
   if (!std::filesystem::exists(dateDir)) {
     std::filesystem::create_directory(dateDir);
   }
   std::string enum_string = enum_to_string(type);
+  if (type >= info && type <= error) {
+    lines_[type]->inc();
+  }
   std::string filename = enum_string + ".log";
   std::string file_path = dateDir + filename;
   std::ofstream myfile (file_path, std::ios::app);
@@ -28,6 +40,7 @@ void Logger::log(TYPE type, std::string data, std::string message) {
     myfile.close();
   }
   else {
+    write_failures_->inc();
     std::cout << "Unable to open file ";
   }
 }
@@ -3,27 +3,65 @@
 //
 
 #include "../include/common/MovingAverage.h"
+#include <algorithm>
+#include <iostream>
+#include "../include/common/MovingAverageBackend.h"
+#include "../include/metrics/PerfCounters.h"
 
-MovingAverage::MovingAverage(std::size_t window_size)
-  : window_size_(window_size), sum_(0.0){}
+MovingAverage::MovingAverage(std::size_t window_size, MovingAverageBackend* backend)
+  : window_size_(std::max<std::size_t>(window_size, 1)), backend_(nullptr), channel_(UINT32_MAX){
+  if (backend && !backend->failed()) {
+    channel_ = backend->add_channel(window_size_);
+    if (channel_ == UINT32_MAX) {
+      std::cerr << "Moving average backend " << backend->name() << " cannot take another window, computing in process"
+                << std::endl;
+    } else {
+      backend_ = backend;
+    }
+  }
+  if (!backend_) {
+    use_native();
+  }
+}
 
-void MovingAverage::update(double new_price){
-  window_.push_back(new_price);
-  sum_ += new_price;
+MovingAverage::~MovingAverage() = default;
+MovingAverage::MovingAverage(MovingAverage&&) noexcept = default;
+MovingAverage& MovingAverage::operator=(MovingAverage&&) noexcept = default;
 
-  if (window_.size() > window_size_) {
-    sum_ -= window_.front();
-    window_.pop_front();
+void MovingAverage::use_native() {
+  native_ = std::make_unique<NativeMovingAverageBackend>();
+  channel_ = native_->add_channel(window_size_);
+  for (double price : shadow_) {
+    native_->update(channel_, price);
+  }
+  shadow_.clear();
+  backend_ = native_.get();
+}
+
+void MovingAverage::update(double new_price){
+  PERF_SCOPE(PERF_INDICATOR);
+  if (native_) {
+    native_->update(channel_, new_price);
+    return;
+  }
+  shadow_.push_back(new_price);
+  if (shadow_.size() > window_size_) {
+    shadow_.pop_front();
+  }
+  if (!backend_->failed()) {
+    backend_->update(channel_, new_price);
+  }
+  if (backend_->failed()) {
+    use_native(); // the shadow already holds this price
   }
 }
 
 double MovingAverage::get_value() const{
-  if (window_.empty()) return 0.0;
-  return sum_ / window_.size();
+  return backend_->value(channel_);
 }
 
 bool MovingAverage::is_ready() const {
-  return window_.size() >= window_size_;
+  return backend_->count(channel_) >= window_size_;
 }
 
 bool MovingAverage::is_price_below_MA(double current_price) const{
@@ -33,3 +71,36 @@ bool MovingAverage::is_price_below_MA(double current_price) const{
 bool MovingAverage::is_price_above_MA(double current_price) const{
   return current_price > get_value();
 }
+
+std::size_t MovingAverage::window_size() const {
+  return window_size_;
+}
+
+std::vector<double> MovingAverage::window() const {
+  if (native_) {
+    return native_->window(channel_);
+  }
+  return std::vector<double>(shadow_.begin(), shadow_.end());
+}
+
+void MovingAverage::restore(const std::vector<double>& prices) {
+  const std::size_t skip = prices.size() > window_size_ ? prices.size() - window_size_ : 0;
+  if (native_) {
+    native_->reset(channel_);
+    for (std::size_t i = skip; i < prices.size(); ++i) {
+      native_->update(channel_, prices[i]);
+    }
+    return;
+  }
+  shadow_.assign(prices.begin() + static_cast<std::ptrdiff_t>(skip), prices.end());
+  if (!backend_->failed()) {
+    backend_->reset(channel_);
+    for (double price : shadow_) {
+      backend_->update(channel_, price);
+    }
+    backend_->flush();
+  }
+  if (backend_->failed()) {
+    use_native();
+  }
+}
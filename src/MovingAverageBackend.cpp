@@ -0,0 +1,46 @@
+#include "../include/common/MovingAverageBackend.h"
+#include <algorithm>
+
+std::uint32_t NativeMovingAverageBackend::add_channel(std::size_t window) {
+  if (window == 0) {
+    return UINT32_MAX;
+  }
+  channels_.push_back({prices_.size(), window, 0, 0, 0.0});
+  prices_.resize(prices_.size() + window, 0.0);
+  return static_cast<std::uint32_t>(channels_.size() - 1);
+}
+
+void NativeMovingAverageBackend::reset(std::uint32_t channel) {
+  Channel& state = channels_[channel];
+  std::fill_n(prices_.begin() + static_cast<std::ptrdiff_t>(state.offset), state.window, 0.0);
+  state.next = 0;
+  state.count = 0;
+  state.sum = 0.0;
+}
+
+void NativeMovingAverageBackend::update(std::uint32_t channel, double price) {
+  Channel& state = channels_[channel];
+  double& slot = prices_[state.offset + state.next];
+  state.sum += price - slot; // slots start at 0.0, so this is exact while filling up
+  slot = price;
+  state.next = state.next + 1 == state.window ? 0 : state.next + 1;
+  state.count += state.count < state.window;
+}
+
+double NativeMovingAverageBackend::value(std::uint32_t channel) const {
+  const Channel& state = channels_[channel];
+  return state.count ? state.sum / static_cast<double>(state.count) : 0.0;
+}
+
+std::vector<double> NativeMovingAverageBackend::window(std::uint32_t channel) const {
+  const Channel& state = channels_[channel];
+  std::vector<double> prices;
+  prices.reserve(state.count);
+  // the oldest price sits where the next one goes once the ring is full, at its start before that
+  const std::size_t oldest = state.count == state.window ? state.next : 0;
+  for (std::size_t i = 0; i < state.count; ++i) {
+    const std::size_t slot = oldest + i < state.window ? oldest + i : oldest + i - state.window;
+    prices.push_back(prices_[state.offset + slot]);
+  }
+  return prices;
+}
@@ -3,8 +3,10 @@
 //
 
 #include "../include/common/Visualizer.h"
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include "../include/common/Clock.h"
 
 void display_prices(CoinManager& manager) {
   std::cout  << "\033[2J\033[H" << std::flush;
@@ -19,30 +21,22 @@ void display_prices(CoinManager& manager) {
   std::cout << std::string(55, '-') << std::endl;
 
   std::vector<Coin*> p_coins = manager.all_coins();
+  thread_local CalendarCache calendar; // trades within the same hour only patch the clock digits
 
   for (const auto p_coin: p_coins) {
     long long timestamp_ms = p_coin->last_trade_time();
-    std::time_t t = static_cast<std::time_t>(timestamp_ms / 1000);
     int ms_part = static_cast<int>(timestamp_ms % 1000);
+    calendar.update(timestamp_ms / 1000);
 
-    std::tm time{};
-#ifdef _WIN32
-    localtime_s(&time, &t);
-#else
-    localtime_r(&t, &time);
-#endif
-
-    std::ostringstream time_str;
-    time_str << std::put_time(&time, "%a %b %d %H:%M:%S")
-             << '.' << std::setfill('0') << std::setw(3) << ms_part
-             << ' ' << std::put_time(&time, "%Y");
-
+    char time_str[48];
+    std::snprintf(time_str, sizeof(time_str), "%s %s.%03d %d", calendar.day(), calendar.time(), ms_part,
+                  calendar.year());
 
     std::cout << std::left
               << std::setw(10) << p_coin->symbol()
               << std::setw(15) << std::fixed << std::setprecision(6) << p_coin->price()
               << std::setw(15) << std::fixed << std::setprecision(6) << p_coin->moving_average().get_value()
-              << std::setw(35) << time_str.str()
+              << std::setw(35) << time_str
               << std::endl;
 
   }
@@ -0,0 +1,107 @@
+#include "../include/common/WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+  // which pool and deque the current thread works for, so nested submits stay local
+  thread_local const WorkStealingPool* current_pool = nullptr;
+  thread_local std::size_t current_worker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads) :
+  next_worker_(0), steals_(0), queued_(0), pending_(0), stop_(false) {
+  unsigned count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (unsigned i = 0; i < count; ++i) {
+    threads_.emplace_back(&WorkStealingPool::run, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+  std::size_t index = current_pool == this ? current_worker : next_worker_++ % workers_.size();
+  {
+    // counted before it becomes visible, so a fast worker can never finish it before pending_ includes it
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    ++queued_;
+    ++pending_;
+  }
+  {
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    workers_[index]->tasks.push_back(std::move(task));
+  }
+  work_cv_.notify_one();
+}
+
+bool WorkStealingPool::take(std::size_t index, std::function<void()>& task) {
+  {
+    Worker& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+    Worker& victim = *workers_[(index + offset) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::run(std::size_t index) {
+  current_pool = this;
+  current_worker = index;
+  std::function<void()> task;
+  while (true) {
+    if (take(index, task)) {
+      {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        --queued_;
+      }
+      task();
+      task = nullptr;
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      if (--pending_ == 0) {
+        idle_cv_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    work_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+    if (stop_ && queued_ <= 0) {
+      return;
+    }
+  }
+}
+
+void WorkStealingPool::wait_idle() {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  idle_cv_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+std::size_t WorkStealingPool::size() const {
+  return workers_.size();
+}
+
+std::uint64_t WorkStealingPool::steals() const {
+  return steals_.load(std::memory_order_relaxed);
+}
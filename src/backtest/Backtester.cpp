@@ -0,0 +1,156 @@
+#include "../../include/backtest/Backtester.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include "../../include/common/Clock.h"
+#include "../../include/common/Coin.h"
+#include "../../include/common/WorkStealingPool.h"
+#include "../../include/history/HistoryReader.h"
+
+#define BACKTEST_READ_BATCH 4096
+
+double BacktestReport::trades_per_second() const {
+  return seconds > 0.0 ? static_cast<double>(trades) / seconds : 0.0;
+}
+
+Backtester::Backtester(BacktestConfig config, StrategyFactory factory) :
+  config_(std::move(config)), factory_(std::move(factory)) {}
+
+SymbolResult Backtester::run_symbol(const std::string& symbol) const {
+  SymbolResult result;
+  result.symbol = symbol;
+  const std::int64_t start_ns = Clock::now_ns();
+
+  struct PendingOrder {
+    SignalSide side;
+    long signal_time;
+    std::uint64_t signal_trade; // index of the trade that triggered it; fills only on a later one
+  };
+  std::deque<PendingOrder> pending;
+  std::uint64_t trade_index = 0;
+
+  // the job's own coin, kept out of the live process's metrics; trades reach it and then the engine in the
+  // order CoinManager::update_coin_data() uses
+  Coin coin(symbol, nullptr, false);
+  StrategyEngine engine;
+  engine.set_signal_handler([&](const Signal& signal) {
+    ++result.signals;
+    pending.push_back({signal.side, signal.trade_time, trade_index});
+  });
+  std::shared_ptr<void> strategy = factory_(engine, symbol);
+  coin.bars().set_bar_close_handler([&engine, &coin](long resolution_ms, const Bar& bar) {
+    engine.on_bar_close(coin, resolution_ms, bar);
+  });
+
+  HistoryReader reader(config_.history_dir, symbol);
+  if (!reader.seek_time(config_.begin_ms, config_.end_ms)) {
+    return result;
+  }
+
+  std::vector<TickRecord> buffer(BACKTEST_READ_BATCH);
+  CoinData data;
+  data.symbol = symbol;
+  double peak_equity = 0.0;
+
+  while (std::size_t count = reader.read(buffer.data(), buffer.size())) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const TickRecord& record = buffer[i];
+      ++trade_index;
+
+      // orders reach the market before the strategy sees this trade
+      while (!pending.empty() && pending.front().signal_trade < trade_index &&
+             record.trade_time >= pending.front().signal_time + config_.fill_latency_ms) {
+        const PendingOrder& order = pending.front();
+        const double sign = order.side == SignalSide::buy ? 1.0 : -1.0;
+        const double price = record.price * (1.0 + sign * config_.slippage_bps / 10000.0);
+        const double quantity = config_.order_quantity;
+        const double fee = price * quantity * config_.fee_rate;
+        result.cash -= sign * price * quantity + fee;
+        result.position += sign * quantity;
+        result.fees += fee;
+        result.fills.push_back({symbol, order.side, order.signal_time, static_cast<long>(record.trade_time), price,
+                                quantity, fee});
+        pending.pop_front();
+      }
+
+      data.price = record.price;
+      data.trade_id = static_cast<long>(record.trade_id);
+      data.trade_quantity = record.quantity;
+      data.trade_time = static_cast<long>(record.trade_time);
+      coin.update_trade(data);
+      engine.on_trade(coin, data);
+
+      const double equity = result.cash + result.position * record.price;
+      peak_equity = std::max(peak_equity, equity);
+      result.max_drawdown = std::max(result.max_drawdown, peak_equity - equity);
+      result.last_price = record.price;
+    }
+    result.trades += count;
+  }
+
+  result.unfilled = pending.size();
+  result.pnl = result.cash + result.position * result.last_price;
+  result.seconds = static_cast<double>(Clock::now_ns() - start_ns) / 1e9;
+  return result;
+}
+
+BacktestReport Backtester::run() const {
+  const std::vector<std::string> symbols =
+    config_.symbols.empty() ? tick_files::captured_symbols(config_.history_dir) : config_.symbols;
+  BacktestReport report;
+  report.symbols.resize(symbols.size());
+  const std::int64_t start_ns = Clock::now_ns();
+
+  {
+    WorkStealingPool pool(config_.threads);
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+      pool.submit([this, &report, &symbols, i]() { report.symbols[i] = run_symbol(symbols[i]); });
+    }
+    pool.wait_idle();
+    report.steals = pool.steals();
+  }
+
+  report.seconds = static_cast<double>(Clock::now_ns() - start_ns) / 1e9;
+  for (const SymbolResult& result : report.symbols) {
+    report.pnl += result.pnl;
+    report.trades += result.trades;
+  }
+  return report;
+}
+
+bool Backtester::write_trade_log(const BacktestReport& report, const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    std::fprintf(stderr, "Unable to open trade log %s\n", path.c_str());
+    return false;
+  }
+  std::fputs("symbol,side,signal_time,fill_time,price,quantity,fee\n", file);
+  for (const SymbolResult& result : report.symbols) {
+    for (const BacktestFill& fill : result.fills) {
+      std::fprintf(file, "%s,%s,%ld,%ld,%.10g,%.10g,%.10g\n", fill.symbol.c_str(),
+                   fill.side == SignalSide::buy ? "buy" : "sell", fill.signal_time, fill.fill_time, fill.price,
+                   fill.quantity, fill.fee);
+    }
+  }
+  return std::fclose(file) == 0;
+}
+
+std::string Backtester::summary(const BacktestReport& report) {
+  std::string out;
+  char line[256];
+  for (const SymbolResult& result : report.symbols) {
+    std::snprintf(line, sizeof(line),
+                  "%-10s trades=%llu signals=%llu fills=%zu position=%.6g pnl=%.4f fees=%.4f max_dd=%.4f "
+                  "time=%.3fs (%.2fM trades/s)\n",
+                  result.symbol.c_str(), static_cast<unsigned long long>(result.trades),
+                  static_cast<unsigned long long>(result.signals), result.fills.size(), result.position, result.pnl,
+                  result.fees, result.max_drawdown, result.seconds,
+                  result.seconds > 0.0 ? static_cast<double>(result.trades) / result.seconds / 1e6 : 0.0);
+    out += line;
+  }
+  std::snprintf(line, sizeof(line), "total      trades=%llu pnl=%.4f time=%.3fs (%.2fM trades/s, %llu steals)\n",
+                static_cast<unsigned long long>(report.trades), report.pnl, report.seconds,
+                report.trades_per_second() / 1e6, static_cast<unsigned long long>(report.steals));
+  out += line;
+  return out;
+}
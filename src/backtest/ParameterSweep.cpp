@@ -0,0 +1,179 @@
+#include "../../include/backtest/ParameterSweep.h"
+#include <algorithm>
+#include <cstdio>
+#include "../../include/common/WorkStealingPool.h"
+#include "../../include/history/HistoryReader.h"
+
+#define SWEEP_READ_BATCH 4096
+
+namespace {
+  std::vector<double> load_prices(const SweepConfig& config, const std::string& symbol) {
+    std::vector<double> prices;
+    HistoryReader reader(config.history_dir, symbol);
+    if (!reader.seek_time(config.begin_ms, config.end_ms)) {
+      return prices;
+    }
+    std::vector<TickRecord> buffer(SWEEP_READ_BATCH);
+    while (std::size_t count = reader.read(buffer.data(), buffer.size())) {
+      for (std::size_t i = 0; i < count; ++i) {
+        prices.push_back(buffer[i].price);
+      }
+    }
+    return prices;
+  }
+}
+
+ParameterSweep::ParameterSweep(SweepConfig config) : config_(std::move(config)) {}
+
+std::vector<SweepResult> ParameterSweep::simulate(const std::vector<double>& prices,
+                                                  const std::vector<std::size_t>& windows,
+                                                  const std::vector<double>& thresholds, double slippage_bps,
+                                                  double fee_rate) {
+  for (std::size_t w : windows) {
+    if (w == 0 || w > prices.size()) {
+      return {};
+    }
+  }
+  const std::size_t window_count = windows.size();
+  const std::size_t threshold_count = thresholds.size();
+  const std::size_t lanes = window_count * threshold_count;
+
+  // one slot per parameter set, lane = window index * threshold_count + threshold index
+  std::vector<double> position(lanes, 0.0);
+  std::vector<double> pending(lanes, 0.0); // +1 buy / -1 sell on the next trade, 0 nothing
+  std::vector<double> cash(lanes, 0.0);
+  std::vector<double> fees(lanes, 0.0);
+  std::vector<double> fills(lanes, 0.0);
+  std::vector<double> peak(lanes, 0.0);
+  std::vector<double> drawdown(lanes, 0.0);
+  std::vector<double> lower(threshold_count);
+  std::vector<double> upper(threshold_count);
+  for (std::size_t j = 0; j < threshold_count; ++j) {
+    lower[j] = 1.0 - thresholds[j];
+    upper[j] = 1.0 + thresholds[j];
+  }
+  std::vector<double> sums(window_count, 0.0);
+  const double slip = slippage_bps / 10000.0;
+
+  for (std::size_t t = 0; t < prices.size(); ++t) {
+    const double p = prices[t];
+
+    // fill last trade's orders at this price; every lane runs the same arithmetic, 0 where nothing is pending
+    for (std::size_t l = 0; l < lanes; ++l) {
+      const double side = pending[l];
+      const double fill_price = p * (1.0 + side * slip);
+      const double fee = side * side * fill_price * fee_rate;
+      cash[l] -= side * fill_price + fee;
+      fees[l] += fee;
+      fills[l] += side * side;
+      position[l] += side;
+    }
+
+    for (std::size_t k = 0; k < window_count; ++k) {
+      const std::size_t w = windows[k];
+      sums[k] += p - (t >= w ? prices[t - w] : 0.0);
+      const bool ready = t + 1 >= w;
+      const double average = sums[k] / static_cast<double>(w);
+      double* lane_position = position.data() + k * threshold_count;
+      double* lane_pending = pending.data() + k * threshold_count;
+      for (std::size_t j = 0; j < threshold_count; ++j) {
+        const double buy = lane_position[j] == 0.0 && p < average * lower[j] ? 1.0 : 0.0;
+        const double sell = lane_position[j] == 1.0 && p > average * upper[j] ? 1.0 : 0.0;
+        lane_pending[j] = ready ? buy - sell : 0.0;
+      }
+    }
+
+    for (std::size_t l = 0; l < lanes; ++l) {
+      const double equity = cash[l] + position[l] * p;
+      peak[l] = std::max(peak[l], equity);
+      drawdown[l] = std::max(drawdown[l], peak[l] - equity);
+    }
+  }
+
+  const double last = prices.empty() ? 0.0 : prices.back();
+  std::vector<SweepResult> results(lanes);
+  for (std::size_t k = 0; k < window_count; ++k) {
+    for (std::size_t j = 0; j < threshold_count; ++j) {
+      const std::size_t l = k * threshold_count + j;
+      results[l] = {{}, windows[k], thresholds[j], cash[l] + position[l] * last, fees[l],
+                    static_cast<std::uint64_t>(fills[l]), drawdown[l]};
+    }
+  }
+  return results;
+}
+
+std::vector<SweepResult> ParameterSweep::run() const {
+  const std::vector<std::string> symbols =
+    config_.symbols.empty() ? tick_files::captured_symbols(config_.history_dir) : config_.symbols;
+  const std::size_t threshold_count = config_.thresholds.size();
+
+  std::vector<SweepResult> results;
+  if (config_.windows.empty() || threshold_count == 0) {
+    return results;
+  }
+  if (std::find(config_.windows.begin(), config_.windows.end(), 0u) != config_.windows.end()) {
+    std::fprintf(stderr, "Sweep windows must be at least one trade long\n");
+    return results;
+  }
+  const std::size_t longest = *std::max_element(config_.windows.begin(), config_.windows.end());
+
+  WorkStealingPool pool(config_.threads);
+  // a couple of shards per worker so a slow shard can be balanced by stealing
+  const std::size_t shard_count = std::min(config_.windows.size(), pool.size() * 2);
+  const std::size_t shard_windows = (config_.windows.size() + shard_count - 1) / shard_count;
+
+  for (const std::string& symbol : symbols) {
+    const std::vector<double> prices = load_prices(config_, symbol);
+    if (prices.empty()) {
+      continue;
+    }
+    if (longest > prices.size()) {
+      std::fprintf(stderr, "Skipping %s in sweep: %zu trades, shorter than the %zu-trade window\n", symbol.c_str(),
+                   prices.size(), longest);
+      continue;
+    }
+    std::vector<std::vector<SweepResult>> shards(shard_count);
+    for (std::size_t s = 0; s < shard_count; ++s) {
+      pool.submit([this, &prices, &shards, s, shard_windows]() {
+        const std::size_t first = s * shard_windows;
+        const std::size_t last = std::min(first + shard_windows, config_.windows.size());
+        if (first >= last) {
+          return;
+        }
+        const std::vector<std::size_t> windows(config_.windows.begin() + first, config_.windows.begin() + last);
+        shards[s] = simulate(prices, windows, config_.thresholds, config_.slippage_bps, config_.fee_rate);
+      });
+    }
+    pool.wait_idle();
+
+    // each symbol trades its own 1-unit position, so its results are ranked on their own
+    const std::size_t first = results.size();
+    for (std::vector<SweepResult>& shard : shards) {
+      for (SweepResult& result : shard) {
+        result.symbol = symbol;
+        results.push_back(std::move(result));
+      }
+    }
+    std::stable_sort(results.begin() + static_cast<std::ptrdiff_t>(first), results.end(),
+                     [](const SweepResult& a, const SweepResult& b) { return a.pnl > b.pnl; });
+  }
+  return results;
+}
+
+bool ParameterSweep::write_table(const std::vector<SweepResult>& results, const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    std::fprintf(stderr, "Unable to open sweep table %s\n", path.c_str());
+    return false;
+  }
+  std::fputs("symbol,rank,window,threshold,pnl,fees,fills,max_drawdown\n", file);
+  std::size_t rank = 0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const SweepResult& result = results[i];
+    rank = i > 0 && results[i - 1].symbol == result.symbol ? rank + 1 : 1;
+    std::fprintf(file, "%s,%zu,%zu,%.10g,%.10g,%.10g,%llu,%.10g\n", result.symbol.c_str(), rank, result.window,
+                 result.threshold, result.pnl, result.fees, static_cast<unsigned long long>(result.fills),
+                 result.max_drawdown);
+  }
+  return std::fclose(file) == 0;
+}
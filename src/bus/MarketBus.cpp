@@ -0,0 +1,168 @@
+#include "../../include/bus/MarketBus.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../../include/common/Clock.h"
+
+namespace {
+  std::atomic_ref<std::uint64_t> atomic(std::uint64_t& value) {
+    return std::atomic_ref<std::uint64_t>(value);
+  }
+
+  std::size_t align_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+}
+
+MarketBus::MarketBus()
+  : base_(nullptr), size_(0), header_(nullptr), slots_(nullptr), events_(nullptr) {}
+
+MarketBus::~MarketBus() {
+  close();
+}
+
+bool MarketBus::create(const std::string& name, std::uint32_t max_symbols, std::uint32_t ring_capacity) {
+  close();
+  ring_capacity = std::bit_ceil(std::max<std::uint32_t>(ring_capacity, 2));
+  const std::size_t slots_offset = sizeof(market_bus_header);
+  const std::size_t ring_offset = align_up(slots_offset + max_symbols * sizeof(market_bus_slot), 64);
+  const std::size_t size = ring_offset + ring_capacity * sizeof(market_bus_event);
+
+  const std::string path = "/" + name;
+  shm_unlink(path.c_str()); // a region left behind by a previous run
+  const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    std::cerr << "Unable to create shared memory " << path << ": " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    std::cerr << "Unable to size shared memory " << path << ": " << std::strerror(errno) << std::endl;
+    ::close(fd);
+    shm_unlink(path.c_str());
+    return false;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    std::cerr << "Unable to map shared memory " << path << ": " << std::strerror(errno) << std::endl;
+    shm_unlink(path.c_str());
+    return false;
+  }
+
+  name_ = name;
+  base_ = base;
+  size_ = size;
+  header_ = static_cast<market_bus_header*>(base);
+  slots_ = reinterpret_cast<market_bus_slot*>(static_cast<char*>(base) + slots_offset);
+  events_ = reinterpret_cast<market_bus_event*>(static_cast<char*>(base) + ring_offset);
+  index_.clear();
+
+  // a fresh object is zero-filled; the magic goes in last so readers never see a half-written header
+  header_->version = MARKET_BUS_VERSION;
+  header_->max_symbols = max_symbols;
+  header_->ring_capacity = ring_capacity;
+  header_->slot_size = sizeof(market_bus_slot);
+  header_->event_size = sizeof(market_bus_event);
+  header_->slots_offset = slots_offset;
+  header_->ring_offset = ring_offset;
+  header_->total_size = size;
+  header_->writer_pid = static_cast<std::uint32_t>(getpid());
+  std::atomic_ref<std::uint32_t>(header_->magic).store(MARKET_BUS_MAGIC, std::memory_order_release);
+  return true;
+}
+
+void MarketBus::close() {
+  if (!base_) {
+    return;
+  }
+  munmap(base_, size_);
+  shm_unlink(("/" + name_).c_str());
+  base_ = nullptr;
+  header_ = nullptr;
+  slots_ = nullptr;
+  events_ = nullptr;
+  size_ = 0;
+}
+
+std::uint32_t MarketBus::add_symbol(const std::string& symbol) {
+  auto it = index_.find(symbol);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  const std::uint32_t index = header_ ? header_->symbol_count : 0;
+  if (!header_ || index == header_->max_symbols || symbol.size() >= MARKET_BUS_SYMBOL_LENGTH) {
+    return UINT32_MAX;
+  }
+  std::memcpy(slots_[index].symbol, symbol.c_str(), symbol.size() + 1);
+  std::atomic_ref<std::uint32_t>(header_->symbol_count).store(index + 1, std::memory_order_release);
+  index_.emplace(symbol, index);
+  return index;
+}
+
+void MarketBus::touch() {
+  std::atomic_ref<std::int64_t>(header_->updated_ms).store(static_cast<std::int64_t>(Clock::wall_ms()),
+                                                           std::memory_order_relaxed);
+}
+
+void MarketBus::publish_trade(const Coin& coin, const CoinData& trade) {
+  const std::uint32_t index = add_symbol(trade.symbol);
+  if (index == UINT32_MAX) {
+    return;
+  }
+  market_bus_slot& slot = slots_[index];
+  const MovingAverage& average = coin.moving_average();
+  const std::uint64_t sequence = atomic(slot.sequence).load(std::memory_order_relaxed);
+  atomic(slot.sequence).store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.price = trade.price;
+  slot.quantity = trade.trade_quantity;
+  slot.trade_id = trade.trade_id;
+  slot.trade_time = trade.trade_time;
+  slot.moving_average = average.is_ready() ? average.get_value() : 0.0;
+  slot.trade_count += 1;
+  slot.volume += trade.trade_quantity;
+  atomic(slot.sequence).store(sequence + 2, std::memory_order_release);
+
+  // the ring entry is stamped 0 while it is rewritten, so a reader copying the old event notices
+  const std::uint64_t head = atomic(header_->head).load(std::memory_order_relaxed);
+  market_bus_event& event = events_[head & (header_->ring_capacity - 1)];
+  atomic(event.stamp).store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.symbol = index;
+  event.trade_time = trade.trade_time;
+  event.trade_id = trade.trade_id;
+  event.price = trade.price;
+  event.quantity = trade.trade_quantity;
+  event.bid = slot.bid;
+  event.ask = slot.ask;
+  atomic(event.stamp).store(head + 1, std::memory_order_release);
+  atomic(header_->head).store(head + 1, std::memory_order_release);
+  touch();
+}
+
+void MarketBus::publish_quote(const Quote& quote) {
+  const std::uint32_t index = add_symbol(quote.instrument);
+  if (index == UINT32_MAX) {
+    return;
+  }
+  market_bus_slot& slot = slots_[index];
+  const std::uint64_t sequence = atomic(slot.sequence).load(std::memory_order_relaxed);
+  atomic(slot.sequence).store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.bid = quote.bid;
+  slot.bid_quantity = quote.bid_quantity;
+  slot.ask = quote.ask;
+  slot.ask_quantity = quote.ask_quantity;
+  slot.quote_time = quote.time;
+  atomic(slot.sequence).store(sequence + 2, std::memory_order_release);
+  touch();
+}
+
+std::uint64_t MarketBus::published() const {
+  return header_ ? std::atomic_ref<std::uint64_t>(header_->head).load(std::memory_order_relaxed) : 0;
+}
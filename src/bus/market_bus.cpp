@@ -0,0 +1,147 @@
+#include "../../include/bus/market_bus.h"
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Readers map the region PROT_READ. The atomic loads below only read, so the const_casts never lead to a store.
+
+struct market_bus {
+  const void* base;
+  std::size_t size;
+  const market_bus_header* header;
+  const market_bus_slot* slots;
+  const market_bus_event* events;
+};
+
+namespace {
+  template <typename T>
+  T load(const T& value, std::memory_order order) {
+    return std::atomic_ref<T>(const_cast<T&>(value)).load(order);
+  }
+}
+
+extern "C" {
+
+market_bus* market_bus_open(const char* name) {
+  const std::string path = std::string("/") + name;
+  const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat info{};
+  if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(market_bus_header)) {
+    close(fd);
+    return nullptr;
+  }
+  const auto size = static_cast<std::size_t>(info.st_size);
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  const auto* header = static_cast<const market_bus_header*>(base);
+  if (load(header->magic, std::memory_order_acquire) != MARKET_BUS_MAGIC || header->version != MARKET_BUS_VERSION
+      || header->slot_size != sizeof(market_bus_slot) || header->event_size != sizeof(market_bus_event)
+      || header->total_size > size) {
+    munmap(base, size);
+    return nullptr;
+  }
+  const auto* bytes = static_cast<const char*>(base);
+  return new market_bus{base, size, header, reinterpret_cast<const market_bus_slot*>(bytes + header->slots_offset),
+                        reinterpret_cast<const market_bus_event*>(bytes + header->ring_offset)};
+}
+
+void market_bus_close(market_bus* bus) {
+  if (!bus) {
+    return;
+  }
+  munmap(const_cast<void*>(bus->base), bus->size);
+  delete bus;
+}
+
+const void* market_bus_data(const market_bus* bus) {
+  return bus->base;
+}
+
+uint64_t market_bus_size(const market_bus* bus) {
+  return bus->header->total_size;
+}
+
+uint32_t market_bus_symbol_count(const market_bus* bus) {
+  return load(bus->header->symbol_count, std::memory_order_acquire);
+}
+
+int32_t market_bus_find(const market_bus* bus, const char* symbol) {
+  const uint32_t count = market_bus_symbol_count(bus);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (std::strncmp(bus->slots[i].symbol, symbol, MARKET_BUS_SYMBOL_LENGTH) == 0) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+int market_bus_read_slot(const market_bus* bus, uint32_t index, market_bus_slot* out) {
+  if (index >= market_bus_symbol_count(bus)) {
+    return -1;
+  }
+  const market_bus_slot& slot = bus->slots[index];
+  for (int attempt = 0; attempt < MARKET_BUS_READ_RETRIES; ++attempt) {
+    const uint64_t before = load(slot.sequence, std::memory_order_acquire);
+    if (before & 1) {
+      continue;
+    }
+    std::memcpy(out, &slot, sizeof(market_bus_slot));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (load(slot.sequence, std::memory_order_relaxed) == before) {
+      out->sequence = before;
+      return 0;
+    }
+  }
+  return -2;
+}
+
+uint64_t market_bus_head(const market_bus* bus) {
+  return load(bus->header->head, std::memory_order_acquire);
+}
+
+size_t market_bus_poll(const market_bus* bus, uint64_t* cursor, market_bus_event* out, size_t max, uint64_t* lost) {
+  const uint64_t capacity = bus->header->ring_capacity;
+  uint64_t head = market_bus_head(bus);
+  uint64_t next = *cursor;
+  uint64_t skipped = 0;
+  size_t copied = 0;
+  while (next < head && copied < max) {
+    if (head - next > capacity) {
+      skipped += head - capacity - next;
+      next = head - capacity;
+    }
+    const market_bus_event& event = bus->events[next & (capacity - 1)];
+    const uint64_t stamp = load(event.stamp, std::memory_order_acquire);
+    if (stamp == next + 1) {
+      std::memcpy(&out[copied], &event, sizeof(market_bus_event));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (load(event.stamp, std::memory_order_relaxed) == stamp) {
+        ++copied;
+        ++next;
+        continue;
+      }
+    }
+    // the event was published but has since been overwritten: the writer lapped us, so it is lost and the
+    // next pass skips ahead to the oldest event still in the ring
+    ++skipped;
+    ++next;
+    head = market_bus_head(bus);
+  }
+  *cursor = next;
+  if (lost) {
+    *lost = skipped;
+  }
+  return copied;
+}
+
+}
@@ -11,6 +11,10 @@
 #include "../../include/common/Coin.h"
 
 #include "../../include/common/Visualizer.h"
+#include "../../include/metrics/LatencyTracker.h"
+#include "../../include/metrics/MetricsRegistry.h"
+#include "../../include/metrics/PerfCounters.h"
+#include "../../include/metrics/Tracer.h"
 
 using json = nlohmann::json;
 
@@ -20,8 +24,25 @@ public:
   long long message_id = 0;
   bool is_connected = false;
   CoinManager& coin_manager_;
-
-  Impl(CoinManager& manager) : web_socket(std::make_unique<ix::WebSocket>()), coin_manager_(manager) {}
+  MessageStamps stamps{};
+  bool stamping = false; // current message was picked by the latency tracker
+  bool was_connected = false;
+
+  Counter& messages_metric;
+  Counter& parse_errors_metric;
+  Counter& reconnects_metric;
+  Counter& disconnects_metric;
+  Gauge& connected_metric;
+
+  Impl(CoinManager& manager) :
+    web_socket(std::make_unique<ix::WebSocket>()),
+    coin_manager_(manager),
+    messages_metric(METRICS.counter("binance_messages_total", "WebSocket messages received")),
+    parse_errors_metric(METRICS.counter("binance_parse_errors_total",
+                                        "Messages that were not valid JSON or lacked fields")),
+    reconnects_metric(METRICS.counter("binance_reconnects_total", "Connections re-established after the first")),
+    disconnects_metric(METRICS.counter("binance_disconnects_total", "Connection closes and errors")),
+    connected_metric(METRICS.gauge("binance_connected", "1 while the WebSocket is open")) {}
   ~Impl() {
     if (web_socket) {
       web_socket->stop();
@@ -34,6 +55,7 @@ public:
   void handle_message(const ix::WebSocketMessagePtr &msg);
   void handle_ticker(const json &msg);
   void handle_trade(const json &msg);
+  void handle_book_ticker(const json &msg);
 
   void setup_websocket(const std::string& url) {
     ix::initNetSystem();
@@ -80,6 +102,30 @@ bool BinanceClient::is_connected() const {
   return pImpl->is_connected;
 }
 
+namespace {
+  std::vector<std::string> instrument_streams(const std::vector<std::string>& instruments) {
+    std::vector<std::string> streams;
+    for (const std::string& instrument : instruments) {
+      std::string symbol = instruments::to_venue(Venue::binance, instrument);
+      std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
+      if (symbol.empty()) {
+        symbol = instrument; // unknown quote currency, Binance may still list it
+      }
+      streams.push_back(symbol + "@trade");
+      streams.push_back(symbol + "@bookTicker");
+    }
+    return streams;
+  }
+}
+
+void BinanceClient::subscribe(const std::vector<std::string>& instruments) {
+  subscribe_to_streams(instrument_streams(instruments));
+}
+
+void BinanceClient::unsubscribe(const std::vector<std::string>& instruments) {
+  unsubscribe_from_streams(instrument_streams(instruments));
+}
+
 
 void BinanceClient::Impl::send_message(const std::string& message) {
   if (is_connected) {
@@ -91,11 +137,17 @@ void BinanceClient::Impl::send_message(const std::string& message) {
 }
 
 void BinanceClient::Impl::parse_raw_message(const std::string &raw_message) {
-  if (!json::accept(raw_message)) {
-    std::cerr << "Failed to parse message: " << std::endl;
-    return;
+  json msg;
+  {
+    TRACE_SCOPE("parse");
+    PERF_SCOPE(PERF_PARSE);
+    if (!json::accept(raw_message)) {
+      parse_errors_metric.inc();
+      std::cerr << "Failed to parse message: " << std::endl;
+      return;
+    }
+    msg = json::parse(raw_message);
   }
-  json msg = json::parse(raw_message);
 
   if (msg.is_object() && msg.contains("result") && msg.contains("id")) {
     if (msg["result"].is_null()) {
@@ -114,6 +166,9 @@ void BinanceClient::Impl::parse_raw_message(const std::string &raw_message) {
     } else if (event_type == "24hrTicker") {
       handle_ticker(msg);
     }
+  } else if (msg.is_object() && msg.contains("u") && msg.contains("b") && msg.contains("a")) {
+    // book ticker updates carry no event type
+    handle_book_ticker(msg);
   }
 }
 
@@ -121,16 +176,36 @@ void BinanceClient::Impl::parse_raw_message(const std::string &raw_message) {
 void BinanceClient::Impl::handle_message(const ix::WebSocketMessagePtr& msg) {
   if (msg->type == ix::WebSocketMessageType::Message) {
     // std::cout << "received message: " << msg->str << std::endl;
+    TRACE_SCOPE("receive");
+    messages_metric.inc();
+    stamping = LATENCY_TRACKER.begin_message();
+    if (stamping) {
+      stamps.receive_tick = Clock::ticks();
+    }
     parse_raw_message(msg->str);
+    stamping = false;
   } else if (msg->type == ix::WebSocketMessageType::Open) {
     std::cout << "Connection established." << std::endl;
+    TRACER.name_thread("websocket");
+    TRACER.instant("connection open");
     is_connected = true;
+    connected_metric.set(1);
+    if (was_connected) {
+      reconnects_metric.inc();
+    }
+    was_connected = true;
   } else if (msg->type == ix::WebSocketMessageType::Close) {
     std::cout << "Connection closed." << std::endl;
+    TRACER.instant("connection closed");
     is_connected = false;
+    connected_metric.set(0);
+    disconnects_metric.inc();
   } else if (msg->type == ix::WebSocketMessageType::Error) {
     std::cout << "WebSocket message error." << msg->errorInfo.reason << std::endl;
+    TRACER.instant("connection error");
     is_connected = false;
+    connected_metric.set(0);
+    disconnects_metric.inc();
   } else if (msg->type == ix::WebSocketMessageType::Ping) {
     // std::cout << "Ping received." << std::endl;
   }
@@ -163,6 +238,7 @@ void BinanceClient::Impl::handle_ticker(const json &msg) {
 void BinanceClient::Impl::handle_trade(const json &msg) {
   if (!msg.is_object() || !msg.contains("s") || !msg.contains("t") || !msg.contains("p") ||
     !msg.contains("q") || !msg.contains("T") || !msg.contains("m")) {
+    parse_errors_metric.inc();
     std::cerr << "Missing required ticker fields" << std::endl;
     return;
     }
@@ -176,10 +252,44 @@ void BinanceClient::Impl::handle_trade(const json &msg) {
   data.trade_quantity = std::stod(msg["q"].get<std::string>());  // String -> double
   data.trade_time = msg["T"].get<long>();
 
-  coin_manager_.update_coin_data(data);
+  if (stamping) {
+    stamps.exchange_time_ms = msg.contains("E") ? msg["E"].get<long>() : data.trade_time;
+    stamps.parse_tick = Clock::ticks();
+  }
+
+  {
+    TRACE_SCOPE("update");
+    coin_manager_.on_trade(Venue::binance, data);
+  }
+  if (stamping) {
+    stamps.apply_tick = Clock::ticks();
+  }
 
-  display_prices(coin_manager_);
+  {
+    TRACE_SCOPE("render");
+    display_prices(coin_manager_);
+  }
+  if (stamping) {
+    stamps.render_tick = Clock::ticks();
+    LATENCY_TRACKER.record(stamps);
+  }
 }
 
 
 
+
+void BinanceClient::Impl::handle_book_ticker(const json &msg) {
+  if (!msg.contains("s") || !msg.contains("B") || !msg.contains("A")) {
+    parse_errors_metric.inc();
+    std::cerr << "Missing required book ticker fields" << std::endl;
+    return;
+  }
+  Quote quote;
+  quote.instrument = instruments::from_venue(Venue::binance, msg["s"].get<std::string>());
+  quote.bid = std::stod(msg["b"].get<std::string>());
+  quote.bid_quantity = std::stod(msg["B"].get<std::string>());
+  quote.ask = std::stod(msg["a"].get<std::string>());
+  quote.ask_quantity = std::stod(msg["A"].get<std::string>());
+  quote.time = msg.contains("T") ? msg["T"].get<long>() : 0;
+  coin_manager_.on_quote(Venue::binance, quote);
+}
@@ -0,0 +1,152 @@
+#include "../../include/exchange/OrderBook.h"
+#include <algorithm>
+
+#define ORDER_SLOT_NONE UINT32_MAX
+
+namespace {
+  // bids are kept ascending and asks descending, so in both the best level is at the back
+  template<typename Levels>
+  auto find_level(Levels& levels, OrderSide side, std::int64_t price) {
+    if (side == OrderSide::buy) {
+      return std::lower_bound(levels.begin(), levels.end(), price,
+                              [](const auto& level, std::int64_t p) { return level.price < p; });
+    }
+    return std::lower_bound(levels.begin(), levels.end(), price,
+                            [](const auto& level, std::int64_t p) { return level.price > p; });
+  }
+}
+
+OrderBook::OrderBook(std::size_t expected_orders) {
+  orders_.reserve(expected_orders);
+  free_.reserve(expected_orders);
+  index_.reserve(expected_orders);
+}
+
+std::uint32_t OrderBook::allocate(std::uint64_t id, OrderSide side, std::int64_t price, std::int64_t quantity) {
+  std::uint32_t slot;
+  if (!free_.empty()) {
+    slot = free_.back();
+    free_.pop_back();
+  } else {
+    slot = static_cast<std::uint32_t>(orders_.size());
+    orders_.emplace_back();
+  }
+  orders_[slot] = {id, price, quantity, ORDER_SLOT_NONE, ORDER_SLOT_NONE, side};
+  return slot;
+}
+
+void OrderBook::release(std::uint32_t slot) {
+  index_.erase(orders_[slot].id);
+  free_.push_back(slot);
+}
+
+void OrderBook::rest(std::uint32_t slot) {
+  Order& order = orders_[slot];
+  std::vector<Level>& levels = order.side == OrderSide::buy ? bids_ : asks_;
+  auto it = find_level(levels, order.side, order.price);
+  if (it == levels.end() || it->price != order.price) {
+    it = levels.insert(it, Level{order.price, 0, ORDER_SLOT_NONE, ORDER_SLOT_NONE});
+  }
+  Level& level = *it;
+  order.prev = level.tail;
+  if (level.tail != ORDER_SLOT_NONE) {
+    orders_[level.tail].next = slot;
+  } else {
+    level.head = slot;
+  }
+  level.tail = slot;
+  level.quantity += order.remaining;
+  index_.emplace(order.id, slot);
+}
+
+template<typename Cross>
+std::int64_t OrderBook::match(std::vector<Level>& levels, Cross cross, std::uint64_t taker_id, OrderSide taker_side,
+                              std::int64_t quantity, std::vector<BookFill>& fills) {
+  while (quantity > 0 && !levels.empty() && cross(levels.back().price)) {
+    Level& level = levels.back();
+    while (quantity > 0 && level.head != ORDER_SLOT_NONE) {
+      Order& maker = orders_[level.head];
+      const std::int64_t traded = std::min(quantity, maker.remaining);
+      fills.push_back({maker.id, taker_id, taker_side, level.price, traded});
+      maker.remaining -= traded;
+      level.quantity -= traded;
+      quantity -= traded;
+      if (maker.remaining == 0) {
+        const std::uint32_t slot = level.head;
+        level.head = maker.next;
+        if (level.head != ORDER_SLOT_NONE) {
+          orders_[level.head].prev = ORDER_SLOT_NONE;
+        } else {
+          level.tail = ORDER_SLOT_NONE;
+        }
+        release(slot);
+      }
+    }
+    if (level.head == ORDER_SLOT_NONE) {
+      levels.pop_back();
+    }
+  }
+  return quantity;
+}
+
+std::int64_t OrderBook::add(std::uint64_t id, OrderSide side, std::int64_t price, std::int64_t quantity, bool rest,
+                            std::vector<BookFill>& fills) {
+  std::int64_t left;
+  if (side == OrderSide::buy) {
+    left = match(asks_, [price](std::int64_t ask) { return ask <= price; }, id, side, quantity, fills);
+  } else {
+    left = match(bids_, [price](std::int64_t bid) { return bid >= price; }, id, side, quantity, fills);
+  }
+  if (left > 0 && rest && price != MARKET_BUY_PRICE && price != MARKET_SELL_PRICE) {
+    this->rest(allocate(id, side, price, left));
+  }
+  return left;
+}
+
+bool OrderBook::cancel(std::uint64_t id) {
+  auto found = index_.find(id);
+  if (found == index_.end()) {
+    return false;
+  }
+  const std::uint32_t slot = found->second;
+  const Order& order = orders_[slot];
+  std::vector<Level>& levels = order.side == OrderSide::buy ? bids_ : asks_;
+  auto level = find_level(levels, order.side, order.price);
+
+  if (order.prev != ORDER_SLOT_NONE) {
+    orders_[order.prev].next = order.next;
+  } else {
+    level->head = order.next;
+  }
+  if (order.next != ORDER_SLOT_NONE) {
+    orders_[order.next].prev = order.prev;
+  } else {
+    level->tail = order.prev;
+  }
+  level->quantity -= order.remaining;
+  if (level->head == ORDER_SLOT_NONE) {
+    levels.erase(level);
+  }
+  release(slot);
+  return true;
+}
+
+void OrderBook::on_trade(std::int64_t price, std::int64_t quantity, std::vector<BookFill>& fills) {
+  match(bids_, [price](std::int64_t bid) { return bid >= price; }, 0, OrderSide::sell, quantity, fills);
+  match(asks_, [price](std::int64_t ask) { return ask <= price; }, 0, OrderSide::buy, quantity, fills);
+}
+
+std::int64_t OrderBook::quantity_at(OrderSide side, std::int64_t price) const {
+  const std::vector<Level>& levels = side == OrderSide::buy ? bids_ : asks_;
+  auto level = find_level(levels, side, price);
+  return level != levels.end() && level->price == price ? level->quantity : 0;
+}
+
+std::int64_t OrderBook::remaining(std::uint64_t id) const {
+  auto found = index_.find(id);
+  return found == index_.end() ? 0 : orders_[found->second].remaining;
+}
+
+std::size_t OrderBook::level_count(OrderSide side) const {
+  return side == OrderSide::buy ? bids_.size() : asks_.size();
+}
@@ -0,0 +1,580 @@
+#include "../../include/exchange/OrderGateway.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/ssl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "../../include/common/Clock.h"
+
+namespace {
+  // what place_order() writes after the price: "&timestamp=" with at most 20 digits, "&signature=" and the
+  // signature; the quantity also leaves room for "&price="
+  constexpr std::size_t ORDER_PARAMS_TAIL = 11 + 20 + 11 + HMAC_SHA256_HEX_SIZE;
+  constexpr std::size_t ORDER_PRICE_KEY = 7;
+
+  std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+  }
+
+  std::string upper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+    return s;
+  }
+
+  char* write_text(char* out, const char* text) {
+    while (*text) {
+      *out++ = *text++;
+    }
+    return out;
+  }
+
+  // monotonic, for connection idle times
+  std::int64_t steady_ms() {
+    return Clock::now_ns() / 1000000;
+  }
+}
+
+OrderGateway::OrderGateway(GatewayConfig config) :
+  config_(std::move(config)), ssl_context_(nullptr), signer_(config_.secret_key), connects_(0),
+  blocked_until_ms_(0), time_offset_ms_(0), running_(false), sending_(false) {
+  if (config_.binance_limits) {
+    limiter_.add_limit(RateLimitKind::request_weight, 60000, 6000);
+    limiter_.add_limit(RateLimitKind::orders, 10000, 100);
+    limiter_.add_limit(RateLimitKind::orders, 86400000, 200000);
+  }
+  endpoints_ = {{"POST /api/v3/order", {1, 1}},   {"DELETE /api/v3/order", {1, 0}},
+                {"GET /api/v3/order", {4, 0}},    {"GET /api/v3/openOrders", {6, 0}},
+                {"GET /api/v3/ping", {1, 0}},     {"GET /api/v3/time", {1, 0}}};
+  if (config_.tls) {
+    ssl_context_ = SSL_CTX_new(TLS_client_method());
+    if (!ssl_context_) {
+      std::cerr << "Order gateway cannot create a TLS context" << std::endl;
+      return;
+    }
+    SSL_CTX_set_default_verify_paths(ssl_context_);
+    SSL_CTX_set_verify(ssl_context_, SSL_VERIFY_PEER, nullptr);
+  }
+}
+
+OrderGateway::~OrderGateway() {
+  stop();
+  SSL_CTX_free(ssl_context_);
+}
+
+bool OrderGateway::start() {
+  running_ = true;
+  for (std::size_t i = 0; i < config_.connections; ++i) {
+    Connection connection{};
+    if (open(connection)) {
+      release(connection);
+    }
+  }
+  if (connects_ == 0) {
+    running_ = false;
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    sending_ = true;
+  }
+  sender_thread_ = std::thread(&OrderGateway::send_loop, this);
+  if (config_.keepalive_ms > 0) {
+    keepalive_thread_ = std::thread(&OrderGateway::keepalive_loop, this);
+  }
+  return true;
+}
+
+void OrderGateway::stop() {
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    sending_ = false;
+  }
+  send_wake_.notify_all();
+  if (sender_thread_.joinable()) {
+    sender_thread_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(keepalive_mutex_);
+    running_ = false;
+  }
+  keepalive_wake_.notify_all();
+  if (keepalive_thread_.joinable()) {
+    keepalive_thread_.join();
+  }
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  for (Connection& connection : idle_) {
+    close(connection);
+  }
+  idle_.clear();
+}
+
+bool OrderGateway::open(Connection& connection) {
+  if (config_.tls && !ssl_context_) {
+    return false;
+  }
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (::getaddrinfo(config_.host.c_str(), std::to_string(config_.port).c_str(), &hints, &addresses) != 0) {
+    std::cerr << "Order gateway cannot resolve " << config_.host << std::endl;
+    return false;
+  }
+  connection.fd = -1;
+  for (addrinfo* address = addresses; address; address = address->ai_next) {
+    int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+      connection.fd = fd;
+      break;
+    }
+    ::close(fd);
+  }
+  ::freeaddrinfo(addresses);
+  if (connection.fd < 0) {
+    std::cerr << "Order gateway cannot connect to " << config_.host << ":" << config_.port << std::endl;
+    return false;
+  }
+
+  int one = 1;
+  ::setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  timeval timeout{config_.timeout_ms / 1000, (config_.timeout_ms % 1000) * 1000};
+  ::setsockopt(connection.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  ::setsockopt(connection.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  connection.ssl = nullptr;
+  if (config_.tls) {
+    connection.ssl = SSL_new(ssl_context_);
+    SSL_set_fd(connection.ssl, connection.fd);
+    SSL_set_tlsext_host_name(connection.ssl, config_.host.c_str());
+    SSL_set1_host(connection.ssl, config_.host.c_str());
+    if (SSL_connect(connection.ssl) != 1) {
+      std::cerr << "Order gateway TLS handshake with " << config_.host << " failed" << std::endl;
+      close(connection);
+      return false;
+    }
+  }
+  connection.last_used_ms = steady_ms();
+  ++connects_;
+  return true;
+}
+
+void OrderGateway::close(Connection& connection) {
+  if (connection.ssl) {
+    SSL_free(connection.ssl);
+    connection.ssl = nullptr;
+  }
+  if (connection.fd >= 0) {
+    ::close(connection.fd);
+    connection.fd = -1;
+  }
+}
+
+bool OrderGateway::acquire(Connection& connection) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    while (!idle_.empty()) {
+      connection = idle_.back();
+      idle_.pop_back();
+      // an idle HTTP connection has nothing to read unless the server closed it; with TLS it may also
+      // hold session tickets, which SSL_read consumes
+      char probe;
+      const ssize_t n = ::recv(connection.fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+      if (n > 0 ? connection.ssl != nullptr : n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+      }
+      close(connection);
+    }
+  }
+  return open(connection);
+}
+
+void OrderGateway::release(Connection& connection) {
+  connection.last_used_ms = steady_ms();
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  idle_.push_back(connection);
+}
+
+bool OrderGateway::write_all(Connection& connection, const char* data, std::size_t size) {
+  std::size_t offset = 0;
+  while (offset < size) {
+    const ssize_t n = connection.ssl
+                        ? SSL_write(connection.ssl, data + offset, static_cast<int>(size - offset))
+                        : ::send(connection.fd, data + offset, size - offset, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    offset += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool OrderGateway::read_response(Connection& connection, GatewayResponse& response, bool& keep_alive) {
+  std::string input;
+  char buffer[GATEWAY_READ_CHUNK];
+  auto more = [&]() {
+    const ssize_t n = connection.ssl ? SSL_read(connection.ssl, buffer, sizeof(buffer))
+                                     : ::recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return false;
+    }
+    input.append(buffer, static_cast<std::size_t>(n));
+    return true;
+  };
+
+  std::size_t header_end;
+  while ((header_end = input.find("\r\n\r\n")) == std::string::npos) {
+    if (!more()) {
+      return false;
+    }
+  }
+  if (input.compare(0, 5, "HTTP/") != 0 || input.size() < 12) {
+    return false;
+  }
+  response.status = std::atoi(input.c_str() + 9);
+
+  long content_length = -1;
+  bool chunked = false;
+  const std::int64_t now_ms = timestamp_ms();
+  for (std::size_t line = input.find("\r\n") + 2; line < header_end;) {
+    std::size_t line_end = input.find("\r\n", line);
+    std::size_t colon = input.find(':', line);
+    if (colon < line_end) {
+      const std::string name = lower(input.substr(line, colon - line));
+      const std::size_t value_start = std::min(input.find_first_not_of(' ', colon + 1), line_end);
+      const std::string value = input.substr(value_start, line_end - value_start);
+      if (name == "content-length") {
+        content_length = std::strtol(value.c_str(), nullptr, 10);
+      } else if (name == "transfer-encoding") {
+        chunked = lower(value).find("chunked") != std::string::npos;
+      } else if (name == "connection") {
+        keep_alive = lower(value) != "close";
+      } else if (name == "retry-after" && (response.status == 429 || response.status == 418)) {
+        blocked_until_ms_ = now_ms + std::strtoll(value.c_str(), nullptr, 10) * 1000;
+      } else if (name.rfind("x-mbx-used-weight-", 0) == 0) {
+        limiter_.sync(RateLimitKind::request_weight, RateLimiter::parse_interval(name.substr(18)),
+                      static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)), now_ms);
+      } else if (name.rfind("x-mbx-order-count-", 0) == 0) {
+        limiter_.sync(RateLimitKind::orders, RateLimiter::parse_interval(name.substr(18)),
+                      static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)), now_ms);
+      }
+    }
+    line = line_end + 2;
+  }
+
+  std::size_t position = header_end + 4;
+  if (chunked) {
+    while (true) {
+      std::size_t size_end;
+      while ((size_end = input.find("\r\n", position)) == std::string::npos) {
+        if (!more()) {
+          return false;
+        }
+      }
+      const std::size_t chunk = std::strtoul(input.c_str() + position, nullptr, 16);
+      position = size_end + 2;
+      while (input.size() < position + chunk + 2) {
+        if (!more()) {
+          return false;
+        }
+      }
+      if (chunk == 0) {
+        return true;
+      }
+      response.body.append(input, position, chunk);
+      position += chunk + 2;
+    }
+  }
+  if (content_length < 0) {
+    keep_alive = false; // body runs until the server closes
+    while (more()) {
+    }
+    response.body = input.substr(position);
+    return true;
+  }
+  while (input.size() < position + static_cast<std::size_t>(content_length)) {
+    if (!more()) {
+      return false;
+    }
+  }
+  response.body = input.substr(position, static_cast<std::size_t>(content_length));
+  return true;
+}
+
+GatewayResponse OrderGateway::exchange(const std::string& endpoint, const char* wire, std::size_t size,
+                                       std::uint64_t trigger_tick) {
+  GatewayResponse response;
+  const std::int64_t now_ms = timestamp_ms();
+  if (now_ms < blocked_until_ms_) {
+    response.error = "blocked until Retry-After";
+    return response;
+  }
+  auto cost = endpoints_.find(endpoint);
+  const Endpoint charge = cost != endpoints_.end() ? cost->second : Endpoint{1, 0};
+  if (!limiter_.try_acquire(charge.weight, charge.orders, now_ms)) {
+    response.error = "rate limited";
+    return response;
+  }
+
+  Connection connection{};
+  if (!acquire(connection)) {
+    response.error = "connect failed";
+    return response;
+  }
+  const std::uint64_t start_tick = Clock::ticks();
+  if (!write_all(connection, wire, size)) {
+    close(connection);
+    response.error = "send failed";
+    return response;
+  }
+  const std::uint64_t sent_tick = Clock::ticks();
+  bool keep_alive = true;
+  const bool answered = read_response(connection, response, keep_alive);
+  const std::uint64_t done_tick = Clock::ticks();
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (trigger_tick) {
+      tick_to_sent_.record(Clock::ticks_to_ns(static_cast<std::int64_t>(sent_tick - trigger_tick)));
+    }
+    if (answered) {
+      round_trip_.record(Clock::ticks_to_ns(static_cast<std::int64_t>(done_tick - start_tick)));
+    }
+  }
+  if (answered && keep_alive) {
+    release(connection);
+  } else {
+    close(connection);
+  }
+  if (!answered) {
+    response.error = "no response";
+  }
+  return response;
+}
+
+std::size_t OrderGateway::prepare_order(const std::string& symbol, OrderSide side, OrderType type,
+                                        TimeInForce time_in_force, int price_decimals, int quantity_decimals) {
+  std::string body_prefix = "symbol=" + upper(symbol) + "&side=" + (side == OrderSide::buy ? "BUY" : "SELL");
+  if (type == OrderType::limit) {
+    body_prefix += std::string("&type=LIMIT&timeInForce=") + (time_in_force == TimeInForce::gtc ? "GTC" : "IOC");
+  } else {
+    body_prefix += "&type=MARKET";
+  }
+  body_prefix += "&recvWindow=" + std::to_string(config_.recv_window_ms) + "&";
+
+  auto order = std::make_unique<OrderTemplate>(signer_.with_prefix(body_prefix.data(), body_prefix.size()));
+  order->head = "POST /api/v3/order HTTP/1.1\r\nHost: " + config_.host + "\r\nX-MBX-APIKEY: " + config_.api_key +
+                "\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: ";
+  order->body_prefix = std::move(body_prefix);
+  order->has_price = type == OrderType::limit;
+  order->price_decimals = price_decimals;
+  order->quantity_decimals = quantity_decimals;
+  order->wire.reserve(order->head.size() + order->body_prefix.size() + 256);
+  templates_.push_back(std::move(order));
+  return templates_.size() - 1;
+}
+
+int OrderGateway::step_decimals(double step) {
+  int decimals = 0;
+  double scaled = step;
+  // a step such as 0.00001 is not exact in binary, so whole means within rounding of an integer
+  while (decimals < GATEWAY_MAX_DECIMALS && std::abs(scaled - std::round(scaled)) > 1e-9 * scaled) {
+    scaled *= 10.0;
+    ++decimals;
+  }
+  return decimals;
+}
+
+GatewayResponse OrderGateway::place_order(std::size_t template_id, double price, double quantity,
+                                          std::uint64_t trigger_tick) {
+  if (template_id >= templates_.size()) {
+    GatewayResponse response;
+    response.error = "unknown order template";
+    return response;
+  }
+  OrderTemplate& order = *templates_[template_id];
+  std::lock_guard<std::mutex> lock(order.mutex);
+
+  // the only bytes that change per order
+  char params[256];
+  char* const numbers_end = params + sizeof(params) - ORDER_PARAMS_TAIL;
+  char* out = write_text(params, "quantity=");
+  std::to_chars_result written =
+    std::to_chars(out, numbers_end - ORDER_PRICE_KEY, quantity, std::chars_format::fixed, order.quantity_decimals);
+  if (written.ec == std::errc() && order.has_price) {
+    out = write_text(written.ptr, "&price=");
+    written = std::to_chars(out, numbers_end, price, std::chars_format::fixed, order.price_decimals);
+  }
+  if (written.ec != std::errc()) {
+    GatewayResponse response;
+    response.error = "order quantity or price too long";
+    return response;
+  }
+  out = written.ptr;
+  out = write_text(out, "&timestamp=");
+  out = std::to_chars(out, params + sizeof(params), timestamp_ms()).ptr;
+  out = write_text(out, "&signature=");
+  const std::size_t signed_size = static_cast<std::size_t>(out - params) - 11;
+  order.signer.sign(params, signed_size, out);
+  out += HMAC_SHA256_HEX_SIZE;
+
+  const std::size_t params_size = static_cast<std::size_t>(out - params);
+  char length[24];
+  char* length_end = std::to_chars(length, length + sizeof(length), order.body_prefix.size() + params_size).ptr;
+  order.wire.assign(order.head);
+  order.wire.append(length, length_end);
+  order.wire.append("\r\n\r\n");
+  order.wire.append(order.body_prefix);
+  order.wire.append(params, params_size);
+  return exchange("POST /api/v3/order", order.wire.data(), order.wire.size(), trigger_tick);
+}
+
+SubmitResult OrderGateway::submit_order(std::size_t template_id, double price, double quantity,
+                                        std::uint64_t trigger_tick, OrderCallback on_response) {
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (!sending_) {
+      return SubmitResult::stopped;
+    }
+    if (send_queue_.size() >= GATEWAY_MAX_QUEUED) {
+      return SubmitResult::queue_full;
+    }
+    send_queue_.push_back({template_id, price, quantity, trigger_tick, std::move(on_response)});
+  }
+  send_wake_.notify_one();
+  return SubmitResult::queued;
+}
+
+GatewayResponse OrderGateway::cancel_order(const std::string& symbol, std::uint64_t order_id) {
+  const std::string params = "symbol=" + upper(symbol) + "&orderId=" + std::to_string(order_id);
+  return request("DELETE", "/api/v3/order", params, true);
+}
+
+GatewayResponse OrderGateway::request(const std::string& method, const std::string& path, const std::string& params,
+                                      bool sign) {
+  std::string query = params;
+  if (sign) {
+    query += (query.empty() ? "recvWindow=" : "&recvWindow=") + std::to_string(config_.recv_window_ms) +
+             "&timestamp=" + std::to_string(timestamp_ms());
+    HmacSha256 signer = signer_.with_prefix("", 0); // signer_ itself is shared between threads
+    query += "&signature=" + signer.sign(query);
+  }
+  std::string wire = method + " " + path + (query.empty() ? "" : "?" + query) + " HTTP/1.1\r\nHost: " + config_.host;
+  if (!config_.api_key.empty()) {
+    wire += "\r\nX-MBX-APIKEY: " + config_.api_key;
+  }
+  wire += "\r\nContent-Length: 0\r\n\r\n";
+  return exchange(method + " " + path, wire.data(), wire.size(), 0);
+}
+
+bool OrderGateway::sync_time() {
+  const std::int64_t sent_ms = Clock::wall_ms();
+  GatewayResponse response = request("GET", "/api/v3/time");
+  const std::int64_t received_ms = Clock::wall_ms();
+  const std::size_t field = response.body.find("\"serverTime\":");
+  if (response.status != 200 || field == std::string::npos) {
+    return false;
+  }
+  const std::int64_t server_ms = std::strtoll(response.body.c_str() + field + 13, nullptr, 10);
+  time_offset_ms_ = server_ms - (sent_ms + received_ms) / 2;
+  return true;
+}
+
+void OrderGateway::set_endpoint_weight(const std::string& method, const std::string& path, std::uint32_t weight,
+                                       std::uint32_t orders) {
+  endpoints_[method + " " + path] = {weight, orders};
+}
+
+std::int64_t OrderGateway::timestamp_ms() const {
+  return Clock::wall_ms() + time_offset_ms_.load(std::memory_order_relaxed);
+}
+
+void OrderGateway::keepalive_loop() {
+  const std::string ping = "GET /api/v3/ping HTTP/1.1\r\nHost: " + config_.host + "\r\n\r\n";
+  std::unique_lock<std::mutex> lock(keepalive_mutex_);
+  while (running_) {
+    keepalive_wake_.wait_for(lock, std::chrono::milliseconds(std::max(config_.keepalive_ms / 4, 1L)));
+    if (!running_) {
+      break;
+    }
+    lock.unlock();
+
+    // ping connections that sat idle for keepalive_ms, then top the pool back up
+    std::vector<Connection> stale;
+    std::size_t idle_count;
+    {
+      std::lock_guard<std::mutex> pool_lock(pool_mutex_);
+      const std::int64_t cutoff = steady_ms() - config_.keepalive_ms;
+      auto split = std::partition(idle_.begin(), idle_.end(),
+                                  [cutoff](const Connection& c) { return c.last_used_ms > cutoff; });
+      stale.assign(split, idle_.end());
+      idle_.erase(split, idle_.end());
+      idle_count = idle_.size();
+    }
+    for (Connection& connection : stale) {
+      GatewayResponse response;
+      bool keep_alive = true;
+      if (!limiter_.try_acquire(1, 0, timestamp_ms())) {
+        release(connection); // no weight to spare, try again next round
+        ++idle_count;
+      } else if (write_all(connection, ping.data(), ping.size()) && read_response(connection, response, keep_alive) &&
+                 keep_alive) {
+        release(connection);
+        ++idle_count;
+      } else {
+        close(connection);
+      }
+    }
+    for (; idle_count < config_.connections; ++idle_count) {
+      Connection connection{};
+      if (!open(connection)) {
+        break;
+      }
+      release(connection);
+    }
+
+    lock.lock();
+  }
+}
+
+void OrderGateway::send_loop() {
+  std::unique_lock<std::mutex> lock(send_mutex_);
+  while (true) {
+    send_wake_.wait(lock, [this] { return !sending_ || !send_queue_.empty(); });
+    if (!sending_) {
+      break;
+    }
+    QueuedOrder order = std::move(send_queue_.front());
+    send_queue_.pop_front();
+    lock.unlock();
+    // tick_to_order_sent is recorded here, on the sender thread, by exchange()
+    const GatewayResponse response = place_order(order.template_id, order.price, order.quantity, order.trigger_tick);
+    if (order.on_response) {
+      order.on_response(response);
+    }
+    lock.lock();
+  }
+
+  std::deque<QueuedOrder> unsent;
+  unsent.swap(send_queue_);
+  lock.unlock();
+  GatewayResponse stopped;
+  stopped.error = "gateway stopped";
+  for (QueuedOrder& order : unsent) {
+    if (order.on_response) {
+      order.on_response(stopped);
+    }
+  }
+}
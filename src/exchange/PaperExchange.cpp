@@ -0,0 +1,424 @@
+#include "../../include/exchange/PaperExchange.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+#include "../../include/net/HttpServer.h"
+
+using json = nlohmann::json;
+
+namespace {
+  std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+  }
+
+  std::string upper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+    return s;
+  }
+
+  // Binance sends decimals as strings
+  std::string decimal(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.8f", value);
+    return buffer;
+  }
+
+  HttpResponse reply(int status, const json& body) {
+    HttpResponse response;
+    response.status = status;
+    response.content_type = "application/json";
+    response.body = body.dump();
+    return response;
+  }
+
+  // Binance error payload, e.g. {"code":-1121,"msg":"Invalid symbol."}
+  HttpResponse error(int code, const std::string& message) {
+    return reply(400, json{{"code", code}, {"msg", message}});
+  }
+
+  json order_json(const PaperOrder& order) {
+    const PaperOrderRequest& request = order.request;
+    return json{{"symbol", upper(request.symbol)},
+                {"orderId", order.id},
+                {"clientOrderId", request.client_order_id},
+                {"price", decimal(request.price)},
+                {"origQty", decimal(request.quantity)},
+                {"executedQty", decimal(order.executed)},
+                {"cummulativeQuoteQty", decimal(order.quote_executed)},
+                {"status", PaperExchange::status_name(order.status)},
+                {"timeInForce", request.time_in_force == TimeInForce::gtc ? "GTC" : "IOC"},
+                {"type", request.type == OrderType::limit ? "LIMIT" : "MARKET"},
+                {"side", request.side == OrderSide::buy ? "BUY" : "SELL"},
+                {"time", order.created_ms},
+                {"updateTime", order.updated_ms}};
+  }
+
+  bool is_live(OrderStatus status) {
+    return status == OrderStatus::pending_new || status == OrderStatus::open ||
+           status == OrderStatus::partially_filled;
+  }
+
+  // value in whole units of unit, or -1 when it is not finite or too large for the book's integer prices
+  std::int64_t to_units(double value, double unit) {
+    const double units = value / unit;
+    return std::isfinite(units) && std::fabs(units) < 0x1p62 ? std::llround(units) : -1;
+  }
+
+  // a positive decimal, the whole parameter; false for anything else, including nan and inf
+  bool parse_positive(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size() && std::isfinite(value) && value > 0.0;
+  }
+}
+
+PaperExchange::PaperExchange(ExchangeConfig config) :
+  config_(config), request_fills_(nullptr), next_id_(1), now_ms_(0) {}
+
+bool PaperExchange::add_symbol(const std::string& symbol, double tick_size, double lot_size) {
+  if (!(std::isfinite(tick_size) && tick_size > 0.0 && std::isfinite(lot_size) && lot_size > 0.0)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  markets_.try_emplace(symbol, Market{tick_size, lot_size, OrderBook(config_.expected_orders)});
+  return true;
+}
+
+std::uint64_t PaperExchange::submit(const PaperOrderRequest& request, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return submit_locked(request, now_ms);
+}
+
+std::uint64_t PaperExchange::submit_locked(const PaperOrderRequest& request, std::int64_t now_ms) {
+  auto market = markets_.find(request.symbol);
+  if (market == markets_.end()) {
+    return 0;
+  }
+  const std::int64_t lots = to_units(request.quantity, market->second.lot_size);
+  const std::int64_t ticks = request.type == OrderType::limit ? to_units(request.price, market->second.tick_size) : 1;
+  if (lots <= 0 || ticks <= 0) {
+    return 0;
+  }
+
+  prune_locked();
+  now_ms_ = std::max(now_ms_, now_ms);
+  const std::uint64_t id = next_id_++;
+  PaperOrder order{id, request, OrderStatus::pending_new, 0.0, 0.0, now_ms, now_ms};
+  order.request.quantity = static_cast<double>(lots) * market->second.lot_size;
+  order.request.price =
+    request.type == OrderType::limit ? static_cast<double>(ticks) * market->second.tick_size : 0.0;
+  orders_.emplace(id, std::move(order));
+  if (!request.client_order_id.empty()) {
+    client_ids_[request.client_order_id] = id;
+  }
+  queue_.push_back({now_ms + config_.latency_ms, id, false});
+  advance_locked(now_ms);
+  return id;
+}
+
+bool PaperExchange::cancel(std::uint64_t order_id, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cancel_locked(order_id, now_ms);
+}
+
+bool PaperExchange::cancel_locked(std::uint64_t order_id, std::int64_t now_ms) {
+  auto order = orders_.find(order_id);
+  if (order == orders_.end() || !is_live(order->second.status)) {
+    return false;
+  }
+  now_ms_ = std::max(now_ms_, now_ms);
+  queue_.push_back({now_ms + config_.latency_ms, order_id, true});
+  advance_locked(now_ms);
+  return true;
+}
+
+void PaperExchange::advance(std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  now_ms_ = std::max(now_ms_, now_ms);
+  advance_locked(now_ms);
+}
+
+void PaperExchange::advance_locked(std::int64_t now_ms) {
+  while (!queue_.empty() && queue_.front().due_ms <= now_ms) {
+    const Action action = queue_.front();
+    queue_.pop_front();
+    execute(action);
+  }
+}
+
+void PaperExchange::execute(const Action& action) {
+  auto found = orders_.find(action.order_id);
+  if (found == orders_.end()) {
+    return; // a cancel for an order that finished and has since left the history
+  }
+  PaperOrder& order = found->second;
+  Market& market = markets_.at(order.request.symbol);
+  if (!action.cancel) {
+    activate(order, market);
+    return;
+  }
+  if (!is_live(order.status)) {
+    return; // filled while the cancel was on its way
+  }
+  market.book.cancel(order.id);
+  order.updated_ms = action.due_ms;
+  finish(order, OrderStatus::canceled);
+}
+
+void PaperExchange::activate(PaperOrder& order, Market& market) {
+  const PaperOrderRequest& request = order.request;
+  const bool buy = request.side == OrderSide::buy;
+  const bool limit = request.type == OrderType::limit;
+  const std::int64_t ticks = limit ? std::llround(request.price / market.tick_size)
+                                   : buy ? OrderBook::MARKET_BUY_PRICE : OrderBook::MARKET_SELL_PRICE;
+  const std::int64_t lots = std::llround(request.quantity / market.lot_size);
+
+  order.status = OrderStatus::open;
+  matches_.clear();
+  std::int64_t left = market.book.add(order.id, request.side, ticks, lots, false, matches_);
+  settle(market);
+
+  const double last = market.last_price;
+  const bool crosses_last = last > 0.0 && (!limit || (buy ? request.price >= last : request.price <= last));
+  if (left > 0 && config_.fill_at_last_trade && crosses_last) {
+    fill(order, last, static_cast<double>(left) * market.lot_size, false);
+    left = 0;
+  }
+
+  if (left > 0 && limit && request.time_in_force == TimeInForce::gtc) {
+    market.book.add(order.id, request.side, ticks, left, true, matches_);
+  } else if (left > 0) {
+    order.updated_ms = now_ms_;
+    finish(order, OrderStatus::expired);
+  }
+}
+
+void PaperExchange::settle(Market& market) {
+  for (const BookFill& match : matches_) {
+    const double price = static_cast<double>(match.price) * market.tick_size;
+    const double quantity = static_cast<double>(match.quantity) * market.lot_size;
+    if (match.maker_id) {
+      fill(orders_.at(match.maker_id), price, quantity, true);
+    }
+    if (match.taker_id) {
+      fill(orders_.at(match.taker_id), price, quantity, false);
+    }
+  }
+  matches_.clear();
+}
+
+void PaperExchange::fill(PaperOrder& order, double price, double quantity, bool maker) {
+  order.executed += quantity;
+  order.quote_executed += price * quantity;
+  order.updated_ms = now_ms_;
+  // compare in lots so rounding in the running sum cannot leave an order a hair short of filled
+  const double lot = markets_.at(order.request.symbol).lot_size;
+  if (std::llround(order.executed / lot) >= std::llround(order.request.quantity / lot)) {
+    finish(order, OrderStatus::filled);
+  } else {
+    order.status = OrderStatus::partially_filled;
+  }
+
+  const PaperFill paper_fill{order.id, order.request.symbol, order.request.side, price, quantity,
+                             price * quantity * config_.fee_rate, now_ms_, maker};
+  if (request_fills_ && !maker) {
+    request_fills_->push_back(paper_fill);
+  }
+  if (fill_handler_) {
+    fill_handler_(paper_fill);
+  }
+}
+
+void PaperExchange::finish(PaperOrder& order, OrderStatus status) {
+  order.status = status;
+  finished_.push_back(order.id);
+}
+
+void PaperExchange::prune_locked() {
+  while (finished_.size() > config_.order_history) {
+    auto order = orders_.find(finished_.front());
+    finished_.pop_front();
+    if (order == orders_.end()) {
+      continue;
+    }
+    const std::string& client_id = order->second.request.client_order_id;
+    if (auto mapped = client_ids_.find(client_id); mapped != client_ids_.end() && mapped->second == order->first) {
+      client_ids_.erase(mapped);
+    }
+    orders_.erase(order);
+  }
+}
+
+void PaperExchange::on_trade(const std::string& symbol, std::int64_t trade_time_ms, double price, double quantity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  now_ms_ = std::max(now_ms_, trade_time_ms);
+  // orders that arrived before this trade see the market as it was
+  advance_locked(trade_time_ms);
+  auto market = markets_.find(symbol);
+  if (market == markets_.end()) {
+    return;
+  }
+  Market& m = market->second;
+  m.book.on_trade(std::llround(price / m.tick_size), std::llround(quantity / m.lot_size), matches_);
+  settle(m);
+  m.last_price = price;
+}
+
+void PaperExchange::on_trade(const Coin&, const CoinData& trade) {
+  on_trade(trade.symbol, trade.trade_time, trade.price, trade.trade_quantity);
+}
+
+bool PaperExchange::order(std::uint64_t order_id, PaperOrder& out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto order = orders_.find(order_id);
+  if (order == orders_.end()) {
+    return false;
+  }
+  out = order->second;
+  return true;
+}
+
+std::vector<PaperOrder> PaperExchange::open_orders(const std::string& symbol) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PaperOrder> open;
+  for (const auto& [id, order] : orders_) {
+    if (is_live(order.status) && (symbol.empty() || order.request.symbol == symbol)) {
+      open.push_back(order);
+    }
+  }
+  std::sort(open.begin(), open.end(), [](const PaperOrder& a, const PaperOrder& b) { return a.id < b.id; });
+  return open;
+}
+
+void PaperExchange::set_fill_handler(std::function<void(const PaperFill&)> handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  fill_handler_ = std::move(handler);
+}
+
+std::uint64_t PaperExchange::find_locked(const std::string& symbol, const std::string& order_id,
+                                         const std::string& client_order_id) const {
+  std::uint64_t id = 0;
+  if (!order_id.empty()) {
+    id = std::strtoull(order_id.c_str(), nullptr, 10);
+  } else if (auto found = client_ids_.find(client_order_id); found != client_ids_.end()) {
+    id = found->second;
+  }
+  auto order = orders_.find(id);
+  return order != orders_.end() && order->second.request.symbol == symbol ? id : 0;
+}
+
+void PaperExchange::serve(HttpServer& server) {
+  server.route("GET", "/api/v3/ping", [](const HttpRequest&) { return reply(200, json::object()); });
+
+  server.route("GET", "/api/v3/time", [this](const HttpRequest&) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reply(200, json{{"serverTime", now_ms_}});
+  });
+
+  server.route("POST", "/api/v3/order", [this](const HttpRequest& http) {
+    PaperOrderRequest request;
+    request.symbol = lower(http.param("symbol"));
+    const std::string side = http.param("side");
+    const std::string type = http.param("type");
+    const std::string quantity = http.param("quantity");
+    if (request.symbol.empty() || side.empty() || type.empty() || quantity.empty()) {
+      return error(-1102, "Mandatory parameter symbol, side, type or quantity was not sent.");
+    }
+    if (side != "BUY" && side != "SELL") {
+      return error(-1100, "Illegal characters found in parameter 'side'.");
+    }
+    request.side = side == "BUY" ? OrderSide::buy : OrderSide::sell;
+    if (!parse_positive(quantity, request.quantity)) {
+      return error(-1013, "Invalid quantity.");
+    }
+    if (type == "LIMIT") {
+      const std::string price = http.param("price");
+      const std::string time_in_force = http.param("timeInForce");
+      if (price.empty() || time_in_force.empty()) {
+        return error(-1102, "Mandatory parameter price or timeInForce was not sent.");
+      }
+      if (time_in_force != "GTC" && time_in_force != "IOC") {
+        return error(-1100, "Illegal characters found in parameter 'timeInForce'.");
+      }
+      request.type = OrderType::limit;
+      if (!parse_positive(price, request.price)) {
+        return error(-1013, "Invalid price.");
+      }
+      request.time_in_force = time_in_force == "GTC" ? TimeInForce::gtc : TimeInForce::ioc;
+    } else if (type == "MARKET") {
+      request.type = OrderType::market;
+      request.time_in_force = TimeInForce::ioc;
+    } else {
+      return error(-1116, "Invalid orderType.");
+    }
+    request.client_order_id = http.param("newClientOrderId");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!markets_.count(request.symbol)) {
+      return error(-1121, "Invalid symbol.");
+    }
+    if (auto existing = client_ids_.find(request.client_order_id);
+        existing != client_ids_.end() && is_live(orders_.at(existing->second).status)) {
+      return error(-2010, "Duplicate order sent.");
+    }
+    std::vector<PaperFill> fills;
+    request_fills_ = &fills;
+    const std::uint64_t id = submit_locked(request, now_ms_);
+    request_fills_ = nullptr;
+    if (!id) {
+      return error(-1013, "Filter failure: LOT_SIZE or PRICE_FILTER.");
+    }
+
+    json body = order_json(orders_.at(id));
+    body["transactTime"] = now_ms_;
+    body["fills"] = json::array();
+    for (const PaperFill& fill : fills) {
+      body["fills"].push_back({{"price", decimal(fill.price)}, {"qty", decimal(fill.quantity)},
+                               {"commission", decimal(fill.fee)}});
+    }
+    return reply(200, body);
+  });
+
+  server.route("GET", "/api/v3/order", [this](const HttpRequest& http) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::uint64_t id =
+      find_locked(lower(http.param("symbol")), http.param("orderId"), http.param("origClientOrderId"));
+    if (!id) {
+      return error(-2013, "Order does not exist.");
+    }
+    return reply(200, order_json(orders_.at(id)));
+  });
+
+  server.route("DELETE", "/api/v3/order", [this](const HttpRequest& http) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::uint64_t id =
+      find_locked(lower(http.param("symbol")), http.param("orderId"), http.param("origClientOrderId"));
+    if (!id || !cancel_locked(id, now_ms_)) {
+      return error(-2011, "Unknown order sent.");
+    }
+    return reply(200, order_json(orders_.at(id)));
+  });
+
+  server.route("GET", "/api/v3/openOrders", [this](const HttpRequest& http) {
+    json body = json::array();
+    for (const PaperOrder& order : open_orders(lower(http.param("symbol")))) {
+      body.push_back(order_json(order));
+    }
+    return reply(200, body);
+  });
+}
+
+const char* PaperExchange::status_name(OrderStatus status) {
+  switch (status) {
+    case OrderStatus::pending_new: return "PENDING_NEW";
+    case OrderStatus::open: return "NEW";
+    case OrderStatus::partially_filled: return "PARTIALLY_FILLED";
+    case OrderStatus::filled: return "FILLED";
+    case OrderStatus::canceled: return "CANCELED";
+    case OrderStatus::expired: return "EXPIRED";
+  }
+  return "UNKNOWN";
+}
@@ -0,0 +1,164 @@
+#include "../../include/exchange/PaperOrderRouter.h"
+#include <cmath>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+#include "../../include/risk/PositionBook.h"
+
+using json = nlohmann::json;
+
+namespace {
+  // Binance sends decimals as strings; anything else counts as absent rather than throwing on the sender thread
+  double decimal(const json& object, const char* key) {
+    const auto field = object.find(key);
+    return field != object.end() && field->is_string() ? std::atof(field->get_ref<const std::string&>().c_str())
+                                                       : 0.0;
+  }
+
+  const char* side_name(OrderSide side) {
+    return side == OrderSide::buy ? " buy" : " sell";
+  }
+}
+
+PaperOrderRouter::PaperOrderRouter(StrategyEngine& engine, RiskManager& risk, PositionBook& positions) :
+  engine_(engine), risk_(risk), positions_(positions) {}
+
+PaperOrderRouter::~PaperOrderRouter() {
+  stop(); // the sender thread calls back into this router
+}
+
+bool PaperOrderRouter::add_symbol(const std::string& symbol, const PaperSymbolFilters& filters,
+                                  const SymbolRiskLimits& limits) {
+  if (gateway_ || route_index_.count(symbol)) {
+    return false;
+  }
+  const double lots = filters.order_quantity / filters.lot_size;
+  if (!(std::isfinite(filters.tick_size) && filters.tick_size > 0.0 && std::isfinite(filters.lot_size) &&
+        filters.lot_size > 0.0 && std::isfinite(lots) && lots >= 1.0) ||
+      std::fabs(lots - std::round(lots)) > 1e-9 * lots) {
+    return false;
+  }
+  const std::uint32_t risk_index = risk_.add_symbol(symbol, limits);
+  const std::uint32_t position_index = positions_.add_symbol(symbol);
+  if (risk_index == UINT32_MAX || position_index == UINT32_MAX) {
+    return false;
+  }
+  route_index_.emplace(symbol, static_cast<std::uint32_t>(routes_.size()));
+  routes_.push_back({symbol, filters, risk_index, position_index, {0, 0}, {0.0, 0.0}});
+  return true;
+}
+
+bool PaperOrderRouter::start(const GatewayConfig& config) {
+  if (gateway_) {
+    return false;
+  }
+  gateway_ = std::make_unique<OrderGateway>(config);
+  for (Route& route : routes_) {
+    const int price_decimals = OrderGateway::step_decimals(route.filters.tick_size);
+    const int quantity_decimals = OrderGateway::step_decimals(route.filters.lot_size);
+    for (OrderSide side : {OrderSide::buy, OrderSide::sell}) {
+      route.templates[static_cast<int>(side)] = gateway_->prepare_order(
+        route.symbol, side, OrderType::market, TimeInForce::ioc, price_decimals, quantity_decimals);
+    }
+  }
+  if (!gateway_->start()) {
+    gateway_.reset();
+    return false;
+  }
+  return true;
+}
+
+void PaperOrderRouter::stop() {
+  if (gateway_) {
+    gateway_->stop();
+  }
+}
+
+void PaperOrderRouter::on_signal(const Signal& signal) {
+  const auto found = route_index_.find(signal.symbol);
+  if (!gateway_ || found == route_index_.end()) {
+    return;
+  }
+  apply_answers();
+  const std::uint32_t route_id = found->second;
+  Route& route = routes_[route_id];
+  const OrderSide side = signal.side == SignalSide::buy ? OrderSide::buy : OrderSide::sell;
+  const double quantity = route.filters.order_quantity;
+  const double pending = route.in_flight[static_cast<int>(side)];
+  if (unsigned violations = risk_.check(route.risk_index, side, pending + quantity, signal.price)) {
+    notice("risk", signal.symbol + side_name(side) + " blocked: " + RiskManager::describe(violations));
+    return;
+  }
+  const SubmitResult submitted = gateway_->submit_order(
+    route.templates[static_cast<int>(side)], 0.0, quantity, engine_.dispatch_tick(),
+    [this, route_id, side, quantity](const GatewayResponse& response) {
+      on_response(route_id, side, quantity, response);
+    });
+  if (submitted != SubmitResult::queued) {
+    const char* reason = submitted == SubmitResult::stopped ? "gateway stopped" : "order queue full";
+    notice("paper", signal.symbol + side_name(side) + " dropped: " + reason);
+    return;
+  }
+  route.in_flight[static_cast<int>(side)] += quantity;
+}
+
+void PaperOrderRouter::on_response(std::uint32_t route, OrderSide side, double quantity,
+                                   const GatewayResponse& response) {
+  Answer answer{route, side, quantity, 0.0, 0.0, 0.0};
+  if (response.status != 200) {
+    notice("paper", "order rejected: " + response.error + response.body);
+  } else {
+    const json order = json::parse(response.body, nullptr, false);
+    const double executed = order.is_object() ? decimal(order, "executedQty") : 0.0;
+    if (executed > 0.0) {
+      answer.executed = executed;
+      answer.price = decimal(order, "cummulativeQuoteQty") / executed;
+      const auto fills = order.find("fills");
+      if (fills != order.end() && fills->is_array()) {
+        for (const json& fill : *fills) {
+          answer.fee += fill.is_object() ? decimal(fill, "commission") : 0.0;
+        }
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(answers_mutex_);
+  answers_.push_back(answer);
+}
+
+void PaperOrderRouter::apply_answers() {
+  {
+    std::lock_guard<std::mutex> lock(answers_mutex_);
+    if (answers_.empty()) {
+      return;
+    }
+    applying_.swap(answers_);
+  }
+  for (const Answer& answer : applying_) {
+    Route& route = routes_[answer.route];
+    route.in_flight[static_cast<int>(answer.side)] -= answer.quantity;
+    if (answer.executed > 0.0) {
+      risk_.on_fill(route.risk_index, answer.side, answer.executed, answer.price, answer.fee);
+      positions_.on_fill(route.position_index, answer.side, answer.executed, answer.price, answer.fee);
+    }
+  }
+  applying_.clear();
+}
+
+void PaperOrderRouter::on_trade(const Coin&, const CoinData&) {
+  apply_answers();
+}
+
+double PaperOrderRouter::in_flight(const std::string& symbol, OrderSide side) const {
+  const auto found = route_index_.find(symbol);
+  return found == route_index_.end() ? 0.0 : routes_[found->second].in_flight[static_cast<int>(side)];
+}
+
+void PaperOrderRouter::set_notice_handler(
+  std::function<void(const std::string& source, const std::string& message)> handler) {
+  notice_handler_ = std::move(handler);
+}
+
+void PaperOrderRouter::notice(const std::string& source, const std::string& message) const {
+  if (notice_handler_) {
+    notice_handler_(source, message);
+  }
+}
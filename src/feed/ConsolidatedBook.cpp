@@ -0,0 +1,113 @@
+#include "../../include/feed/ConsolidatedBook.h"
+
+ConsolidatedBook::ConsolidatedBook(long stale_after_ms) : stale_after_ms_(stale_after_ms) {}
+
+int ConsolidatedBook::pick_bid(const Entry& entry, std::int64_t fresh_after_ms) {
+  int best = -1;
+  for (int v = 0; v < FEED_MAX_VENUES; ++v) {
+    const VenueQuote& quote = entry.venues[v];
+    if (quote.bid > 0.0 && quote.quote_ms > fresh_after_ms && (best < 0 || quote.bid > entry.venues[best].bid)) {
+      best = v;
+    }
+  }
+  return best;
+}
+
+int ConsolidatedBook::pick_ask(const Entry& entry, std::int64_t fresh_after_ms) {
+  int best = -1;
+  for (int v = 0; v < FEED_MAX_VENUES; ++v) {
+    const VenueQuote& quote = entry.venues[v];
+    if (quote.ask > 0.0 && quote.quote_ms > fresh_after_ms && (best < 0 || quote.ask < entry.venues[best].ask)) {
+      best = v;
+    }
+  }
+  return best;
+}
+
+void ConsolidatedBook::on_quote(Venue venue, const Quote& quote, std::int64_t now_ms) {
+  const int v = static_cast<int>(venue);
+  Entry& entry = entries_[quote.instrument];
+  VenueQuote& own = entry.venues[v];
+  const double previous_bid = own.bid;
+  const double previous_ask = own.ask;
+  own.bid = quote.bid;
+  own.bid_quantity = quote.bid_quantity;
+  own.ask = quote.ask;
+  own.ask_quantity = quote.ask_quantity;
+  own.quote_ms = now_ms;
+  venue_seen_ms_[v] = now_ms;
+
+  // the best only needs re-picking when the venue holding it backs off
+  if (entry.best_bid == v && quote.bid < previous_bid) {
+    entry.best_bid = pick_bid(entry, INT64_MIN);
+  } else if (quote.bid > 0.0 && (entry.best_bid < 0 || quote.bid > entry.venues[entry.best_bid].bid)) {
+    entry.best_bid = v;
+  }
+  if (entry.best_ask == v && (quote.ask > previous_ask || quote.ask <= 0.0)) {
+    entry.best_ask = pick_ask(entry, INT64_MIN);
+  } else if (quote.ask > 0.0 && (entry.best_ask < 0 || quote.ask < entry.venues[entry.best_ask].ask)) {
+    entry.best_ask = v;
+  }
+}
+
+void ConsolidatedBook::on_trade(Venue venue, const std::string& instrument, double price, std::int64_t now_ms) {
+  const int v = static_cast<int>(venue);
+  Entry& entry = entries_[instrument];
+  entry.venues[v].last = price;
+  entry.venues[v].trade_ms = now_ms;
+  entry.last_venue = v;
+  venue_seen_ms_[v] = now_ms;
+}
+
+bool ConsolidatedBook::best(const std::string& instrument, std::int64_t now_ms, ConsolidatedQuote& out) const {
+  auto it = entries_.find(instrument);
+  if (it == entries_.end()) {
+    return false;
+  }
+  const Entry& entry = it->second;
+  const std::int64_t fresh_after_ms = now_ms - stale_after_ms_;
+  int bid = entry.best_bid;
+  if (bid >= 0 && entry.venues[bid].quote_ms <= fresh_after_ms) {
+    bid = pick_bid(entry, fresh_after_ms);
+  }
+  int ask = entry.best_ask;
+  if (ask >= 0 && entry.venues[ask].quote_ms <= fresh_after_ms) {
+    ask = pick_ask(entry, fresh_after_ms);
+  }
+
+  out = ConsolidatedQuote{};
+  if (bid >= 0) {
+    out.bid = entry.venues[bid].bid;
+    out.bid_quantity = entry.venues[bid].bid_quantity;
+    out.bid_venue = static_cast<Venue>(bid);
+  }
+  if (ask >= 0) {
+    out.ask = entry.venues[ask].ask;
+    out.ask_quantity = entry.venues[ask].ask_quantity;
+    out.ask_venue = static_cast<Venue>(ask);
+  }
+  if (entry.last_venue >= 0) {
+    out.last = entry.venues[entry.last_venue].last;
+    out.last_venue = static_cast<Venue>(entry.last_venue);
+    out.last_ms = entry.venues[entry.last_venue].trade_ms;
+  }
+  return true;
+}
+
+bool ConsolidatedBook::venue_quote(const std::string& instrument, Venue venue, VenueQuote& out) const {
+  auto it = entries_.find(instrument);
+  if (it == entries_.end()) {
+    return false;
+  }
+  out = it->second.venues[static_cast<int>(venue)];
+  return true;
+}
+
+std::int64_t ConsolidatedBook::last_seen_ms(Venue venue) const {
+  return venue_seen_ms_[static_cast<int>(venue)];
+}
+
+bool ConsolidatedBook::is_fresh(Venue venue, std::int64_t now_ms) const {
+  const std::int64_t seen = last_seen_ms(venue);
+  return seen != 0 && now_ms - seen < stale_after_ms_;
+}
@@ -0,0 +1,96 @@
+#include "../../include/feed/Instrument.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+  // longest first, so "usdt" wins over "usd"
+  const char* const QUOTE_CURRENCIES[] = {"fdusd", "usdt", "usdc", "busd", "usd", "eur", "gbp", "try",
+                                          "btc",   "eth",  "bnb"};
+
+  // venue spelling -> common spelling, applied per currency
+  struct Alias {
+    Venue venue;
+    const char* venue_code;
+    const char* code;
+  };
+  const Alias ALIASES[] = {{Venue::kraken, "xbt", "btc"}, {Venue::kraken, "xdg", "doge"}};
+
+  std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+  }
+
+  std::string upper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+    return s;
+  }
+
+  std::string to_alias(Venue venue, const std::string& code) {
+    for (const Alias& alias : ALIASES) {
+      if (alias.venue == venue && code == alias.code) {
+        return alias.venue_code;
+      }
+    }
+    return code;
+  }
+
+  std::string from_alias(Venue venue, const std::string& code) {
+    for (const Alias& alias : ALIASES) {
+      if (alias.venue == venue && code == alias.venue_code) {
+        return alias.code;
+      }
+    }
+    return code;
+  }
+}
+
+const char* instruments::venue_name(Venue venue) {
+  switch (venue) {
+    case Venue::binance: return "binance";
+    case Venue::coinbase: return "coinbase";
+    case Venue::kraken: return "kraken";
+    case Venue::simulated: return "simulated";
+  }
+  return "unknown";
+}
+
+bool instruments::split(const std::string& id, std::string& base, std::string& quote) {
+  for (const char* currency : QUOTE_CURRENCIES) {
+    const std::string suffix = currency;
+    if (id.size() > suffix.size() && id.compare(id.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      base = id.substr(0, id.size() - suffix.size());
+      quote = suffix;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string instruments::to_venue(Venue venue, const std::string& id) {
+  std::string base;
+  std::string quote;
+  if (!split(lower(id), base, quote)) {
+    return "";
+  }
+  switch (venue) {
+    case Venue::coinbase: return upper(base) + "-" + upper(quote);
+    case Venue::kraken: return upper(to_alias(venue, base)) + "/" + upper(to_alias(venue, quote));
+    case Venue::binance:
+    case Venue::simulated: break;
+  }
+  return upper(base + quote);
+}
+
+std::string instruments::from_venue(Venue venue, const std::string& symbol) {
+  const std::string normalized = lower(symbol);
+  const std::size_t separator = normalized.find_first_of("-/_");
+  if (separator != std::string::npos) {
+    return from_alias(venue, normalized.substr(0, separator)) + from_alias(venue, normalized.substr(separator + 1));
+  }
+  std::string base;
+  std::string quote;
+  if (!split(normalized, base, quote)) {
+    return normalized;
+  }
+  return from_alias(venue, base) + from_alias(venue, quote);
+}
@@ -0,0 +1,82 @@
+#include "../../include/feed/SimulatedFeed.h"
+#include <chrono>
+#include <random>
+#include "../../include/common/Clock.h"
+#include "../../include/common/CoinManager.h"
+
+SimulatedFeed::SimulatedFeed(CoinManager& manager, Venue venue)
+  : coin_manager_(manager), venue_(venue), connected_(false), next_trade_id_(1), walking_(false) {}
+
+SimulatedFeed::~SimulatedFeed() {
+  stop_random_walk();
+}
+
+void SimulatedFeed::subscribe(const std::vector<std::string>& instruments) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribed_.insert(instruments.begin(), instruments.end());
+}
+
+void SimulatedFeed::unsubscribe(const std::vector<std::string>& instruments) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::string& instrument : instruments) {
+    subscribed_.erase(instrument);
+  }
+}
+
+bool SimulatedFeed::is_subscribed(const std::string& instrument) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return subscribed_.count(instrument) != 0;
+}
+
+bool SimulatedFeed::accepts(const std::string& instrument) const {
+  return connected_ && is_subscribed(instrument);
+}
+
+bool SimulatedFeed::push_trade(const std::string& instrument, double price, double quantity, long time_ms) {
+  if (!accepts(instrument)) {
+    return false;
+  }
+  CoinData data{instrument, price, 0, quantity, time_ms};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data.trade_id = next_trade_id_++;
+  }
+  coin_manager_.on_trade(venue_, data);
+  return true;
+}
+
+bool SimulatedFeed::push_quote(const Quote& quote) {
+  if (!accepts(quote.instrument)) {
+    return false;
+  }
+  coin_manager_.on_quote(venue_, quote);
+  return true;
+}
+
+void SimulatedFeed::start_random_walk(const std::map<std::string, double>& start_prices, long interval_ms,
+                                      double spread_bps, unsigned seed) {
+  stop_random_walk();
+  walking_ = true;
+  walker_ = std::thread([this, prices = start_prices, interval_ms, spread_bps, seed]() mutable {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> step(0.0, spread_bps * 1e-4);
+    std::exponential_distribution<double> size(10.0);
+    while (walking_) {
+      const long now_ms = static_cast<long>(Clock::wall_ms());
+      for (auto& [instrument, price] : prices) {
+        price *= 1.0 + step(rng);
+        const double half_spread = price * spread_bps * 0.5e-4;
+        push_quote(Quote{instrument, price - half_spread, size(rng), price + half_spread, size(rng), now_ms});
+        push_trade(instrument, price, size(rng), now_ms);
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+  });
+}
+
+void SimulatedFeed::stop_random_walk() {
+  walking_ = false;
+  if (walker_.joinable()) {
+    walker_.join();
+  }
+}
@@ -0,0 +1,156 @@
+#include "../../include/fpga/FpgaEmulator.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+#include "../../include/fpga/SerialPort.h"
+
+namespace {
+  constexpr int POLL_INTERVAL_MS = 50; // how quickly stop() is noticed
+  constexpr unsigned UART_BITS_PER_BYTE = 10; // start + 8 data + stop
+
+  void append_error(std::vector<std::uint8_t>& out, OffloadError code) {
+    const std::uint8_t payload = code;
+    offload::append_frame(out, OFFLOAD_ERROR, &payload, 1);
+  }
+}
+
+FpgaEmulator::FpgaEmulator(unsigned baud)
+  : baud_(baud), master_fd_(-1), slave_fd_(-1), running_(false), frames_(0) {}
+
+FpgaEmulator::~FpgaEmulator() {
+  stop();
+}
+
+bool FpgaEmulator::start() {
+  stop();
+  master_fd_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (master_fd_ < 0 || grantpt(master_fd_) != 0 || unlockpt(master_fd_) != 0) {
+    std::cerr << "Unable to create a pty for the FPGA emulator: " << std::strerror(errno) << std::endl;
+    stop();
+    return false;
+  }
+  const char* name = ptsname(master_fd_);
+  device_ = name ? name : "";
+  // raw before the host opens it: with the default line discipline the replies would be echoed back to us
+  slave_fd_ = name ? ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC) : -1;
+  if (slave_fd_ < 0 || !SerialPort::make_raw(slave_fd_, 0)) {
+    std::cerr << "Unable to configure the FPGA emulator pty " << device_ << std::endl;
+    stop();
+    return false;
+  }
+  channels_.clear();
+  decoder_.clear();
+  running_ = true;
+  thread_ = std::thread([this]() { run(); });
+  return true;
+}
+
+void FpgaEmulator::stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (slave_fd_ >= 0) {
+    ::close(slave_fd_);
+    slave_fd_ = -1;
+  }
+  if (master_fd_ >= 0) {
+    ::close(master_fd_);
+    master_fd_ = -1;
+  }
+}
+
+void FpgaEmulator::run() {
+  std::uint8_t buffer[4096];
+  OffloadFrame frame;
+  std::vector<std::uint8_t> reply;
+  while (running_.load(std::memory_order_relaxed)) {
+    pollfd ready{master_fd_, POLLIN, 0};
+    if (poll(&ready, 1, POLL_INTERVAL_MS) <= 0) {
+      continue;
+    }
+    const ssize_t received = ::read(master_fd_, buffer, sizeof(buffer));
+    if (received <= 0) {
+      continue;
+    }
+    decoder_.feed(buffer, static_cast<std::size_t>(received));
+    while (decoder_.next(frame)) {
+      reply.clear();
+      handle(frame, reply);
+      frames_.fetch_add(1, std::memory_order_relaxed);
+      if (baud_) {
+        const std::size_t wire_bytes = OFFLOAD_FRAME_OVERHEAD + frame.payload.size() + reply.size();
+        std::this_thread::sleep_for(std::chrono::microseconds(wire_bytes * UART_BITS_PER_BYTE * 1000000 / baud_));
+      }
+      std::size_t written = 0;
+      while (written < reply.size() && running_.load(std::memory_order_relaxed)) {
+        const ssize_t n = ::write(master_fd_, reply.data() + written, reply.size() - written);
+        if (n > 0) {
+          written += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno != EINTR && errno != EAGAIN) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+void FpgaEmulator::handle(const OffloadFrame& frame, std::vector<std::uint8_t>& out) {
+  const std::vector<std::uint8_t>& payload = frame.payload;
+  if (frame.type == OFFLOAD_CONFIGURE) {
+    if (payload.size() != 4) {
+      return append_error(out, OFFLOAD_ERROR_MALFORMED);
+    }
+    const std::uint16_t channel = offload::get_u16(&payload[0]);
+    const std::uint16_t window = offload::get_u16(&payload[2]);
+    if (channel >= OFFLOAD_MAX_CHANNELS) {
+      return append_error(out, OFFLOAD_ERROR_CHANNEL);
+    }
+    if (window == 0 || window > OFFLOAD_MAX_WINDOW) {
+      return append_error(out, OFFLOAD_ERROR_WINDOW);
+    }
+    if (channel >= channels_.size()) {
+      channels_.resize(channel + 1);
+    }
+    channels_[channel] = Channel{std::vector<std::int64_t>(window, 0)};
+    offload::append_frame(out, OFFLOAD_ACK, &payload[0], 2);
+    return;
+  }
+
+  if (frame.type != OFFLOAD_UPDATES || payload.size() < OFFLOAD_BATCH_HEADER) {
+    return append_error(out, OFFLOAD_ERROR_MALFORMED);
+  }
+  const std::size_t count = offload::get_u16(&payload[2]);
+  if (payload.size() != OFFLOAD_BATCH_HEADER + count * OFFLOAD_UPDATE_SIZE) {
+    return append_error(out, OFFLOAD_ERROR_MALFORMED);
+  }
+  std::vector<std::uint8_t> results(OFFLOAD_BATCH_HEADER + count * OFFLOAD_RESULT_SIZE);
+  std::copy(payload.begin(), payload.begin() + OFFLOAD_BATCH_HEADER, results.begin());
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::uint8_t* update = &payload[OFFLOAD_BATCH_HEADER + i * OFFLOAD_UPDATE_SIZE];
+    const std::uint16_t channel = offload::get_u16(update);
+    if (channel >= channels_.size() || channels_[channel].window.empty()) {
+      return append_error(out, OFFLOAD_ERROR_CHANNEL);
+    }
+    Channel& state = channels_[channel];
+    const std::int64_t price = offload::get_i64(update + 2);
+    std::int64_t& slot = state.window[state.next];
+    // modulo 2^64, as the adder in the unit does; signed overflow would be undefined
+    state.sum = static_cast<std::int64_t>(static_cast<std::uint64_t>(state.sum) + static_cast<std::uint64_t>(price) -
+                                          static_cast<std::uint64_t>(slot));
+    slot = price;
+    state.next = state.next + 1 == state.window.size() ? 0 : state.next + 1;
+    state.count += state.count < state.window.size();
+
+    std::uint8_t* result = &results[OFFLOAD_BATCH_HEADER + i * OFFLOAD_RESULT_SIZE];
+    offload::put_u16(result, channel);
+    offload::put_u16(result + 2, static_cast<std::uint16_t>(state.count));
+    offload::put_i64(result + 4, state.sum);
+  }
+  offload::append_frame(out, OFFLOAD_RESULTS, results.data(), results.size());
+}
@@ -0,0 +1,227 @@
+#include "../../include/fpga/GoldenVectors.h"
+#include <iostream>
+#include <vector>
+#include "../../include/common/Clock.h"
+#include "../../include/fpga/SerialPort.h"
+#include "../../include/fpga/VectorFile.h"
+#include "../../include/history/HistoryReader.h"
+
+namespace {
+  constexpr std::size_t READ_BATCH = 4096; // tick records per HistoryReader::read
+  constexpr int REPLY_TIMEOUT_MS = 1000;
+  const char* const FIELD_NAMES[GOLDEN_OUTPUT_FIELDS] = {"count", "sum", "average", "flags"};
+
+  std::vector<int> stimulus_widths() {
+    return {MaUnitPrice::width};
+  }
+
+  std::vector<int> output_widths() {
+    return {GOLDEN_COUNT_BITS, MaUnitSum::width, MaUnitAverage::width, GOLDEN_FLAG_BITS};
+  }
+
+  // the unit's bound, which also keeps count within its GOLDEN_COUNT_BITS field
+  static_assert(OFFLOAD_MAX_WINDOW < (1 << GOLDEN_COUNT_BITS));
+  bool valid_window(std::size_t window, std::ostream& out) {
+    if (window == 0 || window > OFFLOAD_MAX_WINDOW) {
+      out << "The unit takes windows of 1 to " << OFFLOAD_MAX_WINDOW << " prices" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  std::uint64_t low_bits(std::int64_t value, int width) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    return width >= 64 ? bits : bits & ((std::uint64_t(1) << width) - 1);
+  }
+
+  // sends a frame and waits for the reply, which must be of reply_type
+  bool exchange(SerialPort& port, offload::FrameDecoder& decoder, std::uint8_t type,
+                const std::vector<std::uint8_t>& payload, std::uint8_t reply_type, OffloadFrame& reply) {
+    std::vector<std::uint8_t> frame;
+    offload::append_frame(frame, type, payload.data(), payload.size());
+    if (!port.write_all(frame.data(), frame.size())) {
+      std::cerr << "Unable to write to the unit" << std::endl;
+      return false;
+    }
+    std::uint8_t buffer[4096];
+    while (!decoder.next(reply)) {
+      const long received = port.read_some(buffer, sizeof(buffer), REPLY_TIMEOUT_MS);
+      if (received <= 0) {
+        std::cerr << "No reply from the unit within " << REPLY_TIMEOUT_MS << " ms" << std::endl;
+        return false;
+      }
+      decoder.feed(buffer, static_cast<std::size_t>(received));
+    }
+    if (reply.type != reply_type) {
+      std::cerr << "Unit answered with frame type " << static_cast<int>(reply.type) << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+namespace golden {
+  bool generate_vectors(const std::string& history_dir, const std::string& symbol, std::int64_t begin_ms,
+                        std::int64_t end_ms, std::size_t window, const std::string& prefix, std::uint64_t& vectors) {
+    vectors = 0;
+    if (!valid_window(window, std::cerr)) {
+      return false;
+    }
+    HistoryReader reader(history_dir, symbol);
+    if (!reader.seek_time(begin_ms, end_ms)) {
+      std::cerr << "Nothing captured for " << symbol << " in " << history_dir << std::endl;
+      return false;
+    }
+    VectorWriter stimulus(stimulus_widths());
+    VectorWriter expected(output_widths());
+    if (!stimulus.open(prefix + "_stimulus.hex") || !expected.open(prefix + "_expected.hex")) {
+      return false;
+    }
+
+    MaUnitModel model(window);
+    std::vector<TickRecord> ticks(READ_BATCH);
+    while (std::size_t n = reader.read(ticks.data(), ticks.size())) {
+      for (std::size_t i = 0; i < n; ++i) {
+        const MaUnitPrice price = MaUnitPrice::from_double(ticks[i].price);
+        const GoldenOutput out = model.update(price);
+        const std::int64_t price_field = price.raw();
+        const std::int64_t fields[GOLDEN_OUTPUT_FIELDS] = {out.count, out.sum, out.average, out.flags};
+        stimulus.write(&price_field);
+        expected.write(fields);
+      }
+      vectors += n;
+    }
+    const bool written = stimulus.close() & expected.close();
+    if (!written) {
+      std::cerr << "Unable to write the vectors for " << prefix << std::endl;
+    }
+    return written && vectors > 0;
+  }
+
+  bool check_vectors(const std::string& stimulus, const std::string& output, std::size_t window, GoldenCheck& result,
+                     std::ostream& report, std::size_t max_reported) {
+    result = GoldenCheck();
+    const std::vector<int> widths = output_widths();
+    VectorReader inputs(stimulus_widths());
+    VectorReader outputs(widths);
+    if (!valid_window(window, report) || !inputs.open(stimulus) || !outputs.open(output)) {
+      return false;
+    }
+
+    const std::int64_t start_ns = Clock::now_ns();
+    MaUnitModel model(window);
+    std::int64_t price = 0;
+    std::int64_t actual[GOLDEN_OUTPUT_FIELDS];
+    bool ok = true;
+    while (inputs.next(&price)) {
+      const std::size_t fields = outputs.next(actual);
+      if (result.fields == 0) {
+        result.fields = fields;
+      }
+      if (fields == 0 || fields != result.fields) {
+        report << output << ": "
+               << (fields ? "line " + std::to_string(outputs.line()) + " has " + std::to_string(fields) + " fields"
+                          : !outputs.error().empty() ? outputs.error() : "ends before the stimulus")
+               << std::endl;
+        ok = false;
+        break;
+      }
+      const GoldenOutput out = model.update(MaUnitPrice::from_raw(price));
+      const std::int64_t expected[GOLDEN_OUTPUT_FIELDS] = {out.count, out.sum, out.average, out.flags};
+      ++result.vectors;
+      bool match = true;
+      for (std::size_t i = 0; i < fields; ++i) {
+        match &= low_bits(expected[i] ^ actual[i], widths[i]) == 0;
+      }
+      if (match) {
+        continue;
+      }
+      if (result.mismatches++ == 0) {
+        result.first_mismatch = outputs.line();
+      }
+      if (result.mismatches <= max_reported) {
+        report << "line " << outputs.line() << " (price " << std::hex << low_bits(price, MaUnitPrice::width) << "):";
+        for (std::size_t i = 0; i < fields; ++i) {
+          if (low_bits(expected[i] ^ actual[i], widths[i]) != 0) {
+            report << ' ' << FIELD_NAMES[i] << " expected " << low_bits(expected[i], widths[i]) << " got "
+                   << low_bits(actual[i], widths[i]);
+          }
+        }
+        report << std::dec << std::endl;
+      }
+    }
+    if (ok && !inputs.error().empty()) {
+      report << stimulus << ": " << inputs.error() << std::endl;
+      ok = false;
+    }
+    if (ok && outputs.next(actual)) {
+      report << output << ": more vectors than the stimulus has" << std::endl;
+      ok = false;
+    }
+    result.seconds = static_cast<double>(Clock::now_ns() - start_ns) / 1e9;
+    return ok;
+  }
+
+  bool run_unit(const std::string& device, unsigned baud, const std::string& stimulus, std::size_t window,
+                const std::string& output, std::uint64_t& vectors) {
+    vectors = 0;
+    if (!valid_window(window, std::cerr)) {
+      return false;
+    }
+    SerialPort port;
+    VectorReader inputs(stimulus_widths());
+    VectorWriter outputs({GOLDEN_COUNT_BITS, MaUnitSum::width}); // the window unit's fields only
+    if (!port.open(device, baud) || !inputs.open(stimulus) || !outputs.open(output)) {
+      return false;
+    }
+
+    offload::FrameDecoder decoder;
+    OffloadFrame reply;
+    std::vector<std::uint8_t> payload(4);
+    offload::put_u16(&payload[0], 0);
+    offload::put_u16(&payload[2], static_cast<std::uint16_t>(window));
+    if (!exchange(port, decoder, OFFLOAD_CONFIGURE, payload, OFFLOAD_ACK, reply)) {
+      return false;
+    }
+
+    std::uint16_t sequence = 0;
+    std::int64_t price = 0;
+    bool more = true;
+    while (more) {
+      payload.assign(OFFLOAD_BATCH_HEADER, 0);
+      std::size_t count = 0;
+      while (count < OFFLOAD_MAX_BATCH && (more = inputs.next(&price) != 0)) {
+        const std::size_t at = payload.size();
+        payload.resize(at + OFFLOAD_UPDATE_SIZE);
+        offload::put_u16(&payload[at], 0);
+        offload::put_i64(&payload[at + 2], price);
+        ++count;
+      }
+      if (count == 0) {
+        break;
+      }
+      offload::put_u16(&payload[0], sequence);
+      offload::put_u16(&payload[2], static_cast<std::uint16_t>(count));
+      if (!exchange(port, decoder, OFFLOAD_UPDATES, payload, OFFLOAD_RESULTS, reply)) {
+        return false;
+      }
+      if (reply.payload.size() != OFFLOAD_BATCH_HEADER + count * OFFLOAD_RESULT_SIZE
+          || offload::get_u16(&reply.payload[0]) != sequence) {
+        std::cerr << "Unit results do not match batch " << sequence << std::endl;
+        return false;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        const std::uint8_t* result = &reply.payload[OFFLOAD_BATCH_HEADER + i * OFFLOAD_RESULT_SIZE];
+        const std::int64_t fields[2] = {offload::get_u16(result + 2), offload::get_i64(result + 4)};
+        outputs.write(fields);
+      }
+      vectors += count;
+      ++sequence;
+    }
+    if (!inputs.error().empty()) {
+      std::cerr << stimulus << ": " << inputs.error() << std::endl;
+      return false;
+    }
+    return outputs.close();
+  }
+}
@@ -0,0 +1,165 @@
+#include "../../include/fpga/OffloadMovingAverageBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "../../include/common/Clock.h"
+
+OffloadMovingAverageBackend::OffloadMovingAverageBackend(std::size_t batch_size, int timeout_ms)
+  : batch_size_(std::clamp<std::size_t>(batch_size, 1, OFFLOAD_MAX_BATCH)),
+    timeout_ms_(timeout_ms),
+    batch_(OFFLOAD_BATCH_HEADER),
+    pending_(0),
+    sequence_(0),
+    reply_{0, {}},
+    failed_(false),
+    batches_(0),
+    updates_(0),
+    bytes_sent_(0),
+    bytes_received_(0) {
+  batch_.reserve(OFFLOAD_BATCH_HEADER + OFFLOAD_MAX_BATCH * OFFLOAD_UPDATE_SIZE);
+  frame_.reserve(OFFLOAD_FRAME_OVERHEAD + OFFLOAD_MAX_PAYLOAD);
+}
+
+OffloadMovingAverageBackend::~OffloadMovingAverageBackend() {
+  close();
+}
+
+bool OffloadMovingAverageBackend::open(const std::string& device, unsigned baud) {
+  failed_ = false;
+  decoder_.clear();
+  return port_.open(device, baud);
+}
+
+void OffloadMovingAverageBackend::close() {
+  port_.close();
+}
+
+void OffloadMovingAverageBackend::set_batch_size(std::size_t batch_size) {
+  flush();
+  batch_size_ = std::clamp<std::size_t>(batch_size, 1, OFFLOAD_MAX_BATCH);
+}
+
+bool OffloadMovingAverageBackend::fail(const std::string& reason) {
+  if (!failed_) {
+    std::cerr << "FPGA offload failed: " << reason << std::endl;
+  }
+  failed_ = true;
+  return false;
+}
+
+bool OffloadMovingAverageBackend::exchange(std::uint8_t type, const std::uint8_t* payload, std::size_t size,
+                                           std::uint8_t reply_type) {
+  frame_.clear();
+  offload::append_frame(frame_, type, payload, size);
+  if (!port_.write_all(frame_.data(), frame_.size())) {
+    return fail("write error");
+  }
+  bytes_sent_ += frame_.size();
+
+  std::uint8_t buffer[4096];
+  while (!decoder_.next(reply_)) {
+    const long received = port_.read_some(buffer, sizeof(buffer), timeout_ms_);
+    if (received <= 0) {
+      return fail(received == 0 ? "no reply within " + std::to_string(timeout_ms_) + " ms" : "read error");
+    }
+    bytes_received_ += static_cast<std::uint64_t>(received);
+    decoder_.feed(buffer, static_cast<std::size_t>(received));
+  }
+  if (reply_.type == OFFLOAD_ERROR) {
+    return fail("unit reported error " + std::to_string(reply_.payload.empty() ? 0 : reply_.payload[0]));
+  }
+  if (reply_.type != reply_type) {
+    return fail("unexpected frame type " + std::to_string(reply_.type));
+  }
+  return true;
+}
+
+std::uint32_t OffloadMovingAverageBackend::add_channel(std::size_t window) {
+  if (!port_.is_open() || window == 0 || window > OFFLOAD_MAX_WINDOW || channels_.size() == OFFLOAD_MAX_CHANNELS
+      || !flush()) {
+    return UINT32_MAX;
+  }
+  const auto channel = static_cast<std::uint32_t>(channels_.size());
+  std::uint8_t payload[4];
+  offload::put_u16(payload, static_cast<std::uint16_t>(channel));
+  offload::put_u16(payload + 2, static_cast<std::uint16_t>(window));
+  if (!exchange(OFFLOAD_CONFIGURE, payload, sizeof(payload), OFFLOAD_ACK)) {
+    return UINT32_MAX;
+  }
+  channels_.push_back({window, 0, 0, offload::max_price(window)});
+  return channel;
+}
+
+void OffloadMovingAverageBackend::reset(std::uint32_t channel) {
+  const bool flushed = flush(); // before clearing, or the queued updates' results would land after it
+  Channel& state = channels_[channel];
+  state.count = 0;
+  state.sum = 0;
+  if (!flushed) {
+    return;
+  }
+  std::uint8_t payload[4];
+  offload::put_u16(payload, static_cast<std::uint16_t>(channel));
+  offload::put_u16(payload + 2, static_cast<std::uint16_t>(state.window));
+  exchange(OFFLOAD_CONFIGURE, payload, sizeof(payload), OFFLOAD_ACK);
+}
+
+void OffloadMovingAverageBackend::update(std::uint32_t channel, double price) {
+  if (failed_) {
+    return;
+  }
+  if (std::fabs(price) >= channels_[channel].max_price) {
+    fail("price " + std::to_string(price) + " overflows the window sum of channel " + std::to_string(channel));
+    return;
+  }
+  const std::size_t at = batch_.size();
+  batch_.resize(at + OFFLOAD_UPDATE_SIZE);
+  offload::put_u16(&batch_[at], static_cast<std::uint16_t>(channel));
+  offload::put_i64(&batch_[at + 2], offload::to_fixed(price));
+  if (++pending_ == batch_size_) {
+    flush();
+  }
+}
+
+bool OffloadMovingAverageBackend::flush() {
+  if (pending_ == 0 || failed_) {
+    batch_.resize(OFFLOAD_BATCH_HEADER);
+    pending_ = 0;
+    return !failed_;
+  }
+  offload::put_u16(&batch_[0], sequence_);
+  offload::put_u16(&batch_[2], static_cast<std::uint16_t>(pending_));
+  const std::uint64_t start = Clock::ticks();
+  const bool replied = exchange(OFFLOAD_UPDATES, batch_.data(), batch_.size(), OFFLOAD_RESULTS);
+  const std::size_t count = pending_;
+  batch_.resize(OFFLOAD_BATCH_HEADER);
+  pending_ = 0;
+  if (!replied) {
+    return false;
+  }
+
+  const std::vector<std::uint8_t>& payload = reply_.payload;
+  if (payload.size() != OFFLOAD_BATCH_HEADER + count * OFFLOAD_RESULT_SIZE || offload::get_u16(&payload[0]) != sequence_
+      || offload::get_u16(&payload[2]) != count) {
+    return fail("results do not match batch " + std::to_string(sequence_));
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::uint8_t* result = &payload[OFFLOAD_BATCH_HEADER + i * OFFLOAD_RESULT_SIZE];
+    const std::uint16_t channel = offload::get_u16(result);
+    if (channel >= channels_.size()) {
+      return fail("result for unknown channel " + std::to_string(channel));
+    }
+    channels_[channel].count = offload::get_u16(result + 2);
+    channels_[channel].sum = offload::get_i64(result + 4);
+  }
+  round_trip_.record(Clock::ticks_to_ns(static_cast<std::int64_t>(Clock::ticks() - start)));
+  ++sequence_;
+  ++batches_;
+  updates_ += count;
+  return true;
+}
+
+double OffloadMovingAverageBackend::value(std::uint32_t channel) const {
+  const Channel& state = channels_[channel];
+  return state.count ? offload::from_fixed(state.sum) / static_cast<double>(state.count) : 0.0;
+}
@@ -0,0 +1,92 @@
+#include "../../include/fpga/OffloadProtocol.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+  constexpr std::array<std::uint16_t, 256> CRC_TABLE = [] {
+    std::array<std::uint16_t, 256> table{};
+    for (unsigned byte = 0; byte < 256; ++byte) {
+      auto crc = static_cast<std::uint16_t>(byte << 8);
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = static_cast<std::uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+      }
+      table[byte] = crc;
+    }
+    return table;
+  }();
+}
+
+namespace offload {
+  bool is_frame_type(std::uint8_t type) {
+    return type == OFFLOAD_CONFIGURE || type == OFFLOAD_UPDATES || type == OFFLOAD_ACK || type == OFFLOAD_RESULTS
+           || type == OFFLOAD_ERROR;
+  }
+
+  std::uint16_t crc16(const std::uint8_t* data, std::size_t size) {
+    std::uint16_t crc = 0xFFFF;
+    for (std::size_t i = 0; i < size; ++i) {
+      crc = static_cast<std::uint16_t>(crc << 8) ^ CRC_TABLE[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+  }
+
+  void append_frame(std::vector<std::uint8_t>& out, std::uint8_t type, const std::uint8_t* payload,
+                    std::size_t size) {
+    const std::size_t at = out.size();
+    out.resize(at + OFFLOAD_FRAME_OVERHEAD + size);
+    std::uint8_t* frame = out.data() + at;
+    frame[0] = OFFLOAD_START_OF_FRAME;
+    frame[1] = type;
+    put_u16(frame + 2, static_cast<std::uint16_t>(size));
+    std::copy(payload, payload + size, frame + 4);
+    put_u16(frame + 4 + size, crc16(frame + 1, 3 + size));
+  }
+
+  FrameDecoder::FrameDecoder() : start_(0), dropped_bytes_(0), crc_errors_(0) {}
+
+  void FrameDecoder::feed(const std::uint8_t* data, std::size_t size) {
+    if (start_ > 0 && start_ * 2 >= buffer_.size()) {
+      buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(start_));
+      start_ = 0;
+    }
+    buffer_.insert(buffer_.end(), data, data + size);
+  }
+
+  bool FrameDecoder::next(OffloadFrame& frame) {
+    while (true) {
+      while (start_ < buffer_.size() && buffer_[start_] != OFFLOAD_START_OF_FRAME) {
+        ++start_;
+        ++dropped_bytes_;
+      }
+      const std::size_t available = buffer_.size() - start_;
+      if (available < 4) {
+        return false;
+      }
+      const std::uint8_t* head = buffer_.data() + start_;
+      const std::size_t length = get_u16(head + 2);
+      if (!is_frame_type(head[1]) || length > OFFLOAD_MAX_PAYLOAD) {
+        ++start_; // not a real start byte: hunt for the next one instead of waiting for length bytes
+        ++dropped_bytes_;
+        continue;
+      }
+      if (available < OFFLOAD_FRAME_OVERHEAD + length) {
+        return false;
+      }
+      if (crc16(head + 1, 3 + length) != get_u16(head + 4 + length)) {
+        ++crc_errors_;
+        ++start_;
+        ++dropped_bytes_;
+        continue;
+      }
+      frame.type = head[1];
+      frame.payload.assign(head + 4, head + 4 + length);
+      start_ += OFFLOAD_FRAME_OVERHEAD + length;
+      return true;
+    }
+  }
+
+  void FrameDecoder::clear() {
+    buffer_.clear();
+    start_ = 0;
+  }
+}
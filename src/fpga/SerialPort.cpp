@@ -0,0 +1,119 @@
+#include "../../include/fpga/SerialPort.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+  bool speed_for(unsigned baud, speed_t& speed) {
+    switch (baud) {
+      case 9600: speed = B9600; return true;
+      case 19200: speed = B19200; return true;
+      case 38400: speed = B38400; return true;
+      case 57600: speed = B57600; return true;
+      case 115200: speed = B115200; return true;
+      case 230400: speed = B230400; return true;
+#ifdef B460800
+      case 460800: speed = B460800; return true;
+      case 921600: speed = B921600; return true;
+#endif
+#ifdef B3000000
+      case 1000000: speed = B1000000; return true;
+      case 2000000: speed = B2000000; return true;
+      case 3000000: speed = B3000000; return true;
+#endif
+      default: return false;
+    }
+  }
+}
+
+SerialPort::SerialPort() : fd_(-1) {}
+
+SerialPort::~SerialPort() {
+  close();
+}
+
+bool SerialPort::make_raw(int fd, unsigned baud) {
+  termios options{};
+  if (tcgetattr(fd, &options) != 0) {
+    return false;
+  }
+  cfmakeraw(&options);
+  options.c_cflag |= CLOCAL | CREAD;
+  options.c_cflag &= ~(CSTOPB | CRTSCTS);
+  options.c_cc[VMIN] = 0;
+  options.c_cc[VTIME] = 0;
+  if (baud) {
+    speed_t speed;
+    if (!speed_for(baud, speed)) {
+      return false;
+    }
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+  }
+  return tcsetattr(fd, TCSANOW, &options) == 0;
+}
+
+bool SerialPort::open(const std::string& device, unsigned baud) {
+  close();
+  speed_t speed;
+  if (!speed_for(baud, speed)) {
+    std::cerr << "Unsupported baud rate " << baud << std::endl;
+    return false;
+  }
+  fd_ = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (fd_ < 0) {
+    std::cerr << "Unable to open " << device << ": " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  if (!make_raw(fd_, baud)) {
+    std::cerr << "Unable to configure " << device << ": " << std::strerror(errno) << std::endl;
+    close();
+    return false;
+  }
+  tcflush(fd_, TCIOFLUSH);
+  return true;
+}
+
+void SerialPort::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool SerialPort::write_all(const std::uint8_t* data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t written = ::write(fd_, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN) {
+        pollfd ready{fd_, POLLOUT, 0};
+        poll(&ready, 1, 100);
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+long SerialPort::read_some(std::uint8_t* buffer, std::size_t size, int timeout_ms) {
+  pollfd ready{fd_, POLLIN, 0};
+  int result;
+  do {
+    result = poll(&ready, 1, timeout_ms);
+  } while (result < 0 && errno == EINTR);
+  if (result <= 0) {
+    return result;
+  }
+  const ssize_t received = ::read(fd_, buffer, size);
+  return received < 0 && (errno == EAGAIN || errno == EINTR) ? 0 : received;
+}
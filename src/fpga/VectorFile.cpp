@@ -0,0 +1,200 @@
+#include "../../include/fpga/VectorFile.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+  constexpr std::size_t BUFFER_SIZE = 1 << 20;
+  constexpr int MAX_DIGITS = 16;
+  const char HEX_DIGITS[] = "0123456789abcdef";
+
+  constexpr std::uint8_t BLANK = 0x10;
+  constexpr std::uint8_t NOT_HEX = 0x20;
+  // 0-15 for hex digits, BLANK between fields, NOT_HEX for anything else: one lookup per character instead of
+  // branches that digits and letters would keep mispredicting
+  constexpr auto HEX_VALUES = [] {
+    std::array<std::uint8_t, 256> values{};
+    values.fill(NOT_HEX);
+    values[' '] = values['\t'] = values['\r'] = BLANK;
+    for (int i = 0; i < 10; ++i) {
+      values['0' + i] = static_cast<std::uint8_t>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+      values['a' + i] = values['A' + i] = static_cast<std::uint8_t>(10 + i);
+    }
+    return values;
+  }();
+
+  std::int64_t sign_extend(std::uint64_t bits, int width) {
+    return width >= 64 ? static_cast<std::int64_t>(bits)
+                       : static_cast<std::int64_t>(bits << (64 - width)) >> (64 - width);
+  }
+}
+
+VectorWriter::VectorWriter(std::vector<int> widths)
+  : widths_(std::move(widths)), file_(nullptr), buffer_(BUFFER_SIZE), used_(0), failed_(false) {}
+
+VectorWriter::~VectorWriter() {
+  close();
+}
+
+bool VectorWriter::open(const std::string& path) {
+  close();
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    std::cerr << "Unable to create vector file " << path << std::endl;
+    return false;
+  }
+  failed_ = false;
+  return true;
+}
+
+void VectorWriter::drain() {
+  if (used_ && (!file_ || std::fwrite(buffer_.data(), 1, used_, file_) != used_)) {
+    failed_ = true;
+  }
+  used_ = 0;
+}
+
+void VectorWriter::write(const std::int64_t* fields) {
+  if (used_ + widths_.size() * (MAX_DIGITS + 1) + 1 > buffer_.size()) {
+    drain();
+  }
+  char* out = buffer_.data() + used_;
+  for (std::size_t i = 0; i < widths_.size(); ++i) {
+    const auto bits = static_cast<std::uint64_t>(fields[i]);
+    for (int shift = (widths_[i] + 3) / 4 * 4 - 4; shift >= 0; shift -= 4) {
+      *out++ = HEX_DIGITS[(bits >> shift) & 0xf];
+    }
+    *out++ = ' ';
+  }
+  out[-1] = '\n';
+  used_ = static_cast<std::size_t>(out - buffer_.data());
+}
+
+bool VectorWriter::close() {
+  if (!file_) {
+    return !failed_;
+  }
+  drain();
+  if (std::fclose(file_) != 0) {
+    failed_ = true;
+  }
+  file_ = nullptr;
+  return !failed_;
+}
+
+VectorReader::VectorReader(std::vector<int> widths)
+  : widths_(std::move(widths)), file_(nullptr), buffer_(BUFFER_SIZE), begin_(0), end_(0), eof_(true), line_(0) {}
+
+VectorReader::~VectorReader() {
+  close();
+}
+
+bool VectorReader::open(const std::string& path) {
+  close();
+  file_ = std::fopen(path.c_str(), "rb");
+  if (!file_) {
+    std::cerr << "Unable to open vector file " << path << std::endl;
+    return false;
+  }
+  begin_ = end_ = 0;
+  eof_ = false;
+  line_ = 0;
+  error_.clear();
+  return true;
+}
+
+void VectorReader::close() {
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+  eof_ = true;
+}
+
+bool VectorReader::refill() {
+  std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+  end_ -= begin_;
+  begin_ = 0;
+  const std::size_t read = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+  end_ += read;
+  eof_ = read == 0;
+  return read > 0;
+}
+
+std::size_t VectorReader::next(std::int64_t* fields) {
+  while (true) {
+    const char* start = buffer_.data() + begin_;
+    const auto* newline = static_cast<const char*>(std::memchr(start, '\n', end_ - begin_));
+    if (!newline) {
+      if (!eof_ && end_ - begin_ < buffer_.size() && refill()) {
+        continue;
+      }
+      if (end_ == begin_) {
+        return 0;
+      }
+      if (!eof_) {
+        error_ = "line " + std::to_string(line_ + 1) + " is too long";
+        return 0;
+      }
+      newline = buffer_.data() + end_; // last line without a newline
+    }
+    begin_ = std::min(static_cast<std::size_t>(newline - buffer_.data()) + 1, end_);
+    ++line_;
+
+    const char* c = start;
+    std::size_t count = 0;
+    while (true) {
+      while (c < newline && HEX_VALUES[static_cast<unsigned char>(*c)] == BLANK) {
+        ++c;
+      }
+      if (c == newline || (*c == '/' && c + 1 < newline && c[1] == '/')) {
+        break;
+      }
+      if (count == widths_.size()) {
+        error_ = "line " + std::to_string(line_) + " has more than " + std::to_string(count) + " fields";
+        return 0;
+      }
+      std::uint64_t bits = 0;
+      const int width_digits = (widths_[count] + 3) / 4;
+      if (newline - c >= width_digits
+          && (c + width_digits == newline || HEX_VALUES[static_cast<unsigned char>(c[width_digits])] == BLANK)) {
+        // the usual field, exactly as many digits as its width takes: a fixed trip count, no branch per digit
+        std::uint8_t seen = 0;
+        for (int i = 0; i < width_digits; ++i) {
+          const std::uint8_t digit = HEX_VALUES[static_cast<unsigned char>(c[i])];
+          seen |= digit;
+          bits = bits << 4 | (digit & 0xf);
+        }
+        if (seen & NOT_HEX) {
+          error_ = "line " + std::to_string(line_) + " field " + std::to_string(count + 1) + " is not a hex word";
+          return 0;
+        }
+        fields[count] = sign_extend(bits, widths_[count]);
+        ++count;
+        c += width_digits;
+        continue;
+      }
+      int digits = 0;
+      for (; c < newline; ++c, ++digits) {
+        const std::uint8_t digit = HEX_VALUES[static_cast<unsigned char>(*c)];
+        if (digit == BLANK) {
+          break;
+        }
+        if (digit == NOT_HEX || digits == MAX_DIGITS) {
+          error_ = "line " + std::to_string(line_) + " field " + std::to_string(count + 1) + " is not a hex word";
+          return 0;
+        }
+        bits = bits << 4 | digit;
+      }
+      fields[count] = sign_extend(bits, widths_[count]);
+      ++count;
+    }
+    if (count) {
+      return count;
+    }
+  }
+}
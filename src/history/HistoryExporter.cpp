@@ -0,0 +1,309 @@
+#include "../../include/history/HistoryExporter.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include "../../include/common/Clock.h"
+#include "../../include/history/Npy.h"
+#include "../../include/history/TickRecord.h"
+
+#define EXPORT_WRITE_BUFFER_SIZE (4 * 1024 * 1024)
+
+namespace {
+  // read-only mapping of a .ticks file, exposing its records
+  class MappedTicks {
+  private:
+    void* data_ = MAP_FAILED;
+    std::size_t size_ = 0;
+
+  public:
+    explicit MappedTicks(const std::string& path) {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        return;
+      }
+      struct stat st{};
+      if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(TickFileHeader)) {
+        size_ = static_cast<std::size_t>(st.st_size);
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data_ != MAP_FAILED) {
+          ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+      }
+      ::close(fd);
+    }
+    ~MappedTicks() {
+      if (data_ != MAP_FAILED) {
+        ::munmap(data_, size_);
+      }
+    }
+    MappedTicks(const MappedTicks&) = delete;
+    MappedTicks& operator=(const MappedTicks&) = delete;
+
+    [[nodiscard]] bool valid() const {
+      if (data_ == MAP_FAILED) {
+        return false;
+      }
+      const auto* header = static_cast<const TickFileHeader*>(data_);
+      return header->magic == TICK_FILE_MAGIC && header->record_size == sizeof(TickRecord);
+    }
+    [[nodiscard]] const TickRecord* records() const {
+      return reinterpret_cast<const TickRecord*>(static_cast<const char*>(data_) + sizeof(TickFileHeader));
+    }
+    [[nodiscard]] std::size_t count() const { return (size_ - sizeof(TickFileHeader)) / sizeof(TickRecord); }
+    [[nodiscard]] std::size_t size() const { return size_; }
+  };
+
+  // large write-behind buffer over a raw file descriptor
+  class BufferedWriter {
+  private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t written_ = 0;
+    bool ok_;
+
+  public:
+    explicit BufferedWriter(const std::string& path) :
+      fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)),
+      buffer_(EXPORT_WRITE_BUFFER_SIZE),
+      ok_(fd_ >= 0) {
+      if (!ok_) {
+        std::cerr << "Unable to open export file " << path << std::endl;
+      }
+    }
+    ~BufferedWriter() { close(); }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // guarantees at least `bytes` of contiguous space at cursor()
+    char* reserve(std::size_t bytes) {
+      if (used_ + bytes > buffer_.size()) {
+        flush();
+      }
+      return buffer_.data() + used_;
+    }
+    void commit(char* end) { used_ = static_cast<std::size_t>(end - buffer_.data()); }
+    void write(const void* data, std::size_t bytes) {
+      std::memcpy(reserve(bytes), data, bytes);
+      used_ += bytes;
+    }
+
+    void flush() {
+      std::size_t offset = 0;
+      while (ok_ && offset < used_) {
+        ssize_t n = ::write(fd_, buffer_.data() + offset, used_ - offset);
+        if (n <= 0) {
+          ok_ = false;
+          break;
+        }
+        offset += static_cast<std::size_t>(n);
+      }
+      written_ += offset;
+      used_ = 0;
+    }
+    void close() {
+      if (fd_ >= 0) {
+        flush();
+        ::close(fd_);
+        fd_ = -1;
+      }
+    }
+    [[nodiscard]] bool ok() const { return ok_; }
+    [[nodiscard]] std::uint64_t written() const { return written_ + used_; }
+  };
+
+  // longest CSV row: two int64 (20 chars each), two shortest-form doubles (24 each), separators
+  constexpr std::size_t MAX_CSV_ROW = 96;
+
+  char* format_row(char* out, const TickRecord& record) {
+    out = std::to_chars(out, out + 20, record.trade_time).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, out + 20, record.trade_id).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, out + 24, record.price).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, out + 24, record.quantity).ptr;
+    *out++ = '\n';
+    return out;
+  }
+
+  template<typename T, typename Field>
+  std::uint64_t write_column(const std::string& path, const char* descr, const MappedTicks& ticks, Field field) {
+    BufferedWriter out(path);
+    std::string header = npy::header(std::string("'") + descr + "'", ticks.count());
+    out.write(header.data(), header.size());
+
+    const TickRecord* records = ticks.records();
+    const std::size_t count = ticks.count();
+    const std::size_t per_chunk = EXPORT_WRITE_BUFFER_SIZE / sizeof(T);
+    for (std::size_t begin = 0; begin < count; begin += per_chunk) {
+      std::size_t end = std::min(count, begin + per_chunk);
+      auto* column = reinterpret_cast<T*>(out.reserve((end - begin) * sizeof(T)));
+      for (std::size_t i = begin; i < end; ++i) {
+        *column++ = field(records[i]);
+      }
+      out.commit(reinterpret_cast<char*>(column));
+    }
+    out.close();
+    return out.ok() ? out.written() : 0;
+  }
+}
+
+double ExportStats::input_mb_per_s() const {
+  return seconds > 0.0 ? static_cast<double>(bytes_in) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+double ExportStats::output_mb_per_s() const {
+  return seconds > 0.0 ? static_cast<double>(bytes_out) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+HistoryExporter::HistoryExporter(const std::string& history_dir, const std::string& output_dir, unsigned workers) :
+  history_dir_(history_dir),
+  output_dir_(output_dir),
+  workers_(workers ? workers : std::max(1u, std::thread::hardware_concurrency())) {
+  if (!history_dir_.empty() && history_dir_.back() != '/') {
+    history_dir_ += '/';
+  }
+  if (!output_dir_.empty() && output_dir_.back() != '/') {
+    output_dir_ += '/';
+  }
+}
+
+std::vector<HistoryExporter::Job> HistoryExporter::collect_jobs() const {
+  std::vector<std::pair<std::uintmax_t, Job>> sized;
+  std::error_code ec;
+  for (const auto& day : std::filesystem::directory_iterator(history_dir_, ec)) {
+    if (!day.is_directory()) {
+      continue;
+    }
+    for (const auto& file : std::filesystem::directory_iterator(day.path(), ec)) {
+      if (file.path().extension() == ".ticks") {
+        std::error_code size_ec;
+        std::uintmax_t size = std::filesystem::file_size(file.path(), size_ec);
+        sized.push_back({size_ec ? 0 : size, {day.path().filename().string(), file.path().stem().string()}});
+      }
+    }
+  }
+  // biggest files first so one late large file does not leave the other workers idle
+  std::stable_sort(sized.begin(), sized.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+  std::vector<Job> jobs;
+  jobs.reserve(sized.size());
+  for (auto& entry : sized) {
+    jobs.push_back(std::move(entry.second));
+  }
+  return jobs;
+}
+
+ExportStats HistoryExporter::export_all(ExportFormat format) const {
+  const std::vector<Job> jobs = collect_jobs();
+  std::atomic<std::size_t> next_job{0};
+  std::atomic<std::size_t> files{0};
+  std::atomic<std::uint64_t> records{0};
+  std::atomic<std::uint64_t> bytes_in{0};
+  std::atomic<std::uint64_t> bytes_out{0};
+
+  const std::int64_t start_ns = Clock::now_ns();
+
+  auto worker = [&]() {
+    for (std::size_t i = next_job++; i < jobs.size(); i = next_job++) {
+      const Job& job = jobs[i];
+      const std::string ticks_path = tick_files::ticks_path(history_dir_, job.day, job.symbol);
+      std::error_code ec;
+      std::filesystem::create_directories(output_dir_ + job.day, ec);
+
+      std::uint64_t written = format == ExportFormat::csv
+                                  ? export_csv(ticks_path, output_dir_ + job.day + "/" + job.symbol + ".csv")
+                                  : export_npy(ticks_path, output_dir_ + job.day + "/" + job.symbol);
+      if (written == 0) {
+        continue;
+      }
+      ++files;
+      bytes_out += written;
+      std::uintmax_t size = std::filesystem::file_size(ticks_path, ec);
+      if (!ec && size >= sizeof(TickFileHeader)) {
+        records += (size - sizeof(TickFileHeader)) / sizeof(TickRecord);
+        bytes_in += size;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  unsigned count = std::min<unsigned>(workers_, std::max<std::size_t>(1, jobs.size()));
+  for (unsigned i = 1; i < count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ExportStats stats;
+  stats.files = files;
+  stats.records = records;
+  stats.bytes_in = bytes_in;
+  stats.bytes_out = bytes_out;
+  stats.seconds = static_cast<double>(Clock::now_ns() - start_ns) / 1e9;
+  return stats;
+}
+
+std::uint64_t HistoryExporter::export_csv(const std::string& ticks_path, const std::string& csv_path) {
+  MappedTicks ticks(ticks_path);
+  if (!ticks.valid()) {
+    std::cerr << "Skipping unreadable tick file " << ticks_path << std::endl;
+    return 0;
+  }
+
+  BufferedWriter out(csv_path);
+  static constexpr char header[] = "trade_time,trade_id,price,quantity\n";
+  out.write(header, sizeof(header) - 1);
+
+  const TickRecord* records = ticks.records();
+  const std::size_t count = ticks.count();
+  const std::size_t rows_per_chunk = EXPORT_WRITE_BUFFER_SIZE / MAX_CSV_ROW;
+  for (std::size_t begin = 0; begin < count; begin += rows_per_chunk) {
+    std::size_t end = std::min(count, begin + rows_per_chunk);
+    char* cursor = out.reserve((end - begin) * MAX_CSV_ROW);
+    for (std::size_t i = begin; i < end; ++i) {
+      cursor = format_row(cursor, records[i]);
+    }
+    out.commit(cursor);
+  }
+  out.close();
+  return out.ok() ? out.written() : 0;
+}
+
+std::uint64_t HistoryExporter::export_npy(const std::string& ticks_path, const std::string& npy_directory) {
+  MappedTicks ticks(ticks_path);
+  if (!ticks.valid()) {
+    std::cerr << "Skipping unreadable tick file " << ticks_path << std::endl;
+    return 0;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(npy_directory, ec);
+
+  const std::string base = npy_directory + "/";
+  // a file only counts as exported with all four columns; a missing one would misalign the others
+  const std::uint64_t columns[] = {
+    write_column<std::int64_t>(base + "trade_time.npy", "<i8", ticks, [](const TickRecord& r) { return r.trade_time; }),
+    write_column<std::int64_t>(base + "trade_id.npy", "<i8", ticks, [](const TickRecord& r) { return r.trade_id; }),
+    write_column<double>(base + "price.npy", "<f8", ticks, [](const TickRecord& r) { return r.price; }),
+    write_column<double>(base + "quantity.npy", "<f8", ticks, [](const TickRecord& r) { return r.quantity; })};
+  static const char* const names[] = {"trade_time.npy", "trade_id.npy", "price.npy", "quantity.npy"};
+  std::uint64_t written = 0;
+  for (std::size_t i = 0; i < std::size(columns); ++i) {
+    if (columns[i] == 0) {
+      std::cerr << "Failed to export column " << base << names[i] << " of " << ticks_path << std::endl;
+      return 0;
+    }
+    written += columns[i];
+  }
+  return written;
+}
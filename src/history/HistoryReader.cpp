@@ -0,0 +1,213 @@
+#include "../../include/history/HistoryReader.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+  std::int64_t day_number(const std::string& day) {
+    std::tm time{};
+    if (std::sscanf(day.c_str(), "%d-%d-%d", &time.tm_year, &time.tm_mon, &time.tm_mday) != 3) {
+      return -1;
+    }
+    time.tm_year -= 1900;
+    time.tm_mon -= 1;
+    return static_cast<std::int64_t>(timegm(&time)) / 86400;
+  }
+
+  bool read_header(std::FILE* file, std::uint32_t magic, std::uint32_t record_size) {
+    TickFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1) {
+      return false;
+    }
+    return header.magic == magic && header.version == TICK_FILE_VERSION && header.record_size == record_size;
+  }
+}
+
+HistoryReader::HistoryReader(const std::string& directory, const std::string& symbol) :
+  directory_(directory),
+  symbol_(symbol),
+  key_(Key::time),
+  begin_(0),
+  end_(0),
+  next_day_(0),
+  file_(nullptr),
+  skipping_(false),
+  done_(true) {
+  if (!directory_.empty() && directory_.back() != '/') {
+    directory_ += '/';
+  }
+}
+
+HistoryReader::~HistoryReader() {
+  close_file();
+}
+
+bool HistoryReader::seek_time(std::int64_t begin_ms, std::int64_t end_ms) {
+  close_file();
+  key_ = Key::time;
+  begin_ = begin_ms;
+  end_ = end_ms;
+  days_.clear();
+  next_day_ = 0;
+  done_ = begin_ms >= end_ms;
+  if (done_) {
+    return false;
+  }
+
+  const std::int64_t first_day = begin_ms / tick_files::MS_PER_DAY;
+  const std::int64_t last_day = (end_ms - 1) / tick_files::MS_PER_DAY;
+  for (const std::string& day : available_days()) {
+    std::int64_t number = day_number(day);
+    if (number >= first_day && number <= last_day) {
+      days_.push_back(day);
+    }
+  }
+  done_ = days_.empty();
+  return !done_;
+}
+
+bool HistoryReader::seek_trade_id(std::int64_t begin_id, std::int64_t end_id) {
+  close_file();
+  key_ = Key::trade_id;
+  begin_ = begin_id;
+  end_ = end_id;
+  days_.clear();
+  next_day_ = 0;
+  done_ = begin_id >= end_id;
+  if (done_) {
+    return false;
+  }
+
+  // trade ids grow monotonically across days, so the first index entry of each day orders the days
+  std::vector<std::string> days = available_days();
+  auto first_id = [this](const std::string& day) {
+    std::vector<TickIndexEntry> index = load_index(tick_files::index_path(directory_, day, symbol_));
+    return index.empty() ? std::int64_t{0} : index.front().first_trade_id;
+  };
+  auto after = std::partition_point(days.begin(), days.end(),
+                                    [&](const std::string& day) { return first_id(day) <= begin_id; });
+  auto start = after == days.begin() ? days.begin() : after - 1;
+  days_.assign(start, days.end());
+  done_ = days_.empty();
+  return !done_;
+}
+
+std::size_t HistoryReader::read(TickRecord* buffer, std::size_t capacity) {
+  std::size_t filled = 0;
+
+  while (filled < capacity && !done_) {
+    if (!file_ && !open_next_day()) {
+      done_ = true;
+      break;
+    }
+
+    TickRecord* chunk = buffer + filled;
+    std::size_t got = std::fread(chunk, sizeof(TickRecord), capacity - filled, file_);
+    if (got == 0) {
+      close_file();
+      continue;
+    }
+
+    // the located block may start before the range; everything after the first match is in range
+    std::size_t first = 0;
+    if (skipping_) {
+      while (first < got && key_of(chunk[first]) < begin_) {
+        ++first;
+      }
+      skipping_ = first == got;
+    }
+    std::size_t last = first;
+    while (last < got && key_of(chunk[last]) < end_) {
+      ++last;
+    }
+
+    if (first > 0 && last > first) {
+      std::memmove(chunk, chunk + first, (last - first) * sizeof(TickRecord));
+    }
+    filled += last - first;
+
+    if (last < got) {
+      done_ = true;
+      close_file();
+    }
+  }
+  return filled;
+}
+
+bool HistoryReader::done() const {
+  return done_;
+}
+
+bool HistoryReader::open_next_day() {
+  while (next_day_ < days_.size()) {
+    const std::string& day = days_[next_day_++];
+    const std::string path = tick_files::ticks_path(directory_, day, symbol_);
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+      continue;
+    }
+    if (!read_header(file_, TICK_FILE_MAGIC, sizeof(TickRecord))) {
+      std::cerr << "Skipping history file with bad header: " << path << std::endl;
+      close_file();
+      continue;
+    }
+
+    // first block whose first key is >= begin; the block before it may still hold matching records
+    std::vector<TickIndexEntry> index = load_index(tick_files::index_path(directory_, day, symbol_));
+    auto it = std::lower_bound(index.begin(), index.end(), begin_,
+                               [this](const TickIndexEntry& entry, std::int64_t key) { return key_of(entry) < key; });
+    if (it != index.begin()) {
+      std::fseek(file_, static_cast<long>((it - 1)->offset), SEEK_SET);
+    }
+    skipping_ = true;
+    return true;
+  }
+  return false;
+}
+
+void HistoryReader::close_file() {
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+std::int64_t HistoryReader::key_of(const TickRecord& record) const {
+  return key_ == Key::time ? record.trade_time : record.trade_id;
+}
+
+std::int64_t HistoryReader::key_of(const TickIndexEntry& entry) const {
+  return key_ == Key::time ? entry.first_trade_time : entry.first_trade_id;
+}
+
+std::vector<std::string> HistoryReader::available_days() const {
+  std::vector<std::string> days;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+    if (entry.is_directory() && std::filesystem::exists(entry.path() / (symbol_ + ".ticks"))) {
+      days.push_back(entry.path().filename().string());
+    }
+  }
+  std::sort(days.begin(), days.end());
+  return days;
+}
+
+std::vector<TickIndexEntry> HistoryReader::load_index(const std::string& index_path) {
+  std::vector<TickIndexEntry> entries;
+  std::FILE* file = std::fopen(index_path.c_str(), "rb");
+  if (!file) {
+    return entries;
+  }
+  if (read_header(file, TICK_INDEX_MAGIC, sizeof(TickIndexEntry))) {
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    entries.resize((size - static_cast<long>(sizeof(TickFileHeader))) / sizeof(TickIndexEntry));
+    std::fseek(file, sizeof(TickFileHeader), SEEK_SET);
+    entries.resize(std::fread(entries.data(), sizeof(TickIndexEntry), entries.size(), file));
+  }
+  std::fclose(file);
+  return entries;
+}
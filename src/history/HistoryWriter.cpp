@@ -0,0 +1,182 @@
+#include "../../include/history/HistoryWriter.h"
+#include <filesystem>
+#include <iostream>
+#include "../../include/common/Coin.h"
+
+#define HISTORY_WRITE_BUFFER_SIZE (256 * 1024)
+
+HistoryWriter::HistoryWriter(const std::string& directory) : directory_(directory) {
+  if (!directory_.empty() && directory_.back() != '/') {
+    directory_ += '/';
+  }
+}
+
+HistoryWriter::~HistoryWriter() {
+  for (auto& pair : files_) {
+    close_file(*pair.second);
+  }
+}
+
+bool HistoryWriter::append(const CoinData& data) {
+  TickRecord record{data.trade_time, data.trade_id, data.price, data.trade_quantity};
+  return append(data.symbol, record);
+}
+
+bool HistoryWriter::append(const std::string& symbol, const TickRecord& record) {
+  std::unique_ptr<SymbolFile>& slot = files_[symbol];
+  if (!slot) {
+    slot = std::make_unique<SymbolFile>();
+  }
+  SymbolFile& file = *slot;
+
+  // the day string is only rebuilt when the trade falls outside the currently open day
+  std::int64_t day_number = record.trade_time / tick_files::MS_PER_DAY;
+  if (!file.ticks || day_number != file.day_number) {
+    if (!open_day(symbol, file, tick_files::day_string(record.trade_time))) {
+      return false;
+    }
+    file.day_number = day_number;
+  }
+
+  if (file.record_count % TICK_INDEX_BLOCK_RECORDS == 0) {
+    TickIndexEntry entry{record.trade_time, record.trade_id,
+                         sizeof(TickFileHeader) + file.record_count * sizeof(TickRecord)};
+    std::fwrite(&entry, sizeof(entry), 1, file.index);
+    std::fflush(file.index);
+  }
+
+  if (std::fwrite(&record, sizeof(record), 1, file.ticks) != 1) {
+    std::cerr << "Failed to write tick for " << symbol << std::endl;
+    return false;
+  }
+  ++file.record_count;
+  return true;
+}
+
+// rewrites index_path with one entry per block of the first `blocks` blocks in ticks_path, read from each block's
+// first record
+static bool rebuild_index(const std::string& ticks_path, const std::string& index_path, std::uint64_t blocks) {
+  std::FILE* ticks = std::fopen(ticks_path.c_str(), "rb");
+  if (!ticks) {
+    return false;
+  }
+  std::FILE* index = std::fopen(index_path.c_str(), "wb");
+  if (!index) {
+    std::fclose(ticks);
+    return false;
+  }
+  const TickFileHeader index_header{TICK_INDEX_MAGIC, TICK_FILE_VERSION, sizeof(TickIndexEntry),
+                                    TICK_INDEX_BLOCK_RECORDS};
+  bool ok = std::fwrite(&index_header, sizeof(index_header), 1, index) == 1;
+  for (std::uint64_t block = 0; ok && block < blocks; ++block) {
+    const std::uint64_t offset = sizeof(TickFileHeader) + block * TICK_INDEX_BLOCK_RECORDS * sizeof(TickRecord);
+    TickRecord first{};
+    ok = std::fseek(ticks, static_cast<long>(offset), SEEK_SET) == 0 && std::fread(&first, sizeof(first), 1, ticks) == 1;
+    if (ok) {
+      TickIndexEntry entry{first.trade_time, first.trade_id, offset};
+      ok = std::fwrite(&entry, sizeof(entry), 1, index) == 1;
+    }
+  }
+  std::fclose(ticks);
+  ok = std::fclose(index) == 0 && ok;
+  return ok;
+}
+
+bool HistoryWriter::open_day(const std::string& symbol, SymbolFile& file, const std::string& day) {
+  close_file(file);
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory_ + day, ec);
+  if (ec) {
+    std::cerr << "Unable to create history directory " << directory_ + day << ": " << ec.message() << std::endl;
+    return false;
+  }
+
+  const std::string ticks_path = tick_files::ticks_path(directory_, day, symbol);
+  const std::string index_path = tick_files::index_path(directory_, day, symbol);
+  const TickFileHeader ticks_header{TICK_FILE_MAGIC, TICK_FILE_VERSION, sizeof(TickRecord), TICK_INDEX_BLOCK_RECORDS};
+  const TickFileHeader index_header{TICK_INDEX_MAGIC, TICK_FILE_VERSION, sizeof(TickIndexEntry),
+                                    TICK_INDEX_BLOCK_RECORDS};
+
+  // resuming an existing day: drop a torn trailing record left by a crash so records stay aligned,
+  // and drop index entries pointing past the surviving records. An index missing entries for blocks
+  // already in the .ticks file is rebuilt from their first records, otherwise seeks would skip them
+  std::uint64_t existing = 0;
+  bool ticks_exists = false;
+  bool index_exists = false;
+  std::uintmax_t size = std::filesystem::file_size(ticks_path, ec);
+  if (!ec && size >= sizeof(TickFileHeader)) {
+    existing = (size - sizeof(TickFileHeader)) / sizeof(TickRecord);
+    std::filesystem::resize_file(ticks_path, sizeof(TickFileHeader) + existing * sizeof(TickRecord), ec);
+    ticks_exists = true;
+  }
+  if (ticks_exists) {
+    std::uint64_t blocks = (existing + TICK_INDEX_BLOCK_RECORDS - 1) / TICK_INDEX_BLOCK_RECORDS;
+    std::uintmax_t index_size = std::filesystem::file_size(index_path, ec);
+    std::uintmax_t entries = 0;
+    if (!ec && index_size >= sizeof(TickFileHeader)) {
+      entries = (index_size - sizeof(TickFileHeader)) / sizeof(TickIndexEntry);
+    }
+    if (!ec && entries >= blocks) {
+      std::filesystem::resize_file(index_path, sizeof(TickFileHeader) + blocks * sizeof(TickIndexEntry), ec);
+      index_exists = true;
+    } else if (!rebuild_index(ticks_path, index_path, blocks)) {
+      std::cerr << "Unable to rebuild history index " << index_path << ", not resuming " << symbol << " on " << day
+                << std::endl;
+      return false;
+    } else {
+      index_exists = true;
+    }
+  } else {
+    std::filesystem::remove(ticks_path, ec);
+    std::filesystem::remove(index_path, ec);
+  }
+
+  file.ticks = std::fopen(ticks_path.c_str(), "ab");
+  file.index = std::fopen(index_path.c_str(), "ab");
+  if (!file.ticks || !file.index) {
+    std::cerr << "Unable to open history files for " << symbol << " on " << day << std::endl;
+    close_file(file);
+    return false;
+  }
+
+  file.buffer.resize(HISTORY_WRITE_BUFFER_SIZE);
+  std::setvbuf(file.ticks, file.buffer.data(), _IOFBF, file.buffer.size());
+
+  if (!ticks_exists) {
+    std::fwrite(&ticks_header, sizeof(ticks_header), 1, file.ticks);
+  }
+  if (!index_exists) {
+    std::fwrite(&index_header, sizeof(index_header), 1, file.index);
+  }
+
+  file.day = day;
+  file.record_count = existing;
+  return true;
+}
+
+void HistoryWriter::close_file(SymbolFile& file) {
+  if (file.ticks) {
+    std::fclose(file.ticks);
+    file.ticks = nullptr;
+  }
+  if (file.index) {
+    std::fclose(file.index);
+    file.index = nullptr;
+  }
+  file.record_count = 0;
+  file.day.clear();
+  file.day_number = -1;
+}
+
+void HistoryWriter::flush() {
+  for (auto& pair : files_) {
+    if (pair.second->ticks) {
+      std::fflush(pair.second->ticks);
+    }
+  }
+}
+
+const std::string& HistoryWriter::directory() const {
+  return directory_;
+}
@@ -0,0 +1,171 @@
+#include "../../include/history/Snapshot.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+  struct SnapshotHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t coin_count;
+    std::uint32_t reserved;
+    std::int64_t created_ms;
+  };
+
+  template<typename T>
+  bool write_value(std::FILE* file, const T& value) {
+    return std::fwrite(&value, sizeof(T), 1, file) == 1;
+  }
+
+  // makes a rename in the directory durable
+  bool sync_directory(const std::filesystem::path& path) {
+    const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : ".";
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+      return false;
+    }
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+  }
+
+  template<typename T>
+  bool read_value(std::FILE* file, T& value) {
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+  }
+
+  bool write_bar(std::FILE* file, const Bar& bar) {
+    return write_value(file, static_cast<std::int64_t>(bar.open_time)) && write_value(file, bar.open) &&
+           write_value(file, bar.high) && write_value(file, bar.low) && write_value(file, bar.close) &&
+           write_value(file, bar.volume) && write_value(file, static_cast<std::int64_t>(bar.trade_count));
+  }
+
+  bool read_bar(std::FILE* file, Bar& bar) {
+    std::int64_t open_time = 0;
+    std::int64_t trade_count = 0;
+    bool ok = read_value(file, open_time) && read_value(file, bar.open) && read_value(file, bar.high) &&
+              read_value(file, bar.low) && read_value(file, bar.close) && read_value(file, bar.volume) &&
+              read_value(file, trade_count);
+    bar.open_time = static_cast<long>(open_time);
+    bar.trade_count = static_cast<long>(trade_count);
+    return ok;
+  }
+}
+
+namespace snapshot {
+  bool save(const std::string& path, const std::vector<CoinSnapshot>& coins, std::int64_t created_ms) {
+    const std::string tmp_path = path + ".tmp";
+    std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (!file) {
+      std::cerr << "Unable to write snapshot " << tmp_path << std::endl;
+      return false;
+    }
+
+    bool ok = write_value(file, SnapshotHeader{SNAPSHOT_MAGIC, SNAPSHOT_VERSION,
+                                               static_cast<std::uint32_t>(coins.size()), 0, created_ms});
+    for (const CoinSnapshot& coin : coins) {
+      const CoinData& last = coin.last_trade;
+      ok = ok && write_value(file, static_cast<std::uint32_t>(last.symbol.size()));
+      ok = ok && std::fwrite(last.symbol.data(), 1, last.symbol.size(), file) == last.symbol.size();
+      ok = ok && write_value(file, last.price);
+      ok = ok && write_value(file, static_cast<std::int64_t>(last.trade_id));
+      ok = ok && write_value(file, last.trade_quantity);
+      ok = ok && write_value(file, static_cast<std::int64_t>(last.trade_time));
+      ok = ok && write_value(file, static_cast<std::uint32_t>(coin.ma_window.size()));
+      ok = ok && std::fwrite(coin.ma_window.data(), sizeof(double), coin.ma_window.size(), file) ==
+                     coin.ma_window.size();
+      ok = ok && write_value(file, static_cast<std::uint32_t>(coin.bars.size()));
+      for (const BarSeriesSnapshot& series : coin.bars) {
+        ok = ok && write_value(file, static_cast<std::int64_t>(series.resolution_ms));
+        ok = ok && write_value(file, static_cast<std::uint32_t>(series.has_current));
+        ok = ok && write_bar(file, series.current);
+        ok = ok && write_value(file, static_cast<std::uint32_t>(series.closed.size()));
+        for (const Bar& bar : series.closed) {
+          ok = ok && write_bar(file, bar);
+        }
+      }
+    }
+    // on disk before the rename, or a crash could leave the new name pointing at unwritten data
+    ok = ok && std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code ec;
+    if (ok) {
+      std::filesystem::rename(tmp_path, path, ec);
+    }
+    if (ok && !ec && !sync_directory(path)) {
+      std::cerr << "Unable to sync the directory of snapshot " << path << std::endl;
+    }
+    if (!ok || ec) {
+      std::cerr << "Failed to write snapshot " << path << std::endl;
+      std::filesystem::remove(tmp_path, ec);
+      return false;
+    }
+    return true;
+  }
+
+  bool load(const std::string& path, std::vector<CoinSnapshot>& coins) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+      return false;
+    }
+
+    SnapshotHeader header{};
+    bool ok = read_value(file, header) && header.magic == SNAPSHOT_MAGIC &&
+              header.version == SNAPSHOT_VERSION;
+    std::vector<CoinSnapshot> loaded;
+    for (std::uint32_t i = 0; ok && i < header.coin_count; ++i) {
+      CoinSnapshot coin;
+      std::uint32_t symbol_length = 0;
+      std::int64_t trade_id = 0;
+      std::int64_t trade_time = 0;
+      std::uint32_t window_count = 0;
+
+      ok = read_value(file, symbol_length) && symbol_length <= 64;
+      if (ok) {
+        coin.last_trade.symbol.resize(symbol_length);
+        ok = std::fread(coin.last_trade.symbol.data(), 1, symbol_length, file) == symbol_length;
+      }
+      ok = ok && read_value(file, coin.last_trade.price);
+      ok = ok && read_value(file, trade_id);
+      ok = ok && read_value(file, coin.last_trade.trade_quantity);
+      ok = ok && read_value(file, trade_time);
+      ok = ok && read_value(file, window_count) && window_count <= (1u << 20);
+      if (ok) {
+        coin.ma_window.resize(window_count);
+        ok = std::fread(coin.ma_window.data(), sizeof(double), window_count, file) == window_count;
+      }
+      std::uint32_t series_count = 0;
+      ok = ok && read_value(file, series_count) && series_count <= 64;
+      for (std::uint32_t s = 0; ok && s < series_count; ++s) {
+        BarSeriesSnapshot& series = coin.bars.emplace_back();
+        std::int64_t resolution_ms = 0;
+        std::uint32_t has_current = 0;
+        std::uint32_t closed_count = 0;
+        ok = read_value(file, resolution_ms) && read_value(file, has_current) && read_bar(file, series.current) &&
+             read_value(file, closed_count) && closed_count <= (1u << 20);
+        series.resolution_ms = static_cast<long>(resolution_ms);
+        series.has_current = has_current != 0;
+        if (ok) {
+          series.closed.resize(closed_count);
+        }
+        for (std::uint32_t b = 0; ok && b < closed_count; ++b) {
+          ok = read_bar(file, series.closed[b]);
+        }
+      }
+      coin.last_trade.trade_id = static_cast<long>(trade_id);
+      coin.last_trade.trade_time = static_cast<long>(trade_time);
+      loaded.push_back(std::move(coin));
+    }
+    std::fclose(file);
+
+    if (!ok) {
+      std::cerr << "Ignoring corrupt snapshot " << path << std::endl;
+      return false;
+    }
+    coins = std::move(loaded);
+    return true;
+  }
+}
@@ -0,0 +1,39 @@
+#include "../../include/history/TickRecord.h"
+#include <ctime>
+#include <filesystem>
+#include <set>
+
+namespace tick_files {
+  std::string day_string(std::int64_t epoch_ms) {
+    std::time_t t = static_cast<std::time_t>(epoch_ms / 1000);
+    std::tm time{};
+    gmtime_r(&t, &time);
+    char day[11];
+    std::strftime(day, sizeof(day), "%Y-%m-%d", &time);
+    return day;
+  }
+
+  std::string ticks_path(const std::string& directory, const std::string& day, const std::string& symbol) {
+    return directory + day + "/" + symbol + ".ticks";
+  }
+
+  std::string index_path(const std::string& directory, const std::string& day, const std::string& symbol) {
+    return directory + day + "/" + symbol + ".idx";
+  }
+
+  std::vector<std::string> captured_symbols(const std::string& directory) {
+    std::set<std::string> symbols;
+    std::error_code ec;
+    for (const auto& day : std::filesystem::directory_iterator(directory, ec)) {
+      if (!day.is_directory()) {
+        continue;
+      }
+      for (const auto& file : std::filesystem::directory_iterator(day.path(), ec)) {
+        if (file.path().extension() == ".ticks") {
+          symbols.insert(file.path().stem().string());
+        }
+      }
+    }
+    return {symbols.begin(), symbols.end()};
+  }
+}
@@ -1,20 +1,168 @@
 
 #include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
 #include <thread>
+#include "../include/bus/MarketBus.h"
 #include "../include/client/BinanceClient.h"
 
+#include "../include/common/Clock.h"
 #include "../include/common/CoinManager.h"
+#include "../include/exchange/OrderGateway.h"
+#include "../include/exchange/PaperExchange.h"
+#include "../include/exchange/PaperOrderRouter.h"
+#include "../include/fpga/FpgaEmulator.h"
+#include "../include/fpga/OffloadMovingAverageBackend.h"
+#include "../include/history/HistoryWriter.h"
 #include "../include/logging/Logger.h"
+#include "../include/metrics/LatencyTracker.h"
+#include "../include/metrics/MetricsRegistry.h"
+#include "../include/metrics/PerfCounters.h"
+#include "../include/metrics/Tracer.h"
+#include "../include/ml/FeaturePipeline.h"
+#include "../include/ml/Model.h"
+#include "../include/ml/ModelScorer.h"
+#include "../include/net/HttpServer.h"
+#include "../include/risk/PositionBook.h"
+#include "../include/risk/RiskManager.h"
+#include "../include/risk/RollingCorrelation.h"
+#include "../include/strategy/MaCrossStrategy.h"
+#include "../include/strategy/StrategyEngine.h"
+#include "../include/strategy/TriangularArbitrage.h"
 
 int main() {
+  // OpenSSL writes to sockets with write(); a peer that reset the connection must fail that call, not end the process
+  std::signal(SIGPIPE, SIG_IGN);
+  Clock::calibrate();
   Logger& logger = Logger::getInstance();
   logger.log(warning, "data666", "message3");
+  // declared ahead of the coins, which hold the backend until the CoinManager (and its checkpoint thread) is gone
+  FpgaEmulator fpga_emulator;
+  std::unique_ptr<OffloadMovingAverageBackend> average_offload;
   CoinManager coin_manager;
+  HistoryWriter history_writer("../history/");
+  coin_manager.set_history_writer(&history_writer);
+  coin_manager.restore_snapshot("../history/coins.snapshot", history_writer.directory());
+  coin_manager.enable_checkpoints("../history/coins.snapshot", 10000);
 
+  // CRYPTO_MA_OFFLOAD=<serial device> runs the coins' moving averages on the FPGA unit, or on its pty emulator with
+  // CRYPTO_MA_OFFLOAD=emulator; CRYPTO_MA_OFFLOAD_BATCH=<n> sends n updates per round trip (default 1)
+  if (const char* offload_device = std::getenv("CRYPTO_MA_OFFLOAD")) {
+    const char* batch = std::getenv("CRYPTO_MA_OFFLOAD_BATCH");
+    average_offload = std::make_unique<OffloadMovingAverageBackend>(batch ? std::strtoul(batch, nullptr, 10) : 1);
+    const bool emulated = std::string(offload_device) == "emulator";
+    if ((!emulated || fpga_emulator.start())
+        && average_offload->open(emulated ? fpga_emulator.device() : std::string(offload_device))) {
+      coin_manager.set_moving_average_backend(average_offload.get());
+    } else {
+      average_offload.reset();
+    }
+  }
+
+  LATENCY_TRACKER.set_mode(LatencyMode::sampled, 64);
+  LATENCY_TRACKER.start_reporting(std::chrono::seconds(10), [&logger](const std::string& report) {
+    std::size_t start = 0;
+    for (std::size_t end = report.find('\n'); end != std::string::npos; end = report.find('\n', start)) {
+      logger.log(info, "latency", report.substr(start, end - start));
+      start = end + 1;
+    }
+  });
+
+  // Prometheus scrape target on http://127.0.0.1:9464/metrics, served from the HttpServer thread
+  METRICS.add_collector([](std::string& out) { LATENCY_TRACKER.write_prometheus(out); });
+  HttpServer metrics_server(9464);
+  metrics_server.route("GET", "/metrics", [](const HttpRequest&) {
+    HttpResponse response;
+    response.content_type = "text/plain; version=0.0.4";
+    response.body = METRICS.render();
+    return response;
+  });
+  // hardware counters per pipeline stage so far, on demand: curl http://127.0.0.1:9464/perf
+  metrics_server.route("GET", "/perf", [](const HttpRequest&) {
+    HttpResponse response;
+    response.content_type = "text/plain";
+#ifdef PERF_COUNTERS_ENABLED
+    response.body = PERF_PROFILER.report();
+#else
+    response.body = "perf counters are not compiled in, configure with -DENABLE_PERF_COUNTERS=ON\n";
+#endif
+    return response;
+  });
+  metrics_server.start();
+
+  // CRYPTO_TRACE=<file> records pipeline spans as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+  if (const char* trace_path = std::getenv("CRYPTO_TRACE")) {
+    TRACER.start(trace_path);
+  }
+
+  StrategyEngine strategy_engine;
+  std::vector<std::unique_ptr<MaCrossStrategy>> strategies;
+  std::unique_ptr<TriangularArbitrage> arbitrage;
+  RollingCorrelation correlation(300); // five minutes of one-second returns
+  // CRYPTO_FEATURES=<name>.npy streams a row per trade and per 1 min bar to that file, symbols in <name>_symbols.txt
+  FeaturePipeline features;
+  const char* features_path = std::getenv("CRYPTO_FEATURES");
+  // CRYPTO_MODEL=<file> scores each feature row with an exported model (format in Model.h) as it is produced; the
+  // scorer is then the rows' consumer, so there is nothing left for CRYPTO_FEATURES to export
+  Model model;
+  std::unique_ptr<ModelScorer> scorer;
+  if (const char* model_path = std::getenv("CRYPTO_MODEL"); model_path && model.load(model_path)) {
+    scorer = std::make_unique<ModelScorer>(features, model);
+    if (features_path) {
+      std::cout << "Warning: CRYPTO_FEATURES ignored while CRYPTO_MODEL consumes the feature rows" << std::endl;
+      features_path = nullptr;
+    }
+  }
+  if (features_path && !features.begin_export(features_path)) {
+    features_path = nullptr;
+  }
+  // Orders round to each symbol's Binance PRICE_FILTER tickSize and LOT_SIZE stepSize; a symbol missing here is
+  // not paper traded, as the wrong tick or lot would misprice its orders. Every signal trades order_quantity, a
+  // whole number of lots.
+  const std::unordered_map<std::string, PaperSymbolFilters> paper_filters = {
+    {"btcusdt", {0.01, 0.00001, 0.001}}, {"ethusdt", {0.01, 0.0001, 0.001}}, {"solusdt", {0.01, 0.001, 0.001}}};
+  // with the paper exchange running, signals also go out as market orders through the router, after the
+  // pre-trade risk check; executions update the risk state and the position book, which the metrics endpoint
+  // reads from its own thread
+  RiskManager risk;
+  PositionBook positions;
+  METRICS.add_collector([&positions](std::string& out) { positions.write_prometheus(out); });
+  PaperOrderRouter paper_router(strategy_engine, risk, positions);
+  paper_router.set_notice_handler([&logger](const std::string& source, const std::string& message) {
+    logger.log(warning, source, message);
+  });
+  strategy_engine.set_signal_handler([&](const Signal& signal) {
+    const char* side = signal.side == SignalSide::buy ? " buy" : " sell";
+    logger.log(info, signal.strategy, signal.symbol + side + " " + std::to_string(signal.price));
+    paper_router.on_signal(signal);
+  });
+  coin_manager.set_strategy_engine(&strategy_engine);
+
+  // CRYPTO_MARKET_BUS=<name> publishes coin state and trades in /dev/shm/<name> for local readers
+  // (libmarket_bus, see include/bus/market_bus.h)
+  MarketBus market_bus;
+  if (const char* bus_name = std::getenv("CRYPTO_MARKET_BUS")) {
+    if (market_bus.create(bus_name)) {
+      coin_manager.set_market_bus(&market_bus);
+      std::cout << "Market bus: /dev/shm/" << bus_name << std::endl;
+    }
+  }
+
+  // CRYPTO_PAPER_PORT=<port> serves a paper-trading stand-in of the Binance order API, matched against live trades
+  PaperExchange paper_exchange;
+  std::unique_ptr<HttpServer> paper_server;
+  if (const char* paper_port = std::getenv("CRYPTO_PAPER_PORT")) {
+    paper_server = std::make_unique<HttpServer>(static_cast<std::uint16_t>(std::atoi(paper_port)));
+    paper_exchange.serve(*paper_server);
+    paper_exchange.set_fill_handler([&logger](const PaperFill& fill) {
+      logger.log(info, "paper", fill.symbol + (fill.side == OrderSide::buy ? " bought " : " sold ") +
+                                  std::to_string(fill.quantity) + " @ " + std::to_string(fill.price));
+    });
+  }
 
   BinanceClient binance_client(coin_manager);
-  coin_manager.set_binance_client(&binance_client);
+  coin_manager.add_feed(&binance_client);
 
   binance_client.setup_websocket("wss://stream.binance.com:9443/ws/websocket");
 
@@ -36,13 +184,145 @@ int main() {
   if (connected) {
     std::cout << "Subscribing to streams..." << std::endl;
     std::vector<std::string> symbols = {"btcusdt", "ethusdt", "solusdt" };
+    for (const std::string& symbol : symbols) {
+      strategies.push_back(std::make_unique<MaCrossStrategy>(strategy_engine));
+      strategy_engine.subscribe(symbol, EVENT_MA_CROSS, *strategies.back());
+      if (features_path || scorer) {
+        features.add_symbol(symbol);
+        strategy_engine.subscribe(symbol, EVENT_TRADE | EVENT_BAR_CLOSE | EVENT_QUOTE, features);
+      }
+      if (scorer) {
+        strategy_engine.subscribe(symbol, EVENT_TRADE | EVENT_BAR_CLOSE, *scorer);
+      }
+      if (paper_server) {
+        const auto filters = paper_filters.find(symbol);
+        if (filters == paper_filters.end()) {
+          std::cout << "Not paper trading " << symbol << ": no tick / lot size for it" << std::endl;
+          continue;
+        }
+        SymbolRiskLimits limits;
+        limits.max_position = 0.01;
+        limits.max_notional = 1000.0;
+        limits.max_price_deviation = 0.02;
+        limits.stop_loss = 0.05;
+        if (!paper_exchange.add_symbol(symbol, filters->second.tick_size, filters->second.lot_size) ||
+            !paper_router.add_symbol(symbol, filters->second, limits)) {
+          std::cout << "Not paper trading " << symbol << ": bad tick / lot / order size for it" << std::endl;
+          continue;
+        }
+        strategy_engine.subscribe(symbol, EVENT_TRADE, paper_exchange);
+        strategy_engine.subscribe(symbol, EVENT_TRADE, paper_router); // answers applied ahead of risk and positions
+        strategy_engine.subscribe(symbol, EVENT_TRADE, risk);
+        strategy_engine.subscribe(symbol, EVENT_TRADE, positions);
+      }
+    }
+    if (paper_server) {
+      GlobalRiskLimits global_limits;
+      global_limits.max_gross_notional = 2000.0;
+      global_limits.max_daily_loss = 50.0;
+      risk.set_global_limits(global_limits);
+    }
+    if (paper_server && paper_server->start()) {
+      std::cout << "Paper exchange on http://127.0.0.1:" << paper_server->port() << "/api/v3/" << std::endl;
+      GatewayConfig gateway_config;
+      gateway_config.host = "127.0.0.1";
+      gateway_config.port = paper_server->port();
+      gateway_config.tls = false;
+      paper_router.start(gateway_config);
+    }
+    // the cross pairs close usdt triangles for the arbitrage scanner and feed nothing else
+    const std::vector<std::string> cross_pairs = {"ethbtc", "solbtc", "soleth"};
+    std::vector<std::string> scanned = symbols;
+    scanned.insert(scanned.end(), cross_pairs.begin(), cross_pairs.end());
+    arbitrage = std::make_unique<TriangularArbitrage>(strategy_engine, scanned);
+    arbitrage->set_opportunity_handler([&logger](const ArbitrageOpportunity& opportunity) {
+      logger.log(info, "arbitrage", opportunity.path + " net " + std::to_string(opportunity.net_return * 1e4) +
+                                      "bps on " + opportunity.trigger);
+    });
+    for (const std::string& symbol : scanned) {
+      strategy_engine.subscribe(symbol, EVENT_TRADE, *arbitrage);
+      correlation.add_symbol(symbol);
+      strategy_engine.subscribe(symbol, EVENT_TRADE, correlation);
+    }
     coin_manager.add_coins(symbols);
+    coin_manager.add_coins(cross_pairs);
 
     std::cout << "Listening for 30 seconds..." << std::endl;
-    std::this_thread::sleep_for(std::chrono::seconds(30));
+    // this thread is the feature rows' consumer when they are exported: it streams them to the file as they come
+    const auto listen_until = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < listen_until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      if (features_path) {
+        features.export_pending();
+      }
+    }
   } else {
     std::cout << "Failed to connect within " << max_wait << " seconds." << std::endl;
   }
 
+  // no more market data: the feed thread stops dispatching, so everything below reads settled state
+  binance_client.disconnect();
+  LATENCY_TRACKER.stop_reporting();
+  if (TRACER.enabled()) {
+    TRACER.stop();
+    std::cout << "Trace: " << TRACER.written() << " events written, " << TRACER.dropped() << " dropped" << std::endl;
+  }
+  std::cout << LATENCY_TRACKER.report();
+  const LatencyHistogram& signal_latency = strategy_engine.tick_to_signal();
+  std::cout << "tick->signal n=" << signal_latency.count() << " p50=" << signal_latency.percentile(50.0) / 1000.0
+            << "us p99=" << signal_latency.percentile(99.0) / 1000.0 << "us" << std::endl;
+  if (average_offload) {
+    const LatencyHistogram& offload_latency = average_offload->round_trip();
+    std::cout << "MA offload round trips n=" << offload_latency.count()
+              << " p50=" << offload_latency.percentile(50.0) / 1000.0
+              << "us p99=" << offload_latency.percentile(99.0) / 1000.0 << "us, " << average_offload->updates()
+              << " updates" << (average_offload->failed() ? ", failed" : "") << std::endl;
+  }
+  if (arbitrage) {
+    const LatencyHistogram& arbitrage_latency = arbitrage->trigger_to_opportunity();
+    std::cout << "tick->arbitrage n=" << arbitrage_latency.count()
+              << " p50=" << arbitrage_latency.percentile(50.0) / 1000.0
+              << "us p99=" << arbitrage_latency.percentile(99.0) / 1000.0 << "us, " << arbitrage->evaluations()
+              << " cycle evaluations" << std::endl;
+  }
+  if (scorer) {
+    const LatencyHistogram& model_latency = scorer->latency();
+    std::cout << "model predictions n=" << scorer->scored() << " p50=" << model_latency.percentile(50.0) / 1000.0
+              << "us p99=" << model_latency.percentile(99.0) / 1000.0 << "us, latest:";
+    for (std::uint32_t i = 0; i < features.size(); ++i) {
+      std::cout << " " << features.symbol(i) << "=" << scorer->prediction(i);
+    }
+    std::cout << std::endl;
+  }
+  if (features_path) {
+    const std::uint64_t dropped = features.dropped();
+    std::cout << "Features: " << features.finish_export() << " rows written to " << features_path << " (symbols in "
+              << FeaturePipeline::symbols_path(features_path) << "), " << dropped << " dropped" << std::endl;
+  }
+  const std::shared_ptr<const CorrelationSnapshot> correlations = correlation.snapshot();
+  if (correlations->samples > 1) {
+    std::cout << "return correlation over " << correlations->samples << "s:";
+    for (std::size_t i = 0; i < correlations->size(); ++i) {
+      for (std::size_t j = i + 1; j < correlations->size(); ++j) {
+        std::cout << " " << correlations->symbols[i] << "/" << correlations->symbols[j] << "="
+                  << correlations->correlation_at(i, j);
+      }
+    }
+    std::cout << std::endl;
+  }
+  if (const OrderGateway* paper_gateway = paper_router.gateway()) {
+    paper_router.stop(); // the sender thread records the latencies read below
+    const LatencyHistogram& order_latency = paper_gateway->tick_to_order_sent();
+    std::cout << "tick->order sent n=" << order_latency.count() << " p50=" << order_latency.percentile(50.0) / 1000.0
+              << "us p99=" << order_latency.percentile(99.0) / 1000.0 << "us" << std::endl;
+    const PortfolioSnapshot portfolio = positions.portfolio();
+    std::cout << "paper P&L realized " << portfolio.realized << " unrealized " << portfolio.unrealized
+              << ", gross notional " << portfolio.gross_notional << std::endl;
+  }
+#ifdef PERF_COUNTERS_ENABLED
+  std::cout << PERF_PROFILER.report();
+#endif
+
+  metrics_server.stop(); // collectors reference locals that go out of scope first
   return 0;
 }
@@ -0,0 +1,68 @@
+#include "../../include/metrics/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() : total_(0), max_(0) {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::uint64_t LatencyHistogram::bucket_upper(std::size_t index) {
+  if (index < LINEAR_COUNT) {
+    return index;
+  }
+  std::size_t offset = index - LINEAR_COUNT;
+  std::size_t shift = offset / SUB_BUCKETS + 1;
+  std::uint64_t mantissa = offset % SUB_BUCKETS + SUB_BUCKETS;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+  for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+    std::uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+    if (count) {
+      bump(counts_[i], count);
+    }
+  }
+  bump(total_, other.total_.load(std::memory_order_relaxed));
+  max_.store(std::max(max(), other.max()), std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::count() const {
+  return total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::max() const {
+  return max_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double percent) const {
+  // bucket counts are summed rather than trusting total_, which a concurrent writer may have moved on from
+  std::uint64_t total = 0;
+  for (const auto& count : counts_) {
+    total += count.load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  auto target = static_cast<std::uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * total));
+  target = std::max<std::uint64_t>(target, 1);
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      return std::min(bucket_upper(i), max());
+    }
+  }
+  return max();
+}
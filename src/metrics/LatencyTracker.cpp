@@ -0,0 +1,147 @@
+#include "../../include/metrics/LatencyTracker.h"
+#include <cstdio>
+
+LatencyTracker::LatencyTracker() : mode_(LatencyMode::sampled), sample_mask_(63), reporter_stop_(false) {}
+
+LatencyTracker::~LatencyTracker() {
+  stop_reporting();
+}
+
+void LatencyTracker::set_mode(LatencyMode mode, std::uint32_t sample_every) {
+  std::uint32_t power = 1;
+  while (power < sample_every && power < (1u << 31)) {
+    power <<= 1;
+  }
+  sample_mask_.store(power - 1, std::memory_order_relaxed);
+  mode_.store(mode, std::memory_order_relaxed);
+}
+
+LatencyMode LatencyTracker::mode() const {
+  return mode_.load(std::memory_order_relaxed);
+}
+
+LatencyTracker::ThreadHistograms& LatencyTracker::local() {
+  thread_local ThreadHistograms* histograms = nullptr;
+  if (!histograms) {
+    auto owned = std::make_unique<ThreadHistograms>();
+    histograms = owned.get();
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    registry_.push_back(std::move(owned));
+  }
+  return *histograms;
+}
+
+void LatencyTracker::record(const MessageStamps& stamps) {
+  ThreadHistograms& histograms = local();
+  auto delta = [](std::uint64_t from, std::uint64_t to) {
+    return Clock::ticks_to_ns(static_cast<std::int64_t>(to - from));
+  };
+  if (stamps.exchange_time_ms > 0) {
+    histograms.stages[EXCHANGE_TO_RECEIVE].record(Clock::to_wall_ns(stamps.receive_tick) -
+                                                  stamps.exchange_time_ms * 1000000LL);
+  }
+  histograms.stages[RECEIVE_TO_PARSE].record(delta(stamps.receive_tick, stamps.parse_tick));
+  histograms.stages[PARSE_TO_APPLY].record(delta(stamps.parse_tick, stamps.apply_tick));
+  histograms.stages[APPLY_TO_RENDER].record(delta(stamps.apply_tick, stamps.render_tick));
+  histograms.stages[RECEIVE_TO_RENDER].record(delta(stamps.receive_tick, stamps.render_tick));
+}
+
+void LatencyTracker::merged(LatencyStage stage, LatencyHistogram& into) const {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (const auto& histograms : registry_) {
+    into.add(histograms->stages[stage]);
+  }
+}
+
+std::string LatencyTracker::report() const {
+  std::string out;
+  auto merged_stage = std::make_unique<LatencyHistogram>();
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+    merged_stage->reset();
+    merged(static_cast<LatencyStage>(stage), *merged_stage);
+
+    char line[192];
+    std::snprintf(line, sizeof(line), "%-20s n=%llu p50=%.3fus p99=%.3fus p99.9=%.3fus max=%.3fus\n",
+                  stage_name(static_cast<LatencyStage>(stage)),
+                  static_cast<unsigned long long>(merged_stage->count()), merged_stage->percentile(50.0) / 1000.0,
+                  merged_stage->percentile(99.0) / 1000.0, merged_stage->percentile(99.9) / 1000.0,
+                  merged_stage->max() / 1000.0);
+    out += line;
+  }
+  return out;
+}
+
+void LatencyTracker::write_prometheus(std::string& out) const {
+  out += "# HELP pipeline_latency_microseconds Stage latency percentiles since start\n";
+  out += "# TYPE pipeline_latency_microseconds gauge\n";
+  std::string counts = "# HELP pipeline_latency_samples_total Messages stamped per stage\n"
+                       "# TYPE pipeline_latency_samples_total counter\n";
+  auto merged_stage = std::make_unique<LatencyHistogram>();
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+    merged_stage->reset();
+    merged(static_cast<LatencyStage>(stage), *merged_stage);
+    const char* name = stage_name(static_cast<LatencyStage>(stage));
+
+    char line[160];
+    for (double quantile : {50.0, 99.0, 99.9}) {
+      std::snprintf(line, sizeof(line), "pipeline_latency_microseconds{stage=\"%s\",quantile=\"%g\"} %.3f\n", name,
+                    quantile / 100.0, merged_stage->percentile(quantile) / 1000.0);
+      out += line;
+    }
+    std::snprintf(line, sizeof(line), "pipeline_latency_samples_total{stage=\"%s\"} %llu\n", name,
+                  static_cast<unsigned long long>(merged_stage->count()));
+    counts += line;
+  }
+  out += counts;
+}
+
+void LatencyTracker::reset() {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (const auto& histograms : registry_) {
+    for (auto& stage : histograms->stages) {
+      stage.reset();
+    }
+  }
+}
+
+void LatencyTracker::start_reporting(std::chrono::milliseconds interval,
+                                     std::function<void(const std::string&)> sink) {
+  stop_reporting();
+  reporter_stop_ = false;
+  reporter_ = std::thread([this, interval, sink = std::move(sink)]() {
+    std::unique_lock<std::mutex> lock(reporter_mutex_);
+    while (!reporter_cv_.wait_for(lock, interval, [this]() { return reporter_stop_; })) {
+      lock.unlock();
+      sink(report());
+      lock.lock();
+    }
+  });
+}
+
+void LatencyTracker::stop_reporting() {
+  {
+    std::lock_guard<std::mutex> lock(reporter_mutex_);
+    reporter_stop_ = true;
+  }
+  reporter_cv_.notify_all();
+  if (reporter_.joinable()) {
+    reporter_.join();
+  }
+}
+
+const char* LatencyTracker::stage_name(LatencyStage stage) {
+  switch (stage) {
+    case EXCHANGE_TO_RECEIVE:
+      return "exchange->receive";
+    case RECEIVE_TO_PARSE:
+      return "receive->parse";
+    case PARSE_TO_APPLY:
+      return "parse->apply";
+    case APPLY_TO_RENDER:
+      return "apply->render";
+    case RECEIVE_TO_RENDER:
+      return "receive->render";
+    default:
+      return "unknown";
+  }
+}
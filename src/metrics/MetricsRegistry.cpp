@@ -0,0 +1,89 @@
+#include "../../include/metrics/MetricsRegistry.h"
+#include <cstdio>
+#include <iostream>
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type) {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_.emplace(name, Family{type, help, {}, {}}).first;
+  } else if (it->second.type != type) {
+    std::cerr << "Metric " << name << " registered as both counter and gauge" << std::endl;
+  }
+  return it->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& slot = family(name, help, Type::counter).counters[labels];
+  if (!slot) {
+    slot = std::make_unique<Counter>();
+  }
+  return *slot;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& slot = family(name, help, Type::gauge).gauges[labels];
+  if (!slot) {
+    slot = std::make_unique<Gauge>();
+  }
+  return *slot;
+}
+
+void MetricsRegistry::add_collector(std::function<void(std::string&)> collector) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  collectors_.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::render() const {
+  std::string out;
+  char value[32];
+  auto sample = [&out](const std::string& name, const std::string& labels, const char* text) {
+    out += name;
+    if (!labels.empty()) {
+      out += '{';
+      out += labels;
+      out += '}';
+    }
+    out += ' ';
+    out += text;
+    out += '\n';
+  };
+
+  std::vector<std::function<void(std::string&)>> collectors;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, family] : families_) {
+      out += "# HELP " + name + " " + family.help + "\n";
+      out += "# TYPE " + name + (family.type == Type::counter ? " counter\n" : " gauge\n");
+      for (const auto& [labels, counter] : family.counters) {
+        std::snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(counter->value()));
+        sample(name, labels, value);
+      }
+      for (const auto& [labels, gauge] : family.gauges) {
+        std::snprintf(value, sizeof(value), "%.17g", gauge->value());
+        sample(name, labels, value);
+      }
+    }
+    collectors = collectors_;
+  }
+  // outside the lock: a collector may register metrics, and a slow one must not hold up the others
+  for (const auto& collector : collectors) {
+    collector(out);
+  }
+  return out;
+}
+
+std::string MetricsRegistry::label(const std::string& key, const std::string& value) {
+  std::string out = key + "=\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    } else if (c == '\n') {
+      out += "\\n";
+      continue;
+    }
+    out += c;
+  }
+  return out + "\"";
+}
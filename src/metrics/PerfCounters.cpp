@@ -0,0 +1,170 @@
+#include "../../include/metrics/PerfCounters.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+  int open_counter(std::uint32_t type, std::uint64_t config, int group_fd) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+  }
+#endif
+
+  void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+  }
+}
+
+PerfProfiler::ThreadCounters::ThreadCounters() : leader_fd(-1), opened(0) {
+  for (int counter = 0; counter < PERF_COUNTER_COUNT; ++counter) {
+    fds[counter] = -1;
+    slots[counter] = -1;
+  }
+  for (int stage = 0; stage < PERF_STAGE_COUNT; ++stage) {
+    calls[stage].store(0, std::memory_order_relaxed);
+    for (auto& total : totals[stage]) {
+      total.store(0, std::memory_order_relaxed);
+    }
+  }
+
+#ifdef __linux__
+  const std::pair<std::uint32_t, std::uint64_t> events[PERF_COUNTER_COUNT] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+  for (int counter = 0; counter < PERF_COUNTER_COUNT; ++counter) {
+    int fd = open_counter(events[counter].first, events[counter].second, leader_fd);
+    if (fd < 0) {
+      continue;
+    }
+    if (leader_fd == -1) {
+      leader_fd = fd;
+    }
+    fds[counter] = fd;
+    slots[counter] = opened++;
+  }
+  if (leader_fd != -1) {
+    ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif
+}
+
+PerfProfiler::ThreadCounters::~ThreadCounters() {
+#ifdef __linux__
+  for (int fd : fds) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+PerfProfiler::ThreadCounters& PerfProfiler::local() {
+  thread_local ThreadCounters* counters = nullptr;
+  if (!counters) {
+    auto owned = std::make_unique<ThreadCounters>();
+    counters = owned.get();
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    registry_.push_back(std::move(owned));
+  }
+  return *counters;
+}
+
+PerfProfiler::Reading PerfProfiler::read(const ThreadCounters& counters) {
+  Reading reading{};
+  if (counters.leader_fd == -1) {
+    return reading;
+  }
+#ifdef __linux__
+  std::uint64_t buffer[1 + PERF_COUNTER_COUNT] = {};
+  ssize_t bytes = ::read(counters.leader_fd, buffer, sizeof(buffer));
+  if (bytes < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + counters.opened))) {
+    return reading;
+  }
+  for (int counter = 0; counter < PERF_COUNTER_COUNT; ++counter) {
+    if (counters.slots[counter] >= 0) {
+      reading.values[counter] = buffer[1 + counters.slots[counter]];
+    }
+  }
+  reading.valid = true;
+#endif
+  return reading;
+}
+
+void PerfProfiler::accumulate(ThreadCounters& counters, PerfStage stage, const Reading& start, const Reading& end) {
+  bump(counters.calls[stage], 1);
+  if (!start.valid || !end.valid) {
+    return;
+  }
+  for (int counter = 0; counter < PERF_COUNTER_COUNT; ++counter) {
+    bump(counters.totals[stage][counter], end.values[counter] - start.values[counter]);
+  }
+}
+
+bool PerfProfiler::available() {
+  return local().leader_fd != -1;
+}
+
+PerfTotals PerfProfiler::totals(PerfStage stage) const {
+  PerfTotals totals;
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (const auto& counters : registry_) {
+    totals.calls += counters->calls[stage].load(std::memory_order_relaxed);
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; ++counter) {
+      totals.counters[counter] += counters->totals[stage][counter].load(std::memory_order_relaxed);
+    }
+  }
+  return totals;
+}
+
+std::string PerfProfiler::report() const {
+  std::string out;
+  for (int stage = 0; stage < PERF_STAGE_COUNT; ++stage) {
+    PerfTotals stage_totals = totals(static_cast<PerfStage>(stage));
+    double calls = stage_totals.calls ? static_cast<double>(stage_totals.calls) : 1.0;
+    const std::uint64_t* c = stage_totals.counters;
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%-10s calls=%llu cycles=%.1f instructions=%.1f ipc=%.2f l1d_miss=%.3f llc_miss=%.3f "
+                  "branch_miss=%.3f (per call)\n",
+                  stage_name(static_cast<PerfStage>(stage)), static_cast<unsigned long long>(stage_totals.calls),
+                  c[PERF_CYCLES] / calls, c[PERF_INSTRUCTIONS] / calls,
+                  c[PERF_CYCLES] ? static_cast<double>(c[PERF_INSTRUCTIONS]) / c[PERF_CYCLES] : 0.0,
+                  c[PERF_L1D_MISSES] / calls, c[PERF_LLC_MISSES] / calls, c[PERF_BRANCH_MISSES] / calls);
+    out += line;
+  }
+  return out;
+}
+
+const char* PerfProfiler::stage_name(PerfStage stage) {
+  switch (stage) {
+    case PERF_PARSE:
+      return "parse";
+    case PERF_UPDATE:
+      return "update";
+    case PERF_INDICATOR:
+      return "indicator";
+    default:
+      return "unknown";
+  }
+}
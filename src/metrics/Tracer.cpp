@@ -0,0 +1,178 @@
+#include "../../include/metrics/Tracer.h"
+#include <chrono>
+#include <iostream>
+#include <unistd.h>
+
+Tracer::Tracer() :
+  enabled_(false), output_(nullptr), first_event_(true), written_(0), serializer_stop_(false) {}
+
+Tracer::~Tracer() {
+  stop();
+}
+
+Tracer::ThreadBuffer& Tracer::local() {
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    auto owned = std::make_unique<ThreadBuffer>();
+    buffer = owned.get();
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    owned->tid = static_cast<std::uint32_t>(registry_.size() + 1);
+    owned->name = "thread " + std::to_string(owned->tid);
+    registry_.push_back(std::move(owned));
+  }
+  return *buffer;
+}
+
+void Tracer::push(const TraceEvent& event) {
+  ThreadBuffer& buffer = local();
+  if (!buffer.events) {
+    auto events = std::make_unique<TraceEvent[]>(TRACE_BUFFER_EVENTS);
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    buffer.events = std::move(events);
+  }
+  std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  if (head - buffer.tail.load(std::memory_order_acquire) >= TRACE_BUFFER_EVENTS) {
+    buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return;
+  }
+  buffer.events[head & (TRACE_BUFFER_EVENTS - 1)] = event;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::name_thread(const std::string& name) {
+  ThreadBuffer& buffer = local();
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  buffer.name = name;
+  buffer.announced = false;
+}
+
+void Tracer::write_event(const char* json) {
+  std::fputs(first_event_ ? "\n" : ",\n", output_);
+  std::fputs(json, output_);
+  first_event_ = false;
+  written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tracer::drain() {
+  std::lock_guard<std::mutex> output_lock(output_mutex_);
+  if (!output_) {
+    return;
+  }
+  const int pid = static_cast<int>(getpid());
+  char json[256];
+
+  std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+  for (const auto& buffer : registry_) {
+    if (!buffer->announced) {
+      std::string escaped;
+      for (char c : buffer->name) {
+        if (c == '"' || c == '\\') {
+          escaped += '\\';
+        }
+        escaped += c;
+      }
+      std::snprintf(json, sizeof(json),
+                    R"({"name":"thread_name","ph":"M","pid":%d,"tid":%u,"args":{"name":"%.160s"}})", pid,
+                    buffer->tid, escaped.c_str());
+      write_event(json);
+      buffer->announced = true;
+    }
+
+    if (!buffer->events) {
+      continue;
+    }
+    std::uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+      const TraceEvent& event = buffer->events[tail & (TRACE_BUFFER_EVENTS - 1)];
+      const double ts_us = static_cast<double>(Clock::to_ns(event.begin_tick)) / 1000.0;
+      if (event.end_tick == 0) {
+        std::snprintf(json, sizeof(json), R"({"name":"%s","ph":"i","s":"t","pid":%d,"tid":%u,"ts":%.3f})",
+                      event.name, pid, buffer->tid, ts_us);
+      } else {
+        const double dur_us =
+            static_cast<double>(Clock::ticks_to_ns(static_cast<std::int64_t>(event.end_tick - event.begin_tick))) /
+            1000.0;
+        std::snprintf(json, sizeof(json), R"({"name":"%s","ph":"X","pid":%d,"tid":%u,"ts":%.3f,"dur":%.3f})",
+                      event.name, pid, buffer->tid, ts_us, dur_us);
+      }
+      write_event(json);
+    }
+    buffer->tail.store(tail, std::memory_order_release);
+  }
+  std::fflush(output_);
+}
+
+bool Tracer::start(const std::string& path) {
+  stop();
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ = std::fopen(path.c_str(), "w");
+    if (!output_) {
+      std::cerr << "Unable to open trace file " << path << std::endl;
+      return false;
+    }
+    std::fputs("[", output_);
+    first_event_ = true;
+    written_ = 0;
+  }
+  {
+    // forget spans left over from an earlier capture
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (const auto& buffer : registry_) {
+      buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+      buffer->announced = false;
+    }
+  }
+
+  serializer_stop_ = false;
+  serializer_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lock(serializer_mutex_);
+    while (!serializer_cv_.wait_for(lock, std::chrono::milliseconds(TRACE_FLUSH_INTERVAL_MS),
+                                    [this]() { return serializer_stop_; })) {
+      lock.unlock();
+      drain();
+      lock.lock();
+    }
+  });
+  enabled_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void Tracer::stop() {
+  enabled_.store(false, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(serializer_mutex_);
+    serializer_stop_ = true;
+  }
+  serializer_cv_.notify_all();
+  if (serializer_.joinable()) {
+    serializer_.join();
+  }
+
+  drain();
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  if (output_) {
+    std::fputs("\n]\n", output_);
+    std::fclose(output_);
+    output_ = nullptr;
+  }
+}
+
+std::uint64_t Tracer::dropped() const {
+  std::uint64_t total = 0;
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (const auto& buffer : registry_) {
+    total += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::size_t Tracer::rings() const {
+  std::size_t rings = 0;
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (const auto& buffer : registry_) {
+    rings += buffer->events != nullptr;
+  }
+  return rings;
+}
@@ -0,0 +1,274 @@
+#include "../../include/ml/FeaturePipeline.h"
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "../../include/history/Npy.h"
+
+const char* const FEATURE_NAMES[FEATURE_COUNT] = {
+  "log_return", "return_1s", "return_1m", "ma_distance", "ema_fast_distance", "ema_slow_distance", "volatility_fast",
+  "volatility_slow", "spread_bps", "book_imbalance", "trade_quantity", "volume_1m", "trade_interval_ms"};
+
+namespace {
+  constexpr double EMA_FAST_ALPHA = 2.0 / (FEATURE_EMA_FAST_PERIOD + 1.0);
+  constexpr double EMA_SLOW_ALPHA = 2.0 / (FEATURE_EMA_SLOW_PERIOD + 1.0);
+  constexpr double VOLATILITY_FAST_ALPHA = 2.0 / (FEATURE_VOLATILITY_FAST_PERIOD + 1.0);
+  constexpr double VOLATILITY_SLOW_ALPHA = 2.0 / (FEATURE_VOLATILITY_SLOW_PERIOD + 1.0);
+
+  double log_return(double price, double reference) {
+    return price > 0.0 && reference > 0.0 ? std::log(price / reference) : 0.0;
+  }
+
+  double distance(double price, double reference) {
+    return reference > 0.0 ? price / reference - 1.0 : 0.0;
+  }
+
+  // close of the last closed bar at this resolution, 0 if none
+  double last_close(const BarBuilder& bars, long resolution_ms) {
+    const std::size_t index = bars.find_resolution(resolution_ms);
+    return index < bars.resolution_count() && bars.closed_bars(index) ? bars.closed_bar(index, 0).close : 0.0;
+  }
+
+  // creates path and writes the header for count rows; nullptr when the file cannot be written
+  std::FILE* open_npy(const std::string& path, std::size_t count, std::size_t& header_size) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      std::cerr << "Unable to open feature export file " << path << std::endl;
+      return nullptr;
+    }
+    const std::string header = npy::header(FeaturePipeline::numpy_descr(), count);
+    header_size = header.size();
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size()) {
+      std::fclose(file);
+      return nullptr;
+    }
+    return file;
+  }
+}
+
+FeaturePipeline::FeaturePipeline(std::size_t capacity, long bar_resolution_ms)
+  : capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+    bar_resolution_ms_(bar_resolution_ms),
+    head_(0),
+    tail_(0),
+    dropped_(0),
+    export_file_(nullptr),
+    export_header_size_(0),
+    exported_(0),
+    export_failed_(false) {
+  ring_ = std::make_unique<FeatureRow[]>(capacity_);
+}
+
+FeaturePipeline::~FeaturePipeline() {
+  if (export_file_) {
+    std::fclose(export_file_);
+  }
+}
+
+std::uint32_t FeaturePipeline::add_symbol(const std::string& symbol) {
+  auto known = index_.find(symbol);
+  if (known != index_.end()) {
+    return known->second;
+  }
+  std::lock_guard<std::mutex> lock(symbols_mutex_);
+  const auto index = static_cast<std::uint32_t>(symbols_.size());
+  index_.emplace(symbol, index);
+  symbols_.push_back(symbol);
+  state_.emplace_back();
+  return index;
+}
+
+std::uint32_t FeaturePipeline::index_of(const std::string& symbol) const {
+  std::lock_guard<std::mutex> lock(symbols_mutex_);
+  auto it = index_.find(symbol);
+  return it == index_.end() ? UINT32_MAX : it->second;
+}
+
+std::string FeaturePipeline::symbol(std::uint32_t index) const {
+  std::lock_guard<std::mutex> lock(symbols_mutex_);
+  return index < symbols_.size() ? symbols_[index] : std::string();
+}
+
+std::size_t FeaturePipeline::size() const {
+  std::lock_guard<std::mutex> lock(symbols_mutex_);
+  return symbols_.size();
+}
+
+FeatureRow* FeaturePipeline::claim() {
+  const std::uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) == capacity_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  return &ring_[head & (capacity_ - 1)];
+}
+
+void FeaturePipeline::fill(FeatureRow& row, const SymbolState& state, const Coin& coin, double price) const {
+  const MovingAverage& average = coin.moving_average();
+  const BarBuilder& bars = coin.bars();
+  const double minute_close = last_close(bars, 60000);
+  double* values = row.values;
+  values[FEATURE_RETURN_1S] = log_return(price, last_close(bars, 1000));
+  values[FEATURE_RETURN_1M] = log_return(price, minute_close);
+  values[FEATURE_MA_DISTANCE] = distance(price, average.get_value());
+  values[FEATURE_EMA_FAST_DISTANCE] = distance(price, state.ema_fast);
+  values[FEATURE_EMA_SLOW_DISTANCE] = distance(price, state.ema_slow);
+  values[FEATURE_VOLATILITY_FAST] = std::sqrt(state.variance_fast);
+  values[FEATURE_VOLATILITY_SLOW] = std::sqrt(state.variance_slow);
+
+  const bool quoted = state.bid > 0.0 && state.ask > 0.0;
+  const double depth = state.bid_quantity + state.ask_quantity;
+  values[FEATURE_SPREAD_BPS] = quoted ? (state.ask - state.bid) / ((state.ask + state.bid) * 0.5) * 1e4 : 0.0;
+  values[FEATURE_BOOK_IMBALANCE] = quoted && depth > 0.0 ? (state.bid_quantity - state.ask_quantity) / depth : 0.0;
+
+  const std::size_t minute = bars.find_resolution(60000);
+  values[FEATURE_VOLUME_1M] =
+    minute < bars.resolution_count() && bars.has_current_bar(minute) ? bars.current_bar(minute).volume : 0.0;
+
+  row.schema_version = FEATURE_SCHEMA_VERSION;
+  row.price = price;
+  row.flags = (average.is_ready() && minute_close > 0.0 ? FEATURE_FLAG_WARM : 0u) | (quoted ? FEATURE_FLAG_QUOTE : 0u);
+}
+
+void FeaturePipeline::on_trade(const Coin& coin, const CoinData& trade) {
+  const std::uint32_t index = add_symbol(trade.symbol);
+  SymbolState& state = state_[index];
+  const double price = trade.price;
+
+  const double r = log_return(price, state.last_price);
+  if (state.last_price > 0.0) {
+    state.ema_fast += EMA_FAST_ALPHA * (price - state.ema_fast);
+    state.ema_slow += EMA_SLOW_ALPHA * (price - state.ema_slow);
+    state.variance_fast += VOLATILITY_FAST_ALPHA * (r * r - state.variance_fast);
+    state.variance_slow += VOLATILITY_SLOW_ALPHA * (r * r - state.variance_slow);
+  } else {
+    state.ema_fast = price;
+    state.ema_slow = price;
+  }
+  const long interval = state.last_time ? trade.trade_time - state.last_time : 0;
+  state.last_price = price;
+  state.last_time = trade.trade_time;
+
+  FeatureRow* row = claim();
+  if (!row) {
+    return;
+  }
+  row->time_ms = trade.trade_time;
+  row->symbol = index;
+  row->values[FEATURE_LOG_RETURN] = r;
+  row->values[FEATURE_TRADE_QUANTITY] = trade.trade_quantity;
+  row->values[FEATURE_TRADE_INTERVAL_MS] = static_cast<double>(interval);
+  fill(*row, state, coin, price);
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void FeaturePipeline::on_bar_close(const Coin& coin, long resolution_ms, const Bar& bar) {
+  if (resolution_ms != bar_resolution_ms_) {
+    return;
+  }
+  const std::uint32_t index = add_symbol(coin.symbol());
+  SymbolState& state = state_[index];
+  const double r = log_return(bar.close, state.last_bar_close);
+  state.last_bar_close = bar.close;
+
+  FeatureRow* row = claim();
+  if (!row) {
+    return;
+  }
+  row->time_ms = bar.open_time + resolution_ms;
+  row->symbol = index;
+  row->values[FEATURE_LOG_RETURN] = r;
+  row->values[FEATURE_TRADE_QUANTITY] = bar.volume;
+  row->values[FEATURE_TRADE_INTERVAL_MS] = static_cast<double>(resolution_ms);
+  fill(*row, state, coin, bar.close);
+  row->flags |= FEATURE_FLAG_BAR;
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void FeaturePipeline::on_quote(const Coin&, const Quote& quote) {
+  SymbolState& state = state_[add_symbol(quote.instrument)];
+  state.bid = quote.bid;
+  state.ask = quote.ask;
+  state.bid_quantity = quote.bid_quantity;
+  state.ask_quantity = quote.ask_quantity;
+}
+
+std::size_t FeaturePipeline::pending() const {
+  return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+}
+
+bool FeaturePipeline::begin_export(const std::string& path) {
+  if (export_file_) {
+    std::fclose(export_file_);
+  }
+  export_path_ = path;
+  exported_ = 0;
+  export_failed_ = false;
+  export_file_ = open_npy(path, SIZE_MAX, export_header_size_);
+  return export_file_ != nullptr;
+}
+
+std::size_t FeaturePipeline::export_pending() {
+  if (!export_file_) {
+    return 0;
+  }
+  return consume([this](const FeatureRow* rows, std::size_t n) {
+    export_failed_ = export_failed_ || std::fwrite(rows, sizeof(FeatureRow), n, export_file_) != n;
+    exported_ += n;
+  });
+}
+
+std::size_t FeaturePipeline::finish_export() {
+  if (!export_file_) {
+    return 0;
+  }
+  export_pending();
+  const std::string header = npy::header(numpy_descr(), exported_, export_header_size_);
+  bool ok = !export_failed_ && header.size() == export_header_size_ && std::fseek(export_file_, 0, SEEK_SET) == 0
+            && std::fwrite(header.data(), 1, header.size(), export_file_) == header.size();
+  ok = std::fclose(export_file_) == 0 && ok;
+  export_file_ = nullptr;
+
+  const std::string symbols_file = symbols_path(export_path_);
+  std::FILE* table = std::fopen(symbols_file.c_str(), "wb");
+  if (!table) {
+    std::cerr << "Unable to open feature symbol table " << symbols_file << std::endl;
+    return 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(symbols_mutex_);
+    for (const std::string& name : symbols_) {
+      ok = ok && std::fprintf(table, "%s\n", name.c_str()) > 0;
+    }
+  }
+  ok = std::fclose(table) == 0 && ok;
+  return ok ? exported_ : 0;
+}
+
+std::size_t FeaturePipeline::export_npy(const std::string& path) {
+  return begin_export(path) ? finish_export() : 0;
+}
+
+std::string FeaturePipeline::numpy_descr() {
+  std::string descr = "[('time_ms', '<i8'), ('symbol', '<u4'), ('schema_version', '<u2'), ('flags', '<u2'), "
+                      "('price', '<f8')";
+  for (const char* name : FEATURE_NAMES) {
+    descr += std::string(", ('") + name + "', '<f8')";
+  }
+  return descr + "]";
+}
+
+bool FeaturePipeline::write_npy(const std::string& path, const FeatureRow* rows, std::size_t count) {
+  std::size_t header_size;
+  std::FILE* file = open_npy(path, count, header_size);
+  if (!file) {
+    return false;
+  }
+  const bool ok = std::fwrite(rows, sizeof(FeatureRow), count, file) == count;
+  return std::fclose(file) == 0 && ok;
+}
+
+std::string FeaturePipeline::symbols_path(const std::string& npy_path) {
+  const bool npy = npy_path.size() >= 4 && npy_path.compare(npy_path.size() - 4, 4, ".npy") == 0;
+  return (npy ? npy_path.substr(0, npy_path.size() - 4) : npy_path) + "_symbols.txt";
+}
@@ -0,0 +1,271 @@
+#include "../../include/ml/Model.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+  constexpr std::size_t DOT_LANES = 4;
+  constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+  std::uint32_t feature_column(const std::string& name) {
+    for (std::uint32_t i = 0; i < FEATURE_COUNT; ++i) {
+      if (name == FEATURE_NAMES[i]) {
+        return i;
+      }
+    }
+    return UINT32_MAX;
+  }
+}
+
+Model::Model()
+  : kind_(ModelKind::linear), link_(ModelLink::identity), intercept_(0.0), weights_{}, tree_scale_(1.0) {}
+
+bool Model::load(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "Unable to open model " << path << std::endl;
+    return false;
+  }
+  return load(in);
+}
+
+bool Model::load(std::istream& in) {
+  *this = Model();
+  bool have_kind = false;
+  bool have_weights = false;
+  std::vector<ParsedNode> tree;
+  std::size_t tree_nodes = 0;
+  std::string line;
+  std::size_t line_number = 0;
+  auto fail = [&](const std::string& message) {
+    std::cerr << "Model line " << line_number << ": " << message << std::endl;
+    *this = Model();
+    return false;
+  };
+
+  while (std::getline(in, line)) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string directive;
+    if (!(words >> directive)) {
+      continue;
+    }
+
+    if (tree.size() < tree_nodes) {
+      ParsedNode node{};
+      if (directive == "leaf") {
+        node.leaf = true;
+        words >> node.value;
+      } else if (directive == "split") {
+        words >> node.feature >> node.threshold >> node.left >> node.right;
+        if (words && node.feature >= columns_.size()) {
+          return fail("split on feature " + std::to_string(node.feature) + " of " +
+                      std::to_string(columns_.size()));
+        }
+      } else {
+        return fail("expected " + std::to_string(tree_nodes - tree.size()) + " more nodes, got " + directive);
+      }
+      if (!words) {
+        return fail("malformed " + directive);
+      }
+      tree.push_back(node);
+      if (tree.size() == tree_nodes && !add_tree(tree)) {
+        return fail("tree " + std::to_string(roots_.size()) + " is not a tree or deeper than " +
+                    std::to_string(MODEL_MAX_TREE_DEPTH));
+      }
+      continue;
+    }
+
+    if (directive == "model") {
+      std::string kind;
+      words >> kind;
+      if (kind == "linear") {
+        kind_ = ModelKind::linear;
+      } else if (kind == "forest") {
+        kind_ = ModelKind::forest;
+      } else if (kind == "boosted") {
+        kind_ = ModelKind::boosted;
+      } else {
+        return fail("unknown model " + kind);
+      }
+      have_kind = true;
+    } else if (directive == "link") {
+      std::string link;
+      words >> link;
+      if (link == "identity") {
+        link_ = ModelLink::identity;
+      } else if (link == "logistic") {
+        link_ = ModelLink::logistic;
+      } else {
+        return fail("unknown link " + link);
+      }
+    } else if (directive == "features") {
+      std::string name;
+      while (words >> name) {
+        const std::uint32_t column = feature_column(name);
+        if (column == UINT32_MAX) {
+          return fail("unknown feature " + name);
+        }
+        columns_.push_back(column);
+      }
+    } else if (directive == "intercept") {
+      if (!(words >> intercept_)) {
+        return fail("malformed intercept");
+      }
+    } else if (directive == "weights") {
+      std::vector<double> weights;
+      double weight;
+      while (words >> weight) {
+        weights.push_back(weight);
+      }
+      if (weights.size() != columns_.size()) {
+        return fail(std::to_string(weights.size()) + " weights for " + std::to_string(columns_.size()) + " features");
+      }
+      for (std::size_t i = 0; i < weights.size(); ++i) {
+        weights_[columns_[i]] += weights[i];
+      }
+      have_weights = true;
+    } else if (directive == "tree") {
+      if (!(words >> tree_nodes) || tree_nodes == 0) {
+        return fail("malformed tree");
+      }
+      tree.clear();
+    } else {
+      return fail("unknown directive " + directive);
+    }
+  }
+
+  if (!have_kind) {
+    return fail("no model line");
+  }
+  if (tree.size() < tree_nodes) {
+    return fail("tree " + std::to_string(roots_.size()) + " is missing nodes");
+  }
+  if (kind_ == ModelKind::linear ? !have_weights : roots_.empty()) {
+    return fail(kind_ == ModelKind::linear ? "linear model without weights" : "tree model without trees");
+  }
+  tree_scale_ = kind_ == ModelKind::forest ? 1.0 / static_cast<double>(roots_.size()) : 1.0;
+  return true;
+}
+
+bool Model::add_tree(const std::vector<ParsedNode>& tree) {
+  // breadth-first from the root, so both children of a split are assigned consecutive slots
+  std::vector<std::uint32_t> order{0};
+  std::vector<std::uint32_t> depth{0};
+  std::vector<std::uint32_t> position(tree.size(), UINT32_MAX);
+  position[0] = 0;
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const ParsedNode& node = tree[order[k]];
+    if (node.leaf) {
+      continue;
+    }
+    for (const std::uint32_t child : {node.left, node.right}) {
+      if (child >= tree.size() || position[child] != UINT32_MAX || depth[k] + 1 > MODEL_MAX_TREE_DEPTH) {
+        return false; // out of range, shared, a cycle, or too deep
+      }
+      position[child] = static_cast<std::uint32_t>(order.size());
+      order.push_back(child);
+      depth.push_back(depth[k] + 1);
+    }
+  }
+  if (order.size() != tree.size()) {
+    return false; // unreachable nodes
+  }
+
+  const auto base = static_cast<std::uint32_t>(nodes_.size());
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const ParsedNode& node = tree[order[k]];
+    const auto self = base + static_cast<std::uint32_t>(k);
+    if (node.leaf) {
+      nodes_.push_back({NEVER, 0, self});
+      leaf_values_.push_back(node.value);
+    } else {
+      nodes_.push_back({node.threshold, columns_[node.feature], base + position[node.left]});
+      leaf_values_.push_back(0.0);
+    }
+  }
+  roots_.push_back(base);
+  depths_.push_back(*std::max_element(depth.begin(), depth.end()));
+  return true;
+}
+
+double Model::linear_score(const double* values) const {
+  // independent partial sums: without them the additions form one serial chain the compiler may not reorder
+  double lanes[DOT_LANES] = {};
+  std::size_t i = 0;
+  for (; i + DOT_LANES <= FEATURE_COUNT; i += DOT_LANES) {
+    for (std::size_t lane = 0; lane < DOT_LANES; ++lane) {
+      lanes[lane] += weights_[i + lane] * values[i + lane];
+    }
+  }
+  double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < FEATURE_COUNT; ++i) {
+    sum += weights_[i] * values[i];
+  }
+  return intercept_ + sum;
+}
+
+double Model::tree_score(const double* values) const {
+  // MODEL_BATCH_LANES trees walked together: their chains of dependent loads overlap. A leaf steps to itself, so
+  // walking a shallower tree for the group's deepest depth changes nothing
+  double sum = 0.0;
+  std::uint32_t nodes[MODEL_BATCH_LANES];
+  for (std::size_t first = 0; first < roots_.size(); first += MODEL_BATCH_LANES) {
+    const std::size_t lanes = std::min<std::size_t>(MODEL_BATCH_LANES, roots_.size() - first);
+    std::copy_n(roots_.begin() + static_cast<std::ptrdiff_t>(first), lanes, nodes);
+    const std::uint32_t depth = *std::max_element(depths_.begin() + static_cast<std::ptrdiff_t>(first),
+                                                  depths_.begin() + static_cast<std::ptrdiff_t>(first + lanes));
+    for (std::uint32_t step = 0; step < depth; ++step) {
+      for (std::size_t lane = 0; lane < lanes; ++lane) {
+        const TreeNode& split = nodes_[nodes[lane]];
+        nodes[lane] = split.left + (values[split.column] > split.threshold);
+      }
+    }
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+      sum += leaf_values_[nodes[lane]]; // in tree order, as predict_batch() adds them
+    }
+  }
+  return intercept_ + tree_scale_ * sum;
+}
+
+double Model::apply_link(double score) const {
+  return link_ == ModelLink::logistic ? 1.0 / (1.0 + std::exp(-score)) : score;
+}
+
+double Model::predict(const double* values) const {
+  return apply_link(kind_ == ModelKind::linear ? linear_score(values) : tree_score(values));
+}
+
+void Model::predict_batch(const FeatureRow* rows, std::size_t count, double* out) const {
+  if (kind_ == ModelKind::linear) {
+    for (std::size_t i = 0; i < count; ++i) {
+      out[i] = apply_link(linear_score(rows[i].values));
+    }
+    return;
+  }
+  for (std::size_t start = 0; start < count; start += MODEL_BATCH_LANES) {
+    const std::size_t lanes = std::min<std::size_t>(MODEL_BATCH_LANES, count - start);
+    const FeatureRow* block = rows + start;
+    double sums[MODEL_BATCH_LANES] = {};
+    std::uint32_t nodes[MODEL_BATCH_LANES];
+    for (std::size_t tree = 0; tree < roots_.size(); ++tree) {
+      std::fill(nodes, nodes + lanes, roots_[tree]);
+      for (std::uint32_t step = 0; step < depths_[tree]; ++step) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+          const TreeNode& split = nodes_[nodes[lane]];
+          nodes[lane] = split.left + (block[lane].values[split.column] > split.threshold);
+        }
+      }
+      for (std::size_t lane = 0; lane < lanes; ++lane) {
+        sums[lane] += leaf_values_[nodes[lane]];
+      }
+    }
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+      out[start + lane] = apply_link(intercept_ + tree_scale_ * sums[lane]);
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#include "../../include/ml/ModelScorer.h"
+#include <limits>
+#include "../../include/common/Clock.h"
+
+ModelScorer::ModelScorer(FeaturePipeline& pipeline, const Model& model, std::size_t max_symbols)
+  : pipeline_(pipeline), model_(model), max_symbols_(max_symbols),
+    predictions_(std::make_unique<std::atomic<double>[]>(max_symbols)), scored_(0) {
+  for (std::size_t i = 0; i < max_symbols_; ++i) {
+    predictions_[i].store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+  }
+}
+
+void ModelScorer::set_prediction_handler(std::function<void(const FeatureRow&, double)> handler) {
+  prediction_handler_ = std::move(handler);
+}
+
+std::size_t ModelScorer::score() {
+  return pipeline_.consume([this](const FeatureRow* rows, std::size_t count) { score_rows(rows, count); });
+}
+
+void ModelScorer::score_rows(const FeatureRow* rows, std::size_t count) {
+  if (batch_.size() < count) {
+    batch_.resize(count);
+  }
+  const std::uint64_t start = Clock::ticks();
+  model_.predict_batch(rows, count, batch_.data());
+  const std::int64_t per_row =
+      Clock::ticks_to_ns(static_cast<std::int64_t>(Clock::ticks() - start)) / static_cast<std::int64_t>(count);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    latency_.record(per_row);
+    const std::uint32_t symbol = rows[i].symbol;
+    if (symbol < max_symbols_) {
+      predictions_[symbol].store(batch_[i], std::memory_order_relaxed);
+    }
+    if (prediction_handler_) {
+      prediction_handler_(rows[i], batch_[i]);
+    }
+  }
+  scored_.store(scored_.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+double ModelScorer::prediction(std::uint32_t symbol) const {
+  return symbol < max_symbols_ ? predictions_[symbol].load(std::memory_order_relaxed)
+                               : std::numeric_limits<double>::quiet_NaN();
+}
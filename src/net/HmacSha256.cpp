@@ -0,0 +1,88 @@
+#include "../../include/net/HmacSha256.h"
+#include <cstring>
+#include <openssl/evp.h>
+#include <utility>
+
+#define SHA256_BLOCK_SIZE 64
+#define SHA256_DIGEST_SIZE 32
+
+namespace {
+  void to_hex(const unsigned char* bytes, std::size_t size, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (std::size_t i = 0; i < size; ++i) {
+      out[2 * i] = digits[bytes[i] >> 4];
+      out[2 * i + 1] = digits[bytes[i] & 0x0f];
+    }
+  }
+}
+
+HmacSha256::HmacSha256() : inner_(nullptr), outer_(nullptr), scratch_(EVP_MD_CTX_new()) {}
+
+HmacSha256::HmacSha256(const std::string& key) : HmacSha256() {
+  unsigned char block[SHA256_BLOCK_SIZE] = {};
+  if (key.size() > SHA256_BLOCK_SIZE) {
+    unsigned int length = 0;
+    EVP_Digest(key.data(), key.size(), block, &length, EVP_sha256(), nullptr);
+  } else {
+    std::memcpy(block, key.data(), key.size());
+  }
+
+  unsigned char pad[SHA256_BLOCK_SIZE];
+  inner_ = EVP_MD_CTX_new();
+  outer_ = EVP_MD_CTX_new();
+  for (std::size_t i = 0; i < SHA256_BLOCK_SIZE; ++i) {
+    pad[i] = block[i] ^ 0x36;
+  }
+  EVP_DigestInit_ex(inner_, EVP_sha256(), nullptr);
+  EVP_DigestUpdate(inner_, pad, sizeof(pad));
+  for (std::size_t i = 0; i < SHA256_BLOCK_SIZE; ++i) {
+    pad[i] = block[i] ^ 0x5c;
+  }
+  EVP_DigestInit_ex(outer_, EVP_sha256(), nullptr);
+  EVP_DigestUpdate(outer_, pad, sizeof(pad));
+}
+
+HmacSha256::~HmacSha256() {
+  EVP_MD_CTX_free(inner_);
+  EVP_MD_CTX_free(outer_);
+  EVP_MD_CTX_free(scratch_);
+}
+
+HmacSha256::HmacSha256(HmacSha256&& other) noexcept :
+  inner_(std::exchange(other.inner_, nullptr)), outer_(std::exchange(other.outer_, nullptr)),
+  scratch_(std::exchange(other.scratch_, nullptr)) {}
+
+HmacSha256& HmacSha256::operator=(HmacSha256&& other) noexcept {
+  std::swap(inner_, other.inner_);
+  std::swap(outer_, other.outer_);
+  std::swap(scratch_, other.scratch_);
+  return *this;
+}
+
+HmacSha256 HmacSha256::with_prefix(const char* prefix, std::size_t size) const {
+  HmacSha256 signer;
+  signer.inner_ = EVP_MD_CTX_new();
+  signer.outer_ = EVP_MD_CTX_new();
+  EVP_MD_CTX_copy_ex(signer.inner_, inner_);
+  EVP_MD_CTX_copy_ex(signer.outer_, outer_);
+  EVP_DigestUpdate(signer.inner_, prefix, size);
+  return signer;
+}
+
+void HmacSha256::sign(const char* data, std::size_t size, char* hex_out) {
+  unsigned char digest[SHA256_DIGEST_SIZE];
+  unsigned int length = 0;
+  EVP_MD_CTX_copy_ex(scratch_, inner_);
+  EVP_DigestUpdate(scratch_, data, size);
+  EVP_DigestFinal_ex(scratch_, digest, &length);
+  EVP_MD_CTX_copy_ex(scratch_, outer_);
+  EVP_DigestUpdate(scratch_, digest, sizeof(digest));
+  EVP_DigestFinal_ex(scratch_, digest, &length);
+  to_hex(digest, sizeof(digest), hex_out);
+}
+
+std::string HmacSha256::sign(const std::string& data) {
+  std::string hex(HMAC_SHA256_HEX_SIZE, '0');
+  sign(data.data(), data.size(), hex.data());
+  return hex;
+}
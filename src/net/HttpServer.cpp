@@ -0,0 +1,303 @@
+#include "../../include/net/HttpServer.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+  bool iequals(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+             return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+  }
+
+  std::string trim(const std::string& s) {
+    std::size_t begin = s.find_first_not_of(" \t");
+    std::size_t end = s.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+  }
+
+  int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+  }
+
+  std::string url_decode(const std::string& s, std::size_t begin, std::size_t end) {
+    std::string out;
+    out.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i) {
+      if (s[i] == '+') {
+        out += ' ';
+      } else if (s[i] == '%' && i + 2 < end && hex_digit(s[i + 1]) >= 0 && hex_digit(s[i + 2]) >= 0) {
+        out += static_cast<char>(hex_digit(s[i + 1]) * 16 + hex_digit(s[i + 2]));
+        i += 2;
+      } else {
+        out += s[i];
+      }
+    }
+    return out;
+  }
+
+  // looks name up in "a=1&b=2"; found tells an empty value from a missing one
+  std::string find_param(const std::string& encoded, const std::string& name, bool& found) {
+    std::size_t start = 0;
+    while (start <= encoded.size()) {
+      std::size_t end = encoded.find('&', start);
+      if (end == std::string::npos) {
+        end = encoded.size();
+      }
+      std::size_t equals = encoded.find('=', start);
+      std::size_t key_end = equals < end ? equals : end;
+      if (url_decode(encoded, start, key_end) == name) {
+        found = true;
+        return key_end < end ? url_decode(encoded, key_end + 1, end) : "";
+      }
+      start = end + 1;
+    }
+    return "";
+  }
+
+  bool send_all(int fd, const std::string& data) {
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+      ssize_t n = ::send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      offset += static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+}
+
+std::string HttpRequest::header(const std::string& name) const {
+  for (const auto& [key, value] : headers) {
+    if (iequals(key, name)) {
+      return value;
+    }
+  }
+  return "";
+}
+
+std::string HttpRequest::param(const std::string& name) const {
+  bool found = false;
+  std::string value = find_param(query, name, found);
+  if (!found && header("Content-Type").rfind("application/x-www-form-urlencoded", 0) == 0) {
+    value = find_param(body, name, found);
+  }
+  return value;
+}
+
+HttpServer::HttpServer(std::uint16_t port, const std::string& address) :
+  address_(address), port_(port), listen_fd_(-1), running_(false) {}
+
+HttpServer::~HttpServer() {
+  stop();
+}
+
+void HttpServer::route(const std::string& method, const std::string& path, HttpHandler handler) {
+  routes_[{method, path}] = std::move(handler);
+}
+
+bool HttpServer::start() {
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    std::cerr << "HttpServer: unable to create socket" << std::endl;
+    return false;
+  }
+  int reuse = 1;
+  ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port_);
+  if (::inet_pton(AF_INET, address_.c_str(), &addr.sin_addr) != 1 ||
+      ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd_, 16) != 0) {
+    std::cerr << "HttpServer: unable to listen on " << address_ << ":" << port_ << std::endl;
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  socklen_t length = sizeof(addr);
+  ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+  port_ = ntohs(addr.sin_port);
+
+  running_ = true;
+  thread_ = std::thread(&HttpServer::run, this);
+  return true;
+}
+
+void HttpServer::stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+  }
+}
+
+void HttpServer::run() {
+  std::vector<Connection> connections;
+  std::vector<pollfd> fds;
+  char buffer[16384];
+
+  while (running_) {
+    fds.clear();
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const Connection& connection : connections) {
+      fds.push_back({connection.fd, POLLIN, 0});
+    }
+    if (::poll(fds.data(), fds.size(), HTTP_POLL_INTERVAL_MS) <= 0) {
+      continue;
+    }
+
+    // fds[i + 1] belongs to connections[i]; walk backwards so erasing keeps the pairing intact
+    for (std::size_t i = connections.size(); i-- > 0;) {
+      if (!fds[i + 1].revents) {
+        continue;
+      }
+      Connection& connection = connections[i];
+      ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+      bool keep = n > 0;
+      if (keep) {
+        connection.input.append(buffer, static_cast<std::size_t>(n));
+        keep = serve(connection);
+      }
+      if (!keep) {
+        ::close(connection.fd);
+        connections.erase(connections.begin() + static_cast<std::ptrdiff_t>(i));
+      }
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        int nodelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        connections.push_back({fd, {}});
+      }
+    }
+  }
+
+  for (const Connection& connection : connections) {
+    ::close(connection.fd);
+  }
+}
+
+bool HttpServer::serve(Connection& connection) {
+  while (true) {
+    std::size_t header_end = connection.input.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+      return connection.input.size() < HTTP_MAX_REQUEST_SIZE;
+    }
+
+    HttpRequest request;
+    std::string version;
+    std::size_t line_end = connection.input.find("\r\n");
+    {
+      const std::string line = connection.input.substr(0, line_end);
+      std::size_t first = line.find(' ');
+      std::size_t second = line.find(' ', first + 1);
+      if (first == std::string::npos || second == std::string::npos) {
+        return false;
+      }
+      request.method = line.substr(0, first);
+      std::string target = line.substr(first + 1, second - first - 1);
+      version = line.substr(second + 1);
+      std::size_t question = target.find('?');
+      request.path = target.substr(0, question);
+      if (question != std::string::npos) {
+        request.query = target.substr(question + 1);
+      }
+    }
+    for (std::size_t begin = line_end + 2; begin < header_end;) {
+      std::size_t end = connection.input.find("\r\n", begin);
+      std::string line = connection.input.substr(begin, end - begin);
+      std::size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        request.headers.emplace_back(trim(line.substr(0, colon)), trim(line.substr(colon + 1)));
+      }
+      begin = end + 2;
+    }
+
+    std::size_t body_length = 0;
+    std::string content_length = request.header("Content-Length");
+    if (!content_length.empty()) {
+      body_length = std::strtoull(content_length.c_str(), nullptr, 10);
+    }
+    if (body_length > HTTP_MAX_REQUEST_SIZE) {
+      return false;
+    }
+    if (connection.input.size() < header_end + 4 + body_length) {
+      return true; // wait for the rest of the body
+    }
+    request.body = connection.input.substr(header_end + 4, body_length);
+    connection.input.erase(0, header_end + 4 + body_length);
+
+    HttpResponse response = dispatch(request);
+    bool keep_alive = version == "HTTP/1.1" ? !iequals(request.header("Connection"), "close")
+                                             : iequals(request.header("Connection"), "keep-alive");
+
+    std::string out = "HTTP/1.1 " + std::to_string(response.status) + " " + status_text(response.status) + "\r\n";
+    out += "Content-Type: " + response.content_type + "\r\n";
+    out += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    out += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    for (const auto& [key, value] : response.headers) {
+      out += key + ": " + value + "\r\n";
+    }
+    out += "\r\n";
+    out += response.body;
+    if (!send_all(connection.fd, out) || !keep_alive) {
+      return false;
+    }
+  }
+}
+
+HttpResponse HttpServer::dispatch(const HttpRequest& request) const {
+  auto it = routes_.find({request.method, request.path});
+  if (it != routes_.end()) {
+    return it->second(request);
+  }
+  HttpResponse response;
+  response.status = 404;
+  response.body = "not found\n";
+  return response;
+}
+
+const char* HttpServer::status_text(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 201:
+      return "Created";
+    case 204:
+      return "No Content";
+    case 400:
+      return "Bad Request";
+    case 401:
+      return "Unauthorized";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 429:
+      return "Too Many Requests";
+    case 500:
+      return "Internal Server Error";
+    case 503:
+      return "Service Unavailable";
+    default:
+      return "Unknown";
+  }
+}
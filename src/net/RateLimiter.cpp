@@ -0,0 +1,71 @@
+#include "../../include/net/RateLimiter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+void RateLimiter::roll(Window& window, std::int64_t now_ms) {
+  const std::int64_t start = now_ms - now_ms % window.interval_ms;
+  if (start != window.start_ms) {
+    window.start_ms = start;
+    window.used = 0;
+  }
+}
+
+void RateLimiter::add_limit(RateLimitKind kind, std::int64_t interval_ms, std::uint32_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  windows_.push_back({kind, interval_ms, limit, 0, 0});
+}
+
+bool RateLimiter::try_acquire(std::uint32_t weight, std::uint32_t orders, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Window& window : windows_) {
+    roll(window, now_ms);
+    const std::uint32_t cost = window.kind == RateLimitKind::request_weight ? weight : orders;
+    if (window.used + cost > window.limit) {
+      return false;
+    }
+  }
+  for (Window& window : windows_) {
+    window.used += window.kind == RateLimitKind::request_weight ? weight : orders;
+  }
+  return true;
+}
+
+void RateLimiter::sync(RateLimitKind kind, std::int64_t interval_ms, std::uint32_t used, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Window& window : windows_) {
+    if (window.kind == kind && window.interval_ms == interval_ms) {
+      roll(window, now_ms);
+      // the header can lag requests we sent after it, never go below our own count
+      window.used = std::max(window.used, used);
+    }
+  }
+}
+
+std::uint32_t RateLimiter::remaining(RateLimitKind kind, std::int64_t now_ms) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::uint32_t left = std::numeric_limits<std::uint32_t>::max();
+  for (const Window& window : windows_) {
+    if (window.kind != kind) {
+      continue;
+    }
+    const bool current = now_ms - now_ms % window.interval_ms == window.start_ms;
+    const std::uint32_t used = current ? window.used : 0;
+    left = std::min(left, window.limit > used ? window.limit - used : 0);
+  }
+  return left;
+}
+
+std::int64_t RateLimiter::parse_interval(const std::string& suffix) {
+  if (suffix.size() < 2) {
+    return 0;
+  }
+  const std::int64_t count = std::strtoll(suffix.c_str(), nullptr, 10);
+  switch (suffix.back()) {
+    case 'S': case 's': return count * 1000;
+    case 'M': case 'm': return count * 60000;
+    case 'H': case 'h': return count * 3600000;
+    case 'D': case 'd': return count * 86400000;
+    default: return 0;
+  }
+}
@@ -0,0 +1,214 @@
+#include "../../include/risk/PositionBook.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+  // what is left of a position after closing it in floating point, e.g. 0.3 - 0.1 - 0.2
+  constexpr double FLAT_EPSILON = 1e-12;
+
+  void store(std::atomic<double>& field, double value) {
+    field.store(value, std::memory_order_relaxed);
+  }
+
+  void store(std::atomic<std::uint64_t>& field, std::uint64_t value) {
+    field.store(value, std::memory_order_relaxed);
+  }
+
+  // writer side of the sequence lock: odd while the fields are being replaced
+  template<typename Write>
+  void publish(std::atomic<std::uint64_t>& sequence, Write write) {
+    const std::uint64_t start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    write();
+    sequence.store(start + 2, std::memory_order_release);
+  }
+
+  // reader side: copies until no write overlapped the copy
+  template<typename Read>
+  void consistent_read(const std::atomic<std::uint64_t>& sequence, Read read) {
+    for (;;) {
+      const std::uint64_t start = sequence.load(std::memory_order_acquire);
+      if (start & 1) {
+        continue; // the writer is a few stores from done
+      }
+      read();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == start) {
+        return;
+      }
+    }
+  }
+}
+
+PositionBook::PositionBook(std::size_t max_symbols)
+  : published_(std::make_unique<Published[]>(max_symbols)), capacity_(max_symbols), count_(0) {
+  state_.reserve(max_symbols);
+  symbols_.reserve(max_symbols);
+  index_.reserve(max_symbols);
+}
+
+std::uint32_t PositionBook::add_symbol(const std::string& symbol) {
+  auto existing = index_.find(symbol);
+  if (existing != index_.end()) {
+    return existing->second;
+  }
+  if (state_.size() == capacity_) {
+    return UINT32_MAX;
+  }
+  const auto index = static_cast<std::uint32_t>(state_.size());
+  state_.emplace_back();
+  symbols_.push_back(symbol);
+  index_.emplace(symbol, index);
+  count_.store(state_.size(), std::memory_order_release);
+  return index;
+}
+
+std::uint32_t PositionBook::index_of(const std::string& symbol) const {
+  auto it = index_.find(symbol);
+  return it == index_.end() ? UINT32_MAX : it->second;
+}
+
+void PositionBook::on_fill(std::uint32_t index, OrderSide side, double quantity, double price, double fee) {
+  if (index >= state_.size() || quantity <= 0.0) {
+    return;
+  }
+  PositionSnapshot& state = state_[index];
+  const PositionSnapshot before = state;
+  const double signed_quantity = side == OrderSide::buy ? quantity : -quantity;
+  double position = state.position + signed_quantity;
+  if (std::fabs(position) <= FLAT_EPSILON * std::max(std::fabs(state.position), quantity)) {
+    position = 0.0;
+  }
+
+  if (state.position * signed_quantity >= 0.0) {
+    // opening or adding: re-average the entry
+    state.entry_price = (state.entry_price * std::fabs(state.position) + price * quantity) / std::fabs(position);
+  } else {
+    // reducing: realize the closed part against the entry; what crosses through flat opens at this price
+    const double closed = std::min(quantity, std::fabs(state.position));
+    state.realized += (price - state.entry_price) * std::copysign(closed, state.position);
+    if (position == 0.0) {
+      state.entry_price = 0.0;
+    } else if (position * state.position < 0.0) {
+      state.entry_price = price;
+    }
+  }
+  state.position = position;
+  state.realized -= fee;
+  state.fees += fee;
+  state.fills += 1;
+  state.last_price = price; // our own trade is the latest print
+  state.unrealized = (state.last_price - state.entry_price) * state.position;
+  commit(index, before);
+}
+
+void PositionBook::on_price(std::uint32_t index, double price) {
+  if (index >= state_.size() || price <= 0.0) {
+    return;
+  }
+  PositionSnapshot& state = state_[index];
+  const PositionSnapshot before = state;
+  state.last_price = price;
+  state.unrealized = (price - state.entry_price) * state.position;
+  commit(index, before);
+}
+
+void PositionBook::on_trade(const Coin&, const CoinData& trade) {
+  on_price(index_of(trade.symbol), trade.price);
+}
+
+void PositionBook::commit(std::uint32_t index, const PositionSnapshot& before) {
+  const PositionSnapshot& after = state_[index];
+  totals_.realized += after.realized - before.realized;
+  totals_.unrealized += after.unrealized - before.unrealized;
+  totals_.fees += after.fees - before.fees;
+  totals_.gross_notional +=
+    std::fabs(after.position) * after.last_price - std::fabs(before.position) * before.last_price;
+  totals_.net_notional += after.position * after.last_price - before.position * before.last_price;
+  totals_.fills += after.fills - before.fills;
+  totals_.open_positions += static_cast<std::uint64_t>(after.position != 0.0);
+  totals_.open_positions -= static_cast<std::uint64_t>(before.position != 0.0);
+
+  Published& published = published_[index];
+  publish(published.sequence, [&] {
+    store(published.position, after.position);
+    store(published.entry_price, after.entry_price);
+    store(published.last_price, after.last_price);
+    store(published.realized, after.realized);
+    store(published.unrealized, after.unrealized);
+    store(published.fees, after.fees);
+    store(published.fills, after.fills);
+  });
+  publish(published_totals_.sequence, [&] {
+    store(published_totals_.realized, totals_.realized);
+    store(published_totals_.unrealized, totals_.unrealized);
+    store(published_totals_.fees, totals_.fees);
+    store(published_totals_.gross_notional, totals_.gross_notional);
+    store(published_totals_.net_notional, totals_.net_notional);
+    store(published_totals_.fills, totals_.fills);
+    store(published_totals_.open_positions, totals_.open_positions);
+  });
+}
+
+bool PositionBook::position(std::uint32_t index, PositionSnapshot& out) const {
+  if (index >= size()) {
+    return false;
+  }
+  const Published& published = published_[index];
+  consistent_read(published.sequence, [&] {
+    out.position = published.position.load(std::memory_order_relaxed);
+    out.entry_price = published.entry_price.load(std::memory_order_relaxed);
+    out.last_price = published.last_price.load(std::memory_order_relaxed);
+    out.realized = published.realized.load(std::memory_order_relaxed);
+    out.unrealized = published.unrealized.load(std::memory_order_relaxed);
+    out.fees = published.fees.load(std::memory_order_relaxed);
+    out.fills = published.fills.load(std::memory_order_relaxed);
+  });
+  return true;
+}
+
+PortfolioSnapshot PositionBook::portfolio() const {
+  PortfolioSnapshot out;
+  consistent_read(published_totals_.sequence, [&] {
+    out.realized = published_totals_.realized.load(std::memory_order_relaxed);
+    out.unrealized = published_totals_.unrealized.load(std::memory_order_relaxed);
+    out.fees = published_totals_.fees.load(std::memory_order_relaxed);
+    out.gross_notional = published_totals_.gross_notional.load(std::memory_order_relaxed);
+    out.net_notional = published_totals_.net_notional.load(std::memory_order_relaxed);
+    out.fills = published_totals_.fills.load(std::memory_order_relaxed);
+    out.open_positions = published_totals_.open_positions.load(std::memory_order_relaxed);
+  });
+  return out;
+}
+
+void PositionBook::write_prometheus(std::string& out) const {
+  const PortfolioSnapshot totals = portfolio();
+  char line[160];
+  out += "# HELP portfolio_pnl Realized and unrealized P&L in quote currency\n";
+  out += "# TYPE portfolio_pnl gauge\n";
+  std::snprintf(line, sizeof(line), "portfolio_pnl{kind=\"realized\"} %.8f\nportfolio_pnl{kind=\"unrealized\"} %.8f\n",
+                totals.realized, totals.unrealized);
+  out += line;
+  out += "# HELP portfolio_notional Sum of |position| (gross) and signed position (net) times mark\n";
+  out += "# TYPE portfolio_notional gauge\n";
+  std::snprintf(line, sizeof(line), "portfolio_notional{kind=\"gross\"} %.8f\nportfolio_notional{kind=\"net\"} %.8f\n",
+                totals.gross_notional, totals.net_notional);
+  out += line;
+
+  std::string positions = "# HELP position_size Signed base quantity held\n# TYPE position_size gauge\n";
+  std::string pnl = "# HELP position_pnl P&L per symbol in quote currency\n# TYPE position_pnl gauge\n";
+  for (std::uint32_t index = 0; index < size(); ++index) {
+    PositionSnapshot snapshot;
+    position(index, snapshot);
+    const char* name = symbols_[index].c_str();
+    std::snprintf(line, sizeof(line), "position_size{symbol=\"%s\"} %.8f\n", name, snapshot.position);
+    positions += line;
+    std::snprintf(line, sizeof(line), "position_pnl{symbol=\"%s\"} %.8f\n", name,
+                  snapshot.realized + snapshot.unrealized);
+    pnl += line;
+  }
+  out += positions;
+  out += pnl;
+}
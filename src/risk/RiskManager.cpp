@@ -0,0 +1,100 @@
+#include "../../include/risk/RiskManager.h"
+
+RiskManager::RiskManager(std::size_t max_symbols) {
+  slots_.reserve(max_symbols);
+  index_.reserve(max_symbols);
+}
+
+std::uint32_t RiskManager::add_symbol(const std::string& symbol, const SymbolRiskLimits& limits) {
+  auto existing = index_.find(symbol);
+  if (existing != index_.end()) {
+    slots_[existing->second].limits = limits;
+    return existing->second;
+  }
+  if (slots_.size() == slots_.capacity()) {
+    return UINT32_MAX;
+  }
+  const auto index = static_cast<std::uint32_t>(slots_.size());
+  slots_.emplace_back();
+  slots_.back().limits = limits;
+  index_.emplace(symbol, index);
+  return index;
+}
+
+std::uint32_t RiskManager::index_of(const std::string& symbol) const {
+  auto it = index_.find(symbol);
+  return it == index_.end() ? UINT32_MAX : it->second;
+}
+
+void RiskManager::set_limits(std::uint32_t index, const SymbolRiskLimits& limits) {
+  if (index < slots_.size()) {
+    slots_[index].limits = limits;
+    revalue(slots_[index]);
+  }
+}
+
+void RiskManager::on_fill(std::uint32_t index, OrderSide side, double quantity, double price, double fee) {
+  if (index >= slots_.size()) {
+    return;
+  }
+  Slot& slot = slots_[index];
+  const double signed_quantity = quantity * SIDE_SIGN[static_cast<int>(side)];
+  const double before = slot.position;
+  const double after = before + signed_quantity;
+
+  if (before * signed_quantity >= 0.0) {
+    // opening or adding: volume-weighted entry
+    const double size = std::fabs(after);
+    slot.entry_price = size > 0.0 ? (slot.entry_price * std::fabs(before) + price * quantity) / size : 0.0;
+  } else if (before * after < 0.0) {
+    // flipped through flat: the remainder opened at this price
+    slot.entry_price = price;
+  } else if (after == 0.0) {
+    slot.entry_price = 0.0;
+  }
+  slot.position = after;
+  slot.cash -= signed_quantity * price + fee;
+  slot.last_price = price; // our own trade is the latest print
+  revalue(slot);
+}
+
+void RiskManager::on_price(std::uint32_t index, double price) {
+  if (index >= slots_.size() || price <= 0.0) {
+    return;
+  }
+  slots_[index].last_price = price;
+  revalue(slots_[index]);
+}
+
+void RiskManager::on_trade(const Coin&, const CoinData& trade) {
+  on_price(index_of(trade.symbol), trade.price);
+}
+
+void RiskManager::revalue(Slot& slot) {
+  const double notional = std::fabs(slot.position) * slot.last_price;
+  gross_notional_ += notional - slot.notional;
+  slot.notional = notional;
+
+  const double pnl = slot.cash + slot.position * slot.last_price;
+  total_pnl_ += pnl - slot.pnl;
+  slot.pnl = pnl;
+
+  const double loss = (slot.entry_price - slot.last_price) * slot.position;
+  const double allowed = slot.limits.stop_loss * std::fabs(slot.position) * slot.entry_price;
+  slot.stopped = slot.position != 0.0 && loss > allowed ? 1.0 : 0.0;
+}
+
+std::string RiskManager::describe(unsigned violations) {
+  static const char* names[] = {"unknown_symbol", "position_limit", "notional_limit", "order_notional",
+                                "price_band", "stop_loss", "gross_limit", "daily_loss", "halted"};
+  std::string out;
+  for (unsigned bit = 0; bit < sizeof(names) / sizeof(names[0]); ++bit) {
+    if (violations & (1u << bit)) {
+      if (!out.empty()) {
+        out += '|';
+      }
+      out += names[bit];
+    }
+  }
+  return out.empty() ? "ok" : out;
+}
@@ -0,0 +1,209 @@
+#include "../../include/risk/RollingCorrelation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+namespace {
+  // variances below this are rounding left behind by returns that have left the window
+  constexpr double MIN_VARIANCE = 1e-20;
+  // square blocks the covariance is mirrored in, so the transposed writes stay in cache
+  constexpr std::size_t MIRROR_TILE = 32;
+
+  // c[j] += a * x[j] - b * y[j] over [begin, end): one row of the cross-product update
+  void update_row(double* c, double a, const double* x, double b, const double* y, std::size_t begin,
+                  std::size_t end) {
+    for (std::size_t j = begin; j < end; ++j) {
+      c[j] += a * x[j] - b * y[j];
+    }
+  }
+}
+
+RollingCorrelation::RollingCorrelation(std::size_t window, std::int64_t interval_ms, std::size_t max_symbols)
+  : window_(std::max<std::size_t>(window, 2)),
+    interval_ms_(std::max<std::int64_t>(interval_ms, 1)),
+    capacity_(max_symbols),
+    price_(max_symbols, 0.0),
+    last_close_(max_symbols, 0.0),
+    next_close_ms_(0),
+    steps_(0),
+    returns_(window_ * max_symbols, 0.0),
+    sum_(max_symbols, 0.0),
+    cross_(max_symbols * max_symbols, 0.0),
+    leaving_(max_symbols, 0.0),
+    inverse_volatility_(max_symbols, 0.0),
+    snapshot_(std::make_shared<CorrelationSnapshot>()) {
+  symbols_.reserve(max_symbols);
+  index_.reserve(max_symbols);
+}
+
+std::uint32_t RollingCorrelation::add_symbol(const std::string& symbol) {
+  auto existing = index_.find(symbol);
+  if (existing != index_.end()) {
+    return existing->second;
+  }
+  if (symbols_.size() == capacity_) {
+    return UINT32_MAX;
+  }
+  const auto index = static_cast<std::uint32_t>(symbols_.size());
+  symbols_.push_back(symbol);
+  index_.emplace(symbol, index);
+  return index;
+}
+
+std::uint32_t RollingCorrelation::index_of(const std::string& symbol) const {
+  auto it = index_.find(symbol);
+  return it == index_.end() ? UINT32_MAX : it->second;
+}
+
+void RollingCorrelation::on_price(std::uint32_t index, double price, std::int64_t time_ms) {
+  if (index >= symbols_.size()) {
+    return;
+  }
+  if (next_close_ms_ == 0) {
+    next_close_ms_ = (time_ms / interval_ms_ + 1) * interval_ms_;
+  }
+  advance_to(time_ms);
+  price_[index] = price;
+}
+
+void RollingCorrelation::on_trade(const Coin&, const CoinData& trade) {
+  auto it = index_.find(trade.symbol);
+  if (it != index_.end()) {
+    on_price(it->second, trade.price, trade.trade_time);
+  }
+}
+
+void RollingCorrelation::advance_to(std::int64_t time_ms) {
+  if (next_close_ms_ == 0 || time_ms < next_close_ms_) {
+    return;
+  }
+  const auto pending = static_cast<std::uint64_t>((time_ms - next_close_ms_) / interval_ms_ + 1);
+  close_interval(next_close_ms_);
+  // after the first close every pending interval has a zero return; window_ of them clear the window,
+  // so the steps before those can be skipped
+  std::uint64_t remaining = pending - 1;
+  if (remaining > window_) {
+    const std::uint64_t skipped = remaining - window_;
+    steps_ += skipped;
+    next_close_ms_ += static_cast<std::int64_t>(skipped) * interval_ms_;
+    remaining = window_;
+  }
+  for (std::uint64_t i = 0; i < remaining; ++i) {
+    close_interval(next_close_ms_);
+  }
+  publish(next_close_ms_ - interval_ms_);
+}
+
+void RollingCorrelation::close_interval(std::int64_t close_ms) {
+  const std::size_t n = symbols_.size();
+  double* incoming = &returns_[(steps_ % window_) * capacity_];
+  // the slot being overwritten holds the return leaving the window (zeros while it fills)
+  std::copy(incoming, incoming + n, leaving_.begin());
+  for (std::size_t i = 0; i < n; ++i) {
+    incoming[i] = price_[i] > 0.0 && last_close_[i] > 0.0 ? std::log(price_[i] / last_close_[i]) : 0.0;
+    last_close_[i] = price_[i];
+  }
+
+  const double* leaving = leaving_.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    sum_[i] += incoming[i] - leaving[i];
+    update_row(&cross_[i * capacity_], incoming[i], incoming, leaving[i], leaving, i, n);
+  }
+  ++steps_;
+  next_close_ms_ = close_ms + interval_ms_;
+  if (steps_ % window_ == 0) {
+    rebuild();
+  }
+}
+
+void RollingCorrelation::rebuild() {
+  const std::size_t n = symbols_.size();
+  std::fill(sum_.begin(), sum_.begin() + static_cast<std::ptrdiff_t>(n), 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    std::fill(&cross_[i * capacity_ + i], &cross_[i * capacity_ + n], 0.0);
+  }
+  for (std::size_t slot = 0; slot < window_; ++slot) {
+    const double* row = &returns_[slot * capacity_];
+    for (std::size_t i = 0; i < n; ++i) {
+      sum_[i] += row[i];
+      update_row(&cross_[i * capacity_], row[i], row, 0.0, row, i, n);
+    }
+  }
+}
+
+void RollingCorrelation::publish(std::int64_t close_ms) {
+  // reuse the previous snapshot's buffers once no reader holds it any more
+  std::shared_ptr<CorrelationSnapshot> next;
+  if (spare_ && spare_.use_count() == 1) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    next = std::move(spare_);
+  } else {
+    next = std::make_shared<CorrelationSnapshot>();
+  }
+
+  const std::size_t n = symbols_.size();
+  const std::size_t samples = static_cast<std::size_t>(std::min<std::uint64_t>(steps_, window_));
+  const double count = static_cast<double>(samples);
+  next->symbols.assign(symbols_.begin(), symbols_.end());
+  next->step = steps_;
+  next->time_ms = close_ms;
+  next->samples = samples;
+  next->mean.resize(n);
+  next->volatility.resize(n);
+  next->covariance.resize(n * n);
+  next->correlation.resize(n * n);
+
+  // upper triangle row by row, mirrored in tiles, then correlation row by row: every pass is contiguous or
+  // stays within a tile, and the inner loops are branch-free so they vectorise
+  double* covariance = next->covariance.data();
+  const double scale = samples > 1 ? 1.0 / (count - 1.0) : 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double mean_i = sum_[i] / count;
+    next->mean[i] = mean_i;
+    const double* cross = &cross_[i * capacity_];
+    double* row = &covariance[i * n];
+    for (std::size_t j = i; j < n; ++j) {
+      row[j] = (cross[j] - mean_i * sum_[j]) * scale;
+    }
+  }
+  for (std::size_t block_i = 0; block_i < n; block_i += MIRROR_TILE) {
+    for (std::size_t block_j = block_i; block_j < n; block_j += MIRROR_TILE) {
+      const std::size_t end_i = std::min(block_i + MIRROR_TILE, n);
+      const std::size_t end_j = std::min(block_j + MIRROR_TILE, n);
+      for (std::size_t i = block_i; i < end_i; ++i) {
+        for (std::size_t j = std::max(block_j, i + 1); j < end_j; ++j) {
+          covariance[j * n + i] = covariance[i * n + j];
+        }
+      }
+    }
+  }
+
+  double* inverse = inverse_volatility_.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    const double variance = covariance[i * n + i];
+    next->volatility[i] = variance > MIN_VARIANCE ? std::sqrt(variance) : 0.0;
+    inverse[i] = next->volatility[i] > 0.0 ? 1.0 / next->volatility[i] : 0.0;
+  }
+  double* correlation = next->correlation.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    const double* row = &covariance[i * n];
+    double* out = &correlation[i * n];
+    const double inverse_i = inverse[i];
+    for (std::size_t j = 0; j < n; ++j) {
+      out[j] = std::min(1.0, std::max(-1.0, row[j] * inverse_i * inverse[j]));
+    }
+  }
+
+  std::shared_ptr<const CorrelationSnapshot> previous;
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    previous = std::exchange(snapshot_, next);
+  }
+  spare_ = std::const_pointer_cast<CorrelationSnapshot>(previous);
+}
+
+std::shared_ptr<const CorrelationSnapshot> RollingCorrelation::snapshot() const {
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  return snapshot_;
+}
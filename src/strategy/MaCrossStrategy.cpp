@@ -0,0 +1,17 @@
+#include "../../include/strategy/MaCrossStrategy.h"
+
+MaCrossStrategy::MaCrossStrategy(StrategyEngine& engine) : engine_(engine), long_(false) {}
+
+void MaCrossStrategy::on_ma_cross(const Coin& coin, const MaCross& cross) {
+  if (cross.direction == CrossDirection::below && !long_) {
+    long_ = true;
+    engine_.emit({"ma_cross", coin.symbol(), SignalSide::buy, cross.price, cross.trade_time});
+  } else if (cross.direction == CrossDirection::above && long_) {
+    long_ = false;
+    engine_.emit({"ma_cross", coin.symbol(), SignalSide::sell, cross.price, cross.trade_time});
+  }
+}
+
+bool MaCrossStrategy::is_long() const {
+  return long_;
+}
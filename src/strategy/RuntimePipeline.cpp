@@ -0,0 +1,82 @@
+#include "../../include/strategy/RuntimePipeline.h"
+#include "../../include/strategy/Pipeline.h"
+
+RuntimeSMA::RuntimeSMA(std::size_t window_size) :
+  window_(window_size ? window_size : 1, 0.0), next_(0), count_(0), sum_(0.0) {}
+
+void RuntimeSMA::update(double price) {
+  sum_ += price - window_[next_];
+  window_[next_] = price;
+  next_ = next_ + 1 == window_.size() ? 0 : next_ + 1;
+  count_ += count_ < window_.size();
+}
+
+double RuntimeSMA::value() const {
+  return count_ ? sum_ / static_cast<double>(count_) : 0.0;
+}
+
+bool RuntimeSMA::ready() const {
+  return count_ == window_.size();
+}
+
+RuntimeEMA::RuntimeEMA(std::size_t period) :
+  period_(period ? period : 1), alpha_(2.0 / (static_cast<double>(period_) + 1.0)), value_(0.0), count_(0) {}
+
+void RuntimeEMA::update(double price) {
+  value_ = count_ ? value_ + alpha_ * (price - value_) : price;
+  count_ += count_ < period_;
+}
+
+double RuntimeEMA::value() const {
+  return value_;
+}
+
+bool RuntimeEMA::ready() const {
+  return count_ == period_;
+}
+
+RuntimeCrossRule::RuntimeCrossRule(const Indicator& fast, const Indicator& slow) :
+  fast_(fast), slow_(slow), side_(0) {}
+
+int RuntimeCrossRule::evaluate(double) {
+  if (!fast_.ready() || !slow_.ready()) {
+    return SIGNAL_NONE;
+  }
+  const int side = fast_.value() > slow_.value() ? 1 : fast_.value() < slow_.value() ? -1 : side_;
+  const int signal = side_ != 0 && side != side_ ? side : SIGNAL_NONE;
+  side_ = side;
+  return signal;
+}
+
+RuntimePriceCrossRule::RuntimePriceCrossRule(const Indicator& average) : average_(average), side_(0) {}
+
+int RuntimePriceCrossRule::evaluate(double price) {
+  if (!average_.ready()) {
+    return SIGNAL_NONE;
+  }
+  const int side = price > average_.value() ? 1 : price < average_.value() ? -1 : side_;
+  const int signal = side_ != 0 && side != side_ ? -side : SIGNAL_NONE;
+  side_ = side;
+  return signal;
+}
+
+Indicator& RuntimePipeline::add_indicator(std::unique_ptr<Indicator> indicator) {
+  indicators_.push_back(std::move(indicator));
+  return *indicators_.back();
+}
+
+void RuntimePipeline::add_rule(std::unique_ptr<SignalRule> rule) {
+  rules_.push_back(std::move(rule));
+}
+
+int RuntimePipeline::update(double price) {
+  for (const auto& indicator : indicators_) {
+    indicator->update(price);
+  }
+  int signal = SIGNAL_NONE;
+  for (const auto& rule : rules_) {
+    const int fired = rule->evaluate(price);
+    signal = signal ? signal : fired;
+  }
+  return signal;
+}
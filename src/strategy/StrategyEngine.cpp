@@ -0,0 +1,98 @@
+#include "../../include/strategy/StrategyEngine.h"
+#include <algorithm>
+#include "../../include/common/Clock.h"
+#include "../../include/metrics/MetricsRegistry.h"
+
+StrategyEngine::StrategyEngine() :
+  dispatch_tick_(0),
+  signals_metric_(&METRICS.counter("strategy_signals_total", "Signals emitted by strategies")) {}
+
+void StrategyEngine::unsubscribe(const void* strategy) {
+  auto remove = [strategy](auto& subscribers) {
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                     [strategy](const auto& s) { return s.strategy == strategy; }),
+                      subscribers.end());
+  };
+  for (auto& [symbol, subscribers] : symbols_) {
+    remove(subscribers.trade);
+    remove(subscribers.ma_cross);
+    remove(subscribers.bar_close);
+    remove(subscribers.quote);
+  }
+}
+
+void StrategyEngine::on_trade(const Coin& coin, const CoinData& trade) {
+  auto it = symbols_.find(trade.symbol);
+  if (it == symbols_.end()) {
+    return;
+  }
+  SymbolSubscribers& subscribers = it->second;
+  dispatch_tick_ = Clock::ticks();
+
+  for (const auto& subscriber : subscribers.trade) {
+    subscriber.call(subscriber.strategy, coin, trade);
+  }
+
+  if (subscribers.ma_cross.empty()) {
+    return;
+  }
+  const MovingAverage& average = coin.moving_average();
+  if (!average.is_ready()) {
+    return;
+  }
+  const double value = average.get_value();
+  int side = trade.price > value ? 1 : trade.price < value ? -1 : subscribers.ma_side;
+  if (side != subscribers.ma_side) {
+    // the first side seen once the average is ready is a baseline, not a cross
+    if (subscribers.ma_side != 0) {
+      MaCross cross{side > 0 ? CrossDirection::above : CrossDirection::below, trade.price, value, trade.trade_time};
+      for (const auto& subscriber : subscribers.ma_cross) {
+        subscriber.call(subscriber.strategy, coin, cross);
+      }
+    }
+    subscribers.ma_side = side;
+  }
+}
+
+void StrategyEngine::on_bar_close(const Coin& coin, long resolution_ms, const Bar& bar) {
+  auto it = symbols_.find(coin.symbol());
+  if (it == symbols_.end() || it->second.bar_close.empty()) {
+    return;
+  }
+  dispatch_tick_ = Clock::ticks();
+  for (const auto& subscriber : it->second.bar_close) {
+    subscriber.call(subscriber.strategy, coin, resolution_ms, bar);
+  }
+}
+
+void StrategyEngine::on_quote(const Coin& coin, const Quote& quote) {
+  auto it = symbols_.find(quote.instrument);
+  if (it == symbols_.end() || it->second.quote.empty()) {
+    return;
+  }
+  dispatch_tick_ = Clock::ticks();
+  for (const auto& subscriber : it->second.quote) {
+    subscriber.call(subscriber.strategy, coin, quote);
+  }
+}
+
+bool StrategyEngine::wants_bar_close(const std::string& symbol) const {
+  auto it = symbols_.find(symbol);
+  return it != symbols_.end() && !it->second.bar_close.empty();
+}
+
+void StrategyEngine::set_signal_handler(SignalHandler handler) {
+  on_signal_ = std::move(handler);
+}
+
+void StrategyEngine::emit(const Signal& signal) {
+  tick_to_signal_.record(Clock::ticks_to_ns(static_cast<std::int64_t>(Clock::ticks() - dispatch_tick_)));
+  signals_metric_->inc();
+  if (on_signal_) {
+    on_signal_(signal);
+  }
+}
+
+const LatencyHistogram& StrategyEngine::tick_to_signal() const {
+  return tick_to_signal_;
+}
@@ -0,0 +1,152 @@
+#include "../../include/strategy/TriangularArbitrage.h"
+#include <algorithm>
+#include <map>
+#include "../../include/common/Clock.h"
+#include "../../include/feed/Instrument.h"
+
+TriangularArbitrage::TriangularArbitrage(StrategyEngine& engine, const std::vector<std::string>& symbols,
+                                         double fee_rate, double min_net_return)
+  : engine_(engine),
+    fee_factor_((1.0 - fee_rate) * (1.0 - fee_rate) * (1.0 - fee_rate)),
+    min_net_return_(min_net_return),
+    evaluations_(0) {
+  std::unordered_map<std::string, std::uint32_t> currency_index;
+  auto currency = [&](const std::string& code) {
+    auto [it, added] = currency_index.emplace(code, static_cast<std::uint32_t>(currencies_.size()));
+    if (added) {
+      currencies_.push_back(code);
+    }
+    return it->second;
+  };
+  for (const std::string& symbol : symbols) {
+    std::string base;
+    std::string quote;
+    if (pair_index_.count(symbol) || !instruments::split(symbol, base, quote)) {
+      continue;
+    }
+    Pair pair;
+    pair.symbol = symbol;
+    pair.base = currency(base);
+    pair.quote = currency(quote);
+    pair_index_.emplace(symbol, static_cast<std::uint32_t>(pairs_.size()));
+    pairs_.push_back(std::move(pair));
+  }
+  build_cycles();
+}
+
+void TriangularArbitrage::build_cycles() {
+  // edge (a, b) -> pair, with a < b
+  std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> edges;
+  for (std::uint32_t p = 0; p < pairs_.size(); ++p) {
+    edges.emplace(std::minmax(pairs_[p].base, pairs_[p].quote), p);
+  }
+  auto edge = [&](std::uint32_t a, std::uint32_t b) -> std::int64_t {
+    auto it = edges.find(std::minmax(a, b));
+    return it == edges.end() ? -1 : static_cast<std::int64_t>(it->second);
+  };
+
+  const auto n = static_cast<std::uint32_t>(currencies_.size());
+  for (std::uint32_t a = 0; a < n; ++a) {
+    for (std::uint32_t b = a + 1; b < n; ++b) {
+      const std::int64_t ab = edge(a, b);
+      if (ab < 0) {
+        continue;
+      }
+      for (std::uint32_t c = b + 1; c < n; ++c) {
+        const std::int64_t bc = edge(b, c);
+        const std::int64_t ca = edge(c, a);
+        if (bc < 0 || ca < 0) {
+          continue;
+        }
+        // both directions around the triangle: a -> b -> c -> a and a -> c -> b -> a
+        const std::uint32_t hops[2][3][2] = {{{a, b}, {b, c}, {c, a}}, {{a, c}, {c, b}, {b, a}}};
+        const std::int64_t legs[2][3] = {{ab, bc, ca}, {ca, bc, ab}};
+        for (int direction = 0; direction < 2; ++direction) {
+          Cycle cycle{};
+          cycle.start = a;
+          for (int leg = 0; leg < 3; ++leg) {
+            const auto pair = static_cast<std::uint32_t>(legs[direction][leg]);
+            cycle.pairs[leg] = pair;
+            // converting from the pair's base into its quote sells the base
+            cycle.sells_base[leg] = pairs_[pair].base == hops[direction][leg][0];
+          }
+          const auto index = static_cast<std::uint32_t>(cycles_.size());
+          cycles_.push_back(cycle);
+          for (std::uint32_t pair : cycle.pairs) {
+            pairs_[pair].cycles.push_back(index);
+          }
+        }
+      }
+    }
+  }
+}
+
+void TriangularArbitrage::on_trade(const Coin&, const CoinData& trade) {
+  auto it = pair_index_.find(trade.symbol);
+  if (it == pair_index_.end()) {
+    return;
+  }
+  Pair& pair = pairs_[it->second];
+  pair.bid = trade.price;
+  pair.ask = trade.price;
+  evaluate(it->second, engine_.dispatch_tick(), trade.trade_time);
+}
+
+void TriangularArbitrage::on_quote(const Quote& quote) {
+  const std::uint64_t trigger_tick = Clock::ticks();
+  auto it = pair_index_.find(quote.instrument);
+  if (it == pair_index_.end()) {
+    return;
+  }
+  Pair& pair = pairs_[it->second];
+  pair.bid = quote.bid;
+  pair.ask = quote.ask;
+  evaluate(it->second, trigger_tick, 0);
+}
+
+void TriangularArbitrage::evaluate(std::uint32_t updated, std::uint64_t trigger_tick, long trade_time) {
+  // single writer, so a relaxed load + store is enough
+  evaluations_.store(evaluations_.load(std::memory_order_relaxed) + pairs_[updated].cycles.size(),
+                     std::memory_order_relaxed);
+  for (std::uint32_t index : pairs_[updated].cycles) {
+    Cycle& cycle = cycles_[index];
+    double gross = 1.0;
+    for (int leg = 0; leg < 3; ++leg) {
+      const Pair& pair = pairs_[cycle.pairs[leg]];
+      // selling base yields bid quote per base; buying base yields 1 / ask base per quote
+      gross *= cycle.sells_base[leg] ? pair.bid : (pair.ask > 0.0 ? 1.0 / pair.ask : 0.0);
+    }
+    const double net = gross * fee_factor_ - 1.0;
+    const bool open = gross > 0.0 && net > min_net_return_;
+    if (!open || cycle.open) {
+      cycle.open = open;
+      continue;
+    }
+    cycle.open = true;
+    const std::int64_t latency = Clock::ticks_to_ns(static_cast<std::int64_t>(Clock::ticks() - trigger_tick));
+    trigger_to_opportunity_.record(latency);
+    if (!on_opportunity_) {
+      continue;
+    }
+    ArbitrageOpportunity opportunity;
+    std::uint32_t at = cycle.start;
+    opportunity.path = currencies_[at];
+    for (int leg = 0; leg < 3; ++leg) {
+      const Pair& pair = pairs_[cycle.pairs[leg]];
+      at = cycle.sells_base[leg] ? pair.quote : pair.base;
+      opportunity.path += ">" + currencies_[at];
+      opportunity.symbols[leg] = pair.symbol;
+      opportunity.sells_base[leg] = cycle.sells_base[leg];
+    }
+    opportunity.gross_return = gross - 1.0;
+    opportunity.net_return = net;
+    opportunity.trigger = pairs_[updated].symbol;
+    opportunity.trade_time = trade_time;
+    opportunity.latency_ns = latency;
+    on_opportunity_(opportunity);
+  }
+}
+
+void TriangularArbitrage::set_opportunity_handler(OpportunityHandler handler) {
+  on_opportunity_ = std::move(handler);
+}
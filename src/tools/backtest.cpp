@@ -0,0 +1,33 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include "../../include/backtest/Backtester.h"
+#include "../../include/strategy/MaCrossStrategy.h"
+
+// backtest <history_dir> [trade_log.csv] [symbol...]
+// Replays the capture through MaCrossStrategy, one instance per symbol.
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <history_dir> [trade_log.csv] [symbol...]" << std::endl;
+    return 1;
+  }
+
+  BacktestConfig config;
+  config.history_dir = argv[1];
+  for (int i = 3; i < argc; ++i) {
+    config.symbols.emplace_back(argv[i]);
+  }
+
+  Backtester backtester(config, [](StrategyEngine& engine, const std::string& symbol) {
+    auto strategy = std::make_shared<MaCrossStrategy>(engine);
+    engine.subscribe(symbol, EVENT_MA_CROSS, *strategy);
+    return std::shared_ptr<void>(strategy);
+  });
+  BacktestReport report = backtester.run();
+
+  std::cout << Backtester::summary(report);
+  if (argc > 2 && !Backtester::write_trade_log(report, argv[2])) {
+    return 1;
+  }
+  return report.trades > 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../../include/common/MovingAverage.h"
+#include "../../include/fpga/FpgaEmulator.h"
+#include "../../include/fpga/GoldenVectors.h"
+#include "../../include/fpga/OffloadMovingAverageBackend.h"
+
+// golden_vectors generate <history_dir> <symbol> <prefix> [window] [begin_ms end_ms]
+// golden_vectors run <stimulus.hex> <output.hex> <device|emulator> [window]
+// golden_vectors check <stimulus.hex> <output.hex> [window]
+// Vectors for the FPGA moving-average unit from captured ticks, a run of them through the unit (or the emulator),
+// and the check of a unit's or testbench's outputs against the golden model. Windows default to MA_STANDARD_SIZE.
+namespace {
+  std::size_t window_arg(int argc, char** argv, int index) {
+    return argc > index ? std::strtoul(argv[index], nullptr, 10) : MA_STANDARD_SIZE;
+  }
+
+  void usage(const char* name) {
+    std::cerr << "usage: " << name << " generate <history_dir> <symbol> <prefix> [window] [begin_ms end_ms]\n"
+              << "       " << name << " run <stimulus.hex> <output.hex> <device|emulator> [window]\n"
+              << "       " << name << " check <stimulus.hex> <output.hex> [window]" << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  const std::string command = argc > 1 ? argv[1] : "";
+  std::uint64_t vectors = 0;
+
+  if (command == "generate" && argc > 4) {
+    const std::int64_t begin_ms = argc > 7 ? std::strtoll(argv[6], nullptr, 10) : 0;
+    const std::int64_t end_ms = argc > 7 ? std::strtoll(argv[7], nullptr, 10) : INT64_MAX;
+    if (!golden::generate_vectors(argv[2], argv[3], begin_ms, end_ms, window_arg(argc, argv, 5), argv[4], vectors)) {
+      return 1;
+    }
+    std::cout << "Wrote " << vectors << " vectors to " << argv[4] << "_stimulus.hex and " << argv[4]
+              << "_expected.hex" << std::endl;
+    return 0;
+  }
+
+  if (command == "run" && argc > 4) {
+    FpgaEmulator emulator;
+    std::string device = argv[4];
+    if (device == "emulator") {
+      if (!emulator.start()) {
+        return 1;
+      }
+      device = emulator.device();
+    }
+    if (!golden::run_unit(device, OFFLOAD_DEFAULT_BAUD, argv[2], window_arg(argc, argv, 5), argv[3], vectors)) {
+      return 1;
+    }
+    std::cout << "Ran " << vectors << " vectors through " << device << std::endl;
+    return 0;
+  }
+
+  if (command == "check" && argc > 3) {
+    GoldenCheck result;
+    if (!golden::check_vectors(argv[2], argv[3], window_arg(argc, argv, 4), result, std::cerr)) {
+      return 1;
+    }
+    std::cout << result.vectors << " vectors, " << result.fields << " fields each, " << result.mismatches
+              << " mismatches";
+    if (result.mismatches) {
+      std::cout << " (first on line " << result.first_mismatch << ")";
+    }
+    std::cout << ", " << result.vectors_per_s() / 1e6 << " M vectors/s" << std::endl;
+    return result.mismatches ? 2 : 0;
+  }
+
+  usage(argv[0]);
+  return 1;
+}
@@ -0,0 +1,30 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../../include/history/HistoryExporter.h"
+
+// history_export <history_dir> <output_dir> [csv|npy] [workers]
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0] << " <history_dir> <output_dir> [csv|npy] [workers]" << std::endl;
+    return 1;
+  }
+
+  std::string format_name = argc > 3 ? argv[3] : "csv";
+  if (format_name != "csv" && format_name != "npy") {
+    std::cerr << "Unknown export format: " << format_name << std::endl;
+    return 1;
+  }
+  ExportFormat format = format_name == "csv" ? ExportFormat::csv : ExportFormat::npy;
+  unsigned workers = argc > 4 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 0;
+
+  HistoryExporter exporter(argv[1], argv[2], workers);
+  ExportStats stats = exporter.export_all(format);
+
+  std::cout << "Exported " << stats.files << " files, " << stats.records << " records in " << stats.seconds << " s"
+            << std::endl;
+  std::cout << "Read " << stats.bytes_in / (1024.0 * 1024.0) << " MB (" << stats.input_mb_per_s() << " MB/s), "
+            << "wrote " << stats.bytes_out / (1024.0 * 1024.0) << " MB (" << stats.output_mb_per_s() << " MB/s)"
+            << std::endl;
+  return stats.files > 0 ? 0 : 1;
+}
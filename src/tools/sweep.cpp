@@ -0,0 +1,38 @@
+#include <iostream>
+#include <string>
+#include "../../include/backtest/ParameterSweep.h"
+
+// sweep <history_dir> <table.csv> [symbol...]
+// Ranks MA mean-reversion parameters over the capture: windows 10..2000, thresholds 0.05 %..2 %.
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0] << " <history_dir> <table.csv> [symbol...]" << std::endl;
+    return 1;
+  }
+
+  SweepConfig config;
+  config.history_dir = argv[1];
+  for (int i = 3; i < argc; ++i) {
+    config.symbols.emplace_back(argv[i]);
+  }
+  for (std::size_t window = 10; window <= 2000; window += 10) {
+    config.windows.push_back(window);
+  }
+  for (double threshold : {0.0005, 0.001, 0.002, 0.003, 0.005, 0.0075, 0.01, 0.015, 0.02}) {
+    config.thresholds.push_back(threshold);
+  }
+
+  std::vector<SweepResult> results = ParameterSweep(config).run();
+  if (results.empty() || !ParameterSweep::write_table(results, argv[2])) {
+    return 1;
+  }
+  std::cout << results.size() << " results" << std::endl;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const SweepResult& best = results[i];
+    if (i == 0 || results[i - 1].symbol != best.symbol) {
+      std::cout << best.symbol << " best: window=" << best.window << " threshold=" << best.threshold
+                << " pnl=" << best.pnl << " fills=" << best.fills << std::endl;
+    }
+  }
+  return 0;
+}
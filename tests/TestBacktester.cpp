@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include "../include/backtest/Backtester.h"
+#include "../include/common/WorkStealingPool.h"
+#include "../include/history/HistoryWriter.h"
+#include "../include/metrics/MetricsRegistry.h"
+
+namespace {
+  // buys on one trade id and sells on another, so fills are easy to predict
+  class ScriptedStrategy {
+  private:
+    StrategyEngine& engine_;
+    long buy_id_;
+    long sell_id_;
+
+  public:
+    ScriptedStrategy(StrategyEngine& engine, long buy_id, long sell_id) :
+      engine_(engine), buy_id_(buy_id), sell_id_(sell_id) {}
+
+    void on_trade(const Coin&, const CoinData& trade) {
+      if (trade.trade_id == buy_id_ || trade.trade_id == sell_id_) {
+        engine_.emit({"scripted", trade.symbol, trade.trade_id == buy_id_ ? SignalSide::buy : SignalSide::sell,
+                      trade.price, trade.trade_time});
+      }
+    }
+  };
+}
+
+class BacktesterTest : public ::testing::Test {
+protected:
+  std::filesystem::path test_dir;
+  const std::int64_t day_start = 1735689600000; // 2025-01-01T00:00:00Z
+
+  void SetUp() override {
+    test_dir = std::filesystem::temp_directory_path() / "backtester_test";
+    std::filesystem::remove_all(test_dir);
+    HistoryWriter writer(test_dir.string());
+    // one trade every 10 ms, price = 100 + id (eth at 10x)
+    for (std::int64_t id = 1; id <= 1000; ++id) {
+      writer.append("btcusdt", TickRecord{day_start + id * 10, id, 100.0 + id, 1.0});
+      writer.append("ethusdt", TickRecord{day_start + id * 10, id, 1000.0 + 10.0 * id, 1.0});
+    }
+  }
+  void TearDown() override { std::filesystem::remove_all(test_dir); }
+
+  Backtester make(BacktestConfig config) {
+    config.history_dir = test_dir.string();
+    return Backtester(config, [](StrategyEngine& engine, const std::string& symbol) {
+      auto strategy = std::make_shared<ScriptedStrategy>(engine, 10, 20);
+      engine.subscribe(symbol, EVENT_TRADE, *strategy);
+      return std::shared_ptr<void>(strategy);
+    });
+  }
+};
+
+TEST_F(BacktesterTest, FillsOnNextTradeAndMarksPnl) {
+  BacktestConfig config;
+  config.fee_rate = 0.0;
+  config.threads = 2;
+  BacktestReport report = make(config).run();
+
+  ASSERT_EQ(report.symbols.size(), 2u); // discovered from the capture
+  const SymbolResult& btc = report.symbols[0];
+  EXPECT_EQ(btc.symbol, "btcusdt");
+  EXPECT_EQ(btc.trades, 1000u);
+  EXPECT_EQ(btc.signals, 2u);
+  ASSERT_EQ(btc.fills.size(), 2u);
+  EXPECT_DOUBLE_EQ(btc.fills[0].price, 111.0); // signal on trade 10, filled on trade 11
+  EXPECT_EQ(btc.fills[0].fill_time, day_start + 110);
+  EXPECT_DOUBLE_EQ(btc.fills[1].price, 121.0);
+  EXPECT_DOUBLE_EQ(btc.position, 0.0);
+  EXPECT_DOUBLE_EQ(btc.pnl, 10.0);
+  EXPECT_DOUBLE_EQ(report.symbols[1].pnl, 100.0);
+  EXPECT_DOUBLE_EQ(report.pnl, 110.0);
+  EXPECT_EQ(report.trades, 2000u);
+}
+
+TEST_F(BacktesterTest, AppliesLatencySlippageAndFees) {
+  BacktestConfig config;
+  config.symbols = {"btcusdt"};
+  config.fill_latency_ms = 50;
+  config.slippage_bps = 100.0; // 1%
+  config.fee_rate = 0.001;
+  BacktestReport report = make(config).run();
+
+  const SymbolResult& btc = report.symbols.at(0);
+  ASSERT_EQ(btc.fills.size(), 2u);
+  EXPECT_DOUBLE_EQ(btc.fills[0].price, 115.0 * 1.01); // first trade >= 50 ms after trade 10
+  EXPECT_DOUBLE_EQ(btc.fills[1].price, 125.0 * 0.99);
+  double fees = 115.0 * 1.01 * 0.001 + 125.0 * 0.99 * 0.001;
+  EXPECT_NEAR(btc.fees, fees, 1e-9);
+  EXPECT_NEAR(btc.pnl, 125.0 * 0.99 - 115.0 * 1.01 - fees, 1e-9);
+}
+
+TEST_F(BacktesterTest, RespectsTimeRangeAndWritesTradeLog) {
+  BacktestConfig config;
+  config.symbols = {"btcusdt"};
+  config.begin_ms = day_start + 150; // starts after the buy signal
+  BacktestReport report = make(config).run();
+  const SymbolResult& btc = report.symbols.at(0);
+  EXPECT_EQ(btc.trades, 986u);
+  ASSERT_EQ(btc.fills.size(), 1u);
+  EXPECT_EQ(btc.fills[0].side, SignalSide::sell);
+  EXPECT_LT(btc.position, 0.0);
+
+  std::string log_path = (test_dir / "trades.csv").string();
+  ASSERT_TRUE(Backtester::write_trade_log(report, log_path));
+  std::ifstream log(log_path);
+  std::string header, row;
+  std::getline(log, header);
+  std::getline(log, row);
+  EXPECT_EQ(header, "symbol,side,signal_time,fill_time,price,quantity,fee");
+  EXPECT_EQ(row.rfind("btcusdt,sell,", 0), 0u);
+}
+
+TEST_F(BacktesterTest, LeavesLiveMetricsAlone) {
+  {
+    HistoryWriter writer(test_dir.string());
+    for (std::int64_t id = 1; id <= 100; ++id) {
+      writer.append("backtestonlyusdt", TickRecord{day_start + id * 10, id, 1.0 + id, 1.0});
+    }
+  }
+  BacktestConfig config;
+  config.symbols = {"backtestonlyusdt"};
+  testing::internal::CaptureStdout();
+  BacktestReport report = make(config).run();
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+  EXPECT_EQ(report.symbols.at(0).trades, 100u);
+  EXPECT_EQ(report.symbols.at(0).fills.size(), 2u);
+  EXPECT_EQ(METRICS.render().find("backtestonlyusdt"), std::string::npos);
+}
+
+TEST(WorkStealingPoolTest, RunsNestedTasksToCompletion) {
+  WorkStealingPool pool(4);
+  std::atomic<int> done{0};
+  for (int i = 0; i < 50; ++i) {
+    pool.submit([&]() {
+      for (int j = 0; j < 10; ++j) {
+        pool.submit([&]() { ++done; });
+      }
+      ++done;
+    });
+  }
+  pool.wait_idle();
+  EXPECT_EQ(done.load(), 550);
+}
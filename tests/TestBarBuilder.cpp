@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/common/BarBuilder.h"
+#include "../include/common/Coin.h"
+
+TEST(BarBuilderTest, AggregatesOhlcvWithinInterval) {
+  BarBuilder builder({1000});
+  builder.update(100.0, 1.0, 5000);
+  builder.update(105.0, 2.0, 5100);
+  builder.update(95.0, 0.5, 5900);
+  builder.update(101.0, 1.5, 5999);
+
+  ASSERT_TRUE(builder.has_current_bar(0));
+  const Bar& bar = builder.current_bar(0);
+  EXPECT_EQ(bar.open_time, 5000);
+  EXPECT_DOUBLE_EQ(bar.open, 100.0);
+  EXPECT_DOUBLE_EQ(bar.high, 105.0);
+  EXPECT_DOUBLE_EQ(bar.low, 95.0);
+  EXPECT_DOUBLE_EQ(bar.close, 101.0);
+  EXPECT_DOUBLE_EQ(bar.volume, 5.0);
+  EXPECT_EQ(bar.trade_count, 4);
+  EXPECT_EQ(builder.closed_bars(0), 0u);
+}
+
+TEST(BarBuilderTest, EmitsCloseEventsPerResolution) {
+  BarBuilder builder({1000, 60000});
+  std::vector<std::pair<long, Bar>> closed;
+  builder.set_bar_close_handler([&](long resolution, const Bar& bar) { closed.emplace_back(resolution, bar); });
+
+  builder.update(100.0, 1.0, 59500);
+  builder.update(102.0, 1.0, 60200);
+
+  ASSERT_EQ(closed.size(), 2u);
+  EXPECT_EQ(closed[0].first, 1000);
+  EXPECT_EQ(closed[0].second.open_time, 59000);
+  EXPECT_EQ(closed[1].first, 60000);
+  EXPECT_EQ(closed[1].second.open_time, 0);
+  EXPECT_DOUBLE_EQ(builder.current_bar(1).open, 102.0);
+}
+
+TEST(BarBuilderTest, EmptyIntervalsCloseAsFlatBars) {
+  BarBuilder builder({1000});
+  builder.update(100.0, 1.0, 1000);
+  builder.update(110.0, 1.0, 4500);
+
+  ASSERT_EQ(builder.closed_bars(0), 3u);
+  EXPECT_EQ(builder.closed_bar(0, 2).open_time, 1000);
+  EXPECT_EQ(builder.closed_bar(0, 1).open_time, 2000);
+  EXPECT_EQ(builder.closed_bar(0, 0).open_time, 3000);
+  EXPECT_DOUBLE_EQ(builder.closed_bar(0, 0).close, 100.0);
+  EXPECT_EQ(builder.closed_bar(0, 0).trade_count, 0);
+  EXPECT_DOUBLE_EQ(builder.closed_bar(0, 0).volume, 0.0);
+}
+
+TEST(BarBuilderTest, RingKeepsNewestBars) {
+  BarBuilder builder({1000}, 4);
+  for (long second = 0; second < 10; ++second) {
+    builder.update(static_cast<double>(second), 1.0, second * 1000);
+  }
+  ASSERT_EQ(builder.closed_bars(0), 4u);
+  EXPECT_DOUBLE_EQ(builder.closed_bar(0, 0).close, 8.0);
+  EXPECT_DOUBLE_EQ(builder.closed_bar(0, 3).close, 5.0);
+
+  // a gap longer than the ring only fills what the ring can hold
+  builder.update(50.0, 1.0, 100000);
+  EXPECT_EQ(builder.closed_bar(0, 0).open_time, 99000);
+  EXPECT_EQ(builder.closed_bar(0, 3).open_time, 96000);
+}
+
+TEST(BarBuilderTest, CoinFeedsBars) {
+  Coin coin("btcusdt");
+  CoinData data{"btcusdt", 97000.0, 1, 0.25, 1735689600000};
+  coin.update_trade(data);
+
+  std::size_t minute = coin.bars().find_resolution(60000);
+  ASSERT_LT(minute, coin.bars().resolution_count());
+  EXPECT_DOUBLE_EQ(coin.bars().current_bar(minute).close, 97000.0);
+  EXPECT_DOUBLE_EQ(coin.bars().current_bar(minute).volume, 0.25);
+}
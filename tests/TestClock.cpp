@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../include/common/Clock.h"
+
+TEST(ClockTest, TicksConvertToElapsedNanoseconds) {
+  std::uint64_t start = Clock::ticks();
+  auto steady_start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::uint64_t end = Clock::ticks();
+  auto steady_elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                               steady_start).count();
+
+  std::int64_t elapsed = Clock::ticks_to_ns(static_cast<std::int64_t>(end - start));
+  EXPECT_NEAR(static_cast<double>(elapsed), static_cast<double>(steady_elapsed), steady_elapsed * 0.02);
+}
+
+TEST(ClockTest, WallClockMatchesSystemClock) {
+  auto system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch()).count();
+  EXPECT_NEAR(static_cast<double>(Clock::wall_ns()), static_cast<double>(system_ns), 5e6);
+  std::int64_t first = Clock::now_ns();
+  std::int64_t second = Clock::now_ns();
+  EXPECT_LE(first, second);
+}
+
+TEST(ClockTest, RecalibratesWhileOtherThreadsConvert) {
+  std::atomic<bool> stop{false};
+  std::atomic<bool> went_back{false};
+  std::thread reader([&]() {
+    const std::int64_t system_ns = Clock::wall_ns();
+    while (!stop.load(std::memory_order_relaxed)) {
+      // a half-updated calibration would throw the conversion far off
+      if (Clock::wall_ns() < system_ns - 1000000000LL) {
+        went_back = true;
+      }
+    }
+  });
+  for (int i = 0; i < 5; ++i) {
+    Clock::calibrate(2);
+  }
+  stop = true;
+  reader.join();
+  EXPECT_FALSE(went_back);
+  const std::int64_t before = Clock::now_ns();
+  EXPECT_LE(before, Clock::now_ns());
+}
+
+TEST(CalendarCacheTest, MatchesGmtimeAcrossBoundaries) {
+  CalendarCache cache(true);
+  // walk across an hour and a day boundary: 2024-12-31 22:59:58 UTC onwards
+  for (std::int64_t second = 1735685998; second < 1735693300; second += 7) {
+    cache.update(second);
+    std::time_t t = static_cast<std::time_t>(second);
+    std::tm expected{};
+    gmtime_r(&t, &expected);
+    char date[11], time[9];
+    std::strftime(date, sizeof(date), "%Y-%m-%d", &expected);
+    std::strftime(time, sizeof(time), "%H:%M:%S", &expected);
+    ASSERT_STREQ(cache.date(), date) << second;
+    ASSERT_STREQ(cache.time(), time) << second;
+  }
+  EXPECT_EQ(cache.year(), 2025);
+  EXPECT_STREQ(cache.day(), "Wed Jan 01");
+}
@@ -58,7 +58,7 @@ TEST_F(CoinManagerTest, AddEmptyCoin) {
 
 TEST_F(CoinManagerTest, AddCoinAndConnectDontWaitToConnect) {
   BinanceClient binance_client(*manager);
-  manager->set_binance_client(&binance_client);
+  manager->add_feed(&binance_client);
 
   binance_client.setup_websocket("wss://stream.binance.com:9443/ws/websocket");
 
@@ -70,7 +70,7 @@ TEST_F(CoinManagerTest, AddCoinAndConnectDontWaitToConnect) {
 
 TEST_F(CoinManagerTest, AddCoinAndConnectWaitToConnect) {
   BinanceClient binance_client(*manager);
-  manager->set_binance_client(&binance_client);
+  manager->add_feed(&binance_client);
 
   binance_client.setup_websocket("wss://stream.binance.com:9443/ws/websocket");
 
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "../include/common/CoinManager.h"
+#include "../include/ml/FeaturePipeline.h"
+#include "../include/strategy/StrategyEngine.h"
+
+namespace {
+  void trade(FeaturePipeline& pipeline, Coin& coin, double price, double quantity, long time) {
+    CoinData data{coin.symbol(), price, time, quantity, time};
+    coin.update_trade(data);
+    pipeline.on_trade(coin, data);
+  }
+}
+
+TEST(FeaturePipelineTest, ComputesRowsIncrementally) {
+  FeaturePipeline pipeline(16);
+  Coin btc("btcusdt");
+  Coin eth("ethusdt");
+  EXPECT_EQ(pipeline.add_symbol("btcusdt"), 0u);
+
+  trade(pipeline, btc, 100.0, 1.0, 1000);
+  trade(pipeline, eth, 10.0, 5.0, 1100);
+  pipeline.on_quote(btc, Quote{"btcusdt", 100.9, 3.0, 101.1, 1.0, 1500});
+  trade(pipeline, btc, 101.0, 2.0, 1700);
+  EXPECT_EQ(pipeline.index_of("ethusdt"), 1u);
+  EXPECT_EQ(pipeline.pending(), 3u);
+
+  std::vector<FeatureRow> rows;
+  EXPECT_EQ(pipeline.consume([&](const FeatureRow* begin, std::size_t count) {
+    rows.insert(rows.end(), begin, begin + count);
+  }), 3u);
+  ASSERT_EQ(rows.size(), 3u);
+  EXPECT_EQ(pipeline.pending(), 0u);
+
+  const FeatureRow& first = rows[0];
+  EXPECT_EQ(first.schema_version, FEATURE_SCHEMA_VERSION);
+  EXPECT_EQ(first.symbol, 0u);
+  EXPECT_EQ(first.time_ms, 1000);
+  EXPECT_DOUBLE_EQ(first.values[FEATURE_LOG_RETURN], 0.0);
+  EXPECT_EQ(first.flags & FEATURE_FLAG_QUOTE, 0u);
+  EXPECT_EQ(rows[1].symbol, 1u);
+  EXPECT_DOUBLE_EQ(rows[1].values[FEATURE_TRADE_QUANTITY], 5.0);
+
+  const FeatureRow& last = rows[2];
+  const double r = std::log(101.0 / 100.0);
+  EXPECT_DOUBLE_EQ(last.price, 101.0);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_LOG_RETURN], r);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_TRADE_INTERVAL_MS], 700.0);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_TRADE_QUANTITY], 2.0);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_VOLUME_1M], 3.0);
+  const double ema_fast = 100.0 + 2.0 / 51.0 * 1.0;
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_EMA_FAST_DISTANCE], 101.0 / ema_fast - 1.0);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_VOLATILITY_FAST], std::sqrt(2.0 / 33.0 * r * r));
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_MA_DISTANCE], 101.0 / 100.5 - 1.0);
+  // the first 1 s bar [1000, 2000) has not closed yet
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_RETURN_1S], 0.0);
+  EXPECT_NE(last.flags & FEATURE_FLAG_QUOTE, 0u);
+  EXPECT_EQ(last.flags & FEATURE_FLAG_WARM, 0u);
+  EXPECT_NEAR(last.values[FEATURE_SPREAD_BPS], 0.2 / 101.0 * 1e4, 1e-9);
+  EXPECT_DOUBLE_EQ(last.values[FEATURE_BOOK_IMBALANCE], 0.5);
+
+  trade(pipeline, btc, 102.0, 1.0, 2100);
+  pipeline.consume([&](const FeatureRow* row, std::size_t) {
+    EXPECT_DOUBLE_EQ(row->values[FEATURE_RETURN_1S], std::log(102.0 / 101.0));
+  });
+
+  Bar bar{60000, 100.0, 103.0, 99.0, 102.0, 42.0, 17};
+  pipeline.on_bar_close(btc, 1000, bar);
+  EXPECT_EQ(pipeline.pending(), 0u);
+  pipeline.on_bar_close(btc, 60000, bar);
+  pipeline.consume([&](const FeatureRow* row, std::size_t count) {
+    ASSERT_EQ(count, 1u);
+    EXPECT_NE(row->flags & FEATURE_FLAG_BAR, 0u);
+    EXPECT_EQ(row->time_ms, 120000);
+    EXPECT_DOUBLE_EQ(row->values[FEATURE_TRADE_QUANTITY], 42.0);
+  });
+}
+
+TEST(FeaturePipelineTest, RingWrapsAndDropsWhenFull) {
+  FeaturePipeline pipeline(4);
+  Coin coin("btcusdt");
+  for (int i = 0; i < 6; ++i) {
+    trade(pipeline, coin, 100.0 + i, 1.0, 1000 + i);
+  }
+  EXPECT_EQ(pipeline.produced(), 4u);
+  EXPECT_EQ(pipeline.dropped(), 2u);
+
+  EXPECT_EQ(pipeline.consume([](const FeatureRow*, std::size_t) {}, 3), 3u);
+  trade(pipeline, coin, 200.0, 1.0, 2000);
+  trade(pipeline, coin, 201.0, 1.0, 2001);
+  // rows 3, 4, 5 sit in slots 3, 0, 1: handed over as two runs, in order
+  std::vector<std::size_t> runs;
+  std::vector<double> prices;
+  EXPECT_EQ(pipeline.consume([&](const FeatureRow* rows, std::size_t count) {
+    runs.push_back(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      prices.push_back(rows[i].price);
+    }
+  }), 3u);
+  EXPECT_EQ(runs, (std::vector<std::size_t>{1, 2}));
+  EXPECT_EQ(prices, (std::vector<double>{103.0, 200.0, 201.0}));
+}
+
+TEST(FeaturePipelineTest, QuotesFromTheFeedReachTheRows) {
+  CoinManager manager;
+  StrategyEngine engine;
+  FeaturePipeline pipeline(16);
+  engine.subscribe("btcusdt", EVENT_TRADE | EVENT_QUOTE, pipeline);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt"});
+
+  manager.on_quote(Venue::binance, Quote{"btcusdt", 99.0, 3.0, 101.0, 1.0, 900});
+  // an unknown instrument reaches nobody
+  manager.on_quote(Venue::binance, Quote{"ethusdt", 1.0, 1.0, 2.0, 1.0, 900});
+  CoinData data{"btcusdt", 100.0, 1, 1.0, 1000};
+  manager.on_trade(Venue::binance, data);
+
+  std::vector<FeatureRow> rows;
+  pipeline.consume([&](const FeatureRow* begin, std::size_t count) { rows.insert(rows.end(), begin, begin + count); });
+  ASSERT_EQ(rows.size(), 1u);
+  EXPECT_NE(rows[0].flags & FEATURE_FLAG_QUOTE, 0u);
+  EXPECT_DOUBLE_EQ(rows[0].values[FEATURE_SPREAD_BPS], 200.0);
+  EXPECT_DOUBLE_EQ(rows[0].values[FEATURE_BOOK_IMBALANCE], 0.5);
+  EXPECT_EQ(pipeline.index_of("ethusdt"), UINT32_MAX);
+}
+
+TEST(FeaturePipelineTest, ExportsNumpyRecords) {
+  const std::string path = (std::filesystem::temp_directory_path() / "feature_pipeline_test.npy").string();
+  FeaturePipeline pipeline(8);
+  Coin coin("btcusdt");
+  trade(pipeline, coin, 100.0, 1.0, 1000);
+  trade(pipeline, coin, 101.0, 1.0, 1001);
+  ASSERT_EQ(pipeline.export_npy(path), 2u);
+  EXPECT_EQ(pipeline.pending(), 0u);
+
+  std::ifstream in(path, std::ios::binary);
+  const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  ASSERT_GT(bytes.size(), 10u);
+  EXPECT_EQ(bytes.compare(0, 6, "\x93NUMPY"), 0);
+  const std::size_t header = 10 + static_cast<unsigned char>(bytes[8]) + 256u * static_cast<unsigned char>(bytes[9]);
+  EXPECT_EQ(header % 64, 0u);
+  ASSERT_EQ(bytes.size(), header + 2 * sizeof(FeatureRow));
+  const std::string dict = bytes.substr(10, header - 10);
+  EXPECT_NE(dict.find("('time_ms', '<i8')"), std::string::npos);
+  EXPECT_NE(dict.find("('trade_interval_ms', '<f8')"), std::string::npos);
+  EXPECT_NE(dict.find("'shape': (2,)"), std::string::npos);
+
+  FeatureRow row;
+  std::memcpy(&row, bytes.data() + header + sizeof(FeatureRow), sizeof(FeatureRow));
+  EXPECT_EQ(row.time_ms, 1001);
+  EXPECT_DOUBLE_EQ(row.price, 101.0);
+  std::filesystem::remove(path);
+  std::filesystem::remove(FeaturePipeline::symbols_path(path));
+}
+
+TEST(FeaturePipelineTest, StreamsMoreRowsThanTheRingHoldsWithTheirSymbols) {
+  const std::string path = (std::filesystem::temp_directory_path() / "feature_stream_test.npy").string();
+  FeaturePipeline pipeline(8);
+  Coin btc("btcusdt");
+  Coin eth("ethusdt");
+  ASSERT_TRUE(pipeline.begin_export(path));
+  for (int i = 0; i < 100; ++i) {
+    trade(pipeline, i % 3 ? btc : eth, 100.0 + i, 1.0, 1000 + i);
+    if (i % 4 == 3) {
+      EXPECT_EQ(pipeline.export_pending(), 4u);
+    }
+  }
+  EXPECT_EQ(pipeline.finish_export(), 100u);
+  EXPECT_EQ(pipeline.dropped(), 0u);
+
+  std::ifstream in(path, std::ios::binary);
+  const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  ASSERT_GT(bytes.size(), 10u);
+  const std::size_t header = 10 + static_cast<unsigned char>(bytes[8]) + 256u * static_cast<unsigned char>(bytes[9]);
+  EXPECT_EQ(header % 64, 0u);
+  ASSERT_EQ(bytes.size(), header + 100 * sizeof(FeatureRow));
+  EXPECT_NE(bytes.substr(10, header - 10).find("'shape': (100,)"), std::string::npos);
+
+  // each row's symbol index is a line of the table
+  FeatureRow row;
+  std::memcpy(&row, bytes.data() + header + 99 * sizeof(FeatureRow), sizeof(FeatureRow));
+  EXPECT_EQ(FeaturePipeline::symbols_path(path), path.substr(0, path.size() - 4) + "_symbols.txt");
+  std::ifstream table(FeaturePipeline::symbols_path(path));
+  std::vector<std::string> symbols;
+  for (std::string line; std::getline(table, line);) {
+    symbols.push_back(line);
+  }
+  EXPECT_EQ(symbols, (std::vector<std::string>{"ethusdt", "btcusdt"}));
+  ASSERT_LT(row.symbol, symbols.size());
+  EXPECT_EQ(symbols[row.symbol], "ethusdt"); // the 100th trade, i = 99
+  EXPECT_EQ(pipeline.symbol(row.symbol), "ethusdt");
+  std::filesystem::remove(path);
+  std::filesystem::remove(FeaturePipeline::symbols_path(path));
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "../include/common/MovingAverage.h"
+#include "../include/fpga/FpgaEmulator.h"
+#include "../include/fpga/GoldenModel.h"
+#include "../include/fpga/GoldenVectors.h"
+#include "../include/fpga/OffloadMovingAverageBackend.h"
+#include "../include/history/HistoryWriter.h"
+
+TEST(GoldenModelTest, FixedPointRoundingAndOverflow) {
+  // Q4.2: steps of 0.25 from -8 to 7.75
+  using Truncate = Fixed<4, 2>;
+  using HalfUp = Fixed<4, 2, Rounding::half_up>;
+  using HalfAway = Fixed<4, 2, Rounding::half_away>;
+  using HalfEven = Fixed<4, 2, Rounding::half_even, Overflow::saturate>;
+
+  // -1.375 and 0.625 sit halfway between two steps, 0.6 does not
+  EXPECT_EQ(Truncate::from_double(-1.375).raw(), -6);
+  EXPECT_EQ(HalfUp::from_double(-1.375).raw(), -5);
+  EXPECT_EQ(HalfAway::from_double(-1.375).raw(), -6);
+  EXPECT_EQ(HalfEven::from_double(-1.375).raw(), -6);
+  EXPECT_EQ(Truncate::from_double(0.625).raw(), 2);
+  EXPECT_EQ(HalfUp::from_double(0.625).raw(), 3);
+  EXPECT_EQ(HalfAway::from_double(0.625).raw(), 3);
+  EXPECT_EQ(HalfEven::from_double(0.625).raw(), 2);
+  EXPECT_EQ(HalfEven::from_double(0.6).raw(), 2);
+  // the same rules on results computed in fixed point
+  using Q8_4 = Fixed<8, 4>;
+  EXPECT_EQ(fixed::convert<HalfUp>(Q8_4::from_double(-1.375)).raw(), -5);
+  EXPECT_EQ(fixed::divide<HalfEven>(Q8_4::from_double(2.5), 4).raw(), 2);  // 0.625
+  EXPECT_EQ(fixed::divide<HalfAway>(Q8_4::from_double(-2.5), 4).raw(), -3); // -0.625
+
+  // 7.75 + 0.5 does not fit
+  EXPECT_EQ(fixed::add<Truncate>(Truncate::from_double(7.75), Truncate::from_double(0.5)).raw(), -32 + 1);
+  EXPECT_EQ(fixed::add<HalfEven>(Truncate::from_double(7.75), Truncate::from_double(0.5)).raw(), HalfEven::max_raw);
+  EXPECT_EQ(HalfEven::from_double(-1e30).raw(), HalfEven::min_raw);
+  EXPECT_EQ(fixed::multiply<Truncate>(Truncate::from_double(-1.5), Truncate::from_double(2.25)).raw(), -14);
+  EXPECT_EQ(fixed::multiply<HalfAway>(Truncate::from_double(-1.5), Truncate::from_double(2.25)).raw(), -14);
+  EXPECT_EQ(fixed::multiply<HalfUp>(Truncate::from_double(1.5), Truncate::from_double(2.25)).raw(), 14);
+
+  // register bits in and out
+  EXPECT_EQ(Truncate::from_double(-0.25).bits(), 0x3fu);
+  EXPECT_EQ(Truncate::from_bits(0x3f).raw(), -1);
+  EXPECT_EQ(MaUnitPrice::from_double(-0.25).bits(), 0xffffffffc0000000ull);
+}
+
+TEST(GoldenModelTest, MovingAverageMatchesFloatingPointAndWraps) {
+  GoldenMovingAverage<MaUnitPrice, MaUnitSum, MaUnitAverage> golden(32);
+  MovingAverage reference(32);
+  std::deque<std::int64_t> window;
+  std::int64_t sum = 0;
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> price(60000.0, 70000.0);
+  for (int i = 0; i < 500; ++i) {
+    const double x = price(rng);
+    const MaUnitPrice p = MaUnitPrice::from_double(x);
+    ASSERT_EQ(p.raw(), offload::to_fixed(x)); // what the host sends the unit
+    golden.update(p);
+    reference.update(p.to_double());
+    window.push_back(p.raw());
+    sum += p.raw();
+    if (window.size() > 32) {
+      sum -= window.front();
+      window.pop_front();
+    }
+    ASSERT_EQ(golden.sum().raw(), sum);
+    ASSERT_EQ(golden.count(), window.size());
+    ASSERT_NEAR(golden.value().to_double(), reference.get_value(), 1e-8);
+    ASSERT_EQ(golden.is_ready(), reference.is_ready());
+  }
+
+  // a Q8.4 sum of four 100s (1600 in Q.4) wraps in 12 bits where a saturating one sticks at the top
+  GoldenMovingAverage<Fixed<8, 4>, Fixed<8, 4>, Fixed<8, 4>> wrapping(4);
+  GoldenMovingAverage<Fixed<8, 4>, Fixed<8, 4, Rounding::truncate, Overflow::saturate>, Fixed<8, 4>> saturating(4);
+  for (int i = 0; i < 4; ++i) {
+    wrapping.update(Fixed<8, 4>::from_double(100.0));
+    saturating.update(Fixed<8, 4>::from_double(100.0));
+  }
+  EXPECT_EQ(wrapping.sum().raw(), (4 * 1600 + 2048) % 4096 - 2048);
+  EXPECT_EQ(saturating.sum().raw(), 2047);
+  EXPECT_EQ(saturating.value().raw(), 511);
+  wrapping.reset();
+  EXPECT_EQ(wrapping.count(), 0u);
+  EXPECT_EQ(wrapping.sum().raw(), 0);
+}
+
+TEST(GoldenModelTest, CrossoverFollowsStrategyEngine) {
+  MaUnitModel model(3);
+  std::vector<std::uint8_t> flags;
+  for (double p : {10.0, 10.0, 10.0, 10.0, 13.0, 12.0, 9.0, 9.0, 12.0}) {
+    flags.push_back(model.update(MaUnitPrice::from_double(p)).flags);
+  }
+  // full from the third price; equal to the average sets no side, 13 is the baseline, 9 crosses below
+  // (average 11.33), 12 crosses back above (average 10)
+  const std::vector<std::uint8_t> expected = {0, 0, GOLDEN_READY, GOLDEN_READY, GOLDEN_READY, GOLDEN_READY,
+                                              GOLDEN_READY | GOLDEN_CROSS_BELOW, GOLDEN_READY,
+                                              GOLDEN_READY | GOLDEN_CROSS_ABOVE};
+  EXPECT_EQ(flags, expected);
+  EXPECT_EQ(model.moving_average().value(), MaUnitAverage::from_double(10.0));
+}
+
+TEST(GoldenModelTest, OutOfRangePricesSaturateOnHostAndModel) {
+  // beyond the 2^31 of Q32.32 the host's conversion clamps exactly as the model's price format does
+  for (const double x : {1e12, -1e12, 0x1p31, -0x1p31, 0x1p31 - 0x1p-33, HUGE_VAL, -HUGE_VAL, std::nan(""), -0.5e-9}) {
+    EXPECT_EQ(offload::to_fixed(x), MaUnitPrice::from_double(x).raw()) << x;
+  }
+  EXPECT_EQ(offload::to_fixed(1e12), MaUnitPrice::max_raw);
+  EXPECT_EQ(offload::to_fixed(-1e12), MaUnitPrice::min_raw);
+
+  // a capture with a price the format cannot hold: saturated on the way in, the window sum then wraps, and the
+  // unit still matches the model bit for bit
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "golden_model_range_test";
+  std::filesystem::remove_all(dir);
+  {
+    HistoryWriter writer((dir / "history").string() + "/");
+    const double prices[] = {65000.0, 1e12, 65010.0, 1e12, -1e12, 65020.0, 65030.0, 65040.0, 65050.0, 65060.0};
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(writer.append("btcusdt", TickRecord{1735689600000 + i * 50, i, prices[i], 0.1}));
+    }
+  }
+  const std::string prefix = (dir / "btc").string();
+  std::uint64_t vectors = 0;
+  ASSERT_TRUE(golden::generate_vectors((dir / "history").string() + "/", "btcusdt", 0, INT64_MAX, 4, prefix,
+                                       vectors));
+  EXPECT_EQ(vectors, 10u);
+
+  FpgaEmulator emulator;
+  ASSERT_TRUE(emulator.start());
+  ASSERT_TRUE(golden::run_unit(emulator.device(), OFFLOAD_DEFAULT_BAUD, prefix + "_stimulus.hex", 4,
+                               prefix + "_unit.hex", vectors));
+  GoldenCheck result;
+  std::ostringstream report;
+  ASSERT_TRUE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_unit.hex", 4, result, report));
+  EXPECT_EQ(result.vectors, 10u);
+  EXPECT_EQ(result.mismatches, 0u) << report.str();
+  std::filesystem::remove_all(dir);
+}
+
+TEST(GoldenModelTest, VectorsFromCaptureMatchTheEmulator) {
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "golden_model_test";
+  std::filesystem::remove_all(dir);
+  {
+    HistoryWriter writer((dir / "history").string() + "/");
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> step(0.0, 5.0);
+    double price = 65000.0;
+    for (int i = 0; i < 3000; ++i) {
+      price += step(rng);
+      ASSERT_TRUE(writer.append("btcusdt", TickRecord{1735689600000 + i * 50, i, price, 0.1}));
+    }
+  }
+  const std::string prefix = (dir / "btc").string();
+  std::uint64_t vectors = 0;
+  ASSERT_TRUE(golden::generate_vectors((dir / "history").string() + "/", "btcusdt", 0, INT64_MAX, 64, prefix,
+                                       vectors));
+  EXPECT_EQ(vectors, 3000u);
+
+  GoldenCheck result;
+  std::ostringstream report;
+  ASSERT_TRUE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_expected.hex", 64, result, report));
+  EXPECT_EQ(result.vectors, 3000u);
+  EXPECT_EQ(result.fields, static_cast<std::size_t>(GOLDEN_OUTPUT_FIELDS));
+  EXPECT_EQ(result.mismatches, 0u) << report.str();
+  // checked against the wrong window, the outputs part from the vector that fills it
+  ASSERT_TRUE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_expected.hex", 63, result, report));
+  EXPECT_EQ(result.first_mismatch, 63u);
+
+  FpgaEmulator emulator;
+  ASSERT_TRUE(emulator.start());
+  ASSERT_TRUE(golden::run_unit(emulator.device(), OFFLOAD_DEFAULT_BAUD, prefix + "_stimulus.hex", 64,
+                               prefix + "_unit.hex", vectors));
+  EXPECT_EQ(vectors, 3000u);
+  report.str("");
+  ASSERT_TRUE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_unit.hex", 64, result, report));
+  EXPECT_EQ(result.fields, 2u);
+  EXPECT_EQ(result.mismatches, 0u) << report.str();
+
+  // one wrong digit in the unit's output is found and reported
+  std::vector<std::string> lines;
+  {
+    std::ifstream in(prefix + "_unit.hex");
+    for (std::string line; std::getline(in, line);) {
+      lines.push_back(line);
+    }
+  }
+  lines[1234].back() = lines[1234].back() == '0' ? '1' : '0';
+  {
+    std::ofstream out(prefix + "_unit.hex");
+    for (const std::string& line : lines) {
+      out << line << '\n';
+    }
+  }
+  report.str("");
+  ASSERT_TRUE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_unit.hex", 64, result, report));
+  EXPECT_EQ(result.mismatches, 1u);
+  EXPECT_EQ(result.first_mismatch, 1235u);
+  EXPECT_NE(report.str().find("line 1235"), std::string::npos);
+
+  lines.pop_back();
+  {
+    std::ofstream out(prefix + "_unit.hex");
+    for (const std::string& line : lines) {
+      out << line << '\n';
+    }
+  }
+  EXPECT_FALSE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_unit.hex", 64, result, report));
+
+  // windows whose count would not fit its field are refused, as the unit refuses them
+  EXPECT_FALSE(golden::generate_vectors((dir / "history").string() + "/", "btcusdt", 0, INT64_MAX,
+                                        OFFLOAD_MAX_WINDOW + 1, prefix + "_large", vectors));
+  EXPECT_FALSE(std::filesystem::exists(prefix + "_large_expected.hex"));
+  EXPECT_FALSE(golden::check_vectors(prefix + "_stimulus.hex", prefix + "_expected.hex", OFFLOAD_MAX_WINDOW + 1,
+                                     result, report));
+  std::filesystem::remove_all(dir);
+}
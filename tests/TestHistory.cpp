@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <vector>
+#include "../include/history/HistoryReader.h"
+#include "../include/history/HistoryWriter.h"
+
+class HistoryTest : public ::testing::Test {
+protected:
+  std::filesystem::path test_dir;
+  // 2025-01-01T00:00:00Z
+  const std::int64_t day_start = 1735689600000;
+
+  void SetUp() override {
+    test_dir = std::filesystem::temp_directory_path() / "history_test";
+    std::filesystem::remove_all(test_dir);
+  }
+  void TearDown() override { std::filesystem::remove_all(test_dir); }
+
+  // one trade every 100 ms starting at `start`, ids continuing from `first_id`
+  void write_ticks(HistoryWriter& writer, std::int64_t start, std::int64_t first_id, int count) {
+    for (int i = 0; i < count; ++i) {
+      TickRecord record{start + i * 100, first_id + i, 100.0 + i, 1.0};
+      ASSERT_TRUE(writer.append("btcusdt", record));
+    }
+  }
+
+  std::vector<TickRecord> read_all(HistoryReader& reader, std::size_t chunk = 333) {
+    std::vector<TickRecord> out;
+    std::vector<TickRecord> buffer(chunk);
+    while (std::size_t n = reader.read(buffer.data(), buffer.size())) {
+      out.insert(out.end(), buffer.begin(), buffer.begin() + n);
+    }
+    return out;
+  }
+};
+
+TEST_F(HistoryTest, IndexHasOneEntryPerBlock) {
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start, 1, TICK_INDEX_BLOCK_RECORDS * 3 + 5);
+  }
+  auto index = HistoryReader::load_index(tick_files::index_path(test_dir.string() + "/", "2025-01-01", "btcusdt"));
+  ASSERT_EQ(index.size(), 4u);
+  EXPECT_EQ(index[1].first_trade_id, TICK_INDEX_BLOCK_RECORDS + 1);
+  EXPECT_EQ(index[1].offset, sizeof(TickFileHeader) + TICK_INDEX_BLOCK_RECORDS * sizeof(TickRecord));
+}
+
+TEST_F(HistoryTest, TimeRangeReturnsExactlyMatchingRecords) {
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start, 1, 10000);
+  }
+  HistoryReader reader(test_dir.string(), "btcusdt");
+  ASSERT_TRUE(reader.seek_time(day_start + 250050, day_start + 500000));
+
+  auto records = read_all(reader);
+  ASSERT_EQ(records.size(), 2499u);
+  EXPECT_EQ(records.front().trade_time, day_start + 250100);
+  EXPECT_EQ(records.back().trade_time, day_start + 499900);
+  EXPECT_TRUE(reader.done());
+}
+
+TEST_F(HistoryTest, TimeRangeSpansDays) {
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start + tick_files::MS_PER_DAY - 100000, 1, 2000);
+  }
+  EXPECT_TRUE(std::filesystem::exists(test_dir / "2025-01-01" / "btcusdt.ticks"));
+  EXPECT_TRUE(std::filesystem::exists(test_dir / "2025-01-02" / "btcusdt.ticks"));
+
+  HistoryReader reader(test_dir.string(), "btcusdt");
+  ASSERT_TRUE(reader.seek_time(day_start, day_start + 2 * tick_files::MS_PER_DAY));
+  auto records = read_all(reader);
+  ASSERT_EQ(records.size(), 2000u);
+  for (std::size_t i = 1; i < records.size(); ++i) {
+    EXPECT_EQ(records[i].trade_id, records[i - 1].trade_id + 1);
+  }
+}
+
+TEST_F(HistoryTest, TradeIdRange) {
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start, 500, 5000);
+  }
+  HistoryReader reader(test_dir.string(), "btcusdt");
+  ASSERT_TRUE(reader.seek_trade_id(3000, 3010));
+  auto records = read_all(reader, 4);
+  ASSERT_EQ(records.size(), 10u);
+  EXPECT_EQ(records.front().trade_id, 3000);
+  EXPECT_EQ(records.back().trade_id, 3009);
+}
+
+TEST_F(HistoryTest, WriterResumesExistingDay) {
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start, 1, 1500);
+  }
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start + 150000, 1501, 1500);
+  }
+  HistoryReader reader(test_dir.string(), "btcusdt");
+  ASSERT_TRUE(reader.seek_time(day_start, day_start + tick_files::MS_PER_DAY));
+  auto records = read_all(reader);
+  ASSERT_EQ(records.size(), 3000u);
+  EXPECT_EQ(records.back().trade_id, 3000);
+
+  auto index = HistoryReader::load_index(tick_files::index_path(test_dir.string() + "/", "2025-01-01", "btcusdt"));
+  EXPECT_EQ(index.size(), 3u);
+}
+
+TEST_F(HistoryTest, WriterRebuildsMissingOrTruncatedIndexOnResume) {
+  const std::string index_path = tick_files::index_path(test_dir.string() + "/", "2025-01-01", "btcusdt");
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start, 1, 2500);
+  }
+  // header plus the first entry only
+  std::filesystem::resize_file(index_path, sizeof(TickFileHeader) + sizeof(TickIndexEntry));
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start + 250000, 2501, 100);
+  }
+  std::filesystem::remove(index_path);
+  {
+    HistoryWriter writer(test_dir.string());
+    write_ticks(writer, day_start + 260000, 2601, 1400);
+  }
+
+  auto index = HistoryReader::load_index(index_path);
+  ASSERT_EQ(index.size(), 4u);
+  for (std::size_t block = 0; block < index.size(); ++block) {
+    EXPECT_EQ(index[block].first_trade_id, static_cast<std::int64_t>(block * TICK_INDEX_BLOCK_RECORDS + 1));
+  }
+  HistoryReader reader(test_dir.string(), "btcusdt");
+  ASSERT_TRUE(reader.seek_trade_id(1500, 1510));
+  auto records = read_all(reader);
+  ASSERT_EQ(records.size(), 10u);
+  EXPECT_EQ(records.front().trade_id, 1500);
+}
+
+TEST_F(HistoryTest, EmptyRangeAndMissingSymbol) {
+  HistoryReader reader(test_dir.string(), "ethusdt");
+  EXPECT_FALSE(reader.seek_time(day_start, day_start + 1000));
+  TickRecord buffer[4];
+  EXPECT_EQ(reader.read(buffer, 4), 0u);
+  EXPECT_FALSE(reader.seek_time(day_start + 10, day_start));
+}
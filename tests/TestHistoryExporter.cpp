@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "../include/history/HistoryExporter.h"
+#include "../include/history/HistoryWriter.h"
+
+class HistoryExporterTest : public ::testing::Test {
+protected:
+  std::filesystem::path history_dir;
+  std::filesystem::path output_dir;
+  const std::int64_t day_start = 1735689600000;
+
+  void SetUp() override {
+    history_dir = std::filesystem::temp_directory_path() / "exporter_test_history";
+    output_dir = std::filesystem::temp_directory_path() / "exporter_test_output";
+    std::filesystem::remove_all(history_dir);
+    std::filesystem::remove_all(output_dir);
+
+    HistoryWriter writer(history_dir.string());
+    for (int i = 0; i < 1000; ++i) {
+      writer.append("btcusdt", TickRecord{day_start + i, 10 + i, 97000.25 + i, 0.5});
+      writer.append("ethusdt", TickRecord{day_start + i, 20 + i, 3100.125, 2.0});
+    }
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(history_dir);
+    std::filesystem::remove_all(output_dir);
+  }
+
+  std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+  }
+};
+
+TEST_F(HistoryExporterTest, CsvExportAllSymbols) {
+  HistoryExporter exporter(history_dir.string(), output_dir.string(), 2);
+  ExportStats stats = exporter.export_all(ExportFormat::csv);
+
+  EXPECT_EQ(stats.files, 2u);
+  EXPECT_EQ(stats.records, 2000u);
+  EXPECT_GT(stats.bytes_out, 0u);
+
+  std::string csv = read_file(output_dir / "2025-01-01" / "btcusdt.csv");
+  EXPECT_EQ(csv.rfind("trade_time,trade_id,price,quantity\n1735689600000,10,97000.25,0.5\n", 0), 0u);
+  EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 1001);
+}
+
+TEST_F(HistoryExporterTest, NpyColumnsHaveNumpyHeader) {
+  HistoryExporter exporter(history_dir.string(), output_dir.string(), 1);
+  ExportStats stats = exporter.export_all(ExportFormat::npy);
+  EXPECT_EQ(stats.files, 2u);
+
+  std::string npy = read_file(output_dir / "2025-01-01" / "ethusdt" / "price.npy");
+  ASSERT_GT(npy.size(), 10u);
+  EXPECT_EQ(npy.substr(0, 6), "\x93NUMPY");
+  std::size_t header_length = static_cast<unsigned char>(npy[8]) | (static_cast<unsigned char>(npy[9]) << 8);
+  std::size_t data_offset = 10 + header_length;
+  EXPECT_EQ(data_offset % 64, 0u);
+  EXPECT_NE(npy.find("'shape': (1000,)"), std::string::npos);
+  ASSERT_EQ(npy.size(), data_offset + 1000 * sizeof(double));
+
+  double first;
+  std::memcpy(&first, npy.data() + data_offset, sizeof(first));
+  EXPECT_DOUBLE_EQ(first, 3100.125);
+}
+
+TEST_F(HistoryExporterTest, MissingInputReturnsZero) {
+  EXPECT_EQ(HistoryExporter::export_csv((history_dir / "nope.ticks").string(), (output_dir / "x.csv").string()), 0u);
+}
+
+TEST_F(HistoryExporterTest, NpyExportFailsWithAnyColumn) {
+  const std::filesystem::path ticks = history_dir / "2025-01-01" / "btcusdt.ticks";
+  const std::filesystem::path npy_directory = output_dir / "btcusdt";
+  std::filesystem::create_directories(npy_directory / "price.npy"); // a directory cannot be opened for writing
+  EXPECT_EQ(HistoryExporter::export_npy(ticks.string(), npy_directory.string()), 0u);
+  EXPECT_GT(std::filesystem::file_size(npy_directory / "quantity.npy"), 0u); // the other columns were written
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../include/metrics/LatencyHistogram.h"
+#include "../include/metrics/LatencyTracker.h"
+
+TEST(LatencyHistogramTest, BucketsCoverValueWithinPrecision) {
+  for (std::uint64_t value : {0ull, 1ull, 255ull, 256ull, 1000ull, 123456ull, 987654321ull, 1ull << 40}) {
+    std::size_t index = LatencyHistogram::bucket_index(value);
+    ASSERT_LT(index, LatencyHistogram::BUCKET_COUNT);
+    std::uint64_t upper = LatencyHistogram::bucket_upper(index);
+    EXPECT_GE(upper, value);
+    EXPECT_LE(upper - value, value / 128 + 1) << value;
+  }
+  EXPECT_EQ(LatencyHistogram::bucket_index(LatencyHistogram::MAX_VALUE * 4), LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  auto histogram = std::make_unique<LatencyHistogram>();
+  for (int i = 1; i <= 1000; ++i) {
+    histogram->record(i * 1000);
+  }
+  EXPECT_EQ(histogram->count(), 1000u);
+  EXPECT_EQ(histogram->max(), 1000000u);
+  EXPECT_NEAR(static_cast<double>(histogram->percentile(50.0)), 500000.0, 500000.0 / 100);
+  EXPECT_NEAR(static_cast<double>(histogram->percentile(99.0)), 990000.0, 990000.0 / 100);
+  EXPECT_EQ(histogram->percentile(100.0), 1000000u);
+}
+
+TEST(LatencyHistogramTest, EmptyAndNegative) {
+  auto histogram = std::make_unique<LatencyHistogram>();
+  EXPECT_EQ(histogram->percentile(99.0), 0u);
+  histogram->record(-5);
+  EXPECT_EQ(histogram->count(), 1u);
+  EXPECT_EQ(histogram->max(), 0u);
+}
+
+TEST(LatencyTrackerTest, MergesThreadsAndSamples) {
+  LatencyTracker& tracker = LATENCY_TRACKER;
+  tracker.reset();
+  tracker.set_mode(LatencyMode::full);
+
+  auto worker = [&tracker]() {
+    for (int i = 0; i < 100; ++i) {
+      if (tracker.begin_message()) {
+        tracker.record(MessageStamps{0, 1000, 2000, 2500, 4000});
+      }
+    }
+  };
+  std::thread a(worker);
+  std::thread b(worker);
+  a.join();
+  b.join();
+
+  auto merged = std::make_unique<LatencyHistogram>();
+  tracker.merged(RECEIVE_TO_RENDER, *merged);
+  EXPECT_EQ(merged->count(), 200u);
+  EXPECT_EQ(merged->max(), static_cast<std::uint64_t>(Clock::ticks_to_ns(3000)));
+
+  merged->reset();
+  tracker.merged(EXCHANGE_TO_RECEIVE, *merged);
+  EXPECT_EQ(merged->count(), 0u);
+
+  tracker.set_mode(LatencyMode::sampled, 50);
+  int stamped = 0;
+  for (int i = 0; i < 640; ++i) {
+    stamped += tracker.begin_message();
+  }
+  EXPECT_EQ(stamped, 10);
+
+  tracker.set_mode(LatencyMode::off);
+  EXPECT_FALSE(tracker.begin_message());
+  EXPECT_NE(tracker.report().find("receive->render"), std::string::npos);
+  tracker.set_mode(LatencyMode::sampled);
+}
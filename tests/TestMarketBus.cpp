@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include "../include/bus/MarketBus.h"
+#include "../include/bus/market_bus.h"
+#include "../include/common/CoinManager.h"
+#include "../include/feed/SimulatedFeed.h"
+#include "../include/strategy/StrategyEngine.h"
+
+namespace {
+  std::string bus_name(const std::string& test) {
+    return "market_bus_test_" + test + "_" + std::to_string(getpid());
+  }
+}
+
+TEST(MarketBusTest, PublishesCoinManagerStateAndTrades) {
+  MarketBus bus;
+  ASSERT_TRUE(bus.create(bus_name("state"), 8, 16));
+  CoinManager manager;
+  manager.add_coins({"btcusdt"});
+  manager.set_market_bus(&bus);
+  manager.add_coins({"ethusdt"});
+
+  market_bus* reader = market_bus_open(bus.name().c_str());
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(market_bus_symbol_count(reader), 2u);
+  EXPECT_EQ(market_bus_find(reader, "btcusdt"), 0);
+  EXPECT_EQ(market_bus_find(reader, "ethusdt"), 1);
+  EXPECT_EQ(market_bus_find(reader, "solusdt"), -1);
+  uint64_t cursor = market_bus_head(reader);
+
+  manager.on_quote(Venue::binance, Quote{"ethusdt", 1999.5, 2.0, 2000.5, 3.0, 900});
+  CoinData first{"ethusdt", 2000.0, 7, 0.5, 1000};
+  CoinData second{"ethusdt", 2001.0, 8, 1.5, 1100};
+  manager.update_coin_data(first);
+  manager.update_coin_data(second);
+  EXPECT_EQ(bus.published(), 2u);
+
+  market_bus_slot slot{};
+  ASSERT_EQ(market_bus_read_slot(reader, 1, &slot), 0);
+  EXPECT_STREQ(slot.symbol, "ethusdt");
+  EXPECT_EQ(slot.sequence % 2, 0u);
+  EXPECT_DOUBLE_EQ(slot.price, 2001.0);
+  EXPECT_EQ(slot.trade_id, 8);
+  EXPECT_EQ(slot.trade_time, 1100);
+  EXPECT_EQ(slot.trade_count, 2u);
+  EXPECT_DOUBLE_EQ(slot.volume, 2.0);
+  EXPECT_DOUBLE_EQ(slot.bid, 1999.5);
+  EXPECT_DOUBLE_EQ(slot.ask_quantity, 3.0);
+  EXPECT_EQ(slot.quote_time, 900);
+  EXPECT_EQ(market_bus_read_slot(reader, 2, &slot), -1);
+
+  market_bus_event events[4];
+  uint64_t lost = 1;
+  ASSERT_EQ(market_bus_poll(reader, &cursor, events, 4, &lost), 2u);
+  EXPECT_EQ(lost, 0u);
+  EXPECT_EQ(cursor, 2u);
+  EXPECT_EQ(events[0].symbol, 1u);
+  EXPECT_EQ(events[0].trade_id, 7);
+  EXPECT_DOUBLE_EQ(events[0].quantity, 0.5);
+  EXPECT_DOUBLE_EQ(events[0].ask, 2000.5);
+  EXPECT_DOUBLE_EQ(events[1].price, 2001.0);
+  EXPECT_EQ(market_bus_poll(reader, &cursor, events, 4, nullptr), 0u);
+
+  // the region is laid out as documented, so a zero-copy view agrees with the copies
+  const auto* header = static_cast<const market_bus_header*>(market_bus_data(reader));
+  const auto* slots = reinterpret_cast<const market_bus_slot*>(
+      static_cast<const char*>(market_bus_data(reader)) + header->slots_offset);
+  EXPECT_DOUBLE_EQ(slots[1].price, 2001.0);
+  EXPECT_EQ(market_bus_size(reader), header->total_size);
+  market_bus_close(reader);
+
+  bus.close();
+  EXPECT_EQ(market_bus_open(bus.name().c_str()), nullptr);
+}
+
+namespace {
+  // what the bus had published when the strategy saw each trade
+  struct PublishedCounter {
+    const MarketBus& bus;
+    std::vector<std::uint64_t> seen;
+
+    void on_trade(const Coin&, const CoinData&) { seen.push_back(bus.published()); }
+  };
+}
+
+TEST(MarketBusTest, ReaderGivesUpOnASlotLeftMidUpdate) {
+  MarketBus bus;
+  ASSERT_TRUE(bus.create(bus_name("stuck"), 8, 16));
+  ASSERT_EQ(bus.add_symbol("btcusdt"), 0u);
+  market_bus* reader = market_bus_open(bus.name().c_str());
+  ASSERT_NE(reader, nullptr);
+
+  // a writer that died between the two sequence increments leaves the slot odd for good
+  const int fd = shm_open(("/" + bus.name()).c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  void* region = mmap(nullptr, market_bus_size(reader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(region, MAP_FAILED);
+  const auto* header = static_cast<const market_bus_header*>(region);
+  auto* slot = reinterpret_cast<market_bus_slot*>(static_cast<char*>(region) + header->slots_offset);
+  ++slot->sequence;
+
+  market_bus_slot copy{};
+  EXPECT_EQ(market_bus_read_slot(reader, 0, &copy), -2);
+  ++slot->sequence;
+  EXPECT_EQ(market_bus_read_slot(reader, 0, &copy), 0);
+  EXPECT_STREQ(copy.symbol, "btcusdt");
+
+  munmap(region, market_bus_size(reader));
+  market_bus_close(reader);
+}
+
+TEST(MarketBusTest, PublishesBeforeStrategiesAndWhileCoinsChange) {
+  MarketBus bus;
+  ASSERT_TRUE(bus.create(bus_name("live"), 8, 1024));
+  CoinManager manager;
+  StrategyEngine engine;
+  PublishedCounter counter{bus, {}};
+  engine.subscribe("btcusdt", EVENT_TRADE, counter);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt"});
+  manager.set_market_bus(&bus);
+  CoinData trade{"btcusdt", 100.0, 1, 1.0, 1000};
+  manager.update_coin_data(trade);
+  EXPECT_EQ(counter.seen, std::vector<std::uint64_t>{1});
+
+  // the bus is attached and symbols registered from this thread while a feed publishes from its own
+  SimulatedFeed feed(manager, Venue::binance);
+  manager.add_feed(&feed);
+  feed.connect();
+  manager.add_coins({"ethusdt"});
+  feed.start_random_walk({{"ethusdt", 3000.0}}, 1, 2.0, 5);
+  for (int i = 0; i < 20; ++i) {
+    manager.set_market_bus(nullptr);
+    manager.set_market_bus(&bus);
+    manager.add_coins({"solusdt"});
+    manager.remove_coins({"solusdt"});
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  feed.stop_random_walk();
+
+  market_bus* reader = market_bus_open(bus.name().c_str());
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(market_bus_find(reader, "ethusdt"), 1);
+  EXPECT_EQ(market_bus_find(reader, "solusdt"), 2);
+  market_bus_close(reader);
+  bus.close();
+}
+
+TEST(MarketBusTest, SlowReaderIsToldWhatItLost) {
+  MarketBus bus;
+  ASSERT_TRUE(bus.create(bus_name("lapped"), 4, 8));
+  Coin coin("btcusdt");
+  market_bus* reader = market_bus_open(bus.name().c_str());
+  ASSERT_NE(reader, nullptr);
+
+  uint64_t cursor = 0;
+  for (long i = 0; i < 20; ++i) {
+    CoinData trade{"btcusdt", 100.0 + static_cast<double>(i), i, 1.0, i};
+    coin.update_trade(trade);
+    bus.publish_trade(coin, trade);
+  }
+  market_bus_event events[16];
+  uint64_t lost = 0;
+  ASSERT_EQ(market_bus_poll(reader, &cursor, events, 16, &lost), 8u);
+  EXPECT_EQ(lost, 12u);
+  EXPECT_EQ(cursor, 20u);
+  EXPECT_EQ(events[0].trade_id, 12);
+  EXPECT_EQ(events[7].trade_id, 19);
+  market_bus_close(reader);
+}
+
+TEST(MarketBusTest, ReaderInAnotherProcess) {
+  MarketBus bus;
+  ASSERT_TRUE(bus.create(bus_name("process"), 4, 1 << 10));
+  bus.add_symbol("btcusdt");
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // follows the ring until it has seen every trade, checking each copy against its slot's invariant
+    market_bus* reader = nullptr;
+    while (!reader) {
+      reader = market_bus_open(bus.name().c_str());
+    }
+    uint64_t cursor = 0;
+    uint64_t seen = 0;
+    uint64_t lost = 0;
+    market_bus_event events[64];
+    market_bus_slot slot{};
+    while (seen + lost < 500) {
+      uint64_t dropped = 0;
+      const size_t count = market_bus_poll(reader, &cursor, events, 64, &dropped);
+      lost += dropped;
+      for (size_t i = 0; i < count; ++i) {
+        if (events[i].price != 100.0 + static_cast<double>(events[i].trade_id)) {
+          _exit(2);
+        }
+      }
+      seen += count;
+      if (market_bus_read_slot(reader, 0, &slot) != 0 || slot.volume != static_cast<double>(slot.trade_count)) {
+        _exit(3);
+      }
+    }
+    market_bus_close(reader);
+    _exit(lost == 0 ? 0 : 4);
+  }
+
+  Coin coin("btcusdt");
+  for (long i = 0; i < 500; ++i) {
+    CoinData trade{"btcusdt", 100.0 + static_cast<double>(i), i, 1.0, i};
+    coin.update_trade(trade);
+    bus.publish_trade(coin, trade);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../include/common/Clock.h"
+#include "../include/common/CoinManager.h"
+#include "../include/feed/ConsolidatedBook.h"
+#include "../include/feed/Instrument.h"
+#include "../include/feed/SimulatedFeed.h"
+#include "../include/strategy/StrategyEngine.h"
+
+TEST(InstrumentTest, MapsBetweenNormalizedAndVenueSymbols) {
+  std::string base;
+  std::string quote;
+  ASSERT_TRUE(instruments::split("btcusdt", base, quote));
+  EXPECT_EQ(base, "btc");
+  EXPECT_EQ(quote, "usdt");
+  ASSERT_TRUE(instruments::split("ethbtc", base, quote));
+  EXPECT_EQ(quote, "btc");
+  EXPECT_FALSE(instruments::split("usdt", base, quote));
+
+  EXPECT_EQ(instruments::to_venue(Venue::binance, "btcusdt"), "BTCUSDT");
+  EXPECT_EQ(instruments::to_venue(Venue::coinbase, "ethusd"), "ETH-USD");
+  EXPECT_EQ(instruments::to_venue(Venue::kraken, "btcusd"), "XBT/USD");
+  EXPECT_EQ(instruments::to_venue(Venue::kraken, "foo"), "");
+
+  EXPECT_EQ(instruments::from_venue(Venue::binance, "BTCUSDT"), "btcusdt");
+  EXPECT_EQ(instruments::from_venue(Venue::coinbase, "ETH-USD"), "ethusd");
+  EXPECT_EQ(instruments::from_venue(Venue::kraken, "XBT/USD"), "btcusd");
+  EXPECT_EQ(instruments::from_venue(Venue::kraken, "XDGUSDT"), "dogeusdt");
+}
+
+TEST(ConsolidatedBookTest, MergesBestBidAndOfferAcrossVenues) {
+  ConsolidatedBook book(1000);
+  book.on_quote(Venue::binance, Quote{"btcusdt", 100.0, 1.0, 101.0, 2.0, 0}, 10);
+  book.on_quote(Venue::coinbase, Quote{"btcusdt", 100.5, 0.5, 101.5, 1.0, 0}, 20);
+
+  ConsolidatedQuote best;
+  ASSERT_TRUE(book.best("btcusdt", 30, best));
+  EXPECT_DOUBLE_EQ(best.bid, 100.5);
+  EXPECT_EQ(best.bid_venue, Venue::coinbase);
+  EXPECT_DOUBLE_EQ(best.ask, 101.0);
+  EXPECT_DOUBLE_EQ(best.ask_quantity, 2.0);
+  EXPECT_EQ(best.ask_venue, Venue::binance);
+
+  // the best bid backs off: the other venue takes over
+  book.on_quote(Venue::coinbase, Quote{"btcusdt", 99.0, 0.5, 101.5, 1.0, 0}, 40);
+  book.best("btcusdt", 50, best);
+  EXPECT_DOUBLE_EQ(best.bid, 100.0);
+  EXPECT_EQ(best.bid_venue, Venue::binance);
+
+  // a third venue improves the offer
+  book.on_quote(Venue::kraken, Quote{"btcusdt", 99.5, 3.0, 100.8, 3.0, 0}, 60);
+  book.on_trade(Venue::kraken, "btcusdt", 100.9, 61);
+  book.best("btcusdt", 70, best);
+  EXPECT_DOUBLE_EQ(best.ask, 100.8);
+  EXPECT_EQ(best.ask_venue, Venue::kraken);
+  EXPECT_DOUBLE_EQ(best.last, 100.9);
+  EXPECT_EQ(best.last_venue, Venue::kraken);
+
+  // binance goes quiet: its bid is no longer trusted
+  book.on_quote(Venue::coinbase, Quote{"btcusdt", 99.2, 0.5, 101.5, 1.0, 0}, 1200);
+  book.on_quote(Venue::kraken, Quote{"btcusdt", 99.5, 3.0, 100.8, 3.0, 0}, 1200);
+  book.best("btcusdt", 1300, best);
+  EXPECT_DOUBLE_EQ(best.bid, 99.5);
+  EXPECT_EQ(best.bid_venue, Venue::kraken);
+  EXPECT_FALSE(book.is_fresh(Venue::binance, 1300));
+  EXPECT_TRUE(book.is_fresh(Venue::kraken, 1300));
+  EXPECT_EQ(book.last_seen_ms(Venue::coinbase), 1200);
+
+  VenueQuote venue;
+  ASSERT_TRUE(book.venue_quote("btcusdt", Venue::binance, venue));
+  EXPECT_DOUBLE_EQ(venue.bid, 100.0);
+  EXPECT_FALSE(book.best("ethusdt", 1300, best));
+}
+
+TEST(MarketDataFeedTest, SeveralFeedsDriveOneMarketState) {
+  CoinManager manager;
+  SimulatedFeed binance(manager, Venue::binance);
+  SimulatedFeed coinbase(manager, Venue::coinbase);
+  manager.add_feed(&binance);
+  manager.add_feed(&coinbase);
+  binance.connect();
+  coinbase.connect();
+  manager.add_coins({"btcusdt"});
+  EXPECT_TRUE(binance.is_subscribed("btcusdt"));
+  EXPECT_TRUE(coinbase.is_subscribed("btcusdt"));
+  EXPECT_FALSE(binance.push_trade("ethusdt", 3000.0, 1.0, 1));
+
+  const long now = static_cast<long>(Clock::wall_ms());
+  EXPECT_TRUE(binance.push_trade("btcusdt", 100.0, 1.0, now));
+  EXPECT_TRUE(coinbase.push_trade("btcusdt", 100.2, 1.0, now + 1));
+  EXPECT_DOUBLE_EQ(manager.all_coins()[0]->price(), 100.2);
+
+  binance.push_quote(Quote{"btcusdt", 99.9, 1.0, 100.1, 1.0, now});
+  coinbase.push_quote(Quote{"btcusdt", 100.0, 2.0, 100.3, 1.0, now});
+  ConsolidatedQuote best;
+  ASSERT_TRUE(manager.best_quote("btcusdt", best));
+  EXPECT_DOUBLE_EQ(best.bid, 100.0);
+  EXPECT_EQ(best.bid_venue, Venue::coinbase);
+  EXPECT_DOUBLE_EQ(best.ask, 100.1);
+  EXPECT_EQ(best.ask_venue, Venue::binance);
+  EXPECT_DOUBLE_EQ(best.last, 100.2);
+  EXPECT_TRUE(manager.venue_fresh(Venue::coinbase));
+  EXPECT_FALSE(manager.venue_fresh(Venue::kraken));
+
+  manager.remove_coins({"btcusdt"});
+  EXPECT_FALSE(coinbase.is_subscribed("btcusdt"));
+  EXPECT_FALSE(coinbase.push_trade("btcusdt", 100.0, 1.0, now));
+}
+
+TEST(MarketDataFeedTest, RandomWalkFeedsRunConcurrently) {
+  CoinManager manager;
+  SimulatedFeed first(manager, Venue::binance);
+  SimulatedFeed second(manager, Venue::kraken);
+  manager.add_feed(&first);
+  manager.add_feed(&second);
+  first.connect();
+  second.connect();
+  manager.add_coins({"btcusdt", "ethusdt"});
+
+  first.start_random_walk({{"btcusdt", 60000.0}, {"ethusdt", 3000.0}}, 1, 2.0, 1);
+  second.start_random_walk({{"btcusdt", 60010.0}, {"ethusdt", 3001.0}}, 1, 2.0, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  first.stop_random_walk();
+  second.stop_random_walk();
+
+  ConsolidatedQuote best;
+  ASSERT_TRUE(manager.best_quote("ethusdt", best));
+  EXPECT_GT(best.bid, 0.0);
+  EXPECT_GT(best.ask, 0.0);
+  EXPECT_TRUE(manager.venue_fresh(Venue::binance));
+  EXPECT_TRUE(manager.venue_fresh(Venue::kraken));
+}
+
+namespace {
+  // holds the feed thread inside its dispatch until released
+  struct BlockingStrategy {
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+
+    void on_trade(const Coin&, const CoinData&) {
+      entered = true;
+      while (!release) {
+        std::this_thread::yield();
+      }
+    }
+  };
+}
+
+TEST(MarketDataFeedTest, BookReadersAndCoinChangesDoNotRaceTheDispatch) {
+  CoinManager manager;
+  StrategyEngine engine;
+  BlockingStrategy strategy;
+  engine.subscribe("btcusdt", EVENT_TRADE, strategy);
+  manager.set_strategy_engine(&engine);
+  SimulatedFeed feed(manager, Venue::binance);
+  manager.add_feed(&feed);
+  feed.connect();
+  manager.add_coins({"btcusdt"});
+
+  std::thread trade([&]() { feed.push_trade("btcusdt", 100.0, 1.0, static_cast<long>(Clock::wall_ms())); });
+  while (!strategy.entered) {
+    std::this_thread::yield();
+  }
+  // the book is readable while the strategy holds up the dispatch
+  ConsolidatedQuote best;
+  ASSERT_TRUE(manager.best_quote("btcusdt", best));
+  EXPECT_DOUBLE_EQ(best.last, 100.0);
+  EXPECT_TRUE(manager.venue_fresh(Venue::binance));
+  strategy.release = true;
+  trade.join();
+
+  // coins come and go, and the engine is swapped, while a feed is running
+  feed.start_random_walk({{"btcusdt", 60000.0}, {"ethusdt", 3000.0}}, 1, 2.0, 3);
+  for (int i = 0; i < 20; ++i) {
+    manager.add_coins({"ethusdt"});
+    manager.set_strategy_engine(i % 2 ? &engine : nullptr);
+    manager.remove_coins({"ethusdt"});
+  }
+  manager.add_coins({"ethusdt"});
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  feed.stop_random_walk();
+  EXPECT_TRUE(manager.has_coin("ethusdt"));
+  EXPECT_EQ(manager.all_coin_symbols().size(), 2u);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/metrics/MetricsRegistry.h"
+#include "../include/net/HttpServer.h"
+
+namespace {
+  int connect_local(std::uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  // sends one request and reads exactly one response (headers + Content-Length body)
+  std::string round_trip(int fd, const std::string& request) {
+    ::send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    while (true) {
+      std::size_t header_end = response.find("\r\n\r\n");
+      if (header_end != std::string::npos) {
+        std::size_t length_at = response.find("Content-Length: ");
+        std::size_t length = std::stoul(response.substr(length_at + 16));
+        if (response.size() >= header_end + 4 + length) {
+          return response;
+        }
+      }
+      ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) {
+        return response;
+      }
+      response.append(buffer, static_cast<std::size_t>(n));
+    }
+  }
+}
+
+TEST(MetricsTest, SameNameAndLabelsShareOneMetric) {
+  Counter& first = METRICS.counter("test_events_total", "Events", MetricsRegistry::label("kind", "a"));
+  Counter& second = METRICS.counter("test_events_total", "Events", MetricsRegistry::label("kind", "a"));
+  Counter& other = METRICS.counter("test_events_total", "Events", MetricsRegistry::label("kind", "b"));
+  EXPECT_EQ(&first, &second);
+  EXPECT_NE(&first, &other);
+
+  first.inc();
+  second.inc(2);
+  EXPECT_EQ(first.value(), 3u);
+  EXPECT_EQ(other.value(), 0u);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+  METRICS.counter("test_render_total", "Rendered", MetricsRegistry::label("symbol", "btcusdt")).inc(7);
+  METRICS.gauge("test_render_gauge", "Level").set(2.5);
+  METRICS.add_collector([](std::string& out) { out += "test_collected 1\n"; });
+
+  std::string text = METRICS.render();
+  EXPECT_NE(text.find("# TYPE test_render_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("test_render_total{symbol=\"btcusdt\"} 7\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_render_gauge gauge\n"), std::string::npos);
+  EXPECT_NE(text.find("test_render_gauge 2.5\n"), std::string::npos);
+  EXPECT_NE(text.find("test_collected 1\n"), std::string::npos);
+}
+
+TEST(MetricsTest, CollectorsMayUseTheRegistry) {
+  METRICS.add_collector([](std::string& out) {
+    Counter& scrapes = METRICS.counter("test_collector_scrapes_total", "Scrapes seen by a collector");
+    scrapes.inc();
+    out += "test_collector_scrapes " + std::to_string(scrapes.value()) + "\n";
+  });
+
+  std::string text = METRICS.render();
+  EXPECT_NE(text.find("test_collector_scrapes 1\n"), std::string::npos);
+  EXPECT_NE(METRICS.render().find("test_collector_scrapes_total 1\n"), std::string::npos);
+}
+
+TEST(MetricsTest, LabelValuesAreEscaped) {
+  EXPECT_EQ(MetricsRegistry::label("path", "a\"b\\c"), "path=\"a\\\"b\\\\c\"");
+}
+
+TEST(HttpServerTest, ServesRoutesOverKeepAliveConnection) {
+  HttpServer server;
+  server.route("GET", "/metrics", [](const HttpRequest&) {
+    HttpResponse response;
+    response.body = "up 1\n";
+    return response;
+  });
+  server.route("POST", "/echo", [](const HttpRequest& request) {
+    HttpResponse response;
+    response.body = request.body + "|" + request.query + "|" + request.header("x-tag");
+    return response;
+  });
+  ASSERT_TRUE(server.start());
+  ASSERT_NE(server.port(), 0);
+
+  int fd = connect_local(server.port());
+  ASSERT_GE(fd, 0);
+  std::string first = round_trip(fd, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  EXPECT_EQ(first.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+  EXPECT_NE(first.find("Connection: keep-alive"), std::string::npos);
+  EXPECT_EQ(first.substr(first.size() - 5), "up 1\n");
+
+  // second request on the same socket, body split across two sends
+  ::send(fd, "POST /echo?a=1 HTTP/1.1\r\nX-Tag: t\r\nContent-Length: 5\r\n\r\nhe", 58, 0);
+  std::string second = round_trip(fd, "llo");
+  EXPECT_EQ(second.substr(second.find("\r\n\r\n") + 4), "hello|a=1|t");
+
+  std::string missing = round_trip(fd, "GET /nope HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(missing.rfind("HTTP/1.1 404", 0), 0u);
+  ::close(fd);
+  server.stop();
+}
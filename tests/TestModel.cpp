@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include "../include/ml/Model.h"
+#include "../include/ml/ModelScorer.h"
+
+namespace {
+  bool load(Model& model, const std::string& text) {
+    std::istringstream in(text);
+    return model.load(in);
+  }
+
+  FeatureRow row_with(double spread_bps, double imbalance, double log_return) {
+    FeatureRow row{};
+    row.values[FEATURE_SPREAD_BPS] = spread_bps;
+    row.values[FEATURE_BOOK_IMBALANCE] = imbalance;
+    row.values[FEATURE_LOG_RETURN] = log_return;
+    return row;
+  }
+
+  // two trees over (book_imbalance, spread_bps); node numbers deliberately not breadth-first
+  const char* const TREES =
+    "features book_imbalance spread_bps\n"
+    "intercept 0.5\n"
+    "tree 5\n"
+    "split 0 0.0 3 1   # imbalance <= 0 goes to node 3\n"
+    "split 1 2.0 2 4\n"
+    "leaf 1.0\n"
+    "leaf -1.0\n"
+    "leaf 3.0\n"
+    "tree 1\n"
+    "leaf 0.25\n";
+}
+
+TEST(ModelTest, LinearAndLogistic) {
+  Model model;
+  ASSERT_TRUE(load(model, "# exported by train.py\n"
+                          "model linear\n"
+                          "features spread_bps book_imbalance log_return\n"
+                          "intercept 0.1\n"
+                          "weights 0.5 -2.0 100.0\n"));
+  EXPECT_EQ(model.kind(), ModelKind::linear);
+  EXPECT_EQ(model.feature_count(), 3u);
+  FeatureRow row = row_with(3.0, 0.25, 0.001);
+  row.values[FEATURE_VOLUME_1M] = 1e6; // not a model feature
+  const double score = 0.1 + 0.5 * 3.0 - 2.0 * 0.25 + 100.0 * 0.001;
+  EXPECT_NEAR(model.predict(row), score, 1e-12);
+
+  ASSERT_TRUE(load(model, "model linear\nlink logistic\nfeatures spread_bps book_imbalance log_return\n"
+                          "intercept 0.1\nweights 0.5 -2.0 100.0\n"));
+  EXPECT_EQ(model.link(), ModelLink::logistic);
+  EXPECT_NEAR(model.predict(row), 1.0 / (1.0 + std::exp(-score)), 1e-12);
+
+  FeatureRow rows[3] = {row, row_with(0.0, 0.0, 0.0), row_with(-1.0, 1.0, -0.01)};
+  double out[3];
+  model.predict_batch(rows, 3, out);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_DOUBLE_EQ(out[i], model.predict(rows[i]));
+  }
+}
+
+TEST(ModelTest, ForestsAndBoostedTrees) {
+  Model forest;
+  ASSERT_TRUE(load(forest, std::string("model forest\n") + TREES));
+  EXPECT_EQ(forest.tree_count(), 2u);
+  EXPECT_EQ(forest.node_count(), 6u);
+  // first tree: imbalance <= 0 -> -1; otherwise spread <= 2 -> 1, else 3; the second always 0.25
+  EXPECT_DOUBLE_EQ(forest.predict(row_with(5.0, -0.5, 0.0)), 0.5 + (-1.0 + 0.25) / 2.0);
+  EXPECT_DOUBLE_EQ(forest.predict(row_with(2.0, 0.5, 0.0)), 0.5 + (1.0 + 0.25) / 2.0);
+  EXPECT_DOUBLE_EQ(forest.predict(row_with(2.5, 0.5, 0.0)), 0.5 + (3.0 + 0.25) / 2.0);
+  EXPECT_DOUBLE_EQ(forest.predict(row_with(2.5, 0.0, 0.0)), 0.5 + (-1.0 + 0.25) / 2.0);
+
+  Model boosted;
+  ASSERT_TRUE(load(boosted, std::string("model boosted\nlink logistic\n") + TREES));
+  EXPECT_DOUBLE_EQ(boosted.predict(row_with(2.5, 0.5, 0.0)), 1.0 / (1.0 + std::exp(-(0.5 + 3.0 + 0.25))));
+
+  // more rows than lanes, so the batch runs in blocks with a partial one at the end
+  std::vector<FeatureRow> rows;
+  for (int i = 0; i < MODEL_BATCH_LANES * 2 + 3; ++i) {
+    rows.push_back(row_with(i % 5, (i % 3) - 1.0, 0.0));
+  }
+  std::vector<double> out(rows.size());
+  boosted.predict_batch(rows.data(), rows.size(), out.data());
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    EXPECT_DOUBLE_EQ(out[i], boosted.predict(rows[i])) << i;
+  }
+}
+
+TEST(ModelTest, RejectsMalformedModels) {
+  Model model;
+  EXPECT_FALSE(load(model, "model linear\nfeatures spread_bps\n"));
+  EXPECT_FALSE(load(model, "model linear\nfeatures spread_bps nope\nweights 1 2\n"));
+  EXPECT_FALSE(load(model, "model linear\nfeatures spread_bps\nweights 1 2\n"));
+  EXPECT_FALSE(load(model, "model svm\n"));
+  EXPECT_FALSE(load(model, "model forest\nfeatures spread_bps\ntree 3\nsplit 0 1.0 1 1\nleaf 1\nleaf 2\n"));
+  EXPECT_FALSE(load(model, "model forest\nfeatures spread_bps\ntree 3\nsplit 1 1.0 1 2\nleaf 1\nleaf 2\n"));
+  EXPECT_FALSE(load(model, "model forest\nfeatures spread_bps\ntree 3\nsplit 0 1.0 1 2\nleaf 1\n"));
+  EXPECT_EQ(model.tree_count(), 0u);
+  EXPECT_TRUE(load(model, "model forest\nfeatures spread_bps\ntree 3\nsplit 0 1.0 1 2\nleaf 1\nleaf 2\n"));
+}
+
+TEST(ModelTest, ScorerDrainsThePipeline) {
+  Model model;
+  ASSERT_TRUE(load(model, "model linear\nfeatures trade_quantity\nweights 2.0\n"));
+  FeaturePipeline pipeline(16);
+  ModelScorer scorer(pipeline, model);
+  std::vector<double> seen;
+  scorer.set_prediction_handler([&](const FeatureRow& row, double prediction) {
+    EXPECT_DOUBLE_EQ(prediction, 2.0 * row.values[FEATURE_TRADE_QUANTITY]);
+    seen.push_back(prediction);
+  });
+
+  Coin btc("btcusdt");
+  Coin eth("ethusdt");
+  CoinData first{"btcusdt", 100.0, 1, 1.5, 1000};
+  CoinData second{"ethusdt", 10.0, 2, 4.0, 1001};
+  btc.update_trade(first);
+  pipeline.on_trade(btc, first);
+  eth.update_trade(second);
+  pipeline.on_trade(eth, second);
+  EXPECT_TRUE(std::isnan(scorer.prediction(0)));
+
+  scorer.on_trade(eth, second);
+  EXPECT_EQ(pipeline.pending(), 0u);
+  EXPECT_EQ(scorer.scored(), 2u);
+  EXPECT_EQ(seen, (std::vector<double>{3.0, 8.0}));
+  EXPECT_DOUBLE_EQ(scorer.prediction(pipeline.index_of("ethusdt")), 8.0);
+  EXPECT_EQ(scorer.latency().count(), 2u);
+  EXPECT_EQ(scorer.score(), 0u);
+}
+
+TEST(ModelTest, ScorerKeepsPredictionsForItsSymbolCapacity) {
+  Model model;
+  ASSERT_TRUE(load(model, "model linear\nfeatures trade_quantity\nweights 1.0\n"));
+  FeaturePipeline pipeline(16);
+  ModelScorer scorer(pipeline, model, 1);
+
+  Coin btc("btcusdt");
+  Coin eth("ethusdt");
+  CoinData first{"btcusdt", 100.0, 1, 1.5, 1000};
+  CoinData second{"ethusdt", 10.0, 2, 4.0, 1001};
+  btc.update_trade(first);
+  pipeline.on_trade(btc, first);
+  eth.update_trade(second);
+  pipeline.on_trade(eth, second);
+
+  EXPECT_EQ(scorer.score(), 2u);
+  EXPECT_EQ(scorer.scored(), 2u);
+  EXPECT_DOUBLE_EQ(scorer.prediction(pipeline.index_of("btcusdt")), 1.5);
+  EXPECT_TRUE(std::isnan(scorer.prediction(pipeline.index_of("ethusdt"))));
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include "../include/common/CoinManager.h"
+#include "../include/common/MovingAverage.h"
+#include "../include/common/MovingAverageBackend.h"
+#include "../include/fpga/FpgaEmulator.h"
+#include "../include/feed/SimulatedFeed.h"
+#include "../include/fpga/OffloadMovingAverageBackend.h"
+
+TEST(MovingAverageBackendTest, NativeMatchesPlainMean) {
+  NativeMovingAverageBackend backend;
+  MovingAverage shared(16, &backend); // on a backend it does not own, so shadowing its window
+  MovingAverage own(16);
+  const std::uint32_t other = backend.add_channel(4);
+  std::deque<double> window;
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> price(90.0, 110.0);
+  for (int i = 0; i < 100; ++i) {
+    const double p = price(rng);
+    shared.update(p);
+    own.update(p);
+    backend.update(other, 1.0);
+    window.push_back(p);
+    if (window.size() > 16) {
+      window.pop_front();
+    }
+    double sum = 0.0;
+    for (double w : window) {
+      sum += w;
+    }
+    EXPECT_NEAR(own.get_value(), sum / static_cast<double>(window.size()), 1e-9);
+    EXPECT_NEAR(shared.get_value(), own.get_value(), 1e-9);
+    EXPECT_EQ(own.is_ready(), window.size() == 16);
+    EXPECT_EQ(shared.is_ready(), own.is_ready());
+  }
+  const std::vector<double> expected(window.begin(), window.end());
+  EXPECT_EQ(own.window(), expected);
+  EXPECT_EQ(shared.window(), expected);
+  EXPECT_DOUBLE_EQ(backend.value(other), 1.0);
+  EXPECT_EQ(backend.add_channel(0), UINT32_MAX);
+
+  for (MovingAverage* average : {&shared, &own}) {
+    average->restore({1.0, 2.0, 3.0});
+    EXPECT_DOUBLE_EQ(average->get_value(), 2.0);
+    EXPECT_FALSE(average->is_ready());
+    EXPECT_EQ(average->window(), (std::vector<double>{1.0, 2.0, 3.0}));
+  }
+}
+
+TEST(MovingAverageBackendTest, FramesSurviveNoiseAndCorruption) {
+  std::vector<std::uint8_t> stream = {0x00, 0x13, OFFLOAD_START_OF_FRAME}; // noise, and a start byte going nowhere
+  const std::uint8_t payload[] = {1, 2, 3, 4, 5};
+  offload::append_frame(stream, OFFLOAD_ACK, payload, 2);
+  const std::size_t corrupt = stream.size();
+  offload::append_frame(stream, OFFLOAD_UPDATES, payload, 5);
+  stream[corrupt + 5] ^= 0x40;
+  offload::append_frame(stream, OFFLOAD_RESULTS, payload, 5);
+
+  offload::FrameDecoder decoder;
+  OffloadFrame frame;
+  // byte by byte, as a serial port might deliver them
+  std::vector<OffloadFrame> frames;
+  for (std::uint8_t byte : stream) {
+    decoder.feed(&byte, 1);
+    while (decoder.next(frame)) {
+      frames.push_back(frame);
+    }
+  }
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0].type, OFFLOAD_ACK);
+  EXPECT_EQ(frames[0].payload, (std::vector<std::uint8_t>{1, 2}));
+  EXPECT_EQ(frames[1].type, OFFLOAD_RESULTS);
+  EXPECT_EQ(frames[1].payload.size(), 5u);
+  EXPECT_EQ(decoder.crc_errors(), 1u);
+
+  EXPECT_EQ(offload::crc16(reinterpret_cast<const std::uint8_t*>("123456789"), 9), 0x29B1);
+  EXPECT_DOUBLE_EQ(offload::from_fixed(offload::to_fixed(64123.4567)), std::ldexp(std::round(std::ldexp(
+      64123.4567, OFFLOAD_PRICE_FRACTION_BITS)), -OFFLOAD_PRICE_FRACTION_BITS));
+}
+
+TEST(MovingAverageBackendTest, OffloadThroughEmulatorMatchesMovingAverage) {
+  FpgaEmulator emulator;
+  ASSERT_TRUE(emulator.start());
+  for (std::size_t batch : {1u, 7u, 64u}) {
+    OffloadMovingAverageBackend offload(batch);
+    ASSERT_TRUE(offload.open(emulator.device()));
+    const std::uint32_t channels[] = {offload.add_channel(8), offload.add_channel(32)};
+    ASSERT_EQ(channels[0], 0u);
+    ASSERT_EQ(channels[1], 1u);
+    MovingAverage reference[] = {MovingAverage(8), MovingAverage(32)};
+
+    std::mt19937_64 rng(batch);
+    std::uniform_real_distribution<double> price(60000.0, 70000.0);
+    for (int i = 0; i < 500; ++i) {
+      const std::uint32_t channel = i % 3 == 0 ? 1 : 0;
+      const double p = price(rng);
+      offload.update(channel, p);
+      reference[channel].update(p);
+      if (batch == 1) {
+        EXPECT_NEAR(offload.value(channel), reference[channel].get_value(), 1e-6);
+      }
+    }
+    ASSERT_TRUE(offload.flush());
+    for (std::uint32_t channel : channels) {
+      EXPECT_NEAR(offload.value(channel), reference[channel].get_value(), 1e-6);
+      EXPECT_EQ(offload.count(channel), reference[channel].window().size());
+    }
+    EXPECT_EQ(offload.updates(), 500u);
+    EXPECT_EQ(offload.batches(), (500 + batch - 1) / batch);
+    EXPECT_EQ(offload.round_trip().count(), offload.batches());
+
+    offload.reset(0);
+    EXPECT_EQ(offload.count(0), 0u);
+    offload.update(0, 5.0);
+    ASSERT_TRUE(offload.flush());
+    EXPECT_DOUBLE_EQ(offload.value(0), 5.0);
+    EXPECT_FALSE(offload.failed());
+  }
+
+  // a coin's moving average on the emulated unit
+  OffloadMovingAverageBackend offload(4);
+  ASSERT_TRUE(offload.open(emulator.device()));
+  MovingAverage average(3, &offload);
+  for (double p : {1.0, 2.0, 3.0, 4.0}) {
+    average.update(p);
+  }
+  EXPECT_TRUE(average.is_ready());
+  EXPECT_DOUBLE_EQ(average.get_value(), 3.0);
+  EXPECT_EQ(average.window(), (std::vector<double>{2.0, 3.0, 4.0}));
+  average.restore({1.0, 2.0});
+  EXPECT_DOUBLE_EQ(average.get_value(), 1.5);
+  EXPECT_FALSE(average.is_ready());
+  EXPECT_EQ(offload.add_channel(OFFLOAD_MAX_WINDOW + 1), UINT32_MAX);
+}
+
+TEST(MovingAverageBackendTest, OffloadFailsWhenTheUnitIsSilent) {
+  FpgaEmulator emulator;
+  ASSERT_TRUE(emulator.start());
+  OffloadMovingAverageBackend offload(1, 50);
+  ASSERT_TRUE(offload.open(emulator.device()));
+  ASSERT_EQ(offload.add_channel(4), 0u);
+  MovingAverage running(3, &offload);
+  for (double p : {1.0, 2.0, 3.0}) {
+    running.update(p);
+  }
+  ASSERT_DOUBLE_EQ(running.get_value(), 2.0);
+  emulator.stop(); // the pty goes away with it
+
+  offload.update(0, 1.0);
+  EXPECT_TRUE(offload.failed());
+  EXPECT_FALSE(offload.flush());
+  MovingAverage average(4, &offload);
+  average.update(2.0);
+  EXPECT_DOUBLE_EQ(average.get_value(), 2.0); // fell back to computing in process
+
+  // an average that was on the unit carries on in process from its own window instead of freezing
+  running.update(7.0);
+  EXPECT_TRUE(running.is_ready());
+  EXPECT_DOUBLE_EQ(running.get_value(), 4.0);
+  running.update(8.0);
+  EXPECT_DOUBLE_EQ(running.get_value(), 6.0);
+}
+
+TEST(MovingAverageBackendTest, OffloadFailsOnPricesItsWindowSumCannotHold) {
+  EXPECT_DOUBLE_EQ(offload::max_price(OFFLOAD_MAX_WINDOW), 524288.0);
+  FpgaEmulator emulator;
+  ASSERT_TRUE(emulator.start());
+  OffloadMovingAverageBackend offload(1);
+  ASSERT_TRUE(offload.open(emulator.device()));
+  ASSERT_EQ(offload.add_channel(OFFLOAD_MAX_WINDOW), 0u);
+  offload.update(0, 524287.0);
+  ASSERT_TRUE(offload.flush());
+  EXPECT_DOUBLE_EQ(offload.value(0), 524287.0);
+
+  offload.update(0, -600000.0);
+  EXPECT_TRUE(offload.failed());
+  EXPECT_EQ(offload.updates(), 1u);
+  EXPECT_DOUBLE_EQ(offload.value(0), 524287.0);
+}
+
+TEST(MovingAverageBackendTest, CoinsGetChannelsWhileTheFeedRuns) {
+  NativeMovingAverageBackend backend;
+  CoinManager manager;
+  manager.set_moving_average_backend(&backend);
+  SimulatedFeed feed(manager, Venue::binance);
+  manager.add_feed(&feed);
+  feed.connect();
+  manager.add_coins({"btcusdt"});
+  feed.start_random_walk({{"btcusdt", 60000.0}}, 1, 2.0, 9);
+  // each coin takes a channel, and with it a resize of the backend's price array, between two updates
+  for (int i = 0; i < 20; ++i) {
+    manager.add_coins({"coin" + std::to_string(i) + "usdt"});
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  feed.stop_random_walk();
+  EXPECT_EQ(manager.all_coins().size(), 21u);
+  EXPECT_GT(backend.count(0), 0u);
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "../include/common/Clock.h"
+#include "../include/exchange/OrderGateway.h"
+#include "../include/exchange/PaperExchange.h"
+#include "../include/net/HmacSha256.h"
+#include "../include/net/HttpServer.h"
+#include "../include/net/RateLimiter.h"
+
+TEST(HmacSha256Test, MatchesReferenceVectors) {
+  // RFC 4231 test cases 2 and 6 (key longer than a block)
+  HmacSha256 jefe("Jefe");
+  EXPECT_EQ(jefe.sign("what do ya want for nothing?"),
+            "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+  HmacSha256 long_key(std::string(131, '\xaa'));
+  EXPECT_EQ(long_key.sign("Test Using Larger Than Block-Size Key - Hash Key First"),
+            "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+
+  // the SIGNED endpoint example from the Binance API documentation, whole and split at a template prefix
+  HmacSha256 binance("NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j");
+  const std::string query = "symbol=LTCBTC&side=BUY&type=LIMIT&timeInForce=GTC&quantity=1&price=0.1&recvWindow=5000"
+                            "&timestamp=1499827319559";
+  const std::string expected = "c8db56825ae71d6d79447849e617115f4a920fa2acdcab2b053c4b2838bd6b71";
+  EXPECT_EQ(binance.sign(query), expected);
+  HmacSha256 prefixed = binance.with_prefix(query.data(), 51);
+  EXPECT_EQ(prefixed.sign(query.substr(51)), expected);
+  EXPECT_EQ(prefixed.sign(query.substr(51)), expected); // reusable
+}
+
+TEST(RateLimiterTest, AdmitsAllOrNothingPerWindow) {
+  RateLimiter limiter;
+  limiter.add_limit(RateLimitKind::request_weight, 60000, 10);
+  limiter.add_limit(RateLimitKind::orders, 10000, 2);
+  const std::int64_t t = 1700000040000; // on a minute boundary
+
+  EXPECT_TRUE(limiter.try_acquire(1, 1, t));
+  EXPECT_TRUE(limiter.try_acquire(1, 1, t + 1));
+  EXPECT_FALSE(limiter.try_acquire(1, 1, t + 2)); // order window full, weight not taken either
+  EXPECT_EQ(limiter.remaining(RateLimitKind::request_weight, t + 2), 8u);
+  EXPECT_TRUE(limiter.try_acquire(1, 1, t + 10000)); // next 10 s window
+  EXPECT_FALSE(limiter.try_acquire(8, 0, t + 10001));
+  EXPECT_TRUE(limiter.try_acquire(7, 0, t + 10001));
+  EXPECT_TRUE(limiter.try_acquire(8, 0, t + 60000)); // next minute
+
+  limiter.sync(RateLimitKind::request_weight, 60000, 10, t + 60001);
+  EXPECT_EQ(limiter.remaining(RateLimitKind::request_weight, t + 60001), 0u);
+  EXPECT_EQ(RateLimiter::parse_interval("1M"), 60000);
+  EXPECT_EQ(RateLimiter::parse_interval("10S"), 10000);
+  EXPECT_EQ(RateLimiter::parse_interval("1D"), 86400000);
+}
+
+class OrderGatewayTest : public ::testing::Test {
+protected:
+  const std::string secret = "gateway-test-secret";
+  HttpServer server;
+  std::atomic<int> orders{0};
+  std::atomic<int> bad_signatures{0};
+  std::string last_body;
+
+  void SetUp() override {
+    // stand-in that checks what Binance would check, and reports a daily weight close to its limit
+    server.route("POST", "/api/v3/order", [this](const HttpRequest& request) {
+      HmacSha256 signer(secret);
+      const std::size_t at = request.body.find("&signature=");
+      if (request.header("X-MBX-APIKEY") != "key" || at == std::string::npos ||
+          signer.sign(request.body.substr(0, at)) != request.body.substr(at + 11)) {
+        ++bad_signatures;
+      }
+      ++orders;
+      last_body = request.body;
+      HttpResponse response;
+      response.content_type = "application/json";
+      response.headers.emplace_back("X-MBX-USED-WEIGHT-1D", "97");
+      response.body = "{\"orderId\":" + std::to_string(orders.load()) + "}";
+      return response;
+    });
+    server.route("GET", "/api/v3/time", [](const HttpRequest&) {
+      HttpResponse response;
+      response.body = "{\"serverTime\":" + std::to_string(Clock::wall_ms() + 250) + "}";
+      return response;
+    });
+    server.route("GET", "/api/v3/busy", [](const HttpRequest&) {
+      HttpResponse response;
+      response.status = 429;
+      response.headers.emplace_back("Retry-After", "60");
+      return response;
+    });
+    ASSERT_TRUE(server.start());
+  }
+
+  GatewayConfig config() const {
+    GatewayConfig gateway;
+    gateway.host = "127.0.0.1";
+    gateway.port = server.port();
+    gateway.tls = false;
+    gateway.api_key = "key";
+    gateway.secret_key = secret;
+    gateway.keepalive_ms = 0;
+    gateway.binance_limits = false;
+    return gateway;
+  }
+};
+
+TEST_F(OrderGatewayTest, SendsSignedTemplatedOrdersOnWarmConnections) {
+  OrderGateway gateway(config());
+  ASSERT_TRUE(gateway.start());
+  EXPECT_EQ(gateway.connects(), 2u);
+
+  const std::size_t buy = gateway.prepare_order("btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 2, 5);
+  const std::size_t sell = gateway.prepare_order("btcusdt", OrderSide::sell, OrderType::market, TimeInForce::ioc, 2, 5);
+  for (int i = 0; i < 20; ++i) {
+    GatewayResponse response = gateway.place_order(i % 2 ? sell : buy, 50000.5 + i, 0.001 * (i + 1), Clock::ticks());
+    ASSERT_EQ(response.status, 200) << response.error;
+  }
+  EXPECT_EQ(orders.load(), 20);
+  EXPECT_EQ(bad_signatures.load(), 0);
+  EXPECT_EQ(last_body.rfind("symbol=BTCUSDT&side=SELL&type=MARKET&recvWindow=5000&quantity=0.02000&timestamp=", 0),
+            0u);
+  EXPECT_EQ(gateway.connects(), 2u); // every order reused a pooled connection
+  EXPECT_EQ(gateway.tick_to_order_sent().count(), 20u);
+  EXPECT_EQ(gateway.round_trip().count(), 20u);
+
+  EXPECT_TRUE(gateway.sync_time());
+  gateway.stop();
+}
+
+TEST_F(OrderGatewayTest, RejectsOrdersThatDoNotFitTheRequest) {
+  OrderGateway gateway(config());
+  ASSERT_TRUE(gateway.start());
+  const std::size_t buy = gateway.prepare_order("btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 2, 5);
+
+  // 1e300 in fixed format is 301 digits, more than the parameter buffer holds
+  GatewayResponse response = gateway.place_order(buy, 50000.0, 1e300);
+  EXPECT_EQ(response.status, 0);
+  EXPECT_EQ(response.error, "order quantity or price too long");
+  response = gateway.place_order(buy, 1e300, 0.001);
+  EXPECT_EQ(response.error, "order quantity or price too long");
+  EXPECT_EQ(orders.load(), 0);
+
+  response = gateway.place_order(buy, 50000.0, 0.001);
+  EXPECT_EQ(response.status, 200) << response.error;
+  EXPECT_EQ(bad_signatures.load(), 0);
+  gateway.stop();
+}
+
+TEST_F(OrderGatewayTest, SubmittedOrdersGoOutOnTheSenderThread) {
+  OrderGateway gateway(config());
+  EXPECT_EQ(gateway.submit_order(0, 0.0, 0.001), SubmitResult::stopped); // not started
+  ASSERT_TRUE(gateway.start());
+  const std::size_t buy = gateway.prepare_order("btcusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 2, 5);
+
+  std::mutex mutex;
+  std::condition_variable done;
+  int answered = 0;
+  bool other_thread = true;
+  const std::thread::id caller = std::this_thread::get_id();
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(gateway.submit_order(buy, 0.0, 0.001, Clock::ticks(), [&](const GatewayResponse& response) {
+      std::lock_guard<std::mutex> lock(mutex);
+      EXPECT_EQ(response.status, 200) << response.error;
+      other_thread &= std::this_thread::get_id() != caller;
+      ++answered;
+      done.notify_one();
+    }), SubmitResult::queued);
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(done.wait_for(lock, std::chrono::seconds(5), [&] { return answered == 5; }));
+  }
+  EXPECT_TRUE(other_thread);
+  EXPECT_EQ(orders.load(), 5);
+  gateway.stop();
+  EXPECT_EQ(gateway.tick_to_order_sent().count(), 5u);
+  EXPECT_EQ(gateway.submit_order(buy, 0.0, 0.001), SubmitResult::stopped);
+}
+
+TEST_F(OrderGatewayTest, StopsAtReportedWeightAndRetryAfter) {
+  OrderGateway gateway(config());
+  gateway.limiter().add_limit(RateLimitKind::request_weight, 86400000, 100);
+  ASSERT_TRUE(gateway.start());
+  const std::size_t order = gateway.prepare_order("ethusdt", OrderSide::buy, OrderType::limit, TimeInForce::ioc, 2, 4);
+
+  // the first response says 97 of 100 are used: room for three more weight-1 orders
+  int sent = 0;
+  for (int i = 0; i < 6; ++i) {
+    GatewayResponse response = gateway.place_order(order, 3000.0, 0.1);
+    sent += response.status == 200;
+    if (i >= 4) {
+      EXPECT_EQ(response.error, "rate limited");
+    }
+  }
+  EXPECT_EQ(sent, 4);
+  EXPECT_EQ(orders.load(), 4);
+
+  OrderGateway polite(config());
+  ASSERT_TRUE(polite.start());
+  EXPECT_EQ(polite.request("GET", "/api/v3/busy").status, 429);
+  GatewayResponse blocked = polite.request("GET", "/api/v3/time");
+  EXPECT_EQ(blocked.status, 0);
+  EXPECT_EQ(blocked.error, "blocked until Retry-After");
+}
+
+TEST(OrderGatewayStepTest, DecimalsFollowTheFilter) {
+  EXPECT_EQ(OrderGateway::step_decimals(0.01), 2);
+  EXPECT_EQ(OrderGateway::step_decimals(0.00001), 5);
+  EXPECT_EQ(OrderGateway::step_decimals(0.001), 3);
+  EXPECT_EQ(OrderGateway::step_decimals(0.5), 1);
+  EXPECT_EQ(OrderGateway::step_decimals(1.0), 0);
+  EXPECT_EQ(OrderGateway::step_decimals(10.0), 0);
+  EXPECT_EQ(OrderGateway::step_decimals(1e-12), GATEWAY_MAX_DECIMALS);
+}
+
+TEST(OrderGatewayPaperTest, PlacesAndCancelsOnPaperExchange) {
+  PaperExchange exchange;
+  exchange.add_symbol("btcusdt", 0.01, 0.00001);
+  exchange.on_trade("btcusdt", 1700000000000, 50000.0, 1.0);
+  HttpServer server;
+  exchange.serve(server);
+  ASSERT_TRUE(server.start());
+
+  GatewayConfig config;
+  config.host = "127.0.0.1";
+  config.port = server.port();
+  config.tls = false;
+  config.keepalive_ms = 0;
+  OrderGateway gateway(config);
+  ASSERT_TRUE(gateway.start());
+  const std::size_t bid = gateway.prepare_order("btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 2, 5);
+  GatewayResponse placed = gateway.place_order(bid, 49000.0, 0.25);
+  ASSERT_EQ(placed.status, 200) << placed.body;
+  EXPECT_NE(placed.body.find("\"status\":\"NEW\""), std::string::npos);
+  ASSERT_EQ(exchange.open_orders("btcusdt").size(), 1u);
+
+  GatewayResponse cancelled = gateway.cancel_order("btcusdt", exchange.open_orders("btcusdt")[0].id);
+  EXPECT_EQ(cancelled.status, 200);
+  EXPECT_NE(cancelled.body.find("\"status\":\"CANCELED\""), std::string::npos);
+  EXPECT_TRUE(exchange.open_orders().empty());
+  gateway.stop();
+  server.stop();
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <limits>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/exchange/OrderBook.h"
+#include "../include/exchange/PaperExchange.h"
+#include "../include/net/HttpServer.h"
+
+namespace {
+  std::string http_call(std::uint16_t port, const std::string& method, const std::string& target,
+                        const std::string& form = "") {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      ::close(fd);
+      return "";
+    }
+    std::string request = method + " " + target + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n";
+    if (!form.empty()) {
+      request += "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: " + std::to_string(form.size()) +
+                 "\r\n";
+    }
+    request += "\r\n" + form;
+    ::send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    for (ssize_t n; (n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0;) {
+      response.append(buffer, static_cast<std::size_t>(n));
+    }
+    ::close(fd);
+    return response;
+  }
+}
+
+TEST(OrderBookTest, MatchesByPriceThenTime) {
+  OrderBook book;
+  std::vector<BookFill> fills;
+  book.add(1, OrderSide::sell, 101, 5, true, fills);
+  book.add(2, OrderSide::sell, 100, 3, true, fills);
+  book.add(3, OrderSide::sell, 100, 4, true, fills);
+  EXPECT_TRUE(fills.empty());
+  EXPECT_EQ(book.best_ask(), 100);
+  EXPECT_EQ(book.quantity_at(OrderSide::sell, 100), 7);
+
+  // takes 100 in arrival order, then part of 101, and rests nothing (IOC)
+  EXPECT_EQ(book.add(4, OrderSide::buy, 101, 9, false, fills), 0);
+  ASSERT_EQ(fills.size(), 3u);
+  EXPECT_EQ(fills[0].maker_id, 2u);
+  EXPECT_EQ(fills[0].quantity, 3);
+  EXPECT_EQ(fills[1].maker_id, 3u);
+  EXPECT_EQ(fills[2].maker_id, 1u);
+  EXPECT_EQ(fills[2].price, 101);
+  EXPECT_EQ(fills[2].quantity, 2);
+  EXPECT_EQ(book.remaining(1), 3);
+  EXPECT_EQ(book.level_count(OrderSide::sell), 1u);
+
+  // the remainder of a limit buy rests as the new best bid
+  fills.clear();
+  EXPECT_EQ(book.add(5, OrderSide::buy, 101, 10, true, fills), 7);
+  EXPECT_EQ(book.best_bid(), 101);
+  EXPECT_EQ(book.best_ask(), 0);
+  EXPECT_EQ(book.remaining(5), 7);
+}
+
+TEST(OrderBookTest, CancelsFromMiddleOfQueueAndTradesThrough) {
+  OrderBook book;
+  std::vector<BookFill> fills;
+  book.add(1, OrderSide::buy, 99, 2, true, fills);
+  book.add(2, OrderSide::buy, 99, 2, true, fills);
+  book.add(3, OrderSide::buy, 99, 2, true, fills);
+  book.add(4, OrderSide::buy, 98, 2, true, fills);
+  EXPECT_TRUE(book.cancel(2));
+  EXPECT_FALSE(book.cancel(2));
+  EXPECT_EQ(book.quantity_at(OrderSide::buy, 99), 4);
+
+  // a real trade at 99 for 3 fills order 1 and part of 3, never the 98 bid
+  book.on_trade(99, 3, fills);
+  ASSERT_EQ(fills.size(), 2u);
+  EXPECT_EQ(fills[0].maker_id, 1u);
+  EXPECT_EQ(fills[0].taker_id, 0u);
+  EXPECT_EQ(fills[1].maker_id, 3u);
+  EXPECT_EQ(fills[1].quantity, 1);
+  EXPECT_EQ(book.remaining(3), 1);
+  EXPECT_EQ(book.remaining(4), 2);
+
+  EXPECT_TRUE(book.cancel(3));
+  EXPECT_EQ(book.best_bid(), 98);
+  EXPECT_EQ(book.order_count(), 1u);
+}
+
+TEST(PaperExchangeTest, DelaysOrdersByLatencyAndFillsOnTradesThrough) {
+  ExchangeConfig config;
+  config.latency_ms = 50;
+  config.fee_rate = 0.001;
+  PaperExchange exchange(config);
+  exchange.add_symbol("btcusdt", 0.01, 0.001);
+  std::vector<PaperFill> fills;
+  exchange.set_fill_handler([&fills](const PaperFill& fill) { fills.push_back(fill); });
+
+  exchange.on_trade("btcusdt", 1000, 100.0, 1.0);
+  const std::uint64_t id =
+    exchange.submit({"btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 99.5, 2.0, "a"}, 1000);
+  ASSERT_NE(id, 0u);
+  PaperOrder order{};
+  ASSERT_TRUE(exchange.order(id, order));
+  EXPECT_EQ(order.status, OrderStatus::pending_new);
+
+  // trades through 99.5 before the order arrives do nothing for it
+  exchange.on_trade("btcusdt", 1020, 99.0, 5.0);
+  exchange.on_trade("btcusdt", 1040, 100.0, 1.0);
+  EXPECT_TRUE(fills.empty());
+  exchange.on_trade("btcusdt", 1060, 99.8, 1.0);
+  ASSERT_TRUE(exchange.order(id, order));
+  EXPECT_EQ(order.status, OrderStatus::open);
+
+  exchange.on_trade("btcusdt", 1100, 99.4, 0.5);
+  ASSERT_EQ(fills.size(), 1u);
+  EXPECT_DOUBLE_EQ(fills[0].price, 99.5);
+  EXPECT_DOUBLE_EQ(fills[0].quantity, 0.5);
+  EXPECT_TRUE(fills[0].maker);
+  EXPECT_NEAR(fills[0].fee, 99.5 * 0.5 * 0.001, 1e-12);
+  ASSERT_TRUE(exchange.order(id, order));
+  EXPECT_EQ(order.status, OrderStatus::partially_filled);
+
+  // the cancel is also delayed, so a fill inside the window still lands
+  EXPECT_TRUE(exchange.cancel(id, 1100));
+  exchange.on_trade("btcusdt", 1120, 99.5, 0.5);
+  exchange.advance(1150);
+  ASSERT_TRUE(exchange.order(id, order));
+  EXPECT_EQ(order.status, OrderStatus::canceled);
+  EXPECT_DOUBLE_EQ(order.executed, 1.0);
+  EXPECT_TRUE(exchange.open_orders().empty());
+}
+
+TEST(PaperExchangeTest, MatchesPaperOrdersThenLastTradeLiquidity) {
+  PaperExchange exchange;
+  exchange.add_symbol("ethusdt", 0.01, 0.01);
+  exchange.on_trade("ethusdt", 1, 2000.0, 1.0);
+
+  const std::uint64_t ask =
+    exchange.submit({"ethusdt", OrderSide::sell, OrderType::limit, TimeInForce::gtc, 2001.0, 1.0, ""}, 2);
+  const std::uint64_t buy =
+    exchange.submit({"ethusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 0.0, 3.0, ""}, 3);
+  PaperOrder order{};
+  ASSERT_TRUE(exchange.order(ask, order));
+  EXPECT_EQ(order.status, OrderStatus::filled);
+  ASSERT_TRUE(exchange.order(buy, order));
+  EXPECT_EQ(order.status, OrderStatus::filled);
+  EXPECT_DOUBLE_EQ(order.quote_executed, 2001.0 + 2.0 * 2000.0);
+
+  EXPECT_EQ(exchange.submit({"ethusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 1.0, 0.001, ""}, 4), 0u);
+  EXPECT_EQ(exchange.submit({"xrpusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 0.0, 1.0, ""}, 4), 0u);
+}
+
+TEST(PaperExchangeTest, ServesBinanceOrderEndpoints) {
+  PaperExchange exchange;
+  exchange.add_symbol("btcusdt", 0.01, 0.00001);
+  exchange.on_trade("btcusdt", 1700000000000, 50000.0, 1.0);
+  HttpServer server;
+  exchange.serve(server);
+  ASSERT_TRUE(server.start());
+
+  std::string placed = http_call(server.port(), "POST", "/api/v3/order",
+                                 "symbol=BTCUSDT&side=BUY&type=LIMIT&timeInForce=GTC&quantity=0.5&price=49000&"
+                                 "newClientOrderId=my%2D1&timestamp=1700000000000&signature=abc");
+  EXPECT_NE(placed.find("200 OK"), std::string::npos);
+  EXPECT_NE(placed.find("\"status\":\"NEW\""), std::string::npos);
+  EXPECT_NE(placed.find("\"clientOrderId\":\"my-1\""), std::string::npos);
+  EXPECT_NE(placed.find("\"symbol\":\"BTCUSDT\""), std::string::npos);
+
+  std::string open = http_call(server.port(), "GET", "/api/v3/openOrders?symbol=BTCUSDT");
+  EXPECT_NE(open.find("\"origQty\":\"0.50000000\""), std::string::npos);
+
+  std::string taker =
+    http_call(server.port(), "POST", "/api/v3/order?symbol=BTCUSDT&side=SELL&type=MARKET&quantity=0.2");
+  EXPECT_NE(taker.find("\"status\":\"FILLED\""), std::string::npos);
+  EXPECT_NE(taker.find("\"price\":\"49000.00000000\",\"qty\":\"0.20000000\""), std::string::npos);
+
+  std::string queried = http_call(server.port(), "GET", "/api/v3/order?symbol=BTCUSDT&origClientOrderId=my-1");
+  EXPECT_NE(queried.find("\"status\":\"PARTIALLY_FILLED\""), std::string::npos);
+  std::string cancelled = http_call(server.port(), "DELETE", "/api/v3/order?symbol=BTCUSDT&origClientOrderId=my-1");
+  EXPECT_NE(cancelled.find("\"status\":\"CANCELED\""), std::string::npos);
+
+  std::string missing = http_call(server.port(), "DELETE", "/api/v3/order?symbol=BTCUSDT&orderId=999");
+  EXPECT_NE(missing.find("400 Bad Request"), std::string::npos);
+  EXPECT_NE(missing.find("-2011"), std::string::npos);
+  std::string bad_symbol =
+    http_call(server.port(), "POST", "/api/v3/order?symbol=NOPE&side=BUY&type=MARKET&quantity=1");
+  EXPECT_NE(bad_symbol.find("-1121"), std::string::npos);
+  server.stop();
+}
+
+TEST(PaperExchangeTest, RejectsNonPositiveOrNonFiniteQuantityAndPrice) {
+  PaperExchange exchange;
+  EXPECT_FALSE(exchange.add_symbol("ethusdt", 0.0, 0.0001));
+  EXPECT_FALSE(exchange.add_symbol("ethusdt", 0.01, -1.0));
+  ASSERT_TRUE(exchange.add_symbol("btcusdt", 0.01, 0.00001));
+  exchange.on_trade("btcusdt", 1700000000000, 50000.0, 1.0);
+  HttpServer server;
+  exchange.serve(server);
+  ASSERT_TRUE(server.start());
+
+  for (const char* quantity : {"nan", "inf", "-1", "0", "1e400", "0.5x"}) {
+    std::string response = http_call(server.port(), "POST",
+                                     std::string("/api/v3/order?symbol=BTCUSDT&side=BUY&type=MARKET&quantity=") +
+                                       quantity);
+    EXPECT_NE(response.find("400 Bad Request"), std::string::npos) << quantity;
+    EXPECT_NE(response.find("Invalid quantity."), std::string::npos) << quantity;
+  }
+  for (const char* price : {"nan", "-inf", "-49000", "0"}) {
+    std::string response =
+      http_call(server.port(), "POST",
+                std::string("/api/v3/order?symbol=BTCUSDT&side=BUY&type=LIMIT&timeInForce=GTC&quantity=1&price=") +
+                  price);
+    EXPECT_NE(response.find("400 Bad Request"), std::string::npos) << price;
+    EXPECT_NE(response.find("Invalid price."), std::string::npos) << price;
+  }
+  server.stop();
+
+  EXPECT_EQ(exchange.submit({"btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 1e300, 1.0, ""}, 1), 0u);
+  EXPECT_EQ(exchange.submit({"btcusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 0.0, std::numeric_limits<double>::quiet_NaN(), ""}, 1), 0u);
+  EXPECT_TRUE(exchange.open_orders().empty());
+}
+
+TEST(PaperExchangeTest, ForgetsOldestFinishedOrdersBeyondTheHistory) {
+  ExchangeConfig config;
+  config.order_history = 2;
+  PaperExchange exchange(config);
+  exchange.add_symbol("btcusdt", 0.01, 0.001);
+  exchange.on_trade("btcusdt", 1, 100.0, 1.0);
+
+  const std::uint64_t resting =
+    exchange.submit({"btcusdt", OrderSide::buy, OrderType::limit, TimeInForce::gtc, 90.0, 1.0, "resting"}, 2);
+  std::vector<std::uint64_t> filled;
+  for (int i = 0; i < 5; ++i) {
+    filled.push_back(exchange.submit(
+      {"btcusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 0.0, 1.0, "m" + std::to_string(i)}, 3 + i));
+    ASSERT_NE(filled.back(), 0u);
+  }
+
+  PaperOrder order{};
+  // pruned before each submit, so two finished orders survive it, plus the one it placed
+  EXPECT_FALSE(exchange.order(filled[0], order));
+  EXPECT_FALSE(exchange.order(filled[1], order));
+  EXPECT_TRUE(exchange.order(filled[3], order));
+  EXPECT_TRUE(exchange.order(filled[4], order));
+  EXPECT_EQ(order.status, OrderStatus::filled);
+  ASSERT_TRUE(exchange.order(resting, order));
+  EXPECT_EQ(order.status, OrderStatus::open);
+  // a forgotten order's client id is free again
+  EXPECT_NE(exchange.submit({"btcusdt", OrderSide::buy, OrderType::market, TimeInForce::ioc, 0.0, 1.0, "m0"}, 9), 0u);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "../include/exchange/PaperExchange.h"
+#include "../include/exchange/PaperOrderRouter.h"
+#include "../include/net/HttpServer.h"
+#include "../include/risk/PositionBook.h"
+
+class PaperOrderRouterTest : public ::testing::Test {
+protected:
+  const std::int64_t now_ms = 1700000000000;
+  PaperExchange exchange;
+  HttpServer server;
+  StrategyEngine engine;
+  RiskManager risk;
+  PositionBook positions;
+  PaperOrderRouter router{engine, risk, positions};
+  std::mutex notices_mutex;
+  std::vector<std::string> notices;
+
+  void SetUp() override {
+    exchange.add_symbol("btcusdt", 0.01, 0.00001);
+    exchange.on_trade("btcusdt", now_ms, 50000.0, 1.0);
+    exchange.serve(server);
+    ASSERT_TRUE(server.start());
+    router.set_notice_handler([this](const std::string& source, const std::string& message) {
+      std::lock_guard<std::mutex> lock(notices_mutex);
+      notices.push_back(source + ": " + message);
+    });
+  }
+  void TearDown() override {
+    router.stop();
+    server.stop();
+  }
+
+  GatewayConfig gateway_config() const {
+    GatewayConfig config;
+    config.host = "127.0.0.1";
+    config.port = server.port();
+    config.tls = false;
+    config.keepalive_ms = 0;
+    return config;
+  }
+
+  // feeds trades to the router until the symbol's orders are answered and applied
+  bool drain(const std::string& symbol, OrderSide side) {
+    const Coin coin(symbol);
+    const CoinData trade{symbol, 50000.0, 1, 1.0, static_cast<long>(now_ms)};
+    for (int i = 0; i < 200; ++i) {
+      router.on_trade(coin, trade);
+      if (router.in_flight(symbol, side) == 0.0) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+};
+
+TEST_F(PaperOrderRouterTest, RejectsFiltersTheExchangeCannotTrade) {
+  EXPECT_FALSE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.000015}, {})); // 1.5 lots
+  EXPECT_FALSE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.000005}, {})); // below one lot
+  EXPECT_FALSE(router.add_symbol("btcusdt", {0.0, 0.00001, 0.001}, {}));
+  EXPECT_TRUE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.001}, {}));
+  EXPECT_FALSE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.001}, {})); // already routed
+}
+
+TEST_F(PaperOrderRouterTest, FillsFromTheResponseReachRiskAndPositions) {
+  ASSERT_TRUE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.001}, {}));
+  router.on_signal({"test", "btcusdt", SignalSide::buy, 50000.0, now_ms}); // not started yet: nothing sent
+  EXPECT_EQ(router.in_flight("btcusdt", OrderSide::buy), 0.0);
+  ASSERT_TRUE(router.start(gateway_config()));
+  ASSERT_NE(router.gateway(), nullptr);
+
+  router.on_signal({"test", "btcusdt", SignalSide::buy, 50000.0, now_ms});
+  router.on_signal({"test", "ethusdt", SignalSide::buy, 3000.0, now_ms}); // not routed
+  ASSERT_TRUE(drain("btcusdt", OrderSide::buy));
+
+  const std::uint32_t risk_index = risk.index_of("btcusdt");
+  EXPECT_NEAR(risk.position(risk_index), 0.001, 1e-12);
+  EXPECT_DOUBLE_EQ(risk.entry_price(risk_index), 50000.0);
+  PositionSnapshot position;
+  ASSERT_TRUE(positions.position(positions.index_of("btcusdt"), position));
+  EXPECT_NEAR(position.position, 0.001, 1e-12);
+  EXPECT_NEAR(position.fees, 50000.0 * 0.001 * 0.001, 1e-9); // the exchange's fee, from the response's fills
+  EXPECT_EQ(exchange.open_orders().size(), 0u);
+
+  router.on_signal({"test", "btcusdt", SignalSide::sell, 50000.0, now_ms});
+  ASSERT_TRUE(drain("btcusdt", OrderSide::sell));
+  EXPECT_NEAR(risk.position(risk_index), 0.0, 1e-12);
+  std::lock_guard<std::mutex> lock(notices_mutex);
+  EXPECT_TRUE(notices.empty());
+}
+
+TEST_F(PaperOrderRouterTest, CountsOrdersInFlightAgainstTheRiskCheck) {
+  SymbolRiskLimits limits;
+  limits.max_position = 0.0015; // room for one order, not for a second before the first is answered
+  ASSERT_TRUE(router.add_symbol("btcusdt", {0.01, 0.00001, 0.001}, limits));
+  ASSERT_TRUE(router.start(gateway_config()));
+
+  router.on_signal({"test", "btcusdt", SignalSide::buy, 50000.0, now_ms});
+  EXPECT_DOUBLE_EQ(router.in_flight("btcusdt", OrderSide::buy), 0.001);
+  router.on_signal({"test", "btcusdt", SignalSide::buy, 50000.0, now_ms});
+  ASSERT_TRUE(drain("btcusdt", OrderSide::buy));
+  EXPECT_NEAR(risk.position(risk.index_of("btcusdt")), 0.001, 1e-12);
+
+  router.stop();
+  router.on_signal({"test", "btcusdt", SignalSide::sell, 50000.0, now_ms});
+  std::lock_guard<std::mutex> lock(notices_mutex);
+  ASSERT_EQ(notices.size(), 2u);
+  EXPECT_EQ(notices[0].rfind("risk: btcusdt buy blocked: ", 0), 0u) << notices[0];
+  EXPECT_EQ(notices[1], "paper: btcusdt sell dropped: gateway stopped");
+}
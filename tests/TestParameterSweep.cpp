@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include "../include/backtest/ParameterSweep.h"
+#include "../include/history/HistoryWriter.h"
+
+namespace {
+  // straightforward one-parameter-set version of the sweep rule, to check the vectorised lanes against
+  SweepResult reference(const std::vector<double>& prices, std::size_t window, double threshold, double slip_bps,
+                        double fee_rate) {
+    SweepResult result{{}, window, threshold, 0.0, 0.0, 0, 0.0};
+    double cash = 0.0, position = 0.0, peak = 0.0;
+    int pending = 0;
+    for (std::size_t t = 0; t < prices.size(); ++t) {
+      const double p = prices[t];
+      if (pending != 0) {
+        const double price = p * (1.0 + pending * slip_bps / 10000.0);
+        const double fee = price * fee_rate;
+        cash -= pending * price + fee;
+        position += pending;
+        result.fees += fee;
+        ++result.fills;
+        pending = 0;
+      }
+      if (t + 1 >= window) {
+        double sum = 0.0;
+        for (std::size_t i = t + 1 - window; i <= t; ++i) {
+          sum += prices[i];
+        }
+        const double average = sum / static_cast<double>(window);
+        if (position == 0.0 && p < average * (1.0 - threshold)) {
+          pending = 1;
+        } else if (position == 1.0 && p > average * (1.0 + threshold)) {
+          pending = -1;
+        }
+      }
+      const double equity = cash + position * p;
+      peak = std::max(peak, equity);
+      result.max_drawdown = std::max(result.max_drawdown, peak - equity);
+    }
+    result.pnl = cash + position * (prices.empty() ? 0.0 : prices.back());
+    return result;
+  }
+
+  std::vector<double> wave(std::size_t count, double period, double amplitude) {
+    std::vector<double> prices(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      prices[i] = 100.0 + amplitude * std::sin(static_cast<double>(i) * 2.0 * M_PI / period) + 0.001 * i;
+    }
+    return prices;
+  }
+}
+
+TEST(ParameterSweepTest, LanesMatchScalarReference) {
+  const std::vector<double> prices = wave(5000, 97.0, 2.0);
+  const std::vector<std::size_t> windows = {5, 20, 50, 200};
+  const std::vector<double> thresholds = {0.0, 0.002, 0.01, 0.05};
+  std::vector<SweepResult> results = ParameterSweep::simulate(prices, windows, thresholds, 5.0, 0.001);
+  ASSERT_EQ(results.size(), 16u);
+
+  std::uint64_t total_fills = 0;
+  for (const SweepResult& result : results) {
+    SweepResult expected = reference(prices, result.window, result.threshold, 5.0, 0.001);
+    EXPECT_EQ(result.fills, expected.fills) << result.window << " " << result.threshold;
+    EXPECT_NEAR(result.pnl, expected.pnl, 1e-6) << result.window << " " << result.threshold;
+    EXPECT_NEAR(result.fees, expected.fees, 1e-9);
+    EXPECT_NEAR(result.max_drawdown, expected.max_drawdown, 1e-6);
+    total_fills += result.fills;
+  }
+  EXPECT_GT(total_fills, 0u);
+  EXPECT_EQ(results.back().fills, 0u); // 5 % never reached by a 2 % wave
+}
+
+class ParameterSweepRunTest : public ::testing::Test {
+protected:
+  std::filesystem::path test_dir;
+  const std::int64_t day_start = 1735689600000; // 2025-01-01T00:00:00Z
+
+  void SetUp() override {
+    test_dir = std::filesystem::temp_directory_path() / "parameter_sweep_test";
+    std::filesystem::remove_all(test_dir);
+    HistoryWriter writer(test_dir.string());
+    const std::vector<double> btc = wave(3000, 61.0, 1.5);
+    const std::vector<double> eth = wave(3000, 143.0, 3.0);
+    for (std::size_t i = 0; i < btc.size(); ++i) {
+      const auto id = static_cast<std::int64_t>(i + 1);
+      writer.append("btcusdt", TickRecord{day_start + id * 10, id, btc[i], 1.0});
+      writer.append("ethusdt", TickRecord{day_start + id * 10, id, eth[i], 1.0});
+    }
+  }
+  void TearDown() override { std::filesystem::remove_all(test_dir); }
+};
+
+TEST(ParameterSweepTest, RejectsWindowsTheSeriesCannotFill) {
+  const std::vector<double> prices = wave(100, 17.0, 1.0);
+  EXPECT_TRUE(ParameterSweep::simulate(prices, {0, 10}, {0.001}, 0.0, 0.001).empty());
+  EXPECT_TRUE(ParameterSweep::simulate(prices, {10, 101}, {0.001}, 0.0, 0.001).empty());
+  EXPECT_EQ(ParameterSweep::simulate(prices, {10, 100}, {0.001}, 0.0, 0.001).size(), 2u);
+}
+
+TEST_F(ParameterSweepRunTest, RanksGridPerSymbolAndWritesTable) {
+  SweepConfig config;
+  config.history_dir = test_dir.string();
+  config.symbols = {"btcusdt", "ethusdt"};
+  config.windows = {8, 16, 32, 64, 128};
+  config.thresholds = {0.001, 0.005, 0.01};
+  config.threads = 3;
+  std::vector<SweepResult> results = ParameterSweep(config).run();
+  ASSERT_EQ(results.size(), 30u);
+
+  // one ranked block per symbol, each simulated on its own
+  const std::vector<double> btc = wave(3000, 61.0, 1.5);
+  const std::vector<double> eth = wave(3000, 143.0, 3.0);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const SweepResult& result = results[i];
+    EXPECT_EQ(result.symbol, i < 15 ? "btcusdt" : "ethusdt");
+    if (i % 15 != 0) {
+      EXPECT_GE(results[i - 1].pnl, result.pnl);
+    }
+    const SweepResult expected =
+      reference(i < 15 ? btc : eth, result.window, result.threshold, 0.0, 0.001);
+    EXPECT_NEAR(result.pnl, expected.pnl, 1e-6);
+    EXPECT_NEAR(result.max_drawdown, expected.max_drawdown, 1e-6);
+  }
+
+  std::string table_path = (test_dir / "sweep.csv").string();
+  ASSERT_TRUE(ParameterSweep::write_table(results, table_path));
+  std::ifstream table(table_path);
+  std::string header, row;
+  std::getline(table, header);
+  EXPECT_EQ(header, "symbol,rank,window,threshold,pnl,fees,fills,max_drawdown");
+  for (int i = 0; i < 16; ++i) {
+    std::getline(table, row);
+  }
+  EXPECT_EQ(row.rfind("ethusdt,1,", 0), 0u);
+}
+
+TEST_F(ParameterSweepRunTest, RejectsZeroWindowAndSkipsShortSymbols) {
+  SweepConfig config;
+  config.history_dir = test_dir.string();
+  config.windows = {0, 16};
+  config.thresholds = {0.001};
+  EXPECT_TRUE(ParameterSweep(config).run().empty());
+
+  config.windows = {16, 5000}; // longer than either capture
+  EXPECT_TRUE(ParameterSweep(config).run().empty());
+}
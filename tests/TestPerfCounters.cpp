@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../include/metrics/PerfCounters.h"
+
+TEST(PerfCountersTest, ScopesCountCallsEvenWithoutCounters) {
+  PerfTotals before = PERF_PROFILER.totals(PERF_INDICATOR);
+  for (int i = 0; i < 10; ++i) {
+    ScopedPerfCounters scope(PERF_INDICATOR);
+  }
+  EXPECT_EQ(PERF_PROFILER.totals(PERF_INDICATOR).calls, before.calls + 10u);
+}
+
+TEST(PerfCountersTest, MeasuresWorkInsideScope) {
+  if (!PERF_PROFILER.available()) {
+    GTEST_SKIP() << "perf_event_open not permitted here";
+  }
+  PerfTotals before = PERF_PROFILER.totals(PERF_PARSE);
+  volatile double sink = 0.0;
+  {
+    ScopedPerfCounters scope(PERF_PARSE);
+    for (int i = 0; i < 100000; ++i) {
+      sink = sink + i * 0.5;
+    }
+  }
+  PerfTotals after = PERF_PROFILER.totals(PERF_PARSE);
+  EXPECT_GT(after.counters[PERF_INSTRUCTIONS] - before.counters[PERF_INSTRUCTIONS], 100000u);
+  EXPECT_GT(after.counters[PERF_CYCLES], before.counters[PERF_CYCLES]);
+}
+
+TEST(PerfCountersTest, ReportHasOneLinePerStage) {
+  std::string report = PERF_PROFILER.report();
+  EXPECT_EQ(std::count(report.begin(), report.end(), '\n'), PERF_STAGE_COUNT);
+  EXPECT_NE(report.find("indicator"), std::string::npos);
+}
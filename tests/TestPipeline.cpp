@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../include/common/CoinManager.h"
+#include "../include/common/MovingAverage.h"
+#include "../include/strategy/Pipeline.h"
+#include "../include/strategy/RuntimePipeline.h"
+
+namespace {
+  std::vector<double> random_walk(std::size_t count) {
+    std::mt19937 rng(11);
+    std::normal_distribution<double> step(0.0, 0.5);
+    std::vector<double> prices(count);
+    double price = 100.0;
+    for (double& p : prices) {
+      p = price += step(rng);
+    }
+    return prices;
+  }
+}
+
+TEST(PipelineTest, SmaMatchesMovingAverage) {
+  SMA<16> sma;
+  MovingAverage average(16);
+  for (double price : random_walk(100)) {
+    sma.update(price);
+    average.update(price);
+    EXPECT_NEAR(sma.value(), average.get_value(), 1e-9);
+    EXPECT_EQ(sma.ready(), average.is_ready());
+  }
+}
+
+TEST(PipelineTest, EmaFollowsRecurrence) {
+  EMA<3> ema;
+  ema.update(10.0);
+  EXPECT_DOUBLE_EQ(ema.value(), 10.0);
+  ema.update(20.0);
+  EXPECT_DOUBLE_EQ(ema.value(), 15.0); // alpha = 0.5
+  EXPECT_FALSE(ema.ready());
+  ema.update(20.0);
+  EXPECT_DOUBLE_EQ(ema.value(), 17.5);
+  EXPECT_TRUE(ema.ready());
+}
+
+TEST(PipelineTest, CompiledAndRuntimePipelinesAgree) {
+  Pipeline<SMA<64>, EMA<8>, CrossRule<EMA<8>, SMA<64>>, PriceCrossRule<SMA<64>>> compiled;
+
+  RuntimePipeline runtime;
+  Indicator& slow = runtime.add_indicator(std::make_unique<RuntimeSMA>(64));
+  Indicator& fast = runtime.add_indicator(std::make_unique<RuntimeEMA>(8));
+  runtime.add_rule(std::make_unique<RuntimeCrossRule>(fast, slow));
+  runtime.add_rule(std::make_unique<RuntimePriceCrossRule>(slow));
+
+  int signals = 0;
+  for (double price : random_walk(5000)) {
+    const int expected = runtime.update(price);
+    ASSERT_EQ(compiled.update(price), expected);
+    signals += expected != SIGNAL_NONE;
+  }
+  EXPECT_GT(signals, 10);
+  EXPECT_DOUBLE_EQ(compiled.get<SMA<64>>().value(), slow.value());
+}
+
+TEST(PipelineTest, PriceCrossRuleBuysBelowAndSellsAbove) {
+  Pipeline<SMA<4>, PriceCrossRule<SMA<4>>> pipeline;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(pipeline.update(100.0), SIGNAL_NONE);
+  }
+  EXPECT_EQ(pipeline.update(104.0), SIGNAL_NONE); // baseline side: above
+  EXPECT_EQ(pipeline.update(90.0), SIGNAL_BUY);
+  EXPECT_EQ(pipeline.update(89.0), SIGNAL_NONE);
+  EXPECT_EQ(pipeline.update(120.0), SIGNAL_SELL);
+}
+
+TEST(PipelineTest, PipelineStrategyEmitsThroughEngine) {
+  CoinManager manager;
+  StrategyEngine engine;
+  PipelineStrategy<Pipeline<SMA<4>, PriceCrossRule<SMA<4>>>> strategy(engine, "sma4_reversion");
+  std::vector<Signal> signals;
+  engine.set_signal_handler([&](const Signal& signal) { signals.push_back(signal); });
+  engine.subscribe("btcusdt", EVENT_TRADE, strategy);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt"});
+
+  long time = 0;
+  for (double price : {100.0, 100.0, 100.0, 100.0, 104.0, 90.0}) {
+    CoinData data{"btcusdt", price, time, 1.0, time};
+    manager.update_coin_data(data);
+    time += 10;
+  }
+  ASSERT_EQ(signals.size(), 1u);
+  EXPECT_STREQ(signals[0].strategy, "sma4_reversion");
+  EXPECT_EQ(signals[0].side, SignalSide::buy);
+  EXPECT_DOUBLE_EQ(signals[0].price, 90.0);
+}
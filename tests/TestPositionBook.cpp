@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "../include/risk/PositionBook.h"
+
+TEST(PositionBookTest, RealizesAgainstAverageCost) {
+  PositionBook book;
+  const std::uint32_t btc = book.add_symbol("btcusdt");
+  EXPECT_EQ(book.add_symbol("btcusdt"), btc);
+
+  book.on_fill(btc, OrderSide::buy, 1.0, 100.0);
+  book.on_fill(btc, OrderSide::buy, 3.0, 120.0, 1.0);
+  PositionSnapshot snapshot;
+  ASSERT_TRUE(book.position(btc, snapshot));
+  EXPECT_DOUBLE_EQ(snapshot.position, 4.0);
+  EXPECT_DOUBLE_EQ(snapshot.entry_price, 115.0);
+  EXPECT_DOUBLE_EQ(snapshot.realized, -1.0);
+  EXPECT_DOUBLE_EQ(snapshot.unrealized, 4.0 * (120.0 - 115.0));
+
+  book.on_fill(btc, OrderSide::sell, 1.0, 125.0);
+  book.position(btc, snapshot);
+  EXPECT_DOUBLE_EQ(snapshot.entry_price, 115.0);
+  EXPECT_DOUBLE_EQ(snapshot.realized, -1.0 + 10.0);
+  EXPECT_DOUBLE_EQ(snapshot.unrealized, 3.0 * 10.0);
+
+  // sell 5 against a long of 3: 3 close at +5 each, 2 open short at 120
+  book.on_fill(btc, OrderSide::sell, 5.0, 120.0);
+  book.position(btc, snapshot);
+  EXPECT_DOUBLE_EQ(snapshot.position, -2.0);
+  EXPECT_DOUBLE_EQ(snapshot.entry_price, 120.0);
+  EXPECT_DOUBLE_EQ(snapshot.realized, 9.0 + 15.0);
+
+  book.on_trade(Coin("btcusdt"), CoinData{"btcusdt", 110.0, 1, 0.5, 0});
+  book.position(btc, snapshot);
+  EXPECT_DOUBLE_EQ(snapshot.unrealized, 20.0);
+  EXPECT_EQ(snapshot.fills, 4u);
+  EXPECT_DOUBLE_EQ(snapshot.fees, 1.0);
+
+  book.on_fill(btc, OrderSide::buy, 2.0, 110.0);
+  book.position(btc, snapshot);
+  EXPECT_DOUBLE_EQ(snapshot.position, 0.0);
+  EXPECT_DOUBLE_EQ(snapshot.entry_price, 0.0);
+  EXPECT_DOUBLE_EQ(snapshot.unrealized, 0.0);
+  EXPECT_DOUBLE_EQ(snapshot.realized, 44.0);
+  EXPECT_FALSE(book.position(7, snapshot));
+}
+
+TEST(PositionBookTest, PortfolioTotalsFollowEverySymbol) {
+  PositionBook book;
+  const std::uint32_t btc = book.add_symbol("btcusdt");
+  const std::uint32_t eth = book.add_symbol("ethusdt");
+  book.on_fill(btc, OrderSide::buy, 0.1, 100.0, 0.01);
+  book.on_fill(eth, OrderSide::sell, 2.0, 30.0, 0.06);
+  book.on_fill(eth, OrderSide::buy, 0.5, 28.0);
+  book.on_price(btc, 90.0);
+  book.on_price(eth, 29.0);
+
+  PortfolioSnapshot totals = book.portfolio();
+  double realized = 0.0;
+  double unrealized = 0.0;
+  for (std::uint32_t i = 0; i < book.size(); ++i) {
+    PositionSnapshot snapshot;
+    book.position(i, snapshot);
+    realized += snapshot.realized;
+    unrealized += snapshot.unrealized;
+  }
+  EXPECT_NEAR(totals.realized, realized, 1e-9);
+  EXPECT_NEAR(totals.unrealized, unrealized, 1e-9);
+  EXPECT_NEAR(totals.pnl(), 1.0 - 0.07 - 1.0 + 1.5, 1e-9);
+  EXPECT_NEAR(totals.gross_notional, 0.1 * 90.0 + 1.5 * 29.0, 1e-9);
+  EXPECT_NEAR(totals.net_notional, 0.1 * 90.0 - 1.5 * 29.0, 1e-9);
+  EXPECT_NEAR(totals.fees, 0.07, 1e-12);
+  EXPECT_EQ(totals.fills, 3u);
+  EXPECT_EQ(totals.open_positions, 2u);
+
+  std::string metrics;
+  book.write_prometheus(metrics);
+  EXPECT_NE(metrics.find("position_size{symbol=\"btcusdt\"} 0.10000000\n"), std::string::npos);
+  EXPECT_NE(metrics.find("portfolio_pnl{kind=\"unrealized\"} 0.50000000\n"), std::string::npos);
+
+  // floating point leftovers of a round trip still count as flat
+  book.on_fill(eth, OrderSide::buy, 0.3, 29.0);
+  book.on_fill(eth, OrderSide::buy, 1.2, 29.0);
+  totals = book.portfolio();
+  EXPECT_EQ(totals.open_positions, 1u);
+
+  PositionBook small(1);
+  EXPECT_EQ(small.add_symbol("a"), 0u);
+  EXPECT_EQ(small.add_symbol("b"), UINT32_MAX);
+}
+
+TEST(PositionBookTest, ReadersNeverSeeTornSnapshots) {
+  PositionBook book(4);
+  const std::uint32_t btc = book.add_symbol("btcusdt");
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> torn{0};
+  std::atomic<std::uint64_t> reads{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 2; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        PositionSnapshot snapshot;
+        book.position(btc, snapshot);
+        // every published state satisfies its own definition of unrealized P&L
+        if (snapshot.unrealized != (snapshot.last_price - snapshot.entry_price) * snapshot.position) {
+          torn.fetch_add(1);
+        }
+        PortfolioSnapshot totals = book.portfolio();
+        if (totals.open_positions > 1) {
+          torn.fetch_add(1);
+        }
+        reads.fetch_add(1);
+      }
+    });
+  }
+  for (int i = 0; i < 200000; ++i) {
+    book.on_fill(btc, i % 3 ? OrderSide::buy : OrderSide::sell, 1.0 + i % 7, 100.0 + i % 13);
+    book.on_price(btc, 100.0 + i % 11);
+  }
+  done.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  EXPECT_GT(reads.load(), 0u);
+  EXPECT_EQ(torn.load(), 0u);
+}
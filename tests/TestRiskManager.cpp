@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "../include/risk/RiskManager.h"
+
+TEST(RiskManagerTest, PositionAndNotionalLimitsOnlyBlockIncreasingOrders) {
+  RiskManager risk;
+  SymbolRiskLimits limits;
+  limits.max_position = 2.5;
+  limits.max_notional = 250.0;
+  const std::uint32_t btc = risk.add_symbol("btcusdt", limits);
+  risk.on_price(btc, 100.0);
+
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 2.0, 100.0), RISK_OK);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 3.0, 100.0), RISK_POSITION_LIMIT | RISK_NOTIONAL_LIMIT);
+
+  risk.on_fill(btc, OrderSide::buy, 2.0, 100.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 0.6, 100.0), RISK_POSITION_LIMIT | RISK_NOTIONAL_LIMIT);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 0.4, 100.0), RISK_OK);
+
+  // the price rises: the same position is now over the notional limit, but selling is always allowed
+  risk.on_price(btc, 200.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 0.1, 200.0), RISK_NOTIONAL_LIMIT);
+  EXPECT_EQ(risk.check(btc, OrderSide::sell, 1.0, 200.0), RISK_OK);
+  // selling through flat into a short of 3 is increasing again
+  EXPECT_EQ(risk.check(btc, OrderSide::sell, 5.0, 200.0), RISK_POSITION_LIMIT | RISK_NOTIONAL_LIMIT);
+
+  EXPECT_EQ(risk.check("ethusdt", OrderSide::buy, 1.0, 10.0), RISK_UNKNOWN_SYMBOL);
+  EXPECT_EQ(RiskManager::describe(RISK_POSITION_LIMIT | RISK_NOTIONAL_LIMIT), "position_limit|notional_limit");
+  EXPECT_EQ(RiskManager::describe(RISK_OK), "ok");
+}
+
+TEST(RiskManagerTest, TracksEntryPriceAndPnlIncrementally) {
+  RiskManager risk;
+  const std::uint32_t btc = risk.add_symbol("btcusdt", {});
+  const std::uint32_t eth = risk.add_symbol("ethusdt", {});
+
+  risk.on_fill(btc, OrderSide::buy, 1.0, 100.0);
+  risk.on_fill(btc, OrderSide::buy, 1.0, 110.0, 0.5);
+  EXPECT_DOUBLE_EQ(risk.position(btc), 2.0);
+  EXPECT_DOUBLE_EQ(risk.entry_price(btc), 105.0);
+  EXPECT_DOUBLE_EQ(risk.pnl(btc), 2.0 * 110.0 - 210.0 - 0.5);
+
+  risk.on_fill(eth, OrderSide::sell, 10.0, 20.0);
+  risk.on_price(eth, 19.0);
+  EXPECT_DOUBLE_EQ(risk.pnl(eth), 10.0);
+  EXPECT_DOUBLE_EQ(risk.gross_notional(), 2.0 * 110.0 + 10.0 * 19.0);
+
+  // reducing keeps the entry, flipping re-opens at the fill price
+  risk.on_fill(btc, OrderSide::sell, 1.0, 120.0);
+  EXPECT_DOUBLE_EQ(risk.entry_price(btc), 105.0);
+  risk.on_fill(btc, OrderSide::sell, 3.0, 120.0);
+  EXPECT_DOUBLE_EQ(risk.position(btc), -2.0);
+  EXPECT_DOUBLE_EQ(risk.entry_price(btc), 120.0);
+
+  Coin coin("btcusdt");
+  risk.on_trade(coin, CoinData{"btcusdt", 125.0, 1, 0.1, 0});
+  // bought 2 for 210 + 0.5 fee, sold 4 at 120, short 2 marked at 125
+  EXPECT_DOUBLE_EQ(risk.pnl(btc), -210.5 + 480.0 - 250.0);
+  EXPECT_DOUBLE_EQ(risk.total_pnl(), risk.pnl(btc) + risk.pnl(eth));
+  EXPECT_DOUBLE_EQ(risk.gross_notional(), 2.0 * 125.0 + 10.0 * 19.0);
+}
+
+TEST(RiskManagerTest, StopLossDailyLossAndHalt) {
+  RiskManager risk;
+  SymbolRiskLimits limits;
+  limits.stop_loss = 0.05;
+  limits.max_price_deviation = 0.1;
+  const std::uint32_t btc = risk.add_symbol("btcusdt", limits);
+  GlobalRiskLimits global;
+  global.max_daily_loss = 100.0;
+  risk.set_global_limits(global);
+
+  risk.on_fill(btc, OrderSide::buy, 10.0, 100.0);
+  risk.on_price(btc, 96.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 96.0), RISK_OK);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 110.0), RISK_PRICE_BAND);
+
+  risk.on_price(btc, 94.0); // 6% down on entry
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 94.0), RISK_STOP_LOSS);
+  EXPECT_EQ(risk.check(btc, OrderSide::sell, 10.0, 94.0), RISK_OK);
+
+  risk.on_price(btc, 89.0); // -110 today
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 89.0), RISK_STOP_LOSS | RISK_DAILY_LOSS);
+  risk.reset_day();
+  EXPECT_DOUBLE_EQ(risk.daily_pnl(), 0.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 89.0), RISK_STOP_LOSS);
+
+  risk.on_fill(btc, OrderSide::sell, 10.0, 89.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 89.0), RISK_OK);
+  risk.halt();
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 89.0), RISK_HALTED);
+  risk.resume();
+  EXPECT_EQ(risk.check(btc, OrderSide::buy, 1.0, 89.0), RISK_OK);
+}
+
+TEST(RiskManagerTest, GrossLimitAcrossSymbolsAndFixedCapacity) {
+  RiskManager risk(2);
+  GlobalRiskLimits global;
+  global.max_gross_notional = 1000.0;
+  risk.set_global_limits(global);
+  const std::uint32_t btc = risk.add_symbol("btcusdt", {});
+  const std::uint32_t eth = risk.add_symbol("ethusdt", {});
+  EXPECT_EQ(risk.add_symbol("solusdt", {}), UINT32_MAX);
+  EXPECT_EQ(risk.add_symbol("btcusdt", {}), btc);
+
+  risk.on_fill(btc, OrderSide::buy, 6.0, 100.0);
+  EXPECT_EQ(risk.check(eth, OrderSide::sell, 20.0, 20.0), RISK_OK);
+  EXPECT_EQ(risk.check(eth, OrderSide::sell, 21.0, 20.0), RISK_GROSS_LIMIT);
+  risk.on_fill(eth, OrderSide::sell, 20.0, 20.0);
+  EXPECT_DOUBLE_EQ(risk.gross_notional(), 1000.0);
+  EXPECT_EQ(risk.check(btc, OrderSide::sell, 6.0, 100.0), RISK_OK);
+}
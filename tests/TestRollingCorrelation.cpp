@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include "../include/risk/RollingCorrelation.h"
+
+namespace {
+  // sample covariance of two return series, computed directly
+  double covariance(const std::vector<double>& x, const std::vector<double>& y) {
+    const double n = static_cast<double>(x.size());
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (std::size_t k = 0; k < x.size(); ++k) {
+      mean_x += x[k] / n;
+      mean_y += y[k] / n;
+    }
+    double sum = 0.0;
+    for (std::size_t k = 0; k < x.size(); ++k) {
+      sum += (x[k] - mean_x) * (y[k] - mean_y);
+    }
+    return sum / (n - 1.0);
+  }
+}
+
+TEST(RollingCorrelationTest, MatchesDirectComputationOverTheWindow) {
+  const std::size_t symbols = 6;
+  const std::size_t window = 20;
+  RollingCorrelation correlation(window, 1000, 8);
+  for (std::size_t i = 0; i < symbols; ++i) {
+    EXPECT_EQ(correlation.add_symbol("sym" + std::to_string(i)), i);
+  }
+  EXPECT_EQ(correlation.add_symbol("sym0"), 0u);
+
+  // a common factor plus noise, so the pairs are genuinely correlated
+  std::mt19937_64 rng(3);
+  std::normal_distribution<double> shock(0.0, 0.001);
+  std::vector<double> prices(symbols, 100.0);
+  std::vector<std::vector<double>> returns(symbols);
+  for (std::int64_t second = 0; second < 95; ++second) {
+    const double market = shock(rng);
+    for (std::size_t i = 0; i < symbols; ++i) {
+      const double previous = prices[i];
+      prices[i] *= std::exp(market * static_cast<double>(i % 3) + shock(rng));
+      // an earlier price in the same second is superseded by the last one
+      correlation.on_price(static_cast<std::uint32_t>(i), previous * 2.0, second * 1000 + 100);
+      correlation.on_price(static_cast<std::uint32_t>(i), prices[i], second * 1000 + 500);
+      if (second > 0) {
+        returns[i].push_back(std::log(prices[i] / previous));
+      }
+    }
+  }
+  correlation.advance_to(95000);
+
+  std::shared_ptr<const CorrelationSnapshot> snapshot = correlation.snapshot();
+  ASSERT_EQ(snapshot->size(), symbols);
+  EXPECT_EQ(snapshot->step, 95u);
+  EXPECT_EQ(snapshot->time_ms, 95000);
+  EXPECT_EQ(snapshot->samples, window);
+  for (std::size_t i = 0; i < symbols; ++i) {
+    const std::vector<double> x(returns[i].end() - window, returns[i].end());
+    EXPECT_NEAR(snapshot->volatility[i], std::sqrt(covariance(x, x)), 1e-12);
+    EXPECT_NEAR(snapshot->correlation_at(i, i), 1.0, 1e-9);
+    for (std::size_t j = 0; j < symbols; ++j) {
+      const std::vector<double> y(returns[j].end() - window, returns[j].end());
+      const double expected = covariance(x, y);
+      EXPECT_NEAR(snapshot->covariance_at(i, j), expected, 1e-12);
+      EXPECT_NEAR(snapshot->correlation_at(i, j), expected / std::sqrt(covariance(x, x) * covariance(y, y)), 1e-8);
+    }
+  }
+  // the shared factor shows up where both symbols load on it
+  EXPECT_GT(snapshot->correlation_at(1, 2), 0.3);
+}
+
+TEST(RollingCorrelationTest, ResamplesOnACommonClock) {
+  RollingCorrelation correlation(4, 1000, 4);
+  const std::uint32_t a = correlation.add_symbol("a");
+  const std::uint32_t b = correlation.add_symbol("b");
+  EXPECT_EQ(correlation.snapshot()->size(), 0u);
+
+  correlation.on_price(a, 100.0, 10500);
+  correlation.on_price(b, 50.0, 10700);
+  correlation.on_price(a, 101.0, 11200); // closes [10000, 11000)
+  EXPECT_EQ(correlation.steps(), 1u);
+  correlation.on_price(b, 51.0, 11900);
+  correlation.advance_to(12000);
+  std::shared_ptr<const CorrelationSnapshot> snapshot = correlation.snapshot();
+  EXPECT_EQ(snapshot->step, 2u);
+  EXPECT_EQ(snapshot->samples, 2u);
+  // first step has no previous close: zero returns; second moves both
+  EXPECT_NEAR(snapshot->mean[a], std::log(1.01) / 2.0, 1e-12);
+  EXPECT_NEAR(snapshot->mean[b], std::log(1.02) / 2.0, 1e-12);
+  EXPECT_NEAR(snapshot->correlation_at(a, b), 1.0, 1e-9);
+
+  // a quiet market: unchanged prices give zero returns, and a long gap leaves only zeros in the window
+  correlation.advance_to(60000);
+  snapshot = correlation.snapshot();
+  EXPECT_EQ(snapshot->step, 50u);
+  EXPECT_EQ(snapshot->time_ms, 60000);
+  EXPECT_DOUBLE_EQ(snapshot->volatility[a], 0.0);
+  EXPECT_DOUBLE_EQ(snapshot->correlation_at(a, b), 0.0);
+
+  // a symbol added later starts from zero returns
+  const std::uint32_t c = correlation.add_symbol("c");
+  correlation.on_price(c, 10.0, 60100);
+  correlation.on_price(a, 100.0, 61100);
+  correlation.advance_to(62000);
+  snapshot = correlation.snapshot();
+  ASSERT_EQ(snapshot->size(), 3u);
+  EXPECT_DOUBLE_EQ(snapshot->mean[c], 0.0);
+  EXPECT_GT(snapshot->volatility[a], 0.0);
+
+  correlation.on_trade(Coin("c"), CoinData{"c", 11.0, 1, 1.0, 62500});
+  correlation.on_trade(Coin("x"), CoinData{"x", 11.0, 1, 1.0, 62600});
+  correlation.advance_to(63000);
+  EXPECT_GT(correlation.snapshot()->mean[c], 0.0);
+  EXPECT_EQ(correlation.add_symbol("d"), 3u);
+  EXPECT_EQ(correlation.add_symbol("e"), UINT32_MAX);
+}
+
+TEST(RollingCorrelationTest, ReadersKeepAConsistentSnapshot) {
+  const std::size_t symbols = 32;
+  RollingCorrelation correlation(30, 1000, symbols);
+  for (std::size_t i = 0; i < symbols; ++i) {
+    correlation.add_symbol("sym" + std::to_string(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> inconsistent{0};
+  std::thread reader([&] {
+    while (!done.load()) {
+      std::shared_ptr<const CorrelationSnapshot> snapshot = correlation.snapshot();
+      const std::size_t n = snapshot->size();
+      for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+          if (snapshot->covariance_at(i, j) != snapshot->covariance_at(j, i)) {
+            ++inconsistent;
+          }
+        }
+        if (snapshot->volatility[i] > 0.0 && std::fabs(snapshot->correlation_at(i, i) - 1.0) > 1e-9) {
+          ++inconsistent;
+        }
+      }
+    }
+  });
+
+  std::mt19937_64 rng(5);
+  std::lognormal_distribution<double> move(0.0, 0.002);
+  std::vector<double> prices(symbols, 100.0);
+  std::shared_ptr<const CorrelationSnapshot> held;
+  for (std::int64_t second = 0; second < 2000; ++second) {
+    for (std::size_t i = 0; i < symbols; ++i) {
+      prices[i] *= move(rng);
+      correlation.on_price(static_cast<std::uint32_t>(i), prices[i], second * 1000 + 1);
+    }
+    if (second == 100) {
+      held = correlation.snapshot();
+    }
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(inconsistent.load(), 0);
+  // a snapshot held by a reader is never reused underneath it
+  EXPECT_EQ(held->step, 100u);
+  EXPECT_EQ(correlation.snapshot()->step, 1999u);
+}
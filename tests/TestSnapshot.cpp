@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "../include/common/CoinManager.h"
+#include "../include/feed/SimulatedFeed.h"
+#include "../include/history/HistoryWriter.h"
+#include "../include/history/Snapshot.h"
+#include "../include/metrics/MetricsRegistry.h"
+
+class SnapshotTest : public ::testing::Test {
+protected:
+  std::filesystem::path test_dir;
+  std::string snapshot_path;
+  const long day_start = 1735689600000;
+
+  void SetUp() override {
+    test_dir = std::filesystem::temp_directory_path() / "snapshot_test";
+    std::filesystem::remove_all(test_dir);
+    std::filesystem::create_directories(test_dir);
+    snapshot_path = (test_dir / "coins.snapshot").string();
+  }
+  void TearDown() override { std::filesystem::remove_all(test_dir); }
+
+  static CoinData trade(const std::string& symbol, long id, double price, long time) {
+    CoinData data;
+    data.symbol = symbol;
+    data.price = price;
+    data.trade_id = id;
+    data.trade_quantity = 1.0;
+    data.trade_time = time;
+    return data;
+  }
+};
+
+TEST_F(SnapshotTest, SaveLoadRoundTrip) {
+  std::vector<CoinSnapshot> coins = {{trade("btcusdt", 42, 97000.5, day_start), {1.0, 2.0, 3.0}, {}},
+                                     {trade("ethusdt", 7, 3100.0, day_start + 5), {}, {}}};
+  ASSERT_TRUE(snapshot::save(snapshot_path, coins, day_start));
+
+  std::vector<CoinSnapshot> loaded;
+  ASSERT_TRUE(snapshot::load(snapshot_path, loaded));
+  ASSERT_EQ(loaded.size(), 2u);
+  EXPECT_EQ(loaded[0].last_trade.symbol, "btcusdt");
+  EXPECT_EQ(loaded[0].last_trade.trade_id, 42);
+  EXPECT_DOUBLE_EQ(loaded[0].last_trade.price, 97000.5);
+  EXPECT_EQ(loaded[0].ma_window, std::vector<double>({1.0, 2.0, 3.0}));
+  EXPECT_EQ(loaded[1].last_trade.trade_time, day_start + 5);
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path + ".tmp"));
+}
+
+TEST_F(SnapshotTest, CorruptSnapshotIgnored) {
+  std::FILE* file = std::fopen(snapshot_path.c_str(), "wb");
+  std::fputs("not a snapshot", file);
+  std::fclose(file);
+
+  std::vector<CoinSnapshot> loaded;
+  EXPECT_FALSE(snapshot::load(snapshot_path, loaded));
+  EXPECT_TRUE(loaded.empty());
+
+  // any other version is refused, not read with this version's layout
+  ASSERT_TRUE(snapshot::save(snapshot_path, {{trade("btcusdt", 1, 1.0, day_start), {}, {}}}, day_start));
+  file = std::fopen(snapshot_path.c_str(), "r+b");
+  const std::uint32_t other_version = SNAPSHOT_VERSION - 1;
+  std::fseek(file, sizeof(std::uint32_t), SEEK_SET); // after the magic
+  std::fwrite(&other_version, sizeof(other_version), 1, file);
+  std::fclose(file);
+  EXPECT_FALSE(snapshot::load(snapshot_path, loaded));
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(SnapshotTest, RestoreMakesMovingAverageReady) {
+  {
+    CoinManager before;
+    before.add_coins({"btcusdt"});
+    for (long i = 0; i < MA_STANDARD_SIZE; ++i) {
+      CoinData data = trade("btcusdt", i, 100.0 + i % 2, day_start + i);
+      before.update_coin_data(data);
+    }
+    ASSERT_TRUE(before.save_snapshot(snapshot_path));
+  }
+
+  CoinManager after;
+  EXPECT_TRUE(after.restore_snapshot(snapshot_path));
+  after.add_coins({"btcusdt"});
+  const Coin* coin = after.all_coins().front();
+  EXPECT_TRUE(coin->moving_average().is_ready());
+  EXPECT_DOUBLE_EQ(coin->moving_average().get_value(), 100.5);
+  EXPECT_EQ(coin->last_trade_id(), MA_STANDARD_SIZE - 1);
+}
+
+TEST_F(SnapshotTest, RestoreResumesBars) {
+  {
+    CoinManager before;
+    before.add_coins({"btcusdt"});
+    // one trade per second for five minutes, then half a minute into the next
+    for (long i = 0; i < 330; ++i) {
+      CoinData data = trade("btcusdt", i, 100.0 + i, day_start + i * 1000);
+      before.update_coin_data(data);
+    }
+    ASSERT_TRUE(before.save_snapshot(snapshot_path));
+  }
+
+  CoinManager after;
+  ASSERT_TRUE(after.restore_snapshot(snapshot_path));
+  after.add_coins({"btcusdt"});
+  const BarBuilder& bars = after.all_coins().front()->bars();
+  const std::size_t minute = bars.find_resolution(60000);
+  ASSERT_LT(minute, bars.resolution_count());
+  ASSERT_EQ(bars.closed_bars(minute), 5u);
+  EXPECT_EQ(bars.closed_bar(minute, 0).open_time, day_start + 240000);
+  EXPECT_DOUBLE_EQ(bars.closed_bar(minute, 0).close, 399.0);
+  EXPECT_EQ(bars.closed_bar(minute, 4).trade_count, 60);
+  ASSERT_TRUE(bars.has_current_bar(minute));
+  EXPECT_DOUBLE_EQ(bars.current_bar(minute).open, 400.0);
+  EXPECT_EQ(bars.current_bar(minute).trade_count, 30);
+  const std::size_t second = bars.find_resolution(1000);
+  EXPECT_EQ(bars.closed_bars(second), std::min<std::size_t>(329, BAR_HISTORY_SIZE));
+  EXPECT_DOUBLE_EQ(bars.closed_bar(second, 0).close, 428.0);
+}
+
+TEST_F(SnapshotTest, RestoreBackfillsGapFromCapture) {
+  const std::string history_dir = (test_dir / "history").string();
+  {
+    HistoryWriter writer(history_dir);
+    CoinManager before;
+    before.set_history_writer(&writer);
+    before.add_coins({"btcusdt"});
+    for (long i = 0; i < 300; ++i) {
+      CoinData data = trade("btcusdt", i, 100.0, day_start + i);
+      before.update_coin_data(data);
+    }
+    ASSERT_TRUE(before.save_snapshot(snapshot_path));
+    // trades after the last checkpoint only survive in the capture
+    for (long i = 300; i < 600; ++i) {
+      CoinData data = trade("btcusdt", i, 200.0, day_start + i);
+      before.update_coin_data(data);
+    }
+  }
+
+  // the replayed trades are counted apart from live ones
+  const Counter& live = METRICS.counter("coin_trades_total", "", MetricsRegistry::label("symbol", "btcusdt"));
+  const Counter& replayed = METRICS.counter("coin_replayed_trades_total", "");
+  const std::uint64_t live_before = live.value();
+  const std::uint64_t replayed_before = replayed.value();
+  CoinManager after;
+  ASSERT_TRUE(after.restore_snapshot(snapshot_path, history_dir));
+  after.add_coins({"btcusdt"});
+  const Coin* coin = after.all_coins().front();
+  EXPECT_EQ(coin->last_trade_id(), 599);
+  EXPECT_DOUBLE_EQ(coin->price(), 200.0);
+  EXPECT_TRUE(coin->moving_average().is_ready());
+  EXPECT_EQ(live.value(), live_before);
+  EXPECT_EQ(replayed.value() - replayed_before, 300u);
+}
+
+TEST_F(SnapshotTest, RestoreResumesTheCaptureVenueOnly) {
+  const std::string history_dir = (test_dir / "history").string();
+  {
+    HistoryWriter writer(history_dir);
+    CoinManager before;
+    before.set_history_writer(&writer);
+    // both feeds number their trades from 1
+    SimulatedFeed binance(before, Venue::binance);
+    SimulatedFeed coinbase(before, Venue::coinbase);
+    binance.connect();
+    coinbase.connect();
+    before.add_feed(&binance);
+    before.add_feed(&coinbase);
+    before.add_coins({"btcusdt"});
+    for (long i = 0; i < 200; ++i) {
+      ASSERT_TRUE(binance.push_trade("btcusdt", 100.0, 1.0, day_start + i));
+      ASSERT_TRUE(coinbase.push_trade("btcusdt", 100.0, 1.0, day_start + i));
+    }
+    ASSERT_TRUE(before.save_snapshot(snapshot_path));
+    EXPECT_EQ(before.all_coins().front()->last_trade_id(), 200);
+    for (long i = 200; i < 300; ++i) {
+      ASSERT_TRUE(binance.push_trade("btcusdt", 200.0, 1.0, day_start + i));
+      // coinbase ids 201..700 would overlap and overtake binance's in a shared capture
+      for (int j = 0; j < 5; ++j) {
+        ASSERT_TRUE(coinbase.push_trade("btcusdt", 300.0, 1.0, day_start + i));
+      }
+    }
+  }
+
+  const Counter& replayed = METRICS.counter("coin_replayed_trades_total", "");
+  const std::uint64_t replayed_before = replayed.value();
+  CoinManager after;
+  ASSERT_TRUE(after.restore_snapshot(snapshot_path, history_dir));
+  after.add_coins({"btcusdt"});
+  const Coin* coin = after.all_coins().front();
+  EXPECT_EQ(replayed.value() - replayed_before, 100u);
+  EXPECT_EQ(coin->last_trade_id(), 300);
+  EXPECT_DOUBLE_EQ(coin->price(), 200.0);
+}
+
+TEST_F(SnapshotTest, CheckpointsInBackgroundFromTheFirstTrade) {
+  {
+    CoinManager manager;
+    manager.add_coins({"btcusdt"});
+    manager.enable_checkpoints(snapshot_path, 1000);
+    for (long i = 0; i < 10; ++i) {
+      CoinData data = trade("btcusdt", i, 100.0, day_start + i * 100);
+      manager.update_coin_data(data);
+    }
+    // 900 ms of trade time since the first trade: not due yet
+    EXPECT_FALSE(std::filesystem::exists(snapshot_path));
+    CoinData data = trade("btcusdt", 10, 101.0, day_start + 1000);
+    manager.update_coin_data(data);
+  } // the queued checkpoint is written before the manager goes away
+
+  std::vector<CoinSnapshot> loaded;
+  ASSERT_TRUE(snapshot::load(snapshot_path, loaded));
+  ASSERT_EQ(loaded.size(), 1u);
+  EXPECT_EQ(loaded[0].last_trade.trade_id, 10);
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path + ".tmp"));
+}
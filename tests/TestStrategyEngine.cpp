@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/common/CoinManager.h"
+#include "../include/strategy/MaCrossStrategy.h"
+#include "../include/strategy/StrategyEngine.h"
+
+namespace {
+  struct RecordingStrategy {
+    std::vector<CoinData> trades;
+    std::vector<MaCross> crosses;
+    std::vector<std::pair<long, Bar>> bars;
+
+    void on_trade(const Coin&, const CoinData& trade) { trades.push_back(trade); }
+    void on_ma_cross(const Coin&, const MaCross& cross) { crosses.push_back(cross); }
+    void on_bar_close(const Coin&, long resolution_ms, const Bar& bar) { bars.emplace_back(resolution_ms, bar); }
+  };
+
+  struct TradeOnlyStrategy {
+    int calls = 0;
+    void on_trade(const Coin&, const CoinData&) { ++calls; }
+  };
+
+  CoinData trade(const std::string& symbol, double price, long time) {
+    static long id = 0;
+    return {symbol, price, ++id, 1.0, time};
+  }
+
+  // fills the moving average at `level` so the next trades decide the side of it
+  void fill_average(CoinManager& manager, const std::string& symbol, double level, long& time) {
+    for (int i = 0; i < MA_STANDARD_SIZE; ++i) {
+      CoinData data = trade(symbol, level, time += 10);
+      manager.update_coin_data(data);
+    }
+  }
+}
+
+TEST(StrategyEngineTest, DispatchesOnlyToSubscribedSymbolsAndEvents) {
+  CoinManager manager;
+  StrategyEngine engine;
+  RecordingStrategy btc;
+  TradeOnlyStrategy eth;
+  engine.subscribe("btcusdt", EVENT_TRADE, btc);
+  engine.subscribe("ethusdt", EVENT_TRADE, eth);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt", "ethusdt", "solusdt"});
+
+  CoinData data = trade("btcusdt", 100.0, 1000);
+  manager.update_coin_data(data);
+  data = trade("solusdt", 20.0, 1000);
+  manager.update_coin_data(data);
+  data = trade("ethusdt", 3000.0, 1000);
+  manager.update_coin_data(data);
+
+  ASSERT_EQ(btc.trades.size(), 1u);
+  EXPECT_EQ(btc.trades[0].symbol, "btcusdt");
+  EXPECT_TRUE(btc.crosses.empty());
+  EXPECT_EQ(eth.calls, 1);
+
+  engine.unsubscribe(&btc);
+  data = trade("btcusdt", 101.0, 1010);
+  manager.update_coin_data(data);
+  EXPECT_EQ(btc.trades.size(), 1u);
+}
+
+TEST(StrategyEngineTest, RaisesMaCrossOnlyWhenSideChanges) {
+  CoinManager manager;
+  StrategyEngine engine;
+  RecordingStrategy strategy;
+  engine.subscribe("btcusdt", EVENT_MA_CROSS, strategy);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt"});
+
+  long time = 0;
+  fill_average(manager, "btcusdt", 100.0, time);
+  for (double price : {101.0, 102.0, 99.0, 98.0, 103.0}) {
+    CoinData data = trade("btcusdt", price, time += 10);
+    manager.update_coin_data(data);
+  }
+
+  // 101 sets the baseline side, 99 crosses below, 103 crosses back above
+  ASSERT_EQ(strategy.crosses.size(), 2u);
+  EXPECT_EQ(strategy.crosses[0].direction, CrossDirection::below);
+  EXPECT_DOUBLE_EQ(strategy.crosses[0].price, 99.0);
+  EXPECT_EQ(strategy.crosses[1].direction, CrossDirection::above);
+  EXPECT_DOUBLE_EQ(strategy.crosses[1].price, 103.0);
+  EXPECT_TRUE(strategy.trades.empty());
+}
+
+TEST(StrategyEngineTest, ForwardsBarCloses) {
+  CoinManager manager;
+  StrategyEngine engine;
+  RecordingStrategy strategy;
+  engine.subscribe("btcusdt", EVENT_BAR_CLOSE, strategy);
+  manager.add_coins({"btcusdt"});
+  manager.set_strategy_engine(&engine);
+
+  for (long time : {1000L, 1500L, 2100L}) {
+    CoinData data = trade("btcusdt", 100.0, time);
+    manager.update_coin_data(data);
+  }
+  ASSERT_EQ(strategy.bars.size(), 1u);
+  EXPECT_EQ(strategy.bars[0].first, 1000);
+  EXPECT_EQ(strategy.bars[0].second.trade_count, 2);
+}
+
+TEST(StrategyEngineTest, MaCrossStrategyEmitsAlternatingSignalsWithLatency) {
+  CoinManager manager;
+  StrategyEngine engine;
+  MaCrossStrategy strategy(engine);
+  std::vector<Signal> signals;
+  engine.set_signal_handler([&](const Signal& signal) { signals.push_back(signal); });
+  engine.subscribe("btcusdt", EVENT_MA_CROSS, strategy);
+  manager.set_strategy_engine(&engine);
+  manager.add_coins({"btcusdt"});
+
+  long time = 0;
+  fill_average(manager, "btcusdt", 100.0, time);
+  for (double price : {101.0, 99.0, 101.0, 99.0}) {
+    CoinData data = trade("btcusdt", price, time += 10);
+    manager.update_coin_data(data);
+  }
+
+  ASSERT_EQ(signals.size(), 3u);
+  EXPECT_EQ(signals[0].side, SignalSide::buy);
+  EXPECT_EQ(signals[1].side, SignalSide::sell);
+  EXPECT_EQ(signals[2].side, SignalSide::buy);
+  EXPECT_EQ(signals[0].symbol, "btcusdt");
+  EXPECT_TRUE(strategy.is_long());
+  EXPECT_EQ(engine.tick_to_signal().count(), 3u);
+}
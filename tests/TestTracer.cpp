@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include "../include/metrics/Tracer.h"
+
+namespace {
+  nlohmann::json load_trace(const std::string& path) {
+    std::ifstream in(path);
+    return nlohmann::json::parse(in);
+  }
+}
+
+TEST(TracerTest, NothingRecordedWhileDisabled) {
+  ASSERT_FALSE(TRACER.enabled());
+  std::string path = (std::filesystem::temp_directory_path() / "tracer_disabled.json").string();
+  {
+    TRACE_SCOPE("before start");
+  }
+  ASSERT_TRUE(TRACER.start(path));
+  TRACER.stop();
+
+  nlohmann::json trace = load_trace(path);
+  for (const auto& event : trace) {
+    EXPECT_NE(event["name"], "before start");
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(TracerTest, NamedThreadsHoldNoRingUntilTheyRecord) {
+  ASSERT_FALSE(TRACER.enabled());
+  const std::size_t rings_before = TRACER.rings();
+  std::thread named([]() {
+    TRACER.name_thread("idle");
+    TRACE_SCOPE("while disabled");
+  });
+  named.join();
+  EXPECT_EQ(TRACER.rings(), rings_before);
+}
+
+TEST(TracerTest, WritesNestedSpansPerThread) {
+  std::string path = (std::filesystem::temp_directory_path() / "tracer_spans.json").string();
+  ASSERT_TRUE(TRACER.start(path));
+
+  auto work = [](const char* thread_name) {
+    TRACER.name_thread(thread_name);
+    for (int i = 0; i < 100; ++i) {
+      TRACE_SCOPE("receive");
+      {
+        TRACE_SCOPE("parse");
+      }
+      TRACER.instant("tick");
+    }
+  };
+  std::thread first(work, "first");
+  std::thread second(work, "second");
+  first.join();
+  second.join();
+  TRACER.stop();
+
+  nlohmann::json trace = load_trace(path);
+  ASSERT_TRUE(trace.is_array());
+
+  std::map<std::string, int> spans;
+  std::map<int, std::string> thread_names;
+  double receive_end = 0.0;
+  for (const auto& event : trace) {
+    std::string phase = event["ph"];
+    if (phase == "M") {
+      thread_names[event["tid"].get<int>()] = event["args"]["name"];
+      continue;
+    }
+    ++spans[event["name"].get<std::string>()];
+    if (phase == "X" && event["name"] == "receive") {
+      receive_end = event["ts"].get<double>() + event["dur"].get<double>();
+    } else if (phase == "X" && event["name"] == "parse") {
+      EXPECT_GE(event["dur"].get<double>(), 0.0);
+    }
+  }
+  EXPECT_EQ(spans["receive"], 200);
+  EXPECT_EQ(spans["parse"], 200);
+  EXPECT_EQ(spans["tick"], 200);
+  EXPECT_GT(receive_end, 0.0);
+
+  int named = 0;
+  for (const auto& [tid, name] : thread_names) {
+    named += name == "first" || name == "second";
+  }
+  EXPECT_EQ(named, 2);
+  EXPECT_EQ(TRACER.dropped(), 0u);
+  std::filesystem::remove(path);
+}
+
+TEST(TracerTest, FullBufferDropsInsteadOfBlocking) {
+  std::string path = (std::filesystem::temp_directory_path() / "tracer_drop.json").string();
+  ASSERT_TRUE(TRACER.start(path));
+  std::uint64_t dropped_before = TRACER.dropped();
+  // the serializer drains every TRACE_FLUSH_INTERVAL_MS, far slower than this loop fills the ring
+  for (int i = 0; i < TRACE_BUFFER_EVENTS * 2; ++i) {
+    TRACER.instant("burst");
+  }
+  TRACER.stop();
+  std::uint64_t dropped = TRACER.dropped() - dropped_before;
+  EXPECT_GT(dropped, 0u);
+  EXPECT_LE(TRACER.written() + dropped, static_cast<std::uint64_t>(TRACE_BUFFER_EVENTS) * 2 + 8);
+  std::filesystem::remove(path);
+}
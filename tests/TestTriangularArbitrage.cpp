@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "../include/strategy/TriangularArbitrage.h"
+
+namespace {
+  void trade(StrategyEngine& engine, Coin& coin, double price, long time = 1) {
+    engine.on_trade(coin, CoinData{coin.symbol(), price, time, 1.0, time});
+  }
+}
+
+TEST(TriangularArbitrageTest, BuildsCyclesFromTheCurrencyGraph) {
+  StrategyEngine engine;
+  TriangularArbitrage scanner(engine, {"btcusdt", "ethusdt", "ethbtc", "solusdt", "solbtc", "xrpusdt", "foo"});
+  // triangles btc-usdt-eth and btc-usdt-sol, each traded in both directions; xrp has one edge only
+  EXPECT_EQ(scanner.cycle_count(), 4u);
+}
+
+TEST(TriangularArbitrageTest, ReportsMispricingNetOfFeesOnce) {
+  StrategyEngine engine;
+  const std::vector<std::string> symbols = {"btcusdt", "ethusdt", "ethbtc", "solusdt", "solbtc"};
+  TriangularArbitrage scanner(engine, symbols, 0.001);
+  for (const std::string& symbol : symbols) {
+    engine.subscribe(symbol, EVENT_TRADE, scanner);
+  }
+  std::vector<ArbitrageOpportunity> found;
+  scanner.set_opportunity_handler([&](const ArbitrageOpportunity& opportunity) { found.push_back(opportunity); });
+
+  Coin btcusdt("btcusdt");
+  Coin ethusdt("ethusdt");
+  Coin ethbtc("ethbtc");
+  Coin solusdt("solusdt");
+  trade(engine, btcusdt, 60000.0);
+  trade(engine, ethusdt, 3000.0);
+  trade(engine, solusdt, 150.0);
+  trade(engine, ethbtc, 0.05);
+  EXPECT_TRUE(found.empty());
+
+  // 0.2% off: less than three fees of 0.1%
+  const std::uint64_t before = scanner.evaluations();
+  trade(engine, ethbtc, 0.0501);
+  EXPECT_TRUE(found.empty());
+  // only the two directions of the one triangle ethbtc is part of were looked at
+  EXPECT_EQ(scanner.evaluations() - before, 2u);
+
+  trade(engine, ethbtc, 0.051, 42);
+  ASSERT_EQ(found.size(), 1u);
+  const ArbitrageOpportunity& opportunity = found[0];
+  EXPECT_EQ(opportunity.path, "btc>usdt>eth>btc");
+  EXPECT_EQ(opportunity.symbols[0], "btcusdt");
+  EXPECT_TRUE(opportunity.sells_base[0]);
+  EXPECT_EQ(opportunity.symbols[1], "ethusdt");
+  EXPECT_FALSE(opportunity.sells_base[1]);
+  EXPECT_EQ(opportunity.symbols[2], "ethbtc");
+  EXPECT_TRUE(opportunity.sells_base[2]);
+  EXPECT_NEAR(opportunity.gross_return, 0.02, 1e-12);
+  EXPECT_NEAR(opportunity.net_return, 1.02 * 0.999 * 0.999 * 0.999 - 1.0, 1e-12);
+  EXPECT_EQ(opportunity.trigger, "ethbtc");
+  EXPECT_EQ(opportunity.trade_time, 42);
+  EXPECT_GE(opportunity.latency_ns, 0);
+  EXPECT_EQ(scanner.trigger_to_opportunity().count(), 1u);
+
+  // still open: not reported again until it closes and reopens
+  trade(engine, ethbtc, 0.0512);
+  EXPECT_EQ(found.size(), 1u);
+  trade(engine, ethbtc, 0.05);
+  trade(engine, ethbtc, 0.049);
+  ASSERT_EQ(found.size(), 2u);
+  EXPECT_EQ(found[1].path, "btc>eth>usdt>btc");
+}
+
+TEST(TriangularArbitrageTest, QuotesUseBidAndAsk) {
+  StrategyEngine engine;
+  TriangularArbitrage scanner(engine, {"btcusdt", "ethusdt", "ethbtc"}, 0.0);
+  std::vector<ArbitrageOpportunity> found;
+  scanner.set_opportunity_handler([&](const ArbitrageOpportunity& opportunity) { found.push_back(opportunity); });
+
+  // mid prices are 2% out of line, but the spreads eat it
+  scanner.on_quote(Quote{"btcusdt", 59000.0, 1.0, 61000.0, 1.0, 0});
+  scanner.on_quote(Quote{"ethusdt", 2950.0, 1.0, 3050.0, 1.0, 0});
+  scanner.on_quote(Quote{"ethbtc", 0.0505, 1.0, 0.0515, 1.0, 0});
+  EXPECT_TRUE(found.empty());
+
+  scanner.on_quote(Quote{"btcusdt", 60000.0, 1.0, 60010.0, 1.0, 0});
+  scanner.on_quote(Quote{"ethusdt", 2999.0, 1.0, 3000.0, 1.0, 0});
+  EXPECT_EQ(found.size(), 1u);
+}